@@ -279,6 +279,36 @@ multimap_get_first (struct multimap *map, const void *key)
   return (*node)->value_list[0];
 }
 
+void *
+multimap_get_nth (struct multimap *map, const void *key, int index)
+{
+  if (map == NULL)
+      return NULL;
+
+  return multimap_get_nth_hashed (map, key, map->hashfunc (key), index);
+}
+
+void *
+multimap_get_nth_hashed (struct multimap *map, const void *key, unsigned long hash, int index)
+{
+  unsigned long idx;
+  struct mapnode **node;
+
+  if (map == NULL || index < 0)
+      return NULL;
+
+  idx = hash % map->nbuckets;
+  node = &map->buckets[idx];
+
+  while (*node && map->cmpfunc (key, (*node)->key))
+    node = &(*node)->next;
+
+  if (!(*node) || index >= (*node)->value_size)
+    return NULL;
+
+  return (*node)->value_list[index];
+}
+
 struct multimap_value_iterator *
 multimap_fetch (struct multimap *map, const void *key)
 {
@@ -395,7 +425,7 @@ multimap_contains_key (struct multimap *map, const void *key)
   while (*node && map->cmpfunc (key, (*node)->key))
     node = &(*node)->next;
 
-  return (*node) ? 1 : 0;
+  return (*node) ? (*node)->value_size : 0;
 }
 
 void *
@@ -57,6 +57,27 @@ multimap_push_value (struct multimap *map, const void *key, void *val);
 void *
 multimap_get_first (struct multimap *map, const void *key);
 
+//!
+//! Retrieve the value at position index of all values pushed to the map with the given key.
+//!
+//! Values are kept in insertion order - index 0 equals multimap_get_first().
+//! No allocation is performed.
+//!
+//! \param[in] map Hash map object.
+//! \param[in] key Key used to identify a value in the hash map.
+//! \param[in] index Position of the value to retrieve.
+//! \return Value at position index if it exists, else NULL.
+//!
+void *
+multimap_get_nth (struct multimap *map, const void *key, int index);
+
+//! \brief Same as multimap_get_nth(), with the hash of key computed up front by the caller.
+//!
+//! \param[in] hash Hash of key, as computed by the hash function the map was created with.
+//!
+void *
+multimap_get_nth_hashed (struct multimap *map, const void *key, unsigned long hash, int index);
+
 //! \brief Get a value iterator for a given key.
 //!
 //! The value iterator holds all values associated with the  given key
@@ -0,0 +1,313 @@
+// nftw
+#define _XOPEN_SOURCE 700
+
+// external public includes
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "bench_common.h"
+
+//! glibc entry points of the allocator we count calls into.
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+//! Number of allocations performed by the process (including libdisir).
+//! Counted from every validating thread.
+static unsigned long bench_allocation_count;
+
+// Interpose the allocator to count every allocation made by libdisir.
+void *malloc (size_t size);
+void *calloc (size_t nmemb, size_t size);
+void *realloc (void *ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+    __atomic_fetch_add (&bench_allocation_count, 1, __ATOMIC_RELAXED);
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+    __atomic_fetch_add (&bench_allocation_count, 1, __ATOMIC_RELAXED);
+    return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+    __atomic_fetch_add (&bench_allocation_count, 1, __ATOMIC_RELAXED);
+    return __libc_realloc (ptr, size);
+}
+
+//! PUBLIC
+unsigned long
+bench_allocations (void)
+{
+    return __atomic_load_n (&bench_allocation_count, __ATOMIC_RELAXED);
+}
+
+//! PUBLIC
+double
+bench_elapsed_ns (struct timespec *start, struct timespec *stop)
+{
+    return (stop->tv_sec - start->tv_sec) * 1e9 + (stop->tv_nsec - start->tv_nsec);
+}
+
+//! PUBLIC
+void
+bench_measure (struct bench_state *state, const char *name, double value)
+{
+    if (state->bs_measure_count >= BENCH_MAX_MEASURES)
+        return;
+
+    state->bs_measures[state->bs_measure_count].bm_name = name;
+    state->bs_measures[state->bs_measure_count].bm_value = value;
+    state->bs_measure_count++;
+}
+
+//! PUBLIC
+int64_t
+bench_default (long index, long version)
+{
+    return index + (version - 1) * 1000000;
+}
+
+//! Add keyval index to parent, with a default for each of the versions of the mold.
+static enum disir_status
+bench_mold_keyval (struct disir_context *parent, long index, long versions)
+{
+    enum disir_status status;
+    struct disir_context *keyval;
+    struct disir_version version;
+    char name[32];
+    long i;
+
+    version.sv_major = 1;
+    version.sv_minor = 0;
+
+    snprintf (name, sizeof (name), "keyval_%ld", index);
+    status = dc_add_keyval_integer (parent, name, bench_default (index, 1),
+                                    "benchmark keyval", &version, &keyval);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (i = 2; i <= versions && status == DISIR_STATUS_OK; i++)
+    {
+        version.sv_major = i;
+        status = dc_add_default_integer (keyval, bench_default (index, i), &version);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_add_restriction_value_range (keyval, 0, 1e12, "benchmark range",
+                                                 NULL, NULL);
+    dc_putcontext (&keyval);
+
+    return status;
+}
+
+//! Add section 'level' and the sections nested below it down to the depth of bench to parent.
+//! The innermost section holds the keyvals.
+static enum disir_status
+bench_mold_section (struct disir_context *parent, struct bench_case *bench, long level)
+{
+    enum disir_status status;
+    struct disir_context *section;
+    char name[32];
+    long i;
+
+    status = dc_begin (parent, DISIR_CONTEXT_SECTION, &section);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    snprintf (name, sizeof (name), "level_%ld", level);
+    status = dc_set_name (section, name, strlen (name));
+    if (status == DISIR_STATUS_OK)
+        status = dc_add_documentation (section, "benchmark section", strlen ("benchmark section"));
+    if (status == DISIR_STATUS_OK && level == 1)
+        status = dc_add_restriction_entries_max (section, 0, NULL);
+    if (status == DISIR_STATUS_OK && level < bench->bc_depth)
+        status = bench_mold_section (section, bench, level + 1);
+    for (i = 0; level == bench->bc_depth && i < bench->bc_width; i++)
+    {
+        if (status != DISIR_STATUS_OK)
+            break;
+        status = bench_mold_keyval (section, i, bench->bc_versions);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&section);
+    if (status != DISIR_STATUS_OK)
+        dc_destroy (&section);
+
+    return status;
+}
+
+//! PUBLIC
+enum disir_status
+bench_mold_create (struct bench_case *bench)
+{
+    enum disir_status status;
+    struct disir_context *context;
+
+    status = dc_mold_begin (&context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = bench_mold_section (context, bench, 1);
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    return dc_mold_finalize (&context, &bench->bc_mold);
+}
+
+//! Add section 'level' to parent, mirroring bench_mold_section, with every keyval
+//! set to its default at version 1.0.
+static enum disir_status
+bench_config_section (struct disir_context *parent, struct bench_case *bench, long level)
+{
+    enum disir_status status;
+    struct disir_context *section;
+    struct disir_context *keyval;
+    char name[32];
+    long i;
+
+    status = dc_begin (parent, DISIR_CONTEXT_SECTION, &section);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    snprintf (name, sizeof (name), "level_%ld", level);
+    status = dc_set_name (section, name, strlen (name));
+    if (status == DISIR_STATUS_OK && level < bench->bc_depth)
+        status = bench_config_section (section, bench, level + 1);
+    for (i = 0; level == bench->bc_depth && i < bench->bc_width; i++)
+    {
+        if (status != DISIR_STATUS_OK)
+            break;
+        snprintf (name, sizeof (name), "keyval_%ld", i);
+        status = dc_begin (section, DISIR_CONTEXT_KEYVAL, &keyval);
+        if (status != DISIR_STATUS_OK)
+            break;
+        status = dc_set_name (keyval, name, strlen (name));
+        if (status == DISIR_STATUS_OK)
+            status = dc_set_value_integer (keyval, bench_default (i, 1));
+        if (status == DISIR_STATUS_OK)
+            status = dc_finalize (&keyval);
+        if (status != DISIR_STATUS_OK)
+            dc_destroy (&keyval);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&section);
+    if (status != DISIR_STATUS_OK)
+        dc_destroy (&section);
+
+    return status;
+}
+
+//! PUBLIC
+enum disir_status
+bench_config_begin (struct bench_case *bench, struct disir_context **context)
+{
+    enum disir_status status;
+    struct disir_version version;
+    long i;
+
+    status = dc_config_begin (bench->bc_mold, context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (i = 0; i < bench->bc_repeat; i++)
+    {
+        status = bench_config_section (*context, bench, 1);
+        if (status != DISIR_STATUS_OK)
+            goto error;
+    }
+
+    version.sv_major = 1;
+    version.sv_minor = 0;
+    status = dc_set_version (*context, &version);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    return DISIR_STATUS_OK;
+error:
+    dc_destroy (context);
+    return status;
+}
+
+//! PUBLIC
+size_t
+bench_query_section (struct bench_case *bench, char *query, size_t size)
+{
+    size_t length;
+    long level;
+
+    length = snprintf (query, size, "level_1@%ld", bench->bc_repeat - 1);
+    for (level = 2; level <= bench->bc_depth && length < size; level++)
+    {
+        length += snprintf (query + length, size - length, ".level_%ld", level);
+    }
+
+    return length;
+}
+
+//! PUBLIC
+void
+bench_query_last_keyval (struct bench_case *bench, char *query, size_t size)
+{
+    size_t length;
+
+    length = bench_query_section (bench, query, size);
+    if (length < size)
+        snprintf (query + length, size - length, ".keyval_%ld", bench->bc_width - 1);
+}
+
+//! PUBLIC
+enum disir_status
+bench_section_find (struct bench_case *bench, struct disir_context **section)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    char name[32];
+    long level;
+
+    context = dc_config_getcontext (bench->bc_config);
+    for (level = 1; level <= bench->bc_depth; level++)
+    {
+        snprintf (name, sizeof (name), "level_%ld", level);
+        status = dc_find_element (context, name, 0, section);
+        dc_putcontext (&context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        context = *section;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+static int
+bench_remove_entry (const char *path, const struct stat *statbuf, int type, struct FTW *ftw)
+{
+    (void) statbuf;
+    (void) type;
+    (void) ftw;
+
+    return remove (path);
+}
+
+//! PUBLIC
+int
+bench_remove_tree (const char *path)
+{
+    return nftw (path, bench_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
@@ -0,0 +1,152 @@
+#ifndef _DISIR_BENCH_COMMON_H
+#define _DISIR_BENCH_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <limits.h>
+
+#include <disir/disir.h>
+
+//! Number of rounds to time for each benchmark and case. Best and median rounds are reported.
+#define BENCH_ROUNDS 5
+
+//! Number of operations timed in each round of a microbenchmark.
+#define BENCH_ITERATIONS 10000
+
+//! Maximum nesting depth of the benchmarked configs.
+#define BENCH_MAX_DEPTH 64
+
+//! Maximum length of a query resolving a keyval of the benchmarked configs.
+#define BENCH_MAX_QUERY (BENCH_MAX_DEPTH * 16 + 64)
+
+//! Maximum number of quantities a benchmark measures besides its time.
+#define BENCH_MAX_MEASURES 2
+
+//! Parameters of a case, from the one varied slowest to the one varied fastest.
+enum bench_parameter
+{
+    BENCH_SIZE,
+    BENCH_DEPTH,
+    BENCH_REPEAT,
+    BENCH_VERSIONS,
+    BENCH_ALLOWED,
+    BENCH_THREADS,
+    BENCH_PARAMETERS,
+};
+
+//! Flag of a parameter a benchmark depends on.
+#define BENCH_USES(parameter) (1 << (parameter))
+
+//! Parameters shaping the mold and config of a case.
+#define BENCH_SHAPE (BENCH_USES (BENCH_SIZE) | BENCH_USES (BENCH_DEPTH) \
+                     | BENCH_USES (BENCH_REPEAT) | BENCH_USES (BENCH_VERSIONS))
+
+//! Shape of the benchmarked mold and config.
+struct bench_case
+{
+    //! Requested number of keyvals in the config.
+    long bc_size;
+    //! Nesting depth of the section holding the keyvals.
+    long bc_depth;
+    //! Number of times the outermost section is repeated under the same key.
+    long bc_repeat;
+    //! Number of mold versions, each introducing a new default for every keyval.
+    long bc_versions;
+    //! Number of values each keyval of the restriction benchmarks is restricted to.
+    long bc_allowed;
+    //! Number of threads validating a config.
+    long bc_threads;
+    //! Number of keyvals in each innermost section.
+    long bc_width;
+    //! Flags of the parameters not at the first of their values.
+    //! Benchmarks that do not use them are only run once for the other parameters.
+    int bc_varied;
+
+    struct disir_mold *bc_mold;
+    //! Finalized config at version 1.0 of bc_mold.
+    struct disir_config *bc_config;
+};
+
+//! Quantity measured by a benchmark besides its time.
+struct bench_measure
+{
+    const char *bm_name;
+    double bm_value;
+};
+
+//! State shared by every benchmark.
+struct bench_state
+{
+    struct disir_instance *bs_instance;
+    //! Temporary directory holding the config entries and archives.
+    //! Leaves room within PATH_MAX for the paths below it.
+    char bs_directory[PATH_MAX / 2];
+    char bs_archive[PATH_MAX];
+    int bs_rounds;
+    long bs_iterations;
+    FILE *bs_output;
+    int bs_results;
+    //! Measured by the benchmark currently running, reported along with its time.
+    struct bench_measure bs_measures[BENCH_MAX_MEASURES];
+    int bs_measure_count;
+};
+
+//! Signature of a benchmark. Each round is timed into samples, while operations
+//! is the number of operations timed per round.
+//! DISIR_STATUS_NO_CAN_DO is returned when the benchmark does not apply to the case.
+typedef enum disir_status (*bench_function) (struct bench_state *state,
+                                             struct bench_case *bench,
+                                             double *samples, long *operations);
+
+//! \brief Nanoseconds elapsed between start and stop.
+double
+bench_elapsed_ns (struct timespec *start, struct timespec *stop);
+
+//! \brief Number of allocations made by the process so far, libdisir included.
+unsigned long
+bench_allocations (void);
+
+//! \brief Record a quantity measured by the running benchmark, reported with its result.
+void
+bench_measure (struct bench_state *state, const char *name, double value);
+
+//! \brief Default value of keyval index introduced by mold version.
+int64_t
+bench_default (long index, long version);
+
+//! \brief Construct the mold of bench into bc_mold.
+//!
+//! The outermost section nests sections down to the depth of bench, the innermost
+//! holding bc_width integer keyvals with a default for each of the mold versions.
+//!
+enum disir_status
+bench_mold_create (struct bench_case *bench);
+
+//! \brief Construct a config of the mold of bench at version 1.0, leaving it constructing.
+//!
+//! Setting the version discards what was validated while the config was constructed.
+//!
+enum disir_status
+bench_config_begin (struct bench_case *bench, struct disir_context **context);
+
+//! \brief Query resolving the innermost section of the last repeat of bench.
+//!
+//! \return the length of the query.
+//!
+size_t
+bench_query_section (struct bench_case *bench, char *query, size_t size);
+
+//! \brief Query resolving the last keyval of the last repeat of bench.
+void
+bench_query_last_keyval (struct bench_case *bench, char *query, size_t size);
+
+//! \brief Retrieve the innermost section of the first repeat of the config of bench.
+enum disir_status
+bench_section_find (struct bench_case *bench, struct disir_context **section);
+
+//! \brief Remove path and everything below it.
+int
+bench_remove_tree (const char *path);
+
+#endif // _DISIR_BENCH_COMMON_H
@@ -0,0 +1,1539 @@
+// mkdtemp
+#define _XOPEN_SOURCE 700
+
+// external public includes
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/archive.h>
+#include <disir/context.h>
+#include <disir/version.h>
+#include <disir/fslib/json.h>
+
+#include "bench_common.h"
+
+//! Directory holding the in-tree plugins, unless given with --plugin-dir.
+#ifndef DISIR_BENCH_PLUGIN_DIR
+#define DISIR_BENCH_PLUGIN_DIR "plugins"
+#endif
+
+//! Maximum number of values accepted for each case parameter.
+#define BENCH_MAX_PARAMETERS 16
+
+//! Config size in keyvals represented by each entry of the archive benchmarks.
+#define BENCH_ARCHIVE_KEYVALS 100
+
+//! Group of the generated configs, read and written with their generated mold.
+#define BENCH_GROUP "bench"
+
+//! Group of the archived configs, whose molds come from the test mold set.
+#define BENCH_ARCHIVE_GROUP "archive"
+
+//! Entry of the generated config within BENCH_GROUP. The test mold set only lets the plugin
+//! write entries it has a mold for, such as those within its "super/" namespace.
+//! The generated mold is passed explicitly when the entry is read.
+#define BENCH_ENTRY "super/bench_config"
+
+//! Command line option, limits and default values of each case parameter,
+//! in the order of enum bench_parameter.
+static const struct bench_option
+{
+    const char *bo_option;
+    long bo_minimum;
+    long bo_maximum;
+    int bo_count;
+    long bo_defaults[BENCH_MAX_PARAMETERS];
+} bench_options[BENCH_PARAMETERS] = {
+    { "--size", 1, LONG_MAX, 2, { 1000, 10000 } },
+    { "--depth", 1, BENCH_MAX_DEPTH, 2, { 1, 4 } },
+    { "--repeat", 1, LONG_MAX, 2, { 1, 16 } },
+    { "--versions", 1, 1000, 2, { 1, 4 } },
+    { "--allowed", 1, 100000, 2, { 1, 100 } },
+    { "--threads", 0, 1024, 2, { 1, 4 } },
+};
+
+//! Microbenchmark: resolve the last keyval of the config by query.
+static enum disir_status
+bench_query_resolve (struct bench_state *state, struct bench_case *bench,
+                     double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *keyval;
+    struct timespec start;
+    struct timespec stop;
+    char query[BENCH_MAX_QUERY];
+    long i;
+    int round;
+
+    bench_query_last_keyval (bench, query, sizeof (query));
+    context = dc_config_getcontext (bench->bc_config);
+
+    status = DISIR_STATUS_OK;
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        for (i = 0; i < state->bs_iterations; i++)
+        {
+            status = dc_query_resolve_context (context, query, &keyval);
+            if (status != DISIR_STATUS_OK)
+                break;
+            dc_putcontext (&keyval);
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    dc_putcontext (&context);
+    *operations = state->bs_iterations;
+    return status;
+}
+
+//! Microbenchmark: resolve the last keyval of the config by a query compiled once.
+static enum disir_status
+bench_query_compiled (struct bench_state *state, struct bench_case *bench,
+                      double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *keyval;
+    struct disir_query *compiled;
+    struct timespec start;
+    struct timespec stop;
+    char query[BENCH_MAX_QUERY];
+    long i;
+    int round;
+
+    bench_query_last_keyval (bench, query, sizeof (query));
+    context = dc_config_getcontext (bench->bc_config);
+    status = dc_query_compile (context, query, &compiled);
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_putcontext (&context);
+        return status;
+    }
+
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        for (i = 0; i < state->bs_iterations; i++)
+        {
+            status = dc_query_resolve (context, compiled, &keyval);
+            if (status != DISIR_STATUS_OK)
+                break;
+            dc_putcontext (&keyval);
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    dc_query_finished (&compiled);
+    dc_putcontext (&context);
+    *operations = state->bs_iterations;
+    return status;
+}
+
+//! Microbenchmark: get the value of the last keyval of the config through the config
+//! interface, formatting the query from its arguments on every call.
+static enum disir_status
+bench_query_formatted (struct bench_state *state, struct bench_case *bench,
+                       double *samples, long *operations)
+{
+    enum disir_status status;
+    struct timespec start;
+    struct timespec stop;
+    char section[BENCH_MAX_QUERY];
+    int64_t value;
+    long i;
+    int round;
+
+    bench_query_section (bench, section, sizeof (section));
+
+    status = DISIR_STATUS_OK;
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        for (i = 0; i < state->bs_iterations; i++)
+        {
+            status = disir_config_get_keyval_integer (bench->bc_config, &value,
+                                                      "%s.keyval_%ld", section,
+                                                      bench->bc_width - 1);
+            if (status != DISIR_STATUS_OK)
+                break;
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = state->bs_iterations;
+    return status;
+}
+
+//! Microbenchmark: find each keyval of the innermost section of the first repeat by name,
+//! in turn. Also measures the log lines queued per lookup.
+static enum disir_status
+bench_find_element (struct bench_state *state, struct bench_case *bench,
+                    double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *section;
+    struct disir_context *element;
+    struct disir_log_stats before;
+    struct disir_log_stats after;
+    struct timespec start;
+    struct timespec stop;
+    char (*names)[32];
+    long i;
+    int round;
+
+    status = bench_section_find (bench, &section);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    names = calloc (bench->bc_width, sizeof (*names));
+    if (names == NULL)
+    {
+        dc_putcontext (&section);
+        return DISIR_STATUS_NO_MEMORY;
+    }
+    for (i = 0; i < bench->bc_width; i++)
+    {
+        snprintf (names[i], sizeof (names[i]), "keyval_%ld", i);
+    }
+
+    disir_log_flush ();
+    disir_log_stats (&before);
+
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        for (i = 0; i < state->bs_iterations; i++)
+        {
+            status = dc_find_element (section, names[i % bench->bc_width], 0, &element);
+            if (status != DISIR_STATUS_OK)
+                break;
+            dc_putcontext (&element);
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    disir_log_stats (&after);
+    bench_measure (state, "log_lines_per_op", (double) (after.ls_written - before.ls_written)
+                                              / (state->bs_rounds * state->bs_iterations));
+
+    free (names);
+    dc_putcontext (&section);
+    *operations = state->bs_iterations;
+    return status;
+}
+
+//! Microbenchmark: set and validate the value of a single keyval.
+static enum disir_status
+bench_keyval_set (struct bench_state *state, struct bench_case *bench,
+                  double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *keyval;
+    struct timespec start;
+    struct timespec stop;
+    char query[BENCH_MAX_QUERY];
+    long i;
+    int round;
+
+    bench_query_last_keyval (bench, query, sizeof (query));
+    context = dc_config_getcontext (bench->bc_config);
+    status = dc_query_resolve_context (context, query, &keyval);
+    dc_putcontext (&context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        for (i = 0; i < state->bs_iterations; i++)
+        {
+            status = dc_set_value_integer (keyval, bench_default (bench->bc_width - 1, 1) + i % 2);
+            if (status != DISIR_STATUS_OK)
+                break;
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    // Leave the keyval at its default, so that the update benchmark finds nothing to resolve
+    if (status == DISIR_STATUS_OK)
+        status = dc_set_value_integer (keyval, bench_default (bench->bc_width - 1, 1));
+    dc_putcontext (&keyval);
+    *operations = state->bs_iterations;
+    return status;
+}
+
+//! Macrobenchmark: read the config entry through the test_config_json plugin.
+static enum disir_status
+bench_config_read (struct bench_state *state, struct bench_case *bench,
+                   double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_config *config;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_config_read (state->bs_instance, BENCH_GROUP, BENCH_ENTRY,
+                                    bench->bc_mold, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Macrobenchmark: validate every context of a config anew while finalizing it.
+static enum disir_status
+bench_validate (struct bench_state *state, struct bench_case *bench,
+                double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_config *config;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        status = bench_config_begin (bench, &context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = dc_config_finalize (&context, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+            return status;
+        }
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Macrobenchmark: construct and finalize a config, validating each of its contexts.
+//! Also measures the allocations made and the heap retained per keyval of the config.
+static enum disir_status
+bench_config_construct (struct bench_state *state, struct bench_case *bench,
+                        double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_config *config;
+    struct mallinfo2 heap_before;
+    struct mallinfo2 heap_after;
+    struct timespec start;
+    struct timespec stop;
+    unsigned long allocations;
+    long keyvals;
+    int round;
+
+    allocations = 0;
+    memset (&heap_before, 0, sizeof (heap_before));
+    memset (&heap_after, 0, sizeof (heap_after));
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        heap_before = mallinfo2 ();
+        allocations = bench_allocations ();
+
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = bench_config_begin (bench, &context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        status = dc_config_finalize (&context, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+            return status;
+        }
+
+        allocations = bench_allocations () - allocations;
+        heap_after = mallinfo2 ();
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    keyvals = bench->bc_repeat * bench->bc_width;
+    bench_measure (state, "allocations_per_keyval", (double) allocations / keyvals);
+    bench_measure (state, "heap_bytes_per_keyval",
+                   ((double) heap_after.uordblks - heap_before.uordblks) / keyvals);
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Macrobenchmark: check the whole config for invalid contexts, of which it has none.
+static enum disir_status
+bench_config_valid (struct bench_state *state, struct bench_case *bench,
+                    double *samples, long *operations)
+{
+    enum disir_status status;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_config_valid (bench->bc_config, NULL);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Construct a flat mold of as many keyvals as the config of bench, alternating between
+//! enum and integer keyvals, each restricted to the bc_allowed values of bench.
+static enum disir_status
+bench_restriction_mold_create (struct bench_case *bench, struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *keyval;
+    char name[32];
+    char value[32];
+    long keyvals;
+    long i;
+    long j;
+
+    status = dc_mold_begin (&context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    keyvals = bench->bc_repeat * bench->bc_width;
+    for (i = 0; i < keyvals && status == DISIR_STATUS_OK; i++)
+    {
+        if (i % 2 == 0)
+        {
+            snprintf (name, sizeof (name), "enum_%ld", i);
+            status = dc_add_keyval_enum (context, name, "value_0", "benchmark enum",
+                                         NULL, &keyval);
+        }
+        else
+        {
+            snprintf (name, sizeof (name), "integer_%ld", i);
+            status = dc_add_keyval_integer (context, name, 0, "benchmark integer",
+                                            NULL, &keyval);
+        }
+        if (status != DISIR_STATUS_OK)
+            break;
+
+        for (j = 0; j < bench->bc_allowed && status == DISIR_STATUS_OK; j++)
+        {
+            if (i % 2 == 0)
+            {
+                snprintf (value, sizeof (value), "value_%ld", j);
+                status = dc_add_restriction_value_enum (keyval, value, "allowed", NULL, NULL);
+            }
+            else
+            {
+                status = dc_add_restriction_value_numeric (keyval, j * 3, "allowed",
+                                                           NULL, NULL);
+            }
+        }
+        dc_putcontext (&keyval);
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    return dc_mold_finalize (&context, mold);
+}
+
+//! Construct and finalize a config of the restriction mold of bench,
+//! with every keyval set to the last of its allowed values.
+static enum disir_status
+bench_restriction_config_create (struct bench_case *bench, struct disir_mold *mold,
+                                 struct disir_config **config)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *keyval;
+    char name[32];
+    char value[32];
+    long keyvals;
+    long i;
+
+    status = dc_config_begin (mold, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    snprintf (value, sizeof (value), "value_%ld", bench->bc_allowed - 1);
+    keyvals = bench->bc_repeat * bench->bc_width;
+    for (i = 0; i < keyvals && status == DISIR_STATUS_OK; i++)
+    {
+        status = dc_begin (context, DISIR_CONTEXT_KEYVAL, &keyval);
+        if (status != DISIR_STATUS_OK)
+            break;
+
+        snprintf (name, sizeof (name), i % 2 == 0 ? "enum_%ld" : "integer_%ld", i);
+        status = dc_set_name (keyval, name, strlen (name));
+        if (status == DISIR_STATUS_OK && i % 2 == 0)
+            status = dc_set_value_enum (keyval, value, strlen (value));
+        else if (status == DISIR_STATUS_OK)
+            status = dc_set_value_integer (keyval, (bench->bc_allowed - 1) * 3);
+        if (status == DISIR_STATUS_OK)
+            status = dc_finalize (&keyval);
+        if (status != DISIR_STATUS_OK)
+            dc_destroy (&keyval);
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    return dc_config_finalize (&context, config);
+}
+
+//! Macrobenchmark: construct and finalize a config whose keyvals are each restricted
+//! to bc_allowed values, checking every value against them.
+static enum disir_status
+bench_restriction_check (struct bench_state *state, struct bench_case *bench,
+                         double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_mold *mold;
+    struct disir_config *config;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    status = bench_restriction_mold_create (bench, &mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = bench_restriction_config_create (bench, mold, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            break;
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    disir_mold_finished (&mold);
+
+    *operations = 1;
+    return status;
+}
+
+//! Macrobenchmark: generate a config at version 1.0 of the mold, resolving the default
+//! of every keyval among the defaults of each mold version.
+//! The outermost section is generated once, so the config holds bc_width keyvals.
+static enum disir_status
+bench_generate (struct bench_state *state, struct bench_case *bench,
+                double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_config *config;
+    struct disir_version version;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    version.sv_major = 1;
+    version.sv_minor = 0;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_generate_config_from_mold (bench->bc_mold, &version, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Microbenchmark: retrieve the elements of the innermost section of the first repeat,
+//! take their count and iterate every one of them. Timed per element, so the result
+//! stays flat as the section grows if iterating is linear in the number of elements.
+static enum disir_status
+bench_collection_next (struct bench_state *state, struct bench_case *bench,
+                       double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_context *element;
+    struct disir_collection *collection;
+    struct timespec start;
+    struct timespec stop;
+    long count;
+    int round;
+
+    status = bench_section_find (bench, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    count = 0;
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = dc_get_elements (context, &collection);
+        if (status != DISIR_STATUS_OK)
+            break;
+        count = dc_collection_size (collection);
+        while (dc_collection_next (collection, &element) != DISIR_STATUS_EXHAUSTED)
+        {
+            dc_putcontext (&element);
+        }
+        dc_collection_finished (&collection);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+    dc_putcontext (&context);
+
+    *operations = count > 0 ? count : 1;
+    return status;
+}
+
+//! Count every context visited by dc_walk.
+static enum disir_status
+bench_walk_count (struct disir_context *context, void *userdata)
+{
+    (void) context;
+
+    (*(long *) userdata)++;
+    return DISIR_STATUS_OK;
+}
+
+//! Macrobenchmark: visit every element of the config with dc_walk, borrowing each context.
+//! Timed per element visited.
+static enum disir_status
+bench_walk (struct bench_state *state, struct bench_case *bench,
+            double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct timespec start;
+    struct timespec stop;
+    long count;
+    int round;
+
+    status = DISIR_STATUS_OK;
+    count = 0;
+    context = dc_config_getcontext (bench->bc_config);
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        count = 0;
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = dc_walk (context, bench_walk_count, NULL, &count);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            break;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+    dc_putcontext (&context);
+
+    *operations = count > 0 ? count : 1;
+    return status;
+}
+
+//! Visit every element below context through a collection of its elements,
+//! the way the library traversed configs before dc_walk.
+static enum disir_status
+bench_walk_collection_recursive (struct disir_context *context, long *count)
+{
+    enum disir_status status;
+    struct disir_collection *collection;
+    struct disir_context *element;
+
+    status = dc_get_elements (context, &collection);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    while (status == DISIR_STATUS_OK
+           && dc_collection_next (collection, &element) != DISIR_STATUS_EXHAUSTED)
+    {
+        (*count)++;
+        if (dc_context_type (element) == DISIR_CONTEXT_SECTION)
+            status = bench_walk_collection_recursive (element, count);
+        dc_putcontext (&element);
+    }
+
+    dc_collection_finished (&collection);
+    return status;
+}
+
+//! Macrobenchmark: the walk benchmark, with a collection per section and a
+//! reference taken on every element. Timed per element visited.
+static enum disir_status
+bench_walk_collection (struct bench_state *state, struct bench_case *bench,
+                       double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct timespec start;
+    struct timespec stop;
+    long count;
+    int round;
+
+    status = DISIR_STATUS_OK;
+    count = 0;
+    context = dc_config_getcontext (bench->bc_config);
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        count = 0;
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = bench_walk_collection_recursive (context, &count);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            break;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+    dc_putcontext (&context);
+
+    *operations = count > 0 ? count : 1;
+    return status;
+}
+
+//! Macrobenchmark: serialize and write the config entry through the test_config_json plugin.
+static enum disir_status
+bench_config_write (struct bench_state *state, struct bench_case *bench,
+                    double *samples, long *operations)
+{
+    enum disir_status status;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_config_write (state->bs_instance, BENCH_GROUP, BENCH_ENTRY,
+                                     bench->bc_config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Macrobenchmark: serialize the config to a file with the JSON serializer, without
+//! going through a plugin. Also measures the size of the document, and the growth in
+//! peak resident memory of the process while writing it.
+static enum disir_status
+bench_json_write (struct bench_state *state, struct bench_case *bench,
+                  double *samples, long *operations)
+{
+    enum disir_status status;
+    struct rusage before;
+    struct rusage after;
+    struct timespec start;
+    struct timespec stop;
+    FILE *output;
+    int round;
+
+    output = tmpfile ();
+    if (output == NULL)
+        return DISIR_STATUS_FS_ERROR;
+
+    getrusage (RUSAGE_SELF, &before);
+
+    status = DISIR_STATUS_OK;
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        rewind (output);
+        if (ftruncate (fileno (output), 0) != 0)
+        {
+            status = DISIR_STATUS_FS_ERROR;
+            break;
+        }
+
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = dio_json_serialize_config (state->bs_instance, bench->bc_config, output);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    getrusage (RUSAGE_SELF, &after);
+
+    // The config is written straight to the descriptor
+    bench_measure (state, "document_bytes", lseek (fileno (output), 0, SEEK_END));
+    bench_measure (state, "peak_rss_growth_kib", after.ru_maxrss - before.ru_maxrss);
+
+    fclose (output);
+
+    *operations = 1;
+    return status;
+}
+
+//! Macrobenchmark: read the config from a file with the JSON unserializer, without
+//! going through a plugin. Also measures the size of the document, and the growth in
+//! peak resident memory of the process while reading it.
+static enum disir_status
+bench_json_read (struct bench_state *state, struct bench_case *bench,
+                 double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_config *config;
+    struct rusage before;
+    struct rusage after;
+    struct timespec start;
+    struct timespec stop;
+    FILE *input;
+    int round;
+
+    input = tmpfile ();
+    if (input == NULL)
+        return DISIR_STATUS_FS_ERROR;
+
+    status = dio_json_serialize_config (state->bs_instance, bench->bc_config, input);
+    if (status != DISIR_STATUS_OK)
+    {
+        fclose (input);
+        return status;
+    }
+
+    getrusage (RUSAGE_SELF, &before);
+
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        rewind (input);
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = dio_json_config_fd_read (state->bs_instance, input, bench->bc_mold, &config);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (status != DISIR_STATUS_OK)
+            break;
+        disir_config_finished (&config);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    getrusage (RUSAGE_SELF, &after);
+
+    bench_measure (state, "document_bytes", lseek (fileno (input), 0, SEEK_END));
+    bench_measure (state, "peak_rss_growth_kib", after.ru_maxrss - before.ru_maxrss);
+
+    fclose (input);
+
+    *operations = 1;
+    return status;
+}
+
+//! Macrobenchmark: update a config from version 1.0 to the highest mold version.
+//! The update changes the config in place, so each round updates a config of its own.
+static enum disir_status
+bench_update (struct bench_state *state, struct bench_case *bench,
+              double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_config *config;
+    struct disir_update *update;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    if (bench->bc_versions < 2)
+        return DISIR_STATUS_NO_CAN_DO;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        status = bench_config_begin (bench, &context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        status = dc_config_finalize (&context, &config);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+            return status;
+        }
+
+        update = NULL;
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_update_config (config, NULL, &update);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        if (update)
+            disir_update_finished (&update, NULL);
+        disir_config_finished (&config);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    *operations = 1;
+    return DISIR_STATUS_OK;
+}
+
+//! Upgrade a config at version 1.0 with a plan computed once for the case.
+static enum disir_status
+bench_update_plan (struct bench_state *state, struct bench_case *bench,
+                   double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_config *config;
+    struct disir_update_plan *plan;
+    struct disir_version source;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    if (bench->bc_versions < 2)
+        return DISIR_STATUS_NO_CAN_DO;
+
+    source.sv_major = 1;
+    source.sv_minor = 0;
+    status = disir_update_plan_create (bench->bc_mold, &source, NULL, &plan);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (round = 0; round < state->bs_rounds; round++)
+    {
+        status = bench_config_begin (bench, &context);
+        if (status != DISIR_STATUS_OK)
+            break;
+        status = dc_config_finalize (&context, &config);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+            break;
+        }
+
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_update_plan_apply (plan, config, 0, NULL, NULL);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        disir_config_finished (&config);
+        if (status != DISIR_STATUS_OK)
+            break;
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    disir_update_plan_finished (&plan);
+
+    *operations = 1;
+    return status;
+}
+
+//! Populate the archive group with one config entry per BENCH_ARCHIVE_KEYVALS keyvals
+//! of the case size. The entries share the namespace mold of the test mold set.
+static enum disir_status
+bench_archive_entries (struct bench_state *state, struct bench_case *bench, long *entries)
+{
+    enum disir_status status;
+    struct disir_mold *mold;
+    struct disir_config *config;
+    char path[PATH_MAX];
+    char entry[64];
+    long i;
+
+    snprintf (path, sizeof (path), "%s/%s", state->bs_directory, BENCH_ARCHIVE_GROUP);
+    bench_remove_tree (path);
+
+    status = disir_mold_read (state->bs_instance, BENCH_ARCHIVE_GROUP, "super/archive", &mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+    status = disir_generate_config_from_mold (mold, NULL, &config);
+    disir_mold_finished (&mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    *entries = bench->bc_size / BENCH_ARCHIVE_KEYVALS;
+    if (*entries < 1)
+        *entries = 1;
+    for (i = 0; i < *entries && status == DISIR_STATUS_OK; i++)
+    {
+        snprintf (entry, sizeof (entry), "super/archive_%ld", i);
+        status = disir_config_write (state->bs_instance, BENCH_ARCHIVE_GROUP, entry, config);
+    }
+
+    disir_config_finished (&config);
+    return status;
+}
+
+//! Export every entry of the archive group to the archive of state.
+static enum disir_status
+bench_archive_export_group (struct bench_state *state)
+{
+    enum disir_status status;
+    struct disir_archive *archive;
+
+    status = disir_archive_export_begin (state->bs_instance, NULL, &archive);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = disir_archive_append_group (state->bs_instance, archive, BENCH_ARCHIVE_GROUP);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_archive_finalize (state->bs_instance, NULL, &archive);
+        return status;
+    }
+
+    return disir_archive_finalize (state->bs_instance, state->bs_archive, &archive);
+}
+
+//! Macrobenchmark: export the archive group to a disir archive.
+static enum disir_status
+bench_archive_export (struct bench_state *state, struct bench_case *bench,
+                      double *samples, long *operations)
+{
+    enum disir_status status;
+    struct timespec start;
+    struct timespec stop;
+    int round;
+
+    status = bench_archive_entries (state, bench, operations);
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        unlink (state->bs_archive);
+
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = bench_archive_export_group (state);
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    return status;
+}
+
+//! Macrobenchmark: import a disir archive of the archive group, checking each entry
+//! against the system before discarding the import.
+static enum disir_status
+bench_archive_import (struct bench_state *state, struct bench_case *bench,
+                      double *samples, long *operations)
+{
+    enum disir_status status;
+    struct disir_import *import;
+    struct timespec start;
+    struct timespec stop;
+    int entries;
+    int round;
+
+    status = bench_archive_entries (state, bench, operations);
+    if (status == DISIR_STATUS_OK)
+    {
+        unlink (state->bs_archive);
+        status = bench_archive_export_group (state);
+    }
+    for (round = 0; round < state->bs_rounds && status == DISIR_STATUS_OK; round++)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        status = disir_archive_import (state->bs_instance, state->bs_archive, &import, &entries);
+        if (status == DISIR_STATUS_OK)
+        {
+            status = disir_import_finalize (state->bs_instance, DISIR_IMPORT_DISCARD,
+                                            &import, NULL);
+        }
+        clock_gettime (CLOCK_MONOTONIC, &stop);
+        samples[round] = bench_elapsed_ns (&start, &stop);
+    }
+
+    return status;
+}
+
+//! Benchmarks in the order they are run for each case.
+static const struct bench_entry
+{
+    const char *be_name;
+    //! "micro" reports time per operation, "macro" time per whole-config operation.
+    const char *be_kind;
+    //! Flags of the case parameters the benchmark depends on.
+    int be_parameters;
+    bench_function be_function;
+} bench_entries[] = {
+    { "query_resolve", "micro", BENCH_SHAPE, bench_query_resolve },
+    { "query_compiled", "micro", BENCH_SHAPE, bench_query_compiled },
+    { "query_formatted", "micro", BENCH_SHAPE, bench_query_formatted },
+    { "find_element", "micro", BENCH_SHAPE, bench_find_element },
+    { "keyval_set", "micro", BENCH_SHAPE, bench_keyval_set },
+    { "collection_next", "micro", BENCH_SHAPE, bench_collection_next },
+    { "config_write", "macro", BENCH_SHAPE, bench_config_write },
+    { "config_read", "macro", BENCH_SHAPE, bench_config_read },
+    { "json_write", "macro", BENCH_SHAPE, bench_json_write },
+    { "json_read", "macro", BENCH_SHAPE, bench_json_read },
+    { "config_construct", "macro", BENCH_SHAPE | BENCH_USES (BENCH_THREADS),
+      bench_config_construct },
+    { "validate", "macro", BENCH_SHAPE | BENCH_USES (BENCH_THREADS), bench_validate },
+    { "config_valid", "macro", BENCH_SHAPE | BENCH_USES (BENCH_THREADS), bench_config_valid },
+    { "restriction_check", "macro",
+      BENCH_USES (BENCH_SIZE) | BENCH_USES (BENCH_ALLOWED) | BENCH_USES (BENCH_THREADS),
+      bench_restriction_check },
+    { "walk", "macro", BENCH_SHAPE, bench_walk },
+    { "walk_collection", "macro", BENCH_SHAPE, bench_walk_collection },
+    { "generate", "macro", BENCH_SHAPE, bench_generate },
+    { "update", "macro", BENCH_SHAPE, bench_update },
+    { "update_plan", "macro", BENCH_SHAPE, bench_update_plan },
+    { "archive_export", "macro", BENCH_SHAPE, bench_archive_export },
+    { "archive_import", "macro", BENCH_SHAPE, bench_archive_import },
+};
+
+static int
+bench_compare_samples (const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+//! Output the best and median of the timed rounds, and the quantities the benchmark
+//! measured besides, as one JSON result object.
+static void
+bench_report (struct bench_state *state, const struct bench_entry *entry,
+              struct bench_case *bench, double *samples, long operations)
+{
+    double best;
+    double median;
+    int i;
+
+    qsort (samples, state->bs_rounds, sizeof (double), bench_compare_samples);
+    best = samples[0] / operations;
+    median = samples[state->bs_rounds / 2] / operations;
+
+    fprintf (state->bs_output,
+             "%s\n    {\"name\": \"%s\", \"kind\": \"%s\", \"size\": %ld, \"depth\": %ld, "
+             "\"repeat\": %ld, \"versions\": %ld, \"allowed\": %ld, \"threads\": %ld, "
+             "\"keyvals\": %ld, \"operations\": %ld, \"rounds\": %d, \"best_ns\": %.1f, "
+             "\"median_ns\": %.1f",
+             state->bs_results == 0 ? "" : ",", entry->be_name, entry->be_kind,
+             bench->bc_size, bench->bc_depth, bench->bc_repeat, bench->bc_versions,
+             bench->bc_allowed, bench->bc_threads, bench->bc_repeat * bench->bc_width,
+             operations, state->bs_rounds, best, median);
+    for (i = 0; i < state->bs_measure_count; i++)
+    {
+        fprintf (state->bs_output, ", \"%s\": %.1f", state->bs_measures[i].bm_name,
+                 state->bs_measures[i].bm_value);
+    }
+    fprintf (state->bs_output, "}");
+    state->bs_results++;
+
+    fprintf (stderr, "%-18s %8ld %6ld %7ld %9ld %8ld %8ld %14.1f %14.1f\n", entry->be_name,
+             bench->bc_size, bench->bc_depth, bench->bc_repeat, bench->bc_versions,
+             bench->bc_allowed, bench->bc_threads, best, median);
+}
+
+//! Run every benchmark matching filter on a single case.
+//! Benchmarks are skipped on the cases varying parameters they do not depend on.
+static int
+bench_run_case (struct bench_state *state, struct bench_case *bench, const char *filter)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    double samples[BENCH_ROUNDS];
+    long operations;
+    size_t i;
+
+    bench->bc_width = bench->bc_size / bench->bc_repeat;
+    if (bench->bc_width < 1)
+        bench->bc_width = 1;
+
+    status = disir_validate_threads_set (bench->bc_threads);
+    if (status == DISIR_STATUS_OK)
+        status = bench_mold_create (bench);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = bench_config_begin (bench, &context);
+        if (status == DISIR_STATUS_OK)
+            status = dc_config_finalize (&context, &bench->bc_config);
+        if (status != DISIR_STATUS_OK)
+            disir_mold_finished (&bench->bc_mold);
+    }
+    if (status == DISIR_STATUS_OK)
+    {
+        // Read by config_read when it runs on its own
+        status = disir_config_write (state->bs_instance, BENCH_GROUP, BENCH_ENTRY,
+                                     bench->bc_config);
+        if (status != DISIR_STATUS_OK)
+        {
+            disir_config_finished (&bench->bc_config);
+            disir_mold_finished (&bench->bc_mold);
+        }
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        fprintf (stderr, "failed to construct config of %ld keyvals: %s\n",
+                 bench->bc_size, disir_status_string (status));
+        return 1;
+    }
+
+    for (i = 0; i < sizeof (bench_entries) / sizeof (bench_entries[0]); i++)
+    {
+        if (filter && strstr (bench_entries[i].be_name, filter) == NULL)
+            continue;
+        if ((bench->bc_varied & ~bench_entries[i].be_parameters) != 0)
+            continue;
+
+        operations = 1;
+        state->bs_measure_count = 0;
+        status = bench_entries[i].be_function (state, bench, samples, &operations);
+        if (status == DISIR_STATUS_NO_CAN_DO)
+            continue;
+        if (status != DISIR_STATUS_OK)
+        {
+            fprintf (stderr, "benchmark %s failed: %s (%s)\n", bench_entries[i].be_name,
+                     disir_status_string (status), disir_error (state->bs_instance));
+            break;
+        }
+        bench_report (state, &bench_entries[i], bench, samples, operations);
+    }
+
+    disir_config_finished (&bench->bc_config);
+    disir_mold_finished (&bench->bc_mold);
+
+    return (status == DISIR_STATUS_OK || status == DISIR_STATUS_NO_CAN_DO) ? 0 : 1;
+}
+
+//! Add a plugin section loading the test_config_json plugin into group_id,
+//! storing its config entries below the directory of state.
+static enum disir_status
+bench_plugin_section (struct disir_context *context, const char *plugin_dir,
+                      const char *directory, const char *group_id)
+{
+    enum disir_status status;
+    struct disir_context *section;
+    char path[PATH_MAX];
+
+    status = dc_begin (context, DISIR_CONTEXT_SECTION, &section);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_set_name (section, "plugin", strlen ("plugin"));
+    if (status == DISIR_STATUS_OK)
+    {
+        snprintf (path, sizeof (path), "%s/dplugin_test_config_json.so", plugin_dir);
+        status = dc_config_set_keyval_string (section, path, "plugin_filepath");
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_config_set_keyval_string (section, group_id, "io_id");
+    if (status == DISIR_STATUS_OK)
+        status = dc_config_set_keyval_string (section, group_id, "group_id");
+    if (status == DISIR_STATUS_OK)
+    {
+        snprintf (path, sizeof (path), "%s/%s", directory, group_id);
+        status = dc_config_set_keyval_string (section, path, "config_base_id");
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_config_set_keyval_string (section, path, "mold_base_id");
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&section);
+    if (status != DISIR_STATUS_OK)
+        dc_destroy (&section);
+
+    return status;
+}
+
+//! Create an instance whose plugins read and write config entries below the
+//! directory of state: generated configs in BENCH_GROUP and archived configs
+//! in BENCH_ARCHIVE_GROUP.
+static enum disir_status
+bench_instance_create (struct bench_state *state, const char *plugin_dir)
+{
+    enum disir_status status;
+    struct disir_mold *mold;
+    struct disir_context *context;
+    struct disir_config *config;
+
+    status = disir_libdisir_mold (&mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_config_begin (mold, &context);
+    disir_mold_finished (&mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = bench_plugin_section (context, plugin_dir, state->bs_directory, BENCH_GROUP);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = bench_plugin_section (context, plugin_dir, state->bs_directory,
+                                       BENCH_ARCHIVE_GROUP);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_config_finalize (&context, &config);
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    // The instance steals the config reference
+    return disir_instance_create (NULL, config, &state->bs_instance);
+}
+
+//! Parse the comma separated list of option into values, each between minimum and maximum.
+//! Return 0 on success, or -1 if the list is invalid.
+static int
+bench_parse_list (const char *option, const char *list, long minimum, long maximum,
+                  long *values, int *count)
+{
+    const char *current;
+    char *end;
+
+    *count = 0;
+    current = list;
+    while (*count < BENCH_MAX_PARAMETERS)
+    {
+        values[*count] = strtol (current, &end, 10);
+        if (end == current || (*end != ',' && *end != '\0')
+            || values[*count] < minimum || values[*count] > maximum)
+        {
+            break;
+        }
+        (*count)++;
+        if (*end == '\0')
+            return 0;
+        current = end + 1;
+    }
+
+    fprintf (stderr, "%s takes at most %d values between %ld and %ld: %s\n",
+             option, BENCH_MAX_PARAMETERS, minimum, maximum, list);
+    return -1;
+}
+
+static void
+bench_usage (const char *program)
+{
+    fprintf (stderr,
+             "Usage: %s [options]\n"
+             "  --size N[,N...]      keyvals in the config (default 1000,10000)\n"
+             "  --depth N[,N...]     nesting depth of the keyvals (default 1,4)\n"
+             "  --repeat N[,N...]    repetitions of the outermost section (default 1,16)\n"
+             "  --versions N[,N...]  mold versions (default 1,4)\n"
+             "  --allowed N[,N...]   values allowed by each keyval of restriction_check\n"
+             "                       (default 1,100)\n"
+             "  --threads N[,N...]   threads validating a config, 0 for one per processor\n"
+             "                       (default 1,4)\n"
+             "  --rounds N           timed rounds per result (default %d, at most %d)\n"
+             "  --iterations N       operations per microbenchmark round (default %d)\n"
+             "  --filter NAME        only run benchmarks whose name contains NAME\n"
+             "  --output FILE        write JSON results to FILE instead of stdout\n"
+             "  --plugin-dir DIR     directory of the test plugins (default %s)\n",
+             program, BENCH_ROUNDS, BENCH_ROUNDS, BENCH_ITERATIONS, DISIR_BENCH_PLUGIN_DIR);
+}
+
+//! Populate bench with the parameters of case index, among the values of each parameter.
+//! The first parameter is varied slowest, and the last fastest.
+static void
+bench_case_set (struct bench_case *bench, long values[][BENCH_MAX_PARAMETERS],
+                const int *counts, int index)
+{
+    long parameters[BENCH_PARAMETERS];
+    int parameter;
+    int position;
+
+    bench->bc_varied = 0;
+    for (parameter = BENCH_PARAMETERS - 1; parameter >= 0; parameter--)
+    {
+        position = index % counts[parameter];
+        index /= counts[parameter];
+
+        parameters[parameter] = values[parameter][position];
+        if (position != 0)
+            bench->bc_varied |= BENCH_USES (parameter);
+    }
+
+    bench->bc_size = parameters[BENCH_SIZE];
+    bench->bc_depth = parameters[BENCH_DEPTH];
+    bench->bc_repeat = parameters[BENCH_REPEAT];
+    bench->bc_versions = parameters[BENCH_VERSIONS];
+    bench->bc_allowed = parameters[BENCH_ALLOWED];
+    bench->bc_threads = parameters[BENCH_THREADS];
+}
+
+//! Run the read, query, validate, serialize, update and archive benchmarks for every
+//! combination of the case parameters, and output the results as JSON.
+//! Each result is identified by its name and case parameters, so that results from
+//! different builds can be compared entry by entry.
+//! Usage: disir_bench [options]
+int
+main (int argc, char *argv[])
+{
+    enum disir_status status;
+    struct bench_state state;
+    struct bench_case bench;
+    const char *plugin_dir;
+    const char *filter;
+    const char *output;
+    const char *tmpdir;
+    long values[BENCH_PARAMETERS][BENCH_MAX_PARAMETERS];
+    long value;
+    int counts[BENCH_PARAMETERS];
+    int parameter;
+    int cases;
+    int failed;
+    int res;
+    int i;
+
+    for (parameter = 0; parameter < BENCH_PARAMETERS; parameter++)
+    {
+        memcpy (values[parameter], bench_options[parameter].bo_defaults,
+                sizeof (values[parameter]));
+        counts[parameter] = bench_options[parameter].bo_count;
+    }
+
+    memset (&state, 0, sizeof (state));
+    state.bs_rounds = BENCH_ROUNDS;
+    state.bs_iterations = BENCH_ITERATIONS;
+    plugin_dir = DISIR_BENCH_PLUGIN_DIR;
+    filter = NULL;
+    output = NULL;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            bench_usage (argv[0]);
+            return 1;
+        }
+
+        for (parameter = 0; parameter < BENCH_PARAMETERS; parameter++)
+        {
+            if (strcmp (argv[i], bench_options[parameter].bo_option) == 0)
+                break;
+        }
+
+        res = 0;
+        if (parameter < BENCH_PARAMETERS)
+        {
+            res = bench_parse_list (argv[i], argv[i + 1], bench_options[parameter].bo_minimum,
+                                    bench_options[parameter].bo_maximum, values[parameter],
+                                    &counts[parameter]);
+        }
+        else if (strcmp (argv[i], "--rounds") == 0)
+        {
+            value = atol (argv[i + 1]);
+            if (value < 1 || value > BENCH_ROUNDS)
+            {
+                fprintf (stderr, "rounds must be between 1 and %d: %s\n",
+                         BENCH_ROUNDS, argv[i + 1]);
+                return 1;
+            }
+            state.bs_rounds = value;
+        }
+        else if (strcmp (argv[i], "--iterations") == 0)
+        {
+            state.bs_iterations = atol (argv[i + 1]);
+            if (state.bs_iterations < 1)
+            {
+                fprintf (stderr, "iterations must be positive: %s\n", argv[i + 1]);
+                return 1;
+            }
+        }
+        else if (strcmp (argv[i], "--filter") == 0)
+            filter = argv[i + 1];
+        else if (strcmp (argv[i], "--output") == 0)
+            output = argv[i + 1];
+        else if (strcmp (argv[i], "--plugin-dir") == 0)
+            plugin_dir = argv[i + 1];
+        else
+        {
+            bench_usage (argv[0]);
+            return 1;
+        }
+
+        if (res != 0)
+            return 1;
+        i++;
+    }
+
+    tmpdir = getenv ("TMPDIR");
+    res = snprintf (state.bs_directory, sizeof (state.bs_directory), "%s/disir_bench_XXXXXX",
+                    tmpdir ? tmpdir : "/tmp");
+    if (res >= (int) sizeof (state.bs_directory))
+    {
+        fprintf (stderr, "TMPDIR is too long: %s\n", tmpdir);
+        return 1;
+    }
+    if (mkdtemp (state.bs_directory) == NULL)
+    {
+        perror ("failed to create temporary directory");
+        return 1;
+    }
+    snprintf (state.bs_archive, sizeof (state.bs_archive), "%s/bench.disir",
+              state.bs_directory);
+
+    status = bench_instance_create (&state, plugin_dir);
+    if (status != DISIR_STATUS_OK)
+    {
+        fprintf (stderr, "failed to create instance with plugins from %s: %s\n",
+                 plugin_dir, disir_status_string (status));
+        bench_remove_tree (state.bs_directory);
+        return 1;
+    }
+
+    state.bs_output = stdout;
+    if (output)
+    {
+        state.bs_output = fopen (output, "w");
+        if (state.bs_output == NULL)
+        {
+            perror (output);
+            disir_instance_destroy (&state.bs_instance);
+            bench_remove_tree (state.bs_directory);
+            return 1;
+        }
+    }
+
+    fprintf (state.bs_output, "{\n  \"suite\": \"disir_bench\",\n  \"libdisir_version\": \"%s\","
+             "\n  \"build\": \"%s\",\n  \"results\": [", libdisir_version_string,
+             libdisir_build_string);
+    fprintf (stderr, "%-18s %8s %6s %7s %9s %8s %8s %14s %14s\n", "benchmark", "size", "depth",
+             "repeat", "versions", "allowed", "threads", "best ns/op", "median ns/op");
+
+    failed = 0;
+    memset (&bench, 0, sizeof (bench));
+    cases = 1;
+    for (parameter = 0; parameter < BENCH_PARAMETERS; parameter++)
+    {
+        cases *= counts[parameter];
+    }
+    for (i = 0; i < cases && failed == 0; i++)
+    {
+        bench_case_set (&bench, values, counts, i);
+        failed = bench_run_case (&state, &bench, filter);
+    }
+
+    fprintf (state.bs_output, "\n  ]\n}\n");
+    if (output)
+        fclose (state.bs_output);
+
+    disir_instance_destroy (&state.bs_instance);
+    bench_remove_tree (state.bs_directory);
+
+    return failed;
+}
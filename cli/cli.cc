@@ -20,6 +20,9 @@
 #include <disir/cli/command_export.h>
 #include <disir/cli/command_import.h>
 #include <disir/cli/command_remove.h>
+#include <disir/cli/command_corpus.h>
+#include <disir/cli/command_stats.h>
+#include <disir/cli/command_upgrade.h>
 
 using namespace disir;
 
@@ -289,6 +292,15 @@ Cli::add_default_commands (void)
 
     command_ptr = std::make_shared<CommandRemove> ();
     add_command (command_ptr);
+
+    command_ptr = std::make_shared<CommandCorpus> ();
+    add_command (command_ptr);
+
+    command_ptr = std::make_shared<CommandStats> ();
+    add_command (command_ptr);
+
+    command_ptr = std::make_shared<CommandUpgrade> ();
+    add_command (command_ptr);
 }
 
 void
@@ -0,0 +1,219 @@
+#include <iostream>
+#include <sstream>
+
+#include <disir/disir.h>
+
+#include <disir/cli/command_corpus.h>
+#include <disir/cli/args.hxx>
+
+using namespace disir;
+
+CommandCorpus::CommandCorpus(void)
+    : Command ("corpus")
+{
+}
+
+int
+CommandCorpus::handle_command (std::vector<std::string> &args)
+{
+    enum disir_status status;
+    struct disir_corpus_parameters parameters;
+    std::stringstream group_description;
+    int index;
+
+    disir_corpus_parameters_default (&parameters);
+
+    args::ArgumentParser parser ("Generate a synthetic mold and config for each entry,"
+                                 " written through the plugins of the group.");
+    setup_parser (parser);
+    parser.Prog ("disir corpus");
+
+    args::HelpFlag help (parser, "help", "Display the corpus help menu and exit.",
+                         args::Matcher{'h', "help"});
+
+    group_description << "Specify the group to operate on. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+
+    args::ValueFlag<uint32_t> opt_keys (parser, "N",
+                                        "Number of keyvals in each mold. Default: 100",
+                                        args::Matcher{"keys"});
+    args::ValueFlag<uint32_t> opt_depth (parser, "N",
+                                         "Maximum depth of nested sections. Default: 2",
+                                         args::Matcher{"depth"});
+    args::ValueFlag<uint32_t> opt_fanout (parser, "N",
+                                          "Number of child sections of each section."
+                                          " Default: 4",
+                                          args::Matcher{"fanout"});
+    args::ValueFlag<uint32_t> opt_repeat (parser, "N",
+                                          "Number of config entries of repeatable sections."
+                                          " Default: 2",
+                                          args::Matcher{"repeat"});
+    args::ValueFlag<std::string> opt_types (parser, "TYPE:WEIGHT,...",
+                                            "Relative weights of the value types string,"
+                                            " integer, float, boolean and enum."
+                                            " Default: string:3,integer:3,float:1,boolean:2,enum:1",
+                                            args::Matcher{"types"});
+    args::ValueFlag<uint32_t> opt_restrictions (parser, "PERCENT",
+                                                "Percentage of numeric keyvals with value"
+                                                " restrictions. Default: 50",
+                                                args::Matcher{"restrictions"});
+    args::ValueFlag<uint32_t> opt_versions (parser, "N",
+                                            "Number of mold versions. Default: 3",
+                                            args::Matcher{"versions"});
+    args::ValueFlag<uint64_t> opt_seed (parser, "SEED",
+                                        "Seed of the first entry. Each following entry"
+                                        " increments it. Default: 1",
+                                        args::Matcher{"seed"});
+
+    args::PositionalList<std::string> opt_entries (parser, "entry",
+                                                   "A list of entries to generate.");
+
+    try
+    {
+        parser.ParseArgs (args);
+    }
+    catch (args::Help&)
+    {
+        std::cout << parser;
+        return (0);
+    }
+    catch (args::ParseError& e)
+    {
+        std::cerr << "ParseError: " << e.what() << std::endl;
+        std::cerr << "See '" << parser.Prog() << " --help'" << std::endl;
+        return (1);
+    }
+    catch (args::ValidationError& e)
+    {
+        std::cerr << "ValidationError: " << e.what() << std::endl;
+        std::cerr << "See '" << parser.Prog() << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (!opt_entries)
+    {
+        std::cerr << "No entries to generate." << std::endl;
+        std::cerr << "See '" << parser.Prog() << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (opt_keys)
+        parameters.cp_keys = args::get (opt_keys);
+    if (opt_depth)
+        parameters.cp_depth = args::get (opt_depth);
+    if (opt_fanout)
+        parameters.cp_fanout = args::get (opt_fanout);
+    if (opt_repeat)
+        parameters.cp_repeat = args::get (opt_repeat);
+    if (opt_restrictions)
+        parameters.cp_restrictions = args::get (opt_restrictions);
+    if (opt_versions)
+        parameters.cp_versions = args::get (opt_versions);
+    if (opt_seed)
+        parameters.cp_seed = args::get (opt_seed);
+    if (opt_types && parse_types (args::get (opt_types), parameters) != 0)
+    {
+        return (1);
+    }
+
+    if (opt_group_id && setup_group (args::get (opt_group_id)))
+    {
+        return (1);
+    }
+
+    std::cout << "In group " << m_cli->group_id() << std::endl;
+    index = 0;
+    for (const auto& entry : args::get (opt_entries))
+    {
+        struct disir_corpus_parameters entry_parameters = parameters;
+
+        entry_parameters.cp_seed += index++;
+        status = disir_corpus_write (m_cli->disir(), m_cli->group_id().c_str(),
+                                     entry.c_str(), &entry_parameters);
+        if (status == DISIR_STATUS_INVALID_ARGUMENT)
+        {
+            std::cerr << "Invalid corpus parameters." << std::endl;
+            std::cerr << "See '" << parser.Prog() << " --help'" << std::endl;
+            return (1);
+        }
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "corpus write error: " << entry << std::endl;
+            if (disir_error (m_cli->disir()) != NULL)
+            {
+                std::cerr << disir_error (m_cli->disir()) << std::endl;
+            }
+            else
+            {
+                std::cerr << "(no error registered)" << std::endl;
+            }
+            return (1);
+        }
+
+        std::cout << "  Generated " << entry << " (seed " << entry_parameters.cp_seed << ")"
+                  << std::endl;
+    }
+
+    return (0);
+}
+
+int
+CommandCorpus::parse_types (const std::string& types, struct disir_corpus_parameters& parameters)
+{
+    std::stringstream stream (types);
+    std::string pair;
+    std::string type;
+    std::string weight_string;
+    uint32_t *weight;
+    size_t separator;
+    unsigned long value;
+
+    parameters.cp_weight_string = 0;
+    parameters.cp_weight_integer = 0;
+    parameters.cp_weight_float = 0;
+    parameters.cp_weight_boolean = 0;
+    parameters.cp_weight_enum = 0;
+
+    while (std::getline (stream, pair, ','))
+    {
+        separator = pair.find (':');
+        type = pair.substr (0, separator);
+        weight_string = (separator == std::string::npos) ? "1" : pair.substr (separator + 1);
+
+        if (type == "string")
+            weight = &parameters.cp_weight_string;
+        else if (type == "integer")
+            weight = &parameters.cp_weight_integer;
+        else if (type == "float")
+            weight = &parameters.cp_weight_float;
+        else if (type == "boolean")
+            weight = &parameters.cp_weight_boolean;
+        else if (type == "enum")
+            weight = &parameters.cp_weight_enum;
+        else
+        {
+            std::cerr << "Unknown value type in --types: '" << type << "'" << std::endl;
+            return (1);
+        }
+
+        try
+        {
+            value = std::stoul (weight_string, &separator);
+        }
+        catch (std::exception&)
+        {
+            separator = 0;
+        }
+        if (separator == 0 || separator != weight_string.size() || value > UINT32_MAX)
+        {
+            std::cerr << "Invalid weight in --types: '" << pair << "'" << std::endl;
+            return (1);
+        }
+        *weight = static_cast<uint32_t> (value);
+    }
+
+    return (0);
+}
+
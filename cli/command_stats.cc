@@ -0,0 +1,251 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+
+#include <disir/disir.h>
+
+#include <disir/cli/command_stats.h>
+#include <disir/cli/args.hxx>
+
+using namespace disir;
+
+//! Format a duration in nanoseconds with a sensible unit.
+static std::string
+format_duration (double nanoseconds)
+{
+    std::ostringstream os;
+
+    os << std::fixed << std::setprecision (1);
+    if (nanoseconds < 1000)
+        os << nanoseconds << "ns";
+    else if (nanoseconds < 1000 * 1000)
+        os << nanoseconds / 1000 << "us";
+    else if (nanoseconds < 1000 * 1000 * 1000)
+        os << nanoseconds / (1000 * 1000) << "ms";
+    else
+        os << nanoseconds / (1000 * 1000 * 1000) << "s";
+
+    return os.str();
+}
+
+CommandStats::CommandStats(void)
+    : Command ("stats")
+{
+}
+
+void
+CommandStats::print_counter (std::ostream& os, const std::string& name,
+                             const struct disir_stats_counter& counter)
+{
+    uint64_t timed;
+
+    if (counter.sc_calls == 0)
+        return;
+
+    // Sampled operations time fewer calls than they make.
+    timed = counter.sc_timed;
+    os << "  " << std::left << std::setw (18) << name << std::right
+       << std::setw (10) << counter.sc_calls
+       << std::setw (8) << counter.sc_errors
+       << std::setw (12) << counter.sc_bytes_read
+       << std::setw (12) << counter.sc_bytes_written
+       << std::setw (10) << (timed ? format_duration (static_cast<double> (
+                                                 counter.sc_nanoseconds) / timed)
+                                   : "-")
+       << std::setw (10) << (timed ? format_duration (disir_stats_percentile (&counter, 50))
+                                   : "-")
+       << std::setw (10) << (timed ? format_duration (disir_stats_percentile (&counter, 99))
+                                   : "-")
+       << std::endl;
+}
+
+int
+CommandStats::handle_command (std::vector<std::string> &args)
+{
+    std::stringstream group_description;
+    args::ArgumentParser parser ("Read entries and display the runtime statistics of libdisir.",
+                                 "Latency percentiles are upper bounds of power-of-two buckets.");
+
+    setup_parser (parser);
+    parser.Prog ("disir stats");
+
+    args::HelpFlag help (parser, "help", "Display the stats help menu and exit.",
+                         args::Matcher{'h', "help"});
+
+    group_description << "Specify the group to operate on. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+    args::Flag opt_mold (parser, "mold",
+                         "Read molds instead of configs.",
+                         args::Matcher{"mold"});
+    args::ValueFlag<int> opt_repeat (parser, "N",
+                                     "Number of times to read every entry. Defaults to 1.",
+                                     args::Matcher{"repeat"});
+    args::PositionalList<std::string> opt_entries (parser, "entry",
+                                                   "A list of entries to read."
+                                                   " Defaults to every entry in the group.");
+
+    try
+    {
+        parser.ParseArgs (args);
+    }
+    catch (args::Help&)
+    {
+        std::cout << parser;
+        return (0);
+    }
+    catch (args::ParseError& e)
+    {
+        std::cerr << "ParseError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+    catch (args::ValidationError& e)
+    {
+        std::cerr << "ValidationError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (opt_group_id && setup_group (args::get(opt_group_id)))
+    {
+        return (1);
+    }
+
+    int repeat = 1;
+    if (opt_repeat)
+    {
+        repeat = args::get (opt_repeat);
+        if (repeat < 1)
+        {
+            std::cerr << "Invalid number of repeats: " << repeat << std::endl;
+            return (1);
+        }
+    }
+
+    // Get the set of entries to read
+    enum disir_status status;
+    std::set<std::string> entries_to_read;
+    if (opt_entries)
+    {
+        for (const auto& entry : args::get (opt_entries))
+        {
+            entries_to_read.insert (entry);
+        }
+    }
+    else
+    {
+        struct disir_entry *entries;
+        struct disir_entry *next;
+        struct disir_entry *current;
+
+        if (opt_mold)
+        {
+            status = disir_mold_entries (m_cli->disir(), m_cli->group_id().c_str(), &entries);
+        }
+        else
+        {
+            status = disir_config_entries (m_cli->disir(), m_cli->group_id().c_str(), &entries);
+        }
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "Failed to retrieve available entries: "
+                      << disir_error (m_cli->disir()) << std::endl;
+            return (1);
+        }
+
+        current = entries;
+        while (current != NULL)
+        {
+            next = current->next;
+
+            entries_to_read.insert (std::string(current->de_entry_name));
+
+            disir_entry_finished (&current);
+            current = next;
+        }
+    }
+
+    m_cli->verbose() << "Reading " << entries_to_read.size() << " entries "
+                     << repeat << " time(s)." << std::endl;
+    for (int i = 0; i < repeat; i++)
+    {
+        for (const auto& entry : entries_to_read)
+        {
+            struct disir_config *config = NULL;
+            struct disir_mold *mold = NULL;
+
+            if (opt_mold)
+            {
+                status = disir_mold_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                          entry.c_str(), &mold);
+            }
+            else
+            {
+                status = disir_config_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                            entry.c_str(), NULL, &config);
+            }
+            if (status != DISIR_STATUS_OK)
+            {
+                m_cli->verbose() << "  " << entry << ": " << disir_status_string (status)
+                                 << std::endl;
+            }
+
+            if (config)
+                disir_config_finished (&config);
+            if (mold)
+                disir_mold_finished (&mold);
+        }
+    }
+
+    struct disir_stats *stats = NULL;
+    struct disir_plugin_stats *plugin;
+
+    status = disir_instance_stats (m_cli->disir(), &stats);
+    if (status != DISIR_STATUS_OK)
+    {
+        std::cerr << "Failed to retrieve statistics: " << disir_status_string (status)
+                  << std::endl;
+        return (1);
+    }
+
+    std::cout << "In group " << m_cli->group_id() << std::endl;
+    std::cout << std::endl;
+    std::cout << "  " << std::left << std::setw (18) << "operation" << std::right
+              << std::setw (10) << "calls"
+              << std::setw (8) << "errors"
+              << std::setw (12) << "read"
+              << std::setw (12) << "written"
+              << std::setw (10) << "mean"
+              << std::setw (10) << "p50"
+              << std::setw (10) << "p99"
+              << std::endl;
+
+    for (int i = 0; i < DISIR_STATS_OPERATION_UNKNOWN; i++)
+    {
+        print_counter (std::cout,
+                       disir_stats_operation_string (static_cast<enum disir_stats_operation> (i)),
+                       stats->st_operations[i]);
+    }
+
+    for (plugin = stats->st_plugins; plugin != NULL; plugin = plugin->next)
+    {
+        std::cout << std::endl;
+        std::cout << "  plugin " << plugin->ps_io_id
+                  << " (group " << plugin->ps_group_id << ")" << std::endl;
+        for (int i = 0; i < DISIR_STATS_OPERATION_UNKNOWN; i++)
+        {
+            print_counter (std::cout,
+                           disir_stats_operation_string (
+                               static_cast<enum disir_stats_operation> (i)),
+                           plugin->ps_operations[i]);
+        }
+    }
+    std::cout << std::endl;
+
+    disir_stats_finished (&stats);
+
+    return (0);
+}
@@ -0,0 +1,237 @@
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <set>
+
+#include <disir/disir.h>
+#include <disir/context.h>
+#include <disir/util.h>
+
+#include <disir/cli/command_upgrade.h>
+#include <disir/cli/args.hxx>
+
+using namespace disir;
+
+CommandUpgrade::CommandUpgrade(void)
+    : Command ("upgrade")
+{
+}
+
+int
+CommandUpgrade::handle_command (std::vector<std::string> &args)
+{
+    std::stringstream group_description;
+    args::ArgumentParser parser ("Upgrade configuration entries to the version of their mold.",
+                                 "Every distinct mold and config version is planned once,"
+                                 " and the plan applied to each config at that version."
+                                 " Keyvals holding their old default are set to the new one."
+                                 " A config holding customized keyvals is not upgraded,"
+                                 " unless --keep-customized is given.");
+
+    setup_parser (parser);
+    parser.Prog ("disir upgrade");
+
+    args::HelpFlag help (parser, "help", "Display the upgrade help menu and exit.",
+                         args::Matcher{'h', "help"});
+
+    group_description << "Specify the group to operate on. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+    args::Flag opt_dry_run (parser, "dry-run",
+                            "Display the upgrade plans without writing any config.",
+                            args::Matcher{"dry-run"});
+    args::Flag opt_keep_customized (parser, "keep-customized",
+                                    "Upgrade configs holding customized keyvals,"
+                                    " keeping their values.",
+                                    args::Matcher{"keep-customized"});
+    args::PositionalList<std::string> opt_entries (parser, "entry",
+                                                   "A list of entries to upgrade."
+                                                   " Defaults to every entry in the group.");
+
+    try
+    {
+        parser.ParseArgs (args);
+    }
+    catch (args::Help&)
+    {
+        std::cout << parser;
+        return (0);
+    }
+    catch (args::ParseError& e)
+    {
+        std::cerr << "ParseError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+    catch (args::ValidationError& e)
+    {
+        std::cerr << "ValidationError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (opt_group_id && setup_group (args::get(opt_group_id)))
+    {
+        return (1);
+    }
+
+    // Get the set of entries to upgrade
+    enum disir_status status;
+    std::set<std::string> entries_to_upgrade;
+    if (opt_entries)
+    {
+        for (const auto& entry : args::get (opt_entries))
+        {
+            entries_to_upgrade.insert (entry);
+        }
+    }
+    else
+    {
+        struct disir_entry *entries;
+        struct disir_entry *next;
+        struct disir_entry *current;
+
+        status = disir_config_entries (m_cli->disir(), m_cli->group_id().c_str(), &entries);
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "Failed to retrieve available entries: "
+                      << disir_error (m_cli->disir()) << std::endl;
+            return (1);
+        }
+
+        current = entries;
+        while (current != NULL)
+        {
+            next = current->next;
+
+            entries_to_upgrade.insert (std::string(current->de_entry_name));
+
+            disir_entry_finished (&current);
+            current = next;
+        }
+    }
+
+    std::cout << "In group " << m_cli->group_id() << std::endl;
+    if (entries_to_upgrade.empty())
+    {
+        std::cout << "  There are no available entries." << std::endl;
+        return (0);
+    }
+
+    // Plans by the mold they were computed from and their source version.
+    // Each plan holds a reference to its mold, so the mold address is not reused.
+    std::map<std::pair<struct disir_mold *, std::string>, struct disir_update_plan *> plans;
+    int upgraded = 0;
+    int failed = 0;
+
+    for (const auto& entry : entries_to_upgrade)
+    {
+        struct disir_config *config = NULL;
+        struct disir_mold *mold = NULL;
+        struct disir_context *context_config;
+        struct disir_update_plan *plan = NULL;
+        struct disir_version version;
+        char buffer[32];
+        int updated;
+        int conflicts;
+
+        status = disir_config_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                    entry.c_str(), NULL, &config);
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cout << "  " << entry << ": " << disir_status_string (status) << std::endl;
+            if (config)
+                disir_config_finished (&config);
+            failed++;
+            continue;
+        }
+
+        context_config = dc_config_getcontext (config);
+        dc_get_version (context_config, &version);
+        dc_putcontext (&context_config);
+        dc_version_string (buffer, sizeof (buffer), &version);
+
+        disir_config_get_mold (config, &mold);
+        auto key = std::make_pair (mold, std::string (buffer));
+        auto found = plans.find (key);
+        if (found != plans.end())
+        {
+            plan = found->second;
+        }
+        else
+        {
+            status = disir_update_plan_create (mold, &version, NULL, &plan);
+            if (status == DISIR_STATUS_OK)
+            {
+                const char *name;
+                const char *source;
+                const char *target;
+
+                std::cout << "  plan from " << buffer << " for " << entry
+                          << ": " << disir_update_plan_size (plan) << " changed default(s)"
+                          << std::endl;
+                for (int32_t i = 0; i < disir_update_plan_size (plan); i++)
+                {
+                    disir_update_plan_entry (plan, i, &name, &source, &target);
+                    std::cout << "    " << name << ": " << source << " -> " << target
+                              << std::endl;
+                }
+            }
+            else if (status != DISIR_STATUS_NO_CAN_DO)
+            {
+                std::cout << "  " << entry << ": cannot upgrade from " << buffer << ": "
+                          << disir_status_string (status) << std::endl;
+            }
+            // Configs already at the mold version get no plan.
+            plans[key] = plan;
+        }
+        disir_mold_finished (&mold);
+
+        if (plan == NULL)
+        {
+            m_cli->verbose() << "  " << entry << ": up to date (" << buffer << ")" << std::endl;
+            disir_config_finished (&config);
+            continue;
+        }
+
+        status = disir_update_plan_apply (plan, config, opt_keep_customized ? 1 : 0,
+                                          &updated, &conflicts);
+        if (status == DISIR_STATUS_OK && !opt_dry_run)
+        {
+            status = disir_config_write (m_cli->disir(), m_cli->group_id().c_str(),
+                                         entry.c_str(), config);
+        }
+        if (status == DISIR_STATUS_CONFLICT)
+        {
+            std::cout << "  " << entry << ": " << conflicts << " customized keyval(s),"
+                      << " not upgraded (see --keep-customized)" << std::endl;
+            failed++;
+        }
+        else if (status != DISIR_STATUS_OK)
+        {
+            std::cout << "  " << entry << ": " << disir_status_string (status) << std::endl;
+            failed++;
+        }
+        else
+        {
+            std::cout << "  " << entry << ": " << updated << " updated, "
+                      << conflicts << " customized kept" << std::endl;
+            upgraded++;
+        }
+        disir_config_finished (&config);
+    }
+
+    for (auto& plan : plans)
+    {
+        if (plan.second)
+            disir_update_plan_finished (&plan.second);
+    }
+
+    std::cout << std::endl;
+    std::cout << "  " << upgraded << " upgraded"
+              << (opt_dry_run ? " (dry run, nothing written)" : "")
+              << ", " << failed << " failed, " << plans.size() << " plan(s)" << std::endl;
+
+    return (failed ? 1 : 0);
+}
@@ -41,6 +41,10 @@ CommandVerify::handle_command (std::vector<std::string> &args)
     args::ValueFlag<std::string> opt_text_mold (parser, "TEXT MOLD",
                                                 "Verify mold from disk.",
                                                 args::Matcher{"text-mold"});
+    args::ValueFlag<int> opt_threads (parser, "N",
+                                      "Number of threads validating the top-level sections"
+                                      " of each config. 0 uses one per processor.",
+                                      args::Matcher{"threads"});
     args::PositionalList<std::string> opt_entries (parser, "entry",
                                                    "A list of entries to verify.");
 
@@ -67,6 +71,12 @@ CommandVerify::handle_command (std::vector<std::string> &args)
     }
 
 
+    if (opt_threads && disir_validate_threads_set (args::get (opt_threads)) != DISIR_STATUS_OK)
+    {
+        std::cerr << "Invalid number of threads: " << args::get (opt_threads) << std::endl;
+        return (1);
+    }
+
     if (opt_text_mold)
     {
         enum disir_status status;
@@ -0,0 +1,28 @@
+#ifndef _LIBDISIRCLI_COMMAND_CORPUS_H
+#define _LIBDISIRCLI_COMMAND_CORPUS_H
+
+#include <string>
+
+#include <disir/disir.h>
+#include <disir/cli/cli.h>
+#include <disir/cli/command.h>
+
+namespace disir
+{
+    class CommandCorpus : public Command
+    {
+    public:
+        //! Basic constructor
+        CommandCorpus (void);
+
+        //! Handle command implementation
+        virtual int handle_command (std::vector<std::string> &args);
+
+        //! Populate the value type weights of parameters from a comma separated
+        //! list of type:weight pairs. Types left out are given weight 0.
+        int parse_types (const std::string& types, struct disir_corpus_parameters& parameters);
+    };
+}
+
+#endif // _LIBDISIRCLI_COMMAND_CORPUS_H
+
@@ -0,0 +1,28 @@
+#ifndef _LIBDISIRCLI_COMMAND_STATS_H
+#define _LIBDISIRCLI_COMMAND_STATS_H
+
+#include <string>
+#include <ostream>
+
+#include <disir/disir.h>
+#include <disir/cli/cli.h>
+#include <disir/cli/command.h>
+
+namespace disir
+{
+    class CommandStats : public Command
+    {
+    public:
+        //! Basic constructor
+        CommandStats (void);
+
+        //! Handle command implementation
+        virtual int handle_command (std::vector<std::string> &args);
+
+        //! Output a single row of the statistics table, if it counted any calls.
+        void print_counter (std::ostream& os, const std::string& name,
+                            const struct disir_stats_counter& counter);
+    };
+}
+
+#endif // _LIBDISIRCLI_COMMAND_STATS_H
@@ -0,0 +1,22 @@
+#ifndef _LIBDISIRCLI_COMMAND_UPGRADE_H
+#define _LIBDISIRCLI_COMMAND_UPGRADE_H
+
+#include <string>
+
+#include <disir/cli/cli.h>
+#include <disir/cli/command.h>
+
+namespace disir
+{
+    class CommandUpgrade : public Command
+    {
+    public:
+        //! Basic constructor
+        CommandUpgrade (void);
+
+        //! Handle command implementation
+        virtual int handle_command (std::vector<std::string> &args);
+    };
+}
+
+#endif // _LIBDISIRCLI_COMMAND_UPGRADE_H
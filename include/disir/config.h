@@ -151,6 +151,35 @@ DISIR_EXPORT
 enum disir_status
 disir_config_valid (struct disir_config *config, struct disir_collection **collection);
 
+//! \brief Set the number of threads validating a config.
+//!
+//! When a config holding several top-level sections is validated, or its invalid
+//! contexts are collected, the sections are split between this many threads.
+//! The outcome is identical to validating serially, and invalid contexts are
+//! collected in document order.
+//! The setting belongs to the process, not to an instance: configs are validated
+//! without reference to the instance they were read through. It is set by the
+//! application, e.g. by `disir verify --threads`. Until then, the `validate_threads`
+//! keyval of the libdisir config applies, if a created instance sets it.
+//!
+//! \param[in] threads Number of threads. 1 validates serially (the default).
+//!     0 uses one thread per online processor.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if threads is negative.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_validate_threads_set (int threads);
+
+//! \brief Return the number of threads validating a config.
+//!
+//! \see disir_validate_threads_set
+//!
+DISIR_EXPORT
+int
+disir_validate_threads (void);
+
 //! \brief Retrieve the mold associated with this config.
 //!
 //! \param[in] config Input config to retrieve mold from.
@@ -75,6 +75,9 @@ dc_context_type_string (struct disir_context *context);
 
 //! \brief Return the error message on input context.
 //!
+//! Error messages set on the contexts of a finalized mold are stored per thread;
+//! only the messages set by the calling thread are returned.
+//!
 //! \return NULL if no error message is associated with input context
 //! \return const char pointer to error message.
 //!
@@ -7,6 +7,9 @@ extern "C"{
 
 #include <disir/disir.h>
 
+//! Forward declare the compiled query object.
+struct disir_query;
+
 //! \brief Return the default value as a string representation from context.
 //!
 //! Retrieve the default value of input context as a string representation.
@@ -111,6 +114,70 @@ enum disir_status
 dc_find_elements (struct disir_context *context, const char *name,
                   struct disir_collection **collection);
 
+//! \brief Signature of the function invoked on every context visited by
+//!     dc_foreach_element() and dc_walk().
+//!
+//! The context is borrowed from its parent for the duration of the call. Its reference
+//! count is not incremented; the callback must neither put nor destroy it, and
+//! elements must not be removed from its parent while it is visited.
+//! Use dc_getcontext() to keep a reference beyond the call.
+//!
+//! \param[in] context Borrowed context being visited.
+//! \param[in] userdata Pointer passed through from dc_foreach_element() or dc_walk().
+//!
+//! \return DISIR_STATUS_OK to continue the visit.
+//!     Any other status ends the visit, and is returned from it.
+//!
+typedef enum disir_status (*dc_visit_function) (struct disir_context *context, void *userdata);
+
+//! \brief Invoke callback on every child element of context, in insertion order.
+//!
+//! Borrowed-reference equivalent of iterating dc_get_elements() or dc_find_elements().
+//! No collection is allocated, and no reference count is changed.
+//!
+//! \param[in] context Parent context to visit child elements of.
+//!     Must be of context type
+//!         * DISIR_CONTEXT_CONFIG
+//!         * DISIR_CONTEXT_MOLD
+//!         * DISIR_CONTEXT_SECTION
+//! \param[in] name Only visit the child elements matching name. NULL visits every element.
+//! \param[in] callback Function invoked on each element, see dc_visit_function.
+//! \param[in] userdata Passed through to callback.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if context or callback are NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if the input context is not of correct type.
+//! \return DISIR_STATUS_NOT_EXIST if name is given, and no element matches it.
+//! \return the first non-OK status returned by callback, which ends the visit.
+//! \return DISIR_STATUS_OK when every element has been visited.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_foreach_element (struct disir_context *context, const char *name,
+                    dc_visit_function callback, void *userdata);
+
+//! \brief Recursively visit every element below context, in document order.
+//!
+//! pre is invoked on each element before the elements of a SECTION are visited,
+//! and post after them. Either may be NULL. If pre returns DISIR_STATUS_NO_CAN_DO,
+//! the elements of that SECTION are skipped, but post is still invoked on it.
+//! Like dc_foreach_element(), contexts are borrowed and nothing is allocated.
+//!
+//! \param[in] context CONFIG, MOLD or SECTION context to walk the elements of.
+//! \param[in] pre Function invoked on each element before its children.
+//! \param[in] post Function invoked on each element after its children.
+//! \param[in] userdata Passed through to pre and post.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if context is NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if the input context is not of correct type.
+//! \return the first status other than OK (or NO_CAN_DO from pre) returned by
+//!     pre or post, which ends the walk.
+//! \return DISIR_STATUS_OK when every element has been visited.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_walk (struct disir_context *context, dc_visit_function pre, dc_visit_function post,
+         void *userdata);
+
 //! \brief Query for a context relative to parent.
 //!
 //! \param[in] parent The context to query from.
@@ -134,6 +201,59 @@ enum disir_status
 dc_query_resolve_context_va (struct disir_context *parent, const char *name,
                              struct disir_context **out, va_list args);
 
+//! \brief Compile a query name into a reusable handle.
+//!
+//! The query name (e.g. "section@2.key") is parsed once; every name is stored
+//! together with its pre-computed hash and index. The handle may then be resolved
+//! with dc_query_resolve() against any config or mold of the same mold structure,
+//! without any string formatting or parsing.
+//!
+//! Every name in the query is checked against the mold of context. All but the last
+//! name must refer to a section.
+//!
+//! \param[in] context CONFIG, MOLD or SECTION context the query is relative to.
+//!     Errors are logged to this context.
+//! \param[in] name Query to compile. Same syntax as dc_query_resolve_context().
+//! \param[out] query Compiled query. Must be released with dc_query_finished().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any argument is NULL, or the name does not parse.
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is not CONFIG, MOLD or SECTION.
+//! \return DISIR_STATUS_MOLD_MISSING if a name in the query does not exist in the mold.
+//! \return DISIR_STATUS_CONFLICT if a name other than the last refers to a keyval.
+//! \return DISIR_STATUS_INSUFFICIENT_RESOURCES if name exceeds 2048 bytes.
+//! \return DISIR_STATUS_NO_MEMORY on allocation failure.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_query_compile (struct disir_context *context, const char *name, struct disir_query **query);
+
+//! \brief Resolve a compiled query relative to parent.
+//!
+//! Equivalent to dc_query_resolve_context() with the name the query was compiled from.
+//!
+//! \param[in] parent CONFIG, MOLD or SECTION context to resolve the query from.
+//! \param[in] query Compiled query from dc_query_compile().
+//! \param[out] out Resolved context. Caller must use dc_putcontext when finished.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any argument is NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if parent, or any intermediate element, is of wrong type.
+//! \return DISIR_STATUS_NOT_EXIST if any element in the query does not exist.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_query_resolve (struct disir_context *parent, struct disir_query *query,
+                  struct disir_context **out);
+
+//! \brief Release a compiled query.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if query or *query are NULL.
+//! \return DISIR_STATUS_OK on success. *query is set to NULL.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_query_finished (struct disir_query **query);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,123 @@
+#ifndef _LIBDISIR_CORPUS_H
+#define _LIBDISIR_CORPUS_H
+
+#ifdef __cplusplus
+extern "C"{
+#endif // __cplusplus
+
+#include <disir/disir.h>
+
+//!
+//! This file exposes the Disir synthetic corpus API.
+//!
+//! A corpus is a generated mold and matching configs, built through the public
+//! context API. The shape of the mold is given by a set of parameters: the number
+//! of keyvals, how deep and wide sections nest, how many entries repeated sections hold,
+//! the mix of value types, how many keyvals are restricted and how many versions
+//! the mold spans. Every choice the generator makes is derived from the parameters
+//! and a seed; the same parameters and seed always produce the same mold and configs.
+//!
+//! Keyvals are spread evenly over the mold, depth first. The first child section
+//! of the mold and of each section is repeatable when configs hold more than
+//! one entry of it. Keyvals are introduced and change their defaults across
+//! the versions 1.0, 2.0, ... of the mold. Generated config values always
+//! fulfill the restrictions of their keyval.
+//!
+
+//! Parameters of a synthetic corpus.
+struct disir_corpus_parameters
+{
+    //! Number of keyvals in the mold. Configs hold more when sections repeat.
+    uint32_t cp_keys;
+    //! Maximum number of sections nested below the mold.
+    uint32_t cp_depth;
+    //! Number of child sections of the mold and of each section above the maximum depth.
+    uint32_t cp_fanout;
+    //! Number of entries configs hold of each repeatable section. 1 disables repetition.
+    uint32_t cp_repeat;
+
+    //! Relative weights of each value type among the keyvals. At least one must be set.
+    uint32_t cp_weight_string;
+    uint32_t cp_weight_integer;
+    uint32_t cp_weight_float;
+    uint32_t cp_weight_boolean;
+    uint32_t cp_weight_enum;
+
+    //! Percentage (0 - 100) of integer and float keyvals restricted to a range
+    //! or a set of values. Enum keyvals are always restricted to their values.
+    uint32_t cp_restrictions;
+    //! Number of mold versions.
+    uint32_t cp_versions;
+    //! Seed every choice of the generator is derived from.
+    uint64_t cp_seed;
+};
+
+//! \brief Populate parameters with the defaults of a small, mixed corpus.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if parameters is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_corpus_parameters_default (struct disir_corpus_parameters *parameters);
+
+//! \brief Generate the mold described by parameters.
+//!
+//! \param[in] parameters Shape and seed of the corpus.
+//! \param[out] mold Populated with the finalized mold on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any of the arguments are NULL,
+//!     cp_keys, cp_repeat or cp_versions are zero, cp_restrictions exceeds 100
+//!     or every value type weight is zero.
+//! \return DISIR_STATUS_NO_MEMORY if allocation failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_corpus_mold (const struct disir_corpus_parameters *parameters, struct disir_mold **mold);
+
+//! \brief Generate a config of a mold generated with the same parameters.
+//!
+//! The config holds every keyval of the mold introduced at or before version,
+//! with values drawn from the seed of parameters. Sections repeatable in the
+//! mold hold cp_repeat entries.
+//!
+//! \param[in] parameters Parameters the mold was generated with.
+//! \param[in] mold Mold returned by disir_corpus_mold().
+//! \param[in] version Version of the config. If NULL, the highest version of the mold is used.
+//! \param[out] config Populated with the finalized config on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if parameters, mold or config are NULL,
+//!     or parameters are invalid.
+//! \return DISIR_STATUS_CONFLICTING_SEMVER if version is higher than the version of the mold.
+//! \return DISIR_STATUS_MOLD_MISSING if the mold does not match the parameters.
+//! \return status of dc_config_finalize() if the config is not valid.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_corpus_config (const struct disir_corpus_parameters *parameters, struct disir_mold *mold,
+                     struct disir_version *version, struct disir_config **config);
+
+//! \brief Generate a corpus entry and write it through the plugin of group_id.
+//!
+//! The mold is written with disir_mold_write() and a config at the highest
+//! mold version with disir_config_write(), both as entry_id.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any of the arguments are NULL,
+//!     or parameters are invalid.
+//! \return status of disir_mold_write() or disir_config_write() if either fail.
+//!     The error is available through disir_error().
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_corpus_write (struct disir_instance *instance, const char *group_id,
+                    const char *entry_id, const struct disir_corpus_parameters *parameters);
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _LIBDISIR_CORPUS_H
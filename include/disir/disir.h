@@ -87,6 +87,8 @@ enum disir_status
 struct disir_instance;
 //! Forward declare the disir_update object
 struct disir_update;
+//! Forward declare the disir_update_plan object
+struct disir_update_plan;
 //! Forward declaration of the top-level context disir_config
 struct disir_config;
 //! Forward declaration of the top-level context disir_mold
@@ -138,6 +140,8 @@ enum disir_restriction_type
 
 #include <disir/util.h>
 #include <disir/config.h>
+#include <disir/snapshot.h>
+#include <disir/corpus.h>
 #include <disir/mold.h>
 #include <disir/context.h>
 #include <disir/collection.h>
@@ -193,6 +197,23 @@ disir_status_string (enum disir_status status);
 
 //! \brief Allocate a new libdisir instance.
 //!
+//! A single instance may be shared by any number of threads once created.
+//! disir_config_read(), disir_mold_read(), disir_config_entries() and the other
+//! I/O operations may be invoked concurrently on the same instance:
+//!     * The error message (disir_error(), disir_error_copy()) is stored per thread.
+//!       A thread only observes errors set by the operations it invoked itself.
+//!     * The set of registered plugins is guarded by a read-write lock.
+//!       Plugins are registered when the instance is created and never removed
+//!       before it is destroyed.
+//!     * Molds are shared between threads through the instance mold cache.
+//!       Their reference counts are updated atomically, and they are never modified
+//!       once finalized - error messages set on their contexts (dc_context_error())
+//!       are stored per thread.
+//! The config and mold objects returned by these operations are not thread-safe;
+//! modifying a single object from multiple threads requires external synchronization.
+//! disir_instance_create() and disir_instance_destroy() must not run concurrently
+//! with any other operation on the instance.
+//!
 //! If a `config` parameter is present, this configuration is used within
 //! this libdisir instance. If NULL, it is ignored.
 //! If `config_filepath` parameter is non-NULL, the INI-formatted file
@@ -241,6 +262,196 @@ DISIR_EXPORT
 void
 disir_log_user (struct disir_instance *instance, const char *message, ...);
 
+//! Counters reported by the libdisir log sink.
+struct disir_log_stats
+{
+    //! Number of log lines queued for output.
+    uint64_t        ls_written;
+    //! Number of log lines dropped because the output queue of a thread was full.
+    uint64_t        ls_dropped;
+    //! Number of batched writes issued to the log file.
+    uint64_t        ls_flushes;
+    //! Number of bytes written to the log file.
+    uint64_t        ls_bytes;
+};
+
+//! \brief Retrieve the counters of the libdisir log sink.
+//!
+//! Log lines are queued per thread and written to the log file in batches
+//! by a background thread. The log sink is shared by all instances in the process.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if `stats` is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_log_stats (struct disir_log_stats *stats);
+
+//! \brief Write all queued log lines to the log file immediately.
+DISIR_EXPORT
+void
+disir_log_flush (void);
+
+//! \brief Record the API calls of libdisir as timed spans, written to filepath.
+//!
+//! Every function marked for tracing is recorded with its thread on entry and exit,
+//! in a buffer owned by the calling thread. The spans are written as Chrome trace event
+//! JSON, which Perfetto (ui.perfetto.dev) and chrome://tracing can open, by
+//! disir_trace_flush() and when the process exits. Each write replaces the file with
+//! every span recorded since tracing was last enabled.
+//!
+//! Tracing is shared by all instances in the process. It is enabled on instance creation
+//! from the DISIR_TRACE_FILEPATH environment variable, or else from the
+//! `trace_filepath` keyval of the libdisir config.
+//!
+//! \param[in] filepath File to write the spans to. NULL or an empty string
+//!     writes the spans recorded so far and stops recording.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if filepath is too long.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_trace_filepath_set (const char *filepath);
+
+//! \brief Write every span recorded so far to the trace filepath.
+//!
+//! \return DISIR_STATUS_NOT_EXIST if tracing is not enabled.
+//! \return DISIR_STATUS_FS_ERROR if the trace file could not be written.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_trace_flush (void);
+
+//! Operations timed by the libdisir runtime statistics.
+enum disir_stats_operation
+{
+    //! disir_config_read(), and dp_config_read of a plugin.
+    DISIR_STATS_CONFIG_READ = 0,
+    //! disir_config_write(), and dp_config_write of a plugin.
+    DISIR_STATS_CONFIG_WRITE,
+    //! disir_config_remove(), and dp_config_remove of a plugin.
+    DISIR_STATS_CONFIG_REMOVE,
+    //! disir_config_query(), and dp_config_query of a plugin.
+    DISIR_STATS_CONFIG_QUERY,
+    //! disir_config_entries(), and dp_config_entries of a plugin.
+    DISIR_STATS_CONFIG_ENTRIES,
+    //! disir_mold_read(), and dp_mold_read of a plugin.
+    DISIR_STATS_MOLD_READ,
+    //! disir_mold_write(), and dp_mold_write of a plugin.
+    DISIR_STATS_MOLD_WRITE,
+    //! disir_mold_query(), and dp_mold_query of a plugin.
+    DISIR_STATS_MOLD_QUERY,
+    //! disir_mold_entries(), and dp_mold_entries of a plugin.
+    DISIR_STATS_MOLD_ENTRIES,
+    //! Validation of a whole config or mold, e.g., when it is finalized.
+    DISIR_STATS_VALIDATE,
+    //! dc_query_resolve_context() and dc_query_resolve().
+    //! Only one in DISIR_STATS_SAMPLE_RATE calls is timed.
+    DISIR_STATS_QUERY_RESOLVE,
+
+    DISIR_STATS_OPERATION_UNKNOWN, // Must be the last element
+};
+
+//! Number of buckets in the latency histogram of a struct disir_stats_counter.
+#define DISIR_STATS_HISTOGRAM_BUCKETS 32
+
+//! Sampled operations are timed on one call in this many, per thread.
+#define DISIR_STATS_SAMPLE_RATE 64
+
+//! Counters of a single operation.
+struct disir_stats_counter
+{
+    //! Number of completed calls.
+    uint64_t        sc_calls;
+    //! Number of calls that failed.
+    uint64_t        sc_errors;
+    //! Bytes read from disk by the calls.
+    uint64_t        sc_bytes_read;
+    //! Bytes written to disk by the calls.
+    uint64_t        sc_bytes_written;
+    //! Number of calls that were timed. Equal to sc_calls unless the operation is sampled.
+    uint64_t        sc_timed;
+    //! Total time spent in the timed calls, in nanoseconds.
+    uint64_t        sc_nanoseconds;
+    //! Latency histogram of the timed calls.
+    //! Bucket 0 counts calls that took less than 2 nanoseconds,
+    //! bucket i counts calls that took [2^i, 2^(i+1)) nanoseconds.
+    //! The last bucket also counts every call that took longer.
+    uint64_t        sc_histogram[DISIR_STATS_HISTOGRAM_BUCKETS];
+};
+
+//! Counters of the operations invoked on a single registered plugin.
+struct disir_plugin_stats
+{
+    //! Internal name the plugin registered with.
+    char                        *ps_io_id;
+    //! Group the plugin is registered to.
+    char                        *ps_group_id;
+    //! Counters indexed by enum disir_stats_operation.
+    //! Validation and query resolution are never attributed to a plugin.
+    struct disir_stats_counter  ps_operations[DISIR_STATS_OPERATION_UNKNOWN];
+
+    //! Linked-list of plugins, in order of registration.
+    struct disir_plugin_stats   *next, *prev;
+};
+
+//! Runtime statistics of a libdisir instance.
+struct disir_stats
+{
+    //! Counters indexed by enum disir_stats_operation.
+    //! DISIR_STATS_VALIDATE and DISIR_STATS_QUERY_RESOLVE operate on contexts
+    //! without an instance - their counters are process wide.
+    struct disir_stats_counter  st_operations[DISIR_STATS_OPERATION_UNKNOWN];
+    //! Counters of every plugin registered with the instance.
+    struct disir_plugin_stats   *st_plugins;
+};
+
+//! \brief Retrieve the runtime statistics of an instance.
+//!
+//! Every thread counts the operations it invokes in storage of its own,
+//! which is summed up by this function. Counting costs two clock reads and a few
+//! uncontended stores per operation - nothing is shared between threads
+//! unless the statistics are retrieved. Operations as cheap as a clock read
+//! are only timed on a sample of their calls (see DISIR_STATS_SAMPLE_RATE).
+//! The counters of an operation include the time spent in nested operations,
+//! e.g., reading the mold of a config as part of disir_config_read().
+//!
+//! The returned statistics must be released with disir_stats_finished().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if `instance` or `stats` are NULL.
+//! \return DISIR_STATUS_NO_MEMORY if allocation failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_instance_stats (struct disir_instance *instance, struct disir_stats **stats);
+
+//! \brief Release statistics retrieved with disir_instance_stats().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if `stats` or `*stats` are NULL.
+//! \return DISIR_STATUS_OK on success. `*stats` is set to NULL.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_stats_finished (struct disir_stats **stats);
+
+//! \brief Return a string representation of a statistics operation.
+DISIR_EXPORT
+const char *
+disir_stats_operation_string (enum disir_stats_operation operation);
+
+//! \brief Estimate the latency below which `percentile` percent of the calls completed.
+//!
+//! The estimate is the upper bound of the histogram bucket holding the percentile.
+//!
+//! \return latency in nanoseconds. 0 if the counter holds no calls.
+//!
+DISIR_EXPORT
+uint64_t
+disir_stats_percentile (const struct disir_stats_counter *counter, double percentile);
+
 //! \brief Set an error message to the disir instance.
 //!
 //! This will also issue a ERROR level log event to the log stream.
@@ -249,7 +460,7 @@ DISIR_EXPORT
 void
 disir_error_set (struct disir_instance *instance, const char *message, ...);
 
-//! \brief Clear any error message previously sat on the disir instance.
+//! \brief Clear any error message previously sat on the disir instance by the calling thread.
 DISIR_EXPORT
 void
 disir_error_clear (struct disir_instance *instance);
@@ -280,7 +491,8 @@ disir_error_copy (struct disir_instance *instance,
 
 //! \brief Return the error message from the instance.
 //!
-//!If no error message exists, NULL is returned.
+//! The error message is the last one set by the calling thread.
+//! If no error message exists, NULL is returned.
 //!
 DISIR_EXPORT
 const char *
@@ -349,6 +561,87 @@ DISIR_EXPORT
 enum disir_status
 disir_update_finished (struct disir_update **update, struct disir_config **config);
 
+//! \brief Compute the upgrade of configs of mold from source to target version, once.
+//!
+//! The plan lists every keyval of mold whose default changed between the two versions.
+//! It may be applied to any number of configs of mold at the source version, from
+//! any number of threads, with disir_update_plan_apply().
+//!
+//! \param[in] mold Mold the configs to upgrade are read with. The plan holds a reference.
+//! \param[in] source Version of the configs to upgrade.
+//! \param[in] target Version to upgrade to. NULL targets the version of mold.
+//! \param[out] plan Allocated plan. Release it with disir_update_plan_finished().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if mold, source or plan are NULL.
+//! \return DISIR_STATUS_CONFLICTING_SEMVER if source is higher than target.
+//! \return DISIR_STATUS_NO_CAN_DO if source and target are of equal version.
+//! \return DISIR_STATUS_NO_MEMORY if memory allocation failed internally.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_update_plan_create (struct disir_mold *mold, struct disir_version *source,
+                          struct disir_version *target, struct disir_update_plan **plan);
+
+//! \brief Return the number of keyvals whose default changed in plan. -1 if plan is NULL.
+DISIR_EXPORT
+int32_t
+disir_update_plan_size (struct disir_update_plan *plan);
+
+//! \brief Get a keyval whose default changed in plan, with its defaults at both versions.
+//!
+//! The output strings are owned by plan.
+//!
+//! \param[in] index Position of the keyval, in mold order, below disir_update_plan_size().
+//! \param[out] name Name of the keyval, resolved from the mold root.
+//! \param[out] source Default value at the source version.
+//! \param[out] target Default value at the target version.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any argument is NULL.
+//! \return DISIR_STATUS_NOT_EXIST if index is out of range.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_update_plan_entry (struct disir_update_plan *plan, int32_t index, const char **name,
+                         const char **source, const char **target);
+
+//! \brief Upgrade config to the target version of plan.
+//!
+//! Only the keyvals listed by plan are visited. A keyval still holding the default of
+//! the source version is set to the default of the target version. A keyval holding
+//! any other value was customized, and is counted as a conflict.
+//! Unless keep_customized is set, a config holding any conflict is left untouched.
+//! Upon success, the version of config is the target version of plan.
+//!
+//! \param[in] config Config to upgrade, read with the mold of plan.
+//! \param[in] keep_customized Non-zero to upgrade config regardless of conflicts,
+//!     keeping the customized values.
+//! \param[out] updated Optional. Number of keyvals set to their target default.
+//! \param[out] conflicts Optional. Number of customized keyvals.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if plan or config are NULL,
+//!     or config was not read with the mold of plan.
+//! \return DISIR_STATUS_CONFLICTING_SEMVER if config is not at the source version of plan.
+//! \return DISIR_STATUS_CONFLICT if config holds customized keyvals and keep_customized
+//!     is zero. Neither its values nor its version are changed.
+//! \return DISIR_STATUS_NO_MEMORY if memory allocation failed internally.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_update_plan_apply (struct disir_update_plan *plan, struct disir_config *config,
+                         int keep_customized, int *updated, int *conflicts);
+
+//! \brief Release plan and its reference to the mold.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if plan or *plan are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_update_plan_finished (struct disir_update_plan **plan);
+
 
 #ifdef __cplusplus
 }
@@ -117,6 +117,26 @@ enum disir_status
 dio_json_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config);
 
+//! \brief Construct a config from the JSON document held in memory.
+//!
+//! Parses the document directly from data; it does not need to be null-terminated.
+//!
+//! \param[in] data Start of the JSON document.
+//! \param[in] size Size of the JSON document in bytes.
+//! \param[in] mold The mold the config is constructed from.
+//! \param[out] config Populated with the constructed config.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance, mold or config is NULL.
+//! \return DISIR_STATUS_FS_ERROR if the document is not valid JSON.
+//! \return DISIR_STATUS_INVALID_CONTEXT if the constructed config is invalid.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_json_unserialize_config_buffer (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config);
+
 //! TODO: docs
 DISIR_EXPORT
 enum disir_status
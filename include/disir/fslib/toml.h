@@ -62,6 +62,20 @@ enum disir_status
 dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config);
 
+//! \brief Construct a config from the TOML document held in memory.
+//!
+//! Parses the document directly from data; it does not need to be null-terminated.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance, mold or config is NULL.
+//! \return DISIR_STATUS_FS_ERROR if the document is not valid TOML.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_toml_unserialize_config_buffer (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config);
+
 
 #ifdef __cplusplus
 }
@@ -33,6 +33,20 @@ typedef enum disir_status (*dio_unserialize_mold) (struct disir_instance *,
                                                    FILE *,
                                                    struct disir_mold **);
 
+//! The complete contents of a file, held in memory for parsing.
+//! The file is read once into a single heap buffer.
+//! fb_data[fb_size] is always readable and holds a terminating zero byte.
+struct fslib_file_buffer
+{
+    //! Start of the file contents.
+    const char      *fb_data;
+    //! Size of the file contents, not counting the terminating zero byte.
+    size_t          fb_size;
+
+    //! Heap allocated memory holding fb_data.
+    void            *fb_memory;
+};
+
 
 //! Create the input path recursively
 //! Similar to shall command mkdir -p
@@ -46,6 +60,15 @@ enum disir_status
 fslib_mkdir_p (struct disir_instance *instance, const char *path);
 
 
+//! Thread-safe strerror. Populate buffer with the description of errnum.
+//!
+//! \return buffer, or a pointer to an immutable static string describing errnum.
+//!
+DISIR_EXPORT
+const char *
+fslib_strerror (int errnum, char *buffer, size_t buffer_size);
+
+
 //! Create namespace entry of input name
 //!
 //! return empty string if no such namespace entry can be created
@@ -132,6 +155,27 @@ enum disir_status
 fslib_mold_query_entries (struct disir_instance *instance, struct disir_register_plugin *plugin,
                           const char *basedir, struct disir_entry **entries);
 
+//! \brief Read the remaining contents of file into buffer.
+//!
+//! Reading starts at the current offset of the underlying file descriptor,
+//! and consumes the file. The buffer does not refer to the file afterwards.
+//! Release the buffer with fslib_file_buffer_release.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any input is NULL.
+//! \return DISIR_STATUS_NO_MEMORY if the buffer could not be allocated.
+//! \return DISIR_STATUS_FS_ERROR if reading the file failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_file_buffer_read (struct disir_instance *instance, FILE *file,
+                        struct fslib_file_buffer *buffer);
+
+//! \brief Release the memory held by a buffer populated by fslib_file_buffer_read.
+DISIR_EXPORT
+void
+fslib_file_buffer_release (struct fslib_file_buffer *buffer);
+
 //! \brief Generic filesystem based implementation of config_read
 DISIR_EXPORT
 enum disir_status
@@ -108,6 +108,46 @@ DISIR_EXPORT
 enum disir_status
 disir_mold_valid (struct disir_mold *mold, struct disir_collection **collection);
 
+//! Counters reported by the mold cache of a libdisir instance.
+struct disir_mold_cache_stats
+{
+    //! Number of config reads served a cached mold.
+    uint64_t        mcs_hits;
+    //! Number of config reads that had the plugin read the mold.
+    uint64_t        mcs_misses;
+    //! Number of cached molds dropped because the mold entry changed on disk.
+    uint64_t        mcs_invalidations;
+    //! Number of molds currently held by the cache.
+    uint32_t        mcs_entries;
+};
+
+//! \brief Retrieve the mold cache counters of the instance.
+//!
+//! Reading a config without supplying its mold (disir_config_read() with mold NULL)
+//! will share the mold between all reads covered by the same mold entry, as long as
+//! the mold entry (and its override entry, if any) is left unchanged on disk.
+//!
+//! \param[in] instance Library instance to retrieve counters from.
+//! \param[out] stats Structure populated with the current counters.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either `instance` or `stats` are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_cache_stats (struct disir_instance *instance, struct disir_mold_cache_stats *stats);
+
+//! \brief Release every mold held by the mold cache of the instance.
+//!
+//! Molds already handed out are not affected. Counters are left untouched.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if `instance` is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_cache_clear (struct disir_instance *instance);
+
 //! \brief Mark yourself finished with the mold object.
 //!
 //! \\param[in,out] mold Object to mark as finished. Turns the pointer to NULL
@@ -0,0 +1,179 @@
+#ifndef _LIBDISIR_SNAPSHOT_H
+#define _LIBDISIR_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C"{
+#endif // __cplusplus
+
+#include <disir/disir.h>
+
+//!
+//! This file exposes the Disir config snapshot API.
+//!
+//! A snapshot is an immutable, flat copy of every keyval in a finalized config.
+//! It is stored in a single contiguous allocation: a table of keys sorted by
+//! their fully resolved name, a typed value for each key and a table of interned strings.
+//! Lookups are a binary search over the key table; they never allocate, take no locks
+//! and touch no reference counts. Any number of threads may therefore read the same
+//! snapshot concurrently, without synchronization.
+//!
+//! Keys use the same naming scheme as the config query API, without the varadic
+//! template arguments: "section@1.keyval". An omitted index is equal to @0.
+//!
+//! To replace the snapshot readers use when a new config version is loaded,
+//! publish the new snapshot with disir_snapshot_publish() and have readers
+//! retrieve the current snapshot with disir_snapshot_acquire(). The previous snapshot
+//! returned by disir_snapshot_publish() must only be finished once no reader
+//! can hold a pointer to it any longer (RCU-style grace period).
+//!
+
+struct disir_snapshot;
+
+//! \brief Create an immutable snapshot of a finalized config.
+//!
+//! The snapshot does not reference the config after it is created;
+//! the config may be modified or finished without affecting the snapshot.
+//!
+//! \param[in] config Finalized config to capture every keyval from.
+//! \param[out] snapshot Populated with the allocated snapshot on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if config or snapshot are NULL.
+//! \return DISIR_STATUS_INSUFFICIENT_RESOURCES if the config is too large to snapshot.
+//! \return DISIR_STATUS_NO_MEMORY if allocation failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_create (struct disir_config *config, struct disir_snapshot **snapshot);
+
+//! \brief Release all resources held by the snapshot.
+//!
+//! \param[in,out] snapshot Snapshot to free. The pointer is set to NULL.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if snapshot or *snapshot are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_finished (struct disir_snapshot **snapshot);
+
+//! \brief Retrieve the version of the config the snapshot was created from.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if snapshot or version are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_version (struct disir_snapshot *snapshot, struct disir_version *version);
+
+//! \brief Number of keyvals held by the snapshot.
+//!
+//! \return 0 if snapshot is NULL.
+//!
+DISIR_EXPORT
+uint32_t
+disir_snapshot_numentries (struct disir_snapshot *snapshot);
+
+//! \brief Retrieve the value type of the keyval identified by key.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any of the arguments are NULL,
+//!     or key is not a well-formed name.
+//! \return DISIR_STATUS_NOT_EXIST if no keyval exists with key.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_type (struct disir_snapshot *snapshot, enum disir_value_type *type,
+                         const char *key);
+
+//! \brief Query the snapshot for a string valued keyval.
+//!
+//! \param[in] snapshot The snapshot to query from.
+//! \param[out] value Populated with a reference to the string value.
+//!     The string is owned by the snapshot and valid until it is finished.
+//! \param[in] key Fully resolved name of the keyval.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any of the arguments are NULL,
+//!     or key is not a well-formed name.
+//! \return DISIR_STATUS_NOT_EXIST if no keyval exists with key.
+//! \return DISIR_STATUS_WRONG_VALUE_TYPE if the keyval is not of type string.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_keyval_string (struct disir_snapshot *snapshot, const char **value,
+                                  const char *key);
+
+//! \brief Query the snapshot for an enum valued keyval.
+//!
+//! \see disir_snapshot_get_keyval_string
+//!
+//! \return DISIR_STATUS_WRONG_VALUE_TYPE if the keyval is not of type enum.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_keyval_enum (struct disir_snapshot *snapshot, const char **value,
+                                const char *key);
+
+//! \brief Query the snapshot for a boolean valued keyval.
+//!
+//! \see disir_snapshot_get_keyval_string
+//!
+//! \return DISIR_STATUS_WRONG_VALUE_TYPE if the keyval is not of type boolean.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_keyval_boolean (struct disir_snapshot *snapshot, uint8_t *value,
+                                   const char *key);
+
+//! \brief Query the snapshot for a float valued keyval.
+//!
+//! \see disir_snapshot_get_keyval_string
+//!
+//! \return DISIR_STATUS_WRONG_VALUE_TYPE if the keyval is not of type float.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_keyval_float (struct disir_snapshot *snapshot, double *value,
+                                 const char *key);
+
+//! \brief Query the snapshot for an integer valued keyval.
+//!
+//! \see disir_snapshot_get_keyval_string
+//!
+//! \return DISIR_STATUS_WRONG_VALUE_TYPE if the keyval is not of type integer.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_snapshot_get_keyval_integer (struct disir_snapshot *snapshot, int64_t *value,
+                                   const char *key);
+
+//! \brief Atomically replace the snapshot stored in slot.
+//!
+//! The store has release semantics; a reader that retrieves snapshot through
+//! disir_snapshot_acquire() observes it fully constructed.
+//!
+//! \param[in,out] slot Shared location readers acquire the current snapshot from.
+//! \param[in] snapshot New snapshot to publish. May be NULL.
+//!
+//! \return The snapshot previously stored in slot. The caller owns it, and must
+//!     not finish it before all readers that may have acquired it are done.
+//!
+DISIR_EXPORT
+struct disir_snapshot *
+disir_snapshot_publish (struct disir_snapshot **slot, struct disir_snapshot *snapshot);
+
+//! \brief Atomically load the snapshot currently stored in slot.
+//!
+//! \return The current snapshot in slot, or NULL if none is published.
+//!
+DISIR_EXPORT
+struct disir_snapshot *
+disir_snapshot_acquire (struct disir_snapshot **slot);
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _LIBDISIR_SNAPSHOT_H
@@ -0,0 +1,295 @@
+// External public includes
+#include <stdlib.h>
+#include <string.h>
+
+// Public disir interface
+#include <disir/disir.h>
+
+// Private
+#include "arena.h"
+#include "log.h"
+
+//! Size of the first chunk requested by an arena.
+#define ARENA_CHUNK_INITIAL 4096
+//! Chunks stop doubling in size once they reach this limit.
+#define ARENA_CHUNK_MAX (1024 * 1024)
+//! Every allocation is aligned to this boundary.
+#define ARENA_ALIGNMENT 16
+//! Freed blocks up to this size are kept in a free list of their exact size.
+//! Larger blocks share a single list, searched first fit.
+#define ARENA_FREE_SMALL_MAX 1024
+//! Number of exact size free lists, one per ARENA_ALIGNMENT step up to ARENA_FREE_SMALL_MAX.
+#define ARENA_FREE_CLASSES (ARENA_FREE_SMALL_MAX / ARENA_ALIGNMENT)
+
+//! Header preceding every block carved from a chunk.
+//! Padded to ARENA_ALIGNMENT, so that the block that follows stays aligned.
+struct arena_block
+{
+    //! Size of the block following the header, rounded up to ARENA_ALIGNMENT.
+    _Alignas (ARENA_ALIGNMENT) size_t ab_size;
+};
+
+//! A freed block, linked into a free list through its own memory.
+struct arena_free
+{
+    struct arena_free   *af_next;
+};
+
+//! A contiguous block of memory allocations are carved from.
+struct arena_chunk
+{
+    struct arena_chunk  *ac_next;
+    size_t              ac_size;
+    size_t              ac_used;
+    // Keep ac_data aligned to ARENA_ALIGNMENT
+    _Alignas (ARENA_ALIGNMENT) unsigned char ac_data[];
+};
+
+struct disir_arena
+{
+    //! Chunk currently being allocated from. Older chunks follow through ac_next.
+    struct arena_chunk          *ar_chunks;
+
+    //! Size of the next regular chunk to allocate.
+    size_t                      ar_next_chunk_size;
+
+    //! Freed blocks of each size up to ARENA_FREE_SMALL_MAX, by size / ARENA_ALIGNMENT - 1.
+    struct arena_free           *ar_free[ARENA_FREE_CLASSES];
+
+    //! Freed blocks larger than ARENA_FREE_SMALL_MAX.
+    struct arena_free           *ar_free_large;
+
+    //! Number of owners (top-level context and its elements) of this arena.
+    int                         ar_reference_count;
+
+    struct disir_arena_stats    ar_stats;
+};
+
+//! STATIC API
+static struct arena_chunk *
+arena_chunk_create (struct disir_arena *arena, size_t size)
+{
+    struct arena_chunk *chunk;
+
+    chunk = malloc (sizeof (struct arena_chunk) + size);
+    if (chunk == NULL)
+    {
+        log_error ("failed to allocate arena chunk of %zu bytes", size);
+        return NULL;
+    }
+
+    chunk->ac_size = size;
+    chunk->ac_used = 0;
+    arena->ar_stats.as_chunks += 1;
+    arena->ar_stats.as_bytes_reserved += size;
+
+    return chunk;
+}
+
+//! INTERNAL API
+struct disir_arena *
+dx_arena_create (void)
+{
+    struct disir_arena *arena;
+
+    arena = calloc (1, sizeof (struct disir_arena));
+    if (arena == NULL)
+        return NULL;
+
+    arena->ar_next_chunk_size = ARENA_CHUNK_INITIAL;
+    arena->ar_reference_count = 1;
+
+    return arena;
+}
+
+//! INTERNAL API
+void
+dx_arena_incref (struct disir_arena *arena)
+{
+    if (arena == NULL)
+        return;
+
+    __atomic_add_fetch (&arena->ar_reference_count, 1, __ATOMIC_RELAXED);
+}
+
+//! INTERNAL API
+void
+dx_arena_decref (struct disir_arena **arena)
+{
+    struct arena_chunk *chunk;
+    struct arena_chunk *next;
+
+    if (arena == NULL || *arena == NULL)
+        return;
+
+    if (__atomic_sub_fetch (&(*arena)->ar_reference_count, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        log_debug (6, "releasing arena %p: %lu allocations in %lu chunks (%lu/%lu bytes)",
+                   *arena,
+                   (unsigned long) (*arena)->ar_stats.as_allocations,
+                   (unsigned long) (*arena)->ar_stats.as_chunks,
+                   (unsigned long) (*arena)->ar_stats.as_bytes_used,
+                   (unsigned long) (*arena)->ar_stats.as_bytes_reserved);
+
+        for (chunk = (*arena)->ar_chunks; chunk != NULL; chunk = next)
+        {
+            next = chunk->ac_next;
+            free (chunk);
+        }
+        free (*arena);
+    }
+
+    *arena = NULL;
+}
+
+//! STATIC API
+//! Block from the free lists of arena fitting size, unlinked. NULL if there is none.
+static struct arena_block *
+arena_free_take (struct disir_arena *arena, size_t size)
+{
+    struct arena_free **link;
+    struct arena_free *entry;
+    struct arena_block *block;
+
+    if (size <= ARENA_FREE_SMALL_MAX)
+    {
+        link = &arena->ar_free[size / ARENA_ALIGNMENT - 1];
+        entry = *link;
+        if (entry == NULL)
+            return NULL;
+
+        *link = entry->af_next;
+        return ((struct arena_block *) entry) - 1;
+    }
+
+    // Take the first large block that fits, without wasting more than half of it.
+    for (link = &arena->ar_free_large; *link != NULL; link = &(*link)->af_next)
+    {
+        block = ((struct arena_block *) *link) - 1;
+        if (block->ab_size >= size && block->ab_size / 2 <= size)
+        {
+            *link = (*link)->af_next;
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+//! INTERNAL API
+void *
+dx_arena_alloc (struct disir_arena *arena, size_t size)
+{
+    struct arena_chunk *chunk;
+    struct arena_block *block;
+    size_t required;
+
+    if (arena == NULL)
+        return calloc (1, size);
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+    if (size == 0)
+        size = ARENA_ALIGNMENT;
+
+    block = arena_free_take (arena, size);
+    if (block != NULL)
+        goto out;
+
+    required = sizeof (struct arena_block) + size;
+
+    chunk = arena->ar_chunks;
+    if (chunk == NULL || chunk->ac_size - chunk->ac_used < required)
+    {
+        if (required > arena->ar_next_chunk_size / 2)
+        {
+            // Oversized allocations get a chunk of their own, linked behind
+            // the current chunk so that we keep bumping from it.
+            chunk = arena_chunk_create (arena, required);
+            if (chunk == NULL)
+                return NULL;
+
+            if (arena->ar_chunks)
+            {
+                chunk->ac_next = arena->ar_chunks->ac_next;
+                arena->ar_chunks->ac_next = chunk;
+            }
+            else
+            {
+                chunk->ac_next = NULL;
+                arena->ar_chunks = chunk;
+            }
+        }
+        else
+        {
+            chunk = arena_chunk_create (arena, arena->ar_next_chunk_size);
+            if (chunk == NULL)
+                return NULL;
+
+            chunk->ac_next = arena->ar_chunks;
+            arena->ar_chunks = chunk;
+
+            if (arena->ar_next_chunk_size < ARENA_CHUNK_MAX)
+                arena->ar_next_chunk_size *= 2;
+        }
+    }
+
+    block = (struct arena_block *) (chunk->ac_data + chunk->ac_used);
+    block->ab_size = size;
+    chunk->ac_used += required;
+
+out:
+    arena->ar_stats.as_allocations += 1;
+    arena->ar_stats.as_bytes_used += block->ab_size;
+
+    // Chunk memory is not cleared up front; only what is handed out.
+    memset (block + 1, 0, block->ab_size);
+
+    return block + 1;
+}
+
+//! INTERNAL API
+void
+dx_arena_free (struct disir_arena *arena, void *ptr)
+{
+    struct arena_block *block;
+    struct arena_free *entry;
+
+    if (arena == NULL)
+    {
+        free (ptr);
+        return;
+    }
+    if (ptr == NULL)
+        return;
+
+    block = ((struct arena_block *) ptr) - 1;
+    entry = ptr;
+    if (block->ab_size <= ARENA_FREE_SMALL_MAX)
+    {
+        entry->af_next = arena->ar_free[block->ab_size / ARENA_ALIGNMENT - 1];
+        arena->ar_free[block->ab_size / ARENA_ALIGNMENT - 1] = entry;
+    }
+    else
+    {
+        entry->af_next = arena->ar_free_large;
+        arena->ar_free_large = entry;
+    }
+
+    arena->ar_stats.as_bytes_used -= block->ab_size;
+}
+
+//! INTERNAL API
+void
+dx_arena_stats (struct disir_arena *arena, struct disir_arena_stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    if (arena == NULL)
+    {
+        memset (stats, 0, sizeof (struct disir_arena_stats));
+        return;
+    }
+
+    *stats = arena->ar_stats;
+}
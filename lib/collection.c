@@ -6,6 +6,24 @@
 #include "collection.h"
 #include "context_private.h"
 
+//! Advanced every time a context is destroyed. Starts at one, since
+//! a collection generation of zero marks it as requiring a coalesce.
+static uint64_t collection_destroy_generation = 1;
+
+//! STATIC API
+//! Coalesce collection unless no context has been destroyed since it was last coalesced.
+static enum disir_status
+collection_coalesce_if_stale (struct disir_collection *collection)
+{
+    if (collection->cc_generation ==
+        __atomic_load_n (&collection_destroy_generation, __ATOMIC_ACQUIRE))
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    return dx_collection_coalesce (collection);
+}
+
 //! PUBLIC API
 int32_t
 dc_collection_size (struct disir_collection *collection)
@@ -15,7 +33,7 @@ dc_collection_size (struct disir_collection *collection)
         return 0;
 
     // Collesce to get an accurate count
-    dx_collection_coalesce (collection);
+    collection_coalesce_if_stale (collection);
 
     return collection->cc_numentries;
 }
@@ -62,8 +80,6 @@ dx_collection_next_noncoalesce (struct disir_collection *collection,
 enum disir_status
 dc_collection_next (struct disir_collection *collection, struct disir_context **context)
 {
-    enum disir_status status;
-
     if (collection == NULL)
     {
         log_debug (0, "invoked with NULL collection pointer.");
@@ -78,11 +94,13 @@ dc_collection_next (struct disir_collection *collection, struct disir_context **
     // Initialize the output with NULL
     *context = NULL;
 
-    // Coalesce array to get it in sync with reality
-    status = dx_collection_coalesce (collection);
-    if (status != DISIR_STATUS_OK)
+    // Skip past contexts destroyed since they were added. They are left in place
+    // for the next coalesce - the entries returned are the same as if the collection
+    // was coalesced first, without scanning the entire collection on every call.
+    while (collection->cc_iterator_index < collection->cc_numentries &&
+           collection->cc_collection[collection->cc_iterator_index]->CONTEXT_STATE_DESTROYED)
     {
-        return status;
+        collection->cc_iterator_index++;
     }
 
     // Exausted?
@@ -136,6 +154,10 @@ dx_collection_coalesce (struct disir_collection *collection)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    // Every context destroyed before this point is removed below.
+    collection->cc_generation = __atomic_load_n (&collection_destroy_generation,
+                                                 __ATOMIC_ACQUIRE);
+
     context = NULL;
     index = 0;
     probe = 1;
@@ -193,6 +215,13 @@ dx_collection_coalesce (struct disir_collection *collection)
     return DISIR_STATUS_OK;
 }
 
+//! INTERNAL API
+void
+dx_collection_context_destroyed (void)
+{
+    __atomic_add_fetch (&collection_destroy_generation, 1, __ATOMIC_RELEASE);
+}
+
 //! INTERNAL API
 struct disir_collection *
 dc_collection_create (void)
@@ -204,6 +233,8 @@ dc_collection_create (void)
         return NULL;
 
     collection->cc_capacity = 10;
+    collection->cc_generation = __atomic_load_n (&collection_destroy_generation,
+                                                 __ATOMIC_ACQUIRE);
 
     collection->cc_collection = calloc (collection->cc_capacity, sizeof (struct disir_context *));
     if (collection->cc_collection == NULL)
@@ -268,16 +299,16 @@ dc_collection_push_context (struct disir_collection *collection, struct disir_co
     }
 
     // Coalesce array to get it in sync with reality
-    status = dx_collection_coalesce (collection);
+    status = collection_coalesce_if_stale (collection);
     if (status != DISIR_STATUS_OK)
     {
         return status;
     }
 
-    // Expand capacity if needed
+    // Expand capacity if needed. Grow geometrically to keep pushing amortized constant.
     if (collection->cc_numentries == collection->cc_capacity)
     {
-        reallocated_capacity = collection->cc_capacity + 10;
+        reallocated_capacity = collection->cc_capacity * 2;
         reallocated_size = reallocated_capacity * sizeof (struct disir_context*);
         log_debug (8, "Reallocating collection to new size( %d )", reallocated_size);
         reallocated_collection = realloc (collection->cc_collection, reallocated_size);
@@ -290,6 +321,10 @@ dc_collection_push_context (struct disir_collection *collection, struct disir_co
         collection->cc_capacity = reallocated_capacity;
     }
 
+    // A context destroyed before it is pushed is not covered by the generation.
+    if (context->CONTEXT_STATE_DESTROYED)
+        collection->cc_generation = 0;
+
     dx_context_incref (context);
     collection->cc_collection[collection->cc_numentries] = context;
     collection->cc_numentries++;
@@ -11,6 +11,7 @@
 
 // Private
 #include "context_private.h"
+#include "collection.h"
 #include "config.h"
 #include "section.h"
 #include "keyval.h"
@@ -164,6 +165,7 @@ context_remove_from_parent (struct disir_context **context)
     if (storage && name)
     {
         log_debug(8, "Removing '%s' from parent storage", name);
+        dx_context_touch ((*context)->cx_parent_context);
         dx_element_storage_remove (storage, name, *context);
     }
 }
@@ -233,6 +235,7 @@ dc_destroy (struct disir_context **context)
 
     // Set the context to destroyed
     (*context)->CONTEXT_STATE_DESTROYED = 1;
+    dx_collection_context_destroyed ();
 
     // Decref the parent ref count attained in dx_context_attach
     // Guard against decrefing ourselves (top-level contexts)
@@ -462,7 +465,7 @@ dc_putcontext (struct disir_context **context)
 
     TRACE_ENTER ("*context: %p", *context);
 
-    if ((*context)->cx_refcount == 1)
+    if (__atomic_load_n (&(*context)->cx_refcount, __ATOMIC_ACQUIRE) == 1)
     {
         log_debug_context (4, *context, "Input context only at 1 reference."
                                         " Destroying instead of reducing refcount.");
@@ -532,6 +535,7 @@ dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
     // Find the name in the mold
     if (dc_context_type (context->cx_root_context) == DISIR_CONTEXT_CONFIG)
     {
+        dx_context_touch (context);
         invalid = dx_set_mold_equiv (context, name, name_size);
         if (invalid != DISIR_STATUS_OK && invalid != DISIR_STATUS_NOT_EXIST)
         {
@@ -566,11 +570,13 @@ dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
 
     if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
     {
-        status = dx_value_set_string (&context->cx_keyval->kv_name, name, name_size);
+        status = dx_value_set_string_arena (&context->cx_keyval->kv_name,
+                                            context->cx_keyval->kv_arena, name, name_size);
     }
     else if (dc_context_type (context) == DISIR_CONTEXT_SECTION)
     {
-        status = dx_value_set_string (&context->cx_section->se_name, name, name_size);
+        status = dx_value_set_string_arena (&context->cx_section->se_name,
+                                            context->cx_section->se_arena, name, name_size);
     }
     else
     {
@@ -987,6 +993,10 @@ dc_add_introduced (struct disir_context *context, struct disir_version *version)
     {
         introduced->sv_major = version->sv_major;
         introduced->sv_minor = version->sv_minor;
+        if (dc_context_type (context) == DISIR_CONTEXT_RESTRICTION)
+        {
+            dx_restriction_parent_changed (context);
+        }
 
         log_debug_context (6, context, "adding introduced to root(%s): %s",
                                        dc_context_type_string (context->cx_root_context),
@@ -1045,6 +1055,10 @@ dc_add_deprecated (struct disir_context *context, struct disir_version *version)
     {
         deprecated->sv_major = version->sv_major;
         deprecated->sv_minor = version->sv_minor;
+        if (dc_context_type (context) == DISIR_CONTEXT_RESTRICTION)
+        {
+            dx_restriction_parent_changed (context);
+        }
 
         log_debug_context (6, context, "adding deprecated to root(%s): %s",
                                        dc_context_type_string (context->cx_root_context),
@@ -1144,7 +1158,7 @@ dc_set_version (struct disir_context *context, struct disir_version *version)
             dx_log_context (context, "Cannot set version to CONFIG whose MOLD is lower.");
             return DISIR_STATUS_CONFLICTING_SEMVER;
         }
-        dc_version_set (&context->cx_config->cf_version, version);
+        dx_config_set_version (context->cx_config, version);
     }
     else if (dc_context_type (context) == DISIR_CONTEXT_MOLD)
     {
@@ -1304,6 +1318,55 @@ dc_get_elements (struct disir_context *context, struct disir_collection **collec
     return status;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_context_element_storage (struct disir_context *context, struct disir_element_storage **storage)
+{
+    enum disir_status status;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+    status = CONTEXT_TYPE_CHECK (context, DISIR_CONTEXT_SECTION,
+                                          DISIR_CONTEXT_MOLD,
+                                          DISIR_CONTEXT_CONFIG);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_MOLD:
+    {
+        *storage = context->cx_mold->mo_elements;
+        break;
+    }
+    case DISIR_CONTEXT_CONFIG:
+    {
+        *storage = context->cx_config->cf_elements;
+        break;
+    }
+    case DISIR_CONTEXT_SECTION:
+    {
+        *storage = context->cx_section->se_elements;
+        break;
+    }
+    default:
+    {
+        dx_context_error_set (context, "Invalid operation for context '%s'"
+                                       " (slipped through internal guard)",
+                                       dc_context_type_string (context));
+        return DISIR_STATUS_INTERNAL_ERROR;
+    }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! PUBLIC API
 //! TODO: Missing test
 enum disir_status
@@ -1311,10 +1374,7 @@ dc_find_element (struct disir_context *parent, const char *name, unsigned int in
                  struct disir_context **output)
 {
     enum disir_status status;
-    struct disir_collection *collection;
-    uint32_t size;
-
-    collection = NULL;
+    struct disir_element_storage *storage;
 
     if (output == NULL)
     {
@@ -1322,61 +1382,23 @@ dc_find_element (struct disir_context *parent, const char *name, unsigned int in
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dc_find_elements (parent, name, &collection);
+    status = dx_context_element_storage (parent, &storage);
     if (status != DISIR_STATUS_OK)
     {
-        goto error;
+        return status;
     }
 
-    // collection size is guaranteed to be atleast 1
-    size = dc_collection_size (collection);
-    if ((size - 1) < index)
+    // Index straight into the storage - no collection is materialized.
+    status = dx_element_storage_get_nth (storage, name, index, output);
+    if (status != DISIR_STATUS_OK)
     {
-        log_debug (5, "requested index (%d) out-of-bounds (size %d)", size, index);
-        status = DISIR_STATUS_NOT_EXIST;
-        goto error;
+        log_debug (5, "requested element '%s' at index (%d) does not exist", name, index);
+        return status;
     }
 
-    log_debug (8, "requested index (%d), collection of size (%d)", index, size);
+    dx_context_incref (*output);
 
-    unsigned int i = 0;
-    do
-    {
-        status = dc_collection_next (collection, output);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            // This should NOT happen, at all.
-            log_error ("collection exhausted on iteration (%d)," \
-                       " requested index (%d) out of size (%d)",
-                        i, index, size);
-            status = DISIR_STATUS_INTERNAL_ERROR;
-            break;
-        }
-        if (i == index)
-        {
-            status = DISIR_STATUS_OK;
-            break;
-        }
-        if (status != DISIR_STATUS_OK)
-        {
-            // Uhmm, something bad happend
-            log_error ("collection returned erroneous condition: %s",
-                       disir_status_string (status));
-        }
-        dc_putcontext (output);
-        i++;
-
-    } while (1);
-
-    // status is OK if output element was retrieved successfully from the collection.
-    // FALL-THROUGH
-error:
-    if (collection)
-    {
-        dc_collection_finished (&collection);
-    }
-
-    return status;
+    return DISIR_STATUS_OK;
 }
 
 //! PUBLIC API
@@ -1385,56 +1407,135 @@ dc_find_elements (struct disir_context *context,
                   const char *name, struct disir_collection **collection)
 {
     enum disir_status status;
+    struct disir_element_storage *storage;
 
     TRACE_ENTER ("context: %p, name: %s, collection: %p", context, name, collection);
 
-    status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
+    status = dx_context_element_storage (context, &storage);
     if (status != DISIR_STATUS_OK)
     {
-        // Already logged
         return status;
     }
-    status = CONTEXT_TYPE_CHECK (context, DISIR_CONTEXT_SECTION,
-                                          DISIR_CONTEXT_MOLD,
-                                          DISIR_CONTEXT_CONFIG);
+    if (collection == NULL)
+    {
+        log_debug (0, "invoked with NULL collection pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dx_element_storage_get (storage, name, collection);
+
+    TRACE_EXIT ("status: %s", disir_status_string (status));
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_foreach_element (struct disir_context *context, const char *name,
+                    dc_visit_function callback, void *userdata)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+
+    status = dx_context_element_storage (context, &storage);
     if (status != DISIR_STATUS_OK)
     {
         return status;
     }
-    if (collection == NULL)
+    if (callback == NULL)
     {
-        log_debug (0, "invoked with NULL collection pointer.");
+        log_debug (0, "invoked with NULL callback pointer.");
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    return dx_element_storage_foreach (storage, name, callback, userdata);
+}
+
+//! State of a single dc_walk, shared by every level of the walk.
+struct context_walk
+{
+    dc_visit_function       cw_pre;
+    dc_visit_function       cw_post;
+    void                    *cw_userdata;
+};
+
+//! STATIC API
+//! Visit element, and every element below it when it is a SECTION.
+static enum disir_status
+context_walk_element (struct disir_context *element, void *userdata)
+{
+    enum disir_status status;
+    struct context_walk *walk;
+
+    walk = userdata;
+
     status = DISIR_STATUS_OK;
-    switch (dc_context_type (context))
-    {
-    case DISIR_CONTEXT_MOLD:
+    if (walk->cw_pre)
     {
-        status = dx_element_storage_get (context->cx_mold->mo_elements, name, collection);
-        break;
+        status = walk->cw_pre (element, walk->cw_userdata);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NO_CAN_DO)
+            return status;
     }
-    case DISIR_CONTEXT_CONFIG:
+
+    if (status == DISIR_STATUS_OK && dc_context_type (element) == DISIR_CONTEXT_SECTION)
     {
-        status = dx_element_storage_get (context->cx_config->cf_elements, name, collection);
-        break;
+        status = dx_element_storage_foreach (element->cx_section->se_elements, NULL,
+                                             context_walk_element, walk);
+        if (status != DISIR_STATUS_OK)
+            return status;
     }
-    case DISIR_CONTEXT_SECTION:
+
+    if (walk->cw_post)
     {
-        status = dx_element_storage_get (context->cx_section->se_elements, name, collection);
-        break;
+        return walk->cw_post (element, walk->cw_userdata);
     }
-    default:
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_walk (struct disir_context *context, dc_visit_function pre, dc_visit_function post,
+         void *userdata)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct context_walk walk;
+
+    TRACE_ENTER ("context: %p", context);
+
+    status = dx_context_element_storage (context, &storage);
+    if (status == DISIR_STATUS_OK)
     {
-        status = DISIR_STATUS_INTERNAL_ERROR;
-        dx_context_error_set (context, "Invalid operation for context '%s'"
-                                       " (slipped through internal guard)",
-                                       dc_context_type_string (context));
-    }
+        walk.cw_pre = pre;
+        walk.cw_post = post;
+        walk.cw_userdata = userdata;
+        status = dx_element_storage_foreach (storage, NULL, context_walk_element, &walk);
     }
 
     TRACE_EXIT ("status: %s", disir_status_string (status));
     return status;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_context_element_count (struct disir_context *context, const char *name, int32_t *count)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+
+    status = dx_context_element_storage (context, &storage);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+    if (name == NULL || count == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (name %p, count %p)", name, count);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    *count = dx_element_storage_count (storage, name);
+
+    return DISIR_STATUS_OK;
+}
+
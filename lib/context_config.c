@@ -8,6 +8,7 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "config.h"
 #include "mold.h"
 #include "mqueue.h"
@@ -67,7 +68,7 @@ dc_config_begin (struct disir_mold *mold, struct disir_context **config)
 
     // Set associated mold
     context->cx_config->cf_mold = mold;
-    mold->mo_reference_count++;
+    dx_mold_incref (mold);
 
     // Set root context to self (such that children can inherit)
     context->cx_root_context = context;
@@ -139,7 +140,15 @@ dx_config_create (struct disir_context *context)
         goto error;
     }
 
-    config->cf_elements = dx_element_storage_create ();
+#ifdef DISIR_CONTEXT_ARENA
+    config->cf_arena = dx_arena_create ();
+    if (config->cf_arena == NULL)
+    {
+        goto error;
+    }
+#endif
+
+    config->cf_elements = dx_element_storage_create (config->cf_arena);
     if (config->cf_elements == NULL)
     {
         goto error;
@@ -147,6 +156,7 @@ dx_config_create (struct disir_context *context)
 
     config->cf_context = context;
     config->cf_version.sv_major = 1;
+    config->cf_generation = 1;
 
     return config;
 error:
@@ -156,6 +166,7 @@ error:
     }
     if (config)
     {
+        dx_arena_decref (&config->cf_arena);
         free (config);
     }
 
@@ -195,12 +206,24 @@ dx_config_destroy (struct disir_config **config)
 
     dx_element_storage_destroy (&(*config)->cf_elements);
 
+    // Releases every section and keyval in one go,
+    // unless the user still holds a reference to any of them.
+    dx_arena_decref (&(*config)->cf_arena);
+
     free (*config);
     *config = NULL;
 
     return DISIR_STATUS_OK;
 }
 
+//! INTERNAL API
+void
+dx_config_set_version (struct disir_config *config, struct disir_version *version)
+{
+    dc_version_set (&config->cf_version, version);
+    config->cf_version_generation = ++config->cf_generation;
+}
+
 //! PUBLIC API
 enum disir_status
 dc_config_get_version (struct disir_config *config, struct disir_version *version)
@@ -230,7 +253,7 @@ disir_config_get_mold (struct disir_config *config, struct disir_mold **mold)
     }
 
     *mold = config->cf_mold;
-    (*mold)->mo_reference_count++;
+    dx_mold_incref (*mold);
 
     return DISIR_STATUS_OK;
 }
@@ -15,7 +15,22 @@
 #include "default.h"
 #include "context_private.h"
 #include "collection.h"
+#include "default_table.h"
+#include "generate.h"
 
+//! STATIC API
+//! Mold the KEYVAL context belongs to, or NULL if its root is not a mold.
+static struct disir_mold *
+default_keyval_mold (struct disir_context *keyval)
+{
+    struct disir_context *root;
+
+    root = keyval->cx_root_context;
+    if (root == NULL || dx_context_type_sanify (root->cx_type) != DISIR_CONTEXT_MOLD)
+        return NULL;
+
+    return root->cx_mold;
+}
 
 //! INTERNAL API
 enum disir_status
@@ -108,6 +123,9 @@ dx_default_finalize (struct disir_context *default_context)
     default_context->CONTEXT_STATE_IN_PARENT = 1;
     MQ_ENQUEUE_CONDITIONAL (*queue, def,
         (dc_version_compare (&entry->de_introduced, &def->de_introduced) > 0));
+    dx_default_table_invalidate (default_keyval_mold (default_context->cx_parent_context),
+                                 default_context->cx_parent_context->cx_keyval);
+    dx_generate_templates_invalidate (default_context);
 
     return dx_validate_context (default_context);
 }
@@ -161,6 +179,7 @@ dx_default_destroy (struct disir_default **def)
             {
                 queue = &(context->cx_parent_context->cx_keyval->kv_default_queue);
                 MQ_REMOVE_SAFE (*queue, tmp);
+                dx_default_table_invalidate (NULL, context->cx_parent_context->cx_keyval);
             }
             else
             {
@@ -622,15 +641,23 @@ dx_default_get_active (struct disir_context *keyval, struct disir_version *versi
     }
     else if (version)
     {
-        current = MQ_FIND (keyval->cx_keyval->kv_default_queue,
-                (dc_version_compare (&entry->de_introduced, version) > 0));
-        if (current != NULL && current->prev != MQ_TAIL (keyval->cx_keyval->kv_default_queue))
-        {
-            current = current->prev;
-        }
+        // Resolved through the table compiled when the mold was finalized.
+        current = dx_default_table_get_active (default_keyval_mold (keyval), keyval->cx_keyval,
+                                               version);
         if (current == NULL)
         {
-            current = MQ_TAIL (keyval->cx_keyval->kv_default_queue);
+            // Not compiled - the mold is still under construction.
+            current = MQ_FIND (keyval->cx_keyval->kv_default_queue,
+                    (dc_version_compare (&entry->de_introduced, version) > 0));
+            if (current != NULL
+                && current->prev != MQ_TAIL (keyval->cx_keyval->kv_default_queue))
+            {
+                current = current->prev;
+            }
+            if (current == NULL)
+            {
+                current = MQ_TAIL (keyval->cx_keyval->kv_default_queue);
+            }
         }
     }
     else
@@ -9,6 +9,7 @@
 
 // private
 #include "context_private.h"
+#include "arena.h"
 #include "keyval.h"
 #include "config.h"
 #include "mold.h"
@@ -16,6 +17,9 @@
 #include "log.h"
 #include "mqueue.h"
 #include "restriction.h"
+#include "restriction_table.h"
+#include "default_table.h"
+#include "generate.h"
 
 //! INTERNAL API
 enum disir_status
@@ -55,7 +59,7 @@ dx_keyval_begin (struct disir_context *parent, struct disir_context **keyval)
         return DISIR_STATUS_NO_MEMORY;
     }
 
-    context->cx_keyval = dx_keyval_create (context);
+    context->cx_keyval = dx_keyval_create (context, dx_context_arena (parent));
     if (context->cx_keyval == NULL)
     {
         dx_context_destroy (&context);
@@ -136,6 +140,8 @@ dx_keyval_finalize (struct disir_context *keyval)
         else
         {
             keyval->CONTEXT_STATE_IN_PARENT = 1;
+            dx_context_touch (keyval->cx_parent_context);
+            dx_generate_templates_invalidate (keyval);
         }
     }
 
@@ -356,16 +362,18 @@ dc_add_keyval_integer (struct disir_context *parent, const char *name, int64_t d
 
 //! INTERNAL API
 struct disir_keyval *
-dx_keyval_create (struct disir_context *parent)
+dx_keyval_create (struct disir_context *parent, struct disir_arena *arena)
 {
     struct disir_keyval *keyval;
 
-    keyval = calloc(1, sizeof (struct disir_keyval));
+    keyval = dx_arena_alloc (arena, sizeof (struct disir_keyval));
     if (keyval == NULL)
         return NULL;
 
     keyval->kv_context = parent;
     keyval->kv_name.dv_type = DISIR_VALUE_TYPE_STRING;
+    keyval->kv_arena = arena;
+    dx_arena_incref (arena);
 
     return keyval;
 }
@@ -378,6 +386,7 @@ dx_keyval_destroy (struct disir_keyval **keyval)
     struct disir_documentation *doc;
     struct disir_default *def;
     struct disir_restriction *restriction;
+    struct disir_arena *arena;
 
     if (keyval == NULL || *keyval == NULL)
     {
@@ -385,10 +394,12 @@ dx_keyval_destroy (struct disir_keyval **keyval)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    arena = (*keyval)->kv_arena;
+
     // Free allocated name
     if ((*keyval)->kv_name.dv_size != 0)
     {
-        free ((*keyval)->kv_name.dv_string);
+        dx_arena_free (arena, (*keyval)->kv_name.dv_string);
     }
 
     // Free allocated value, if string or enum
@@ -396,7 +407,7 @@ dx_keyval_destroy (struct disir_keyval **keyval)
         || (*keyval)->kv_value.dv_type == DISIR_VALUE_TYPE_ENUM)
            && (*keyval)->kv_value.dv_size != 0)
     {
-        free ((*keyval)->kv_value.dv_string);
+        dx_arena_free (arena, (*keyval)->kv_value.dv_string);
     }
 
     // Decref mold_equiv if set
@@ -427,9 +438,14 @@ dx_keyval_destroy (struct disir_keyval **keyval)
         context = restriction->re_context;
         dc_destroy (&context);
     }
+    dx_restriction_table_invalidate (&(*keyval)->kv_restriction_table);
+    dx_default_table_invalidate (NULL, *keyval);
 
-    free (*keyval);
+    dx_arena_free (arena, *keyval);
     *keyval = NULL;
+
+    // Last use of the arena - it may be released here.
+    dx_arena_decref (&arena);
     return DISIR_STATUS_OK;
 }
 
@@ -472,7 +488,9 @@ dc_keyval_set_default (struct disir_context *keyval, struct disir_version *versi
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    status = dx_value_copy (&keyval->cx_keyval->kv_value, &def->de_value);
+    dx_context_touch (keyval);
+    status = dx_value_copy_arena (&keyval->cx_keyval->kv_value, keyval->cx_keyval->kv_arena,
+                                  &def->de_value);
     if (status != DISIR_STATUS_OK)
     {
         log_debug (2, "failed to copy value: %s", disir_status_string (status));
@@ -8,7 +8,10 @@
 
 // private
 #include "context_private.h"
+#include "arena.h"
 #include "mold.h"
+#include "default_table.h"
+#include "generate.h"
 #include "documentation.h"
 #include "mqueue.h"
 #include "log.h"
@@ -90,6 +93,14 @@ dc_mold_finalize (struct disir_context **context, struct disir_mold **mold)
         return DISIR_STATUS_WRONG_CONTEXT;
     }
 
+    // Compile the default tables before validation, which resolves defaults.
+    // Keyvals left without a table fall back to their default queue.
+    status = dx_default_table_compile_mold (*context);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_warn ("failed to compile default tables: %s", disir_status_string (status));
+    }
+
     // Perform full mold validation.
     status = dx_validate_context (*context);
     // Only set state if the validate operation went as planned
@@ -115,6 +126,13 @@ dc_mold_finalize (struct disir_context **context, struct disir_mold **mold)
 }
 
 
+//! INTERNAL API
+void
+dx_mold_incref (struct disir_mold *mold)
+{
+    __atomic_add_fetch (&mold->mo_reference_count, 1, __ATOMIC_RELAXED);
+}
+
 //! INTERNAL API
 struct disir_mold *
 dx_mold_create (struct disir_context *context)
@@ -129,7 +147,16 @@ dx_mold_create (struct disir_context *context)
 
     mold->mo_reference_count = 1;
     mold->mo_context = context;
-    mold->mo_elements = dx_element_storage_create ();
+
+#ifdef DISIR_CONTEXT_ARENA
+    mold->mo_arena = dx_arena_create ();
+    if (mold->mo_arena == NULL)
+    {
+        goto error;
+    }
+#endif
+
+    mold->mo_elements = dx_element_storage_create (mold->mo_arena);
     if (mold->mo_elements == NULL)
     {
         goto error;
@@ -147,6 +174,7 @@ error:
     }
     if (mold)
     {
+        dx_arena_decref (&mold->mo_arena);
         free (mold);
     }
 
@@ -168,6 +196,9 @@ dx_mold_destroy (struct disir_mold **mold)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    // Templates reference the elements, without holding a reference.
+    dx_generate_templates_destroy (*mold);
+
     // Destroy all element_storage children
     status = dx_element_storage_get_all ((*mold)->mo_elements, &collection);
     if (status == DISIR_STATUS_OK)
@@ -187,6 +218,7 @@ dx_mold_destroy (struct disir_mold **mold)
 
     // Destroy element storage in the mold.
     dx_element_storage_destroy (&(*mold)->mo_elements);
+    dx_default_views_destroy (*mold);
 
     // Destroy the documentation associated with the mold.
     while ((doc = MQ_POP ((*mold)->mo_documentation_queue)))
@@ -195,6 +227,10 @@ dx_mold_destroy (struct disir_mold **mold)
         dc_destroy (&context);
     }
 
+    // Releases every section and keyval in one go,
+    // unless the user still holds a reference to any of them.
+    dx_arena_decref (&(*mold)->mo_arena);
+
     free (*mold);
     *mold = NULL;
 
@@ -17,6 +17,8 @@
 #include "section.h"
 #include "config.h"
 #include "mold.h"
+#include "restriction_table.h"
+#include "generate.h"
 
 //! Define the size of the buffer used to name values of all restrictions
 //! active in a restriction check
@@ -189,6 +191,8 @@ dx_restriction_finalize (struct disir_context *context)
         // Enqueue
         MQ_ENQUEUE (*queue, context->cx_restriction);
         context->CONTEXT_STATE_IN_PARENT = 1;
+        dx_restriction_parent_changed (context);
+        dx_generate_templates_invalidate (context);
     }
     else
     {
@@ -265,6 +269,7 @@ dx_restriction_destroy (struct disir_restriction **restriction)
             if (queue)
             {
                 MQ_REMOVE_SAFE (*queue, tmp);
+                dx_restriction_parent_changed (context);
             }
         }
     }
@@ -305,6 +310,20 @@ dx_restriction_get_queue (struct disir_context *context, struct disir_restrictio
     return DISIR_STATUS_OK;
 }
 
+//! INTERNAL API
+void
+dx_restriction_parent_changed (struct disir_context *context)
+{
+    struct disir_context *parent;
+
+    parent = context->cx_parent_context;
+    if (parent && parent->CONTEXT_STATE_DESTROYED == 0
+        && dc_context_type (parent) == DISIR_CONTEXT_KEYVAL)
+    {
+        dx_restriction_table_invalidate (&parent->cx_keyval->kv_restriction_table);
+    }
+}
+
 //! PUBLIC API
 enum disir_status
 dc_get_restriction_type (struct disir_context *context, enum disir_restriction_type *type)
@@ -412,6 +431,7 @@ dc_set_restriction_type (struct disir_context *context, enum disir_restriction_t
 
     // Parent is valid entry to set type to.
     context->cx_restriction->re_type = type;
+    dx_restriction_parent_changed (context);
 
     return DISIR_STATUS_OK;
 }
@@ -491,6 +511,7 @@ dc_restriction_set_string (struct disir_context *context, const char *value)
             free (context->cx_restriction->re_value_string);
         }
         context->cx_restriction->re_value_string = strdup (value);
+        dx_restriction_parent_changed (context);
         break;
     }
     default:
@@ -537,7 +558,7 @@ dc_restriction_set_range (struct disir_context *context, double min, double max)
             context->cx_restriction->re_value_min = min;
             context->cx_restriction->re_value_max = max;
         }
-
+        dx_restriction_parent_changed (context);
 
         break;
     }
@@ -626,6 +647,7 @@ dc_restriction_set_numeric (struct disir_context *context, double value)
     case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
     {
         context->cx_restriction->re_value_numeric = value;
+        dx_restriction_parent_changed (context);
         break;
     }
     case DISIR_RESTRICTION_INC_ENTRY_MIN:
@@ -1017,6 +1039,89 @@ dc_add_restriction_entries_max (struct disir_context *parent, int64_t max,
     return add_restriction_entries_min_max (parent, max, version, DISIR_RESTRICTION_INC_ENTRY_MAX);
 }
 
+//! STATIC API
+//!
+//! Populate allowed_values with the exclusive restrictions in queue active at version,
+//! formatted for the value type of context. Only invoked once a violation is detected.
+//!
+static void
+restriction_allowed_values (struct disir_context *context, struct disir_restriction *queue,
+                            struct disir_version *version, char *allowed_values)
+{
+    int allowed_written;
+
+    allowed_written = 0;
+    allowed_values[0] = '\0';
+
+    MQ_FOREACH (queue,
+    {
+        if (dx_restriction_is_active (entry, version))
+        {
+            switch (entry->re_type)
+            {
+            case DISIR_RESTRICTION_EXC_VALUE_RANGE:
+            {
+                if (dc_value_type (context) == DISIR_VALUE_TYPE_INTEGER)
+                {
+                    allowed_written += snprintf (allowed_values + allowed_written,
+                                                 RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
+                                                 "[%lld, %lld], ",
+                                                 (long long int)entry->re_value_min,
+                                                 (long long int)entry->re_value_max);
+                }
+                else if (dc_value_type (context) == DISIR_VALUE_TYPE_FLOAT)
+                {
+                    allowed_written += snprintf (allowed_values + allowed_written,
+                                                 RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
+                                                 "[%f, %f], ",
+                                                 entry->re_value_min, entry->re_value_max);
+                }
+                break;
+            }
+            case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
+            {
+                if (dc_value_type (context) == DISIR_VALUE_TYPE_INTEGER)
+                {
+                    allowed_written += snprintf (allowed_values + allowed_written,
+                                                 RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
+                                                 "%lld, ", (long long int)entry->re_value_numeric);
+                }
+                else if (dc_value_type (context) == DISIR_VALUE_TYPE_FLOAT)
+                {
+                    allowed_written += snprintf (allowed_values + allowed_written,
+                                                 RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
+                                                 "%f, ", entry->re_value_numeric);
+                }
+                break;
+            }
+            case DISIR_RESTRICTION_EXC_VALUE_ENUM:
+            {
+                allowed_written += snprintf (allowed_values + allowed_written,
+                                             RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
+                                             "'%s', ", entry->re_value_string);
+                break;
+            }
+            default:
+                // Not an exclusive restriction
+                break;
+            }
+
+            if (allowed_written >= RESTRICTION_ENTRIES_BUFFER_SIZE)
+            {
+                // Set the written property to the size of the buffer, dis-allowing any
+                // further writes.
+                allowed_written = RESTRICTION_ENTRIES_BUFFER_SIZE;
+            }
+        }
+    });
+
+    // Strip the last ', ' from allowed_values buffer
+    if (allowed_written != 0)
+    {
+        allowed_values[allowed_written - 2] = '\0';
+    }
+}
+
 //! INTERNAL API
 enum disir_status
 dx_restriction_exclusive_value_check (struct disir_context *context, int64_t integer_value,
@@ -1024,17 +1129,17 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
                                                                      const char *string_value)
 {
     enum disir_status status;
-    struct disir_restriction **queue;
+    struct disir_keyval *mold_keyval;
+    struct disir_restriction_table *table;
     struct disir_version *config_version;
-    int exclusive_fulfilled = 0;
-    int restriction_entries_inactive = 0;
+    uint32_t restriction_entries_active;
+    int exclusive_fulfilled;
     double value;
 
     char allowed_values[RESTRICTION_ENTRIES_BUFFER_SIZE];
-    int allowed_written;
 
     status = DISIR_STATUS_OK;
-    allowed_written = 0;
+    value = 0;
 
     TRACE_ENTER ("%s(%p), int (%d) float (%f)", dc_context_type_string (context), context,
                                                 integer_value, float_value);
@@ -1067,155 +1172,38 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
     }
     }
 
-    queue = &context->cx_keyval->kv_mold_equiv->cx_keyval->kv_restrictions_queue;
+    mold_keyval = context->cx_keyval->kv_mold_equiv->cx_keyval;
     config_version = &context->cx_root_context->cx_config->cf_version;
 
-    MQ_FOREACH (*queue,
+    // Compiled once per mold keyval, and shared by every config validated against it.
+    table = dx_restriction_table_get (&mold_keyval->kv_restriction_table,
+                                      mold_keyval->kv_restrictions_queue);
+    if (table == NULL)
     {
-        if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MIN ||
-            entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MAX)
-        {
-            restriction_entries_inactive += 1;
-            entry = entry->next;
-            continue;
-        }
-
-        log_debug (10, "queue entry (%p), next (%p), prev (%p)", entry, entry->next, entry->prev);
-        // Is restriction valid for this version of the config
-        if (dc_version_compare (config_version, &entry->re_introduced) < 0)
-        {
-            log_debug (9, "queue entry introduced later than config. Skipping");
-            restriction_entries_inactive += 1;
-            // XXX MQ_FOREACH does not increment entry if continue is used
-            entry = entry->next;
-            continue;
-        }
-
-        // Has this restriction been deprecated?
-        if ((entry->re_deprecated.sv_major != 0 || entry->re_deprecated.sv_minor != 0)
-                && dc_version_compare (config_version, &entry->re_deprecated) >= 0)
-        {
-            log_debug(9, "queue entry deprecated. skipping");
-            restriction_entries_inactive += 1;
-            entry = entry->next;
-            continue;
-        }
-
-        switch (entry->re_type)
-        {
-        case DISIR_RESTRICTION_EXC_VALUE_RANGE:
-        {
-            log_debug (9, "value (%f), min (%f), max (%f)", value,
-                          entry->re_value_min, entry->re_value_max);
-
-            if (dc_value_type (context) == DISIR_VALUE_TYPE_INTEGER)
-            {
-                allowed_written += snprintf (allowed_values + allowed_written,
-                                             RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
-                                             "[%lld, %lld], ",
-                                             (long long int)entry->re_value_min,
-                                             (long long int)entry->re_value_max);
-            }
-            else if (dc_value_type (context) == DISIR_VALUE_TYPE_FLOAT)
-            {
-                allowed_written += snprintf (allowed_values + allowed_written,
-                                             RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
-                                             "[%f, %f], ",
-                                             entry->re_value_min, entry->re_value_max);
-            }
-            if (allowed_written >= RESTRICTION_ENTRIES_BUFFER_SIZE)
-            {
-                // Set the written property to the size of the buffer, dis-allowing any
-                // further writes.
-                allowed_written = RESTRICTION_ENTRIES_BUFFER_SIZE;
-            }
-
-            if (value >= entry->re_value_min && value <= entry->re_value_max)
-            {
-                log_debug (8, "Exclusive restriction %s(%p) fulfilled. (Value (%f) == [%f, %f])",
-                              dc_restriction_enum_string (entry->re_type), entry,
-                              value, entry->re_value_min, entry->re_value_max);
-                exclusive_fulfilled = 1;
-            }
-            break;
-        }
-        case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
-        {
-            log_debug (9, "value (%f) numeric (%f)", value, entry->re_value_numeric);
-
-            if (dc_value_type (context) == DISIR_VALUE_TYPE_INTEGER)
-            {
-                allowed_written += snprintf (allowed_values + allowed_written,
-                                             RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
-                                             "%lld, ", (long long int)entry->re_value_numeric);
-            }
-            else if (dc_value_type (context) == DISIR_VALUE_TYPE_FLOAT)
-            {
-                allowed_written += snprintf (allowed_values + allowed_written,
-                                             RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
-                                             "%f, ", entry->re_value_numeric);
-            }
-            if (allowed_written >= RESTRICTION_ENTRIES_BUFFER_SIZE)
-            {
-                // Set the written property to the size of the buffer, dis-allowing any
-                // further writes.
-                allowed_written = RESTRICTION_ENTRIES_BUFFER_SIZE;
-            }
-
-            if (value == entry->re_value_numeric)
-            {
-                log_debug (6, "Exclusive restriction %s(%p) fufilled. (Value (%f) == %f)",
-                              dc_restriction_enum_string (entry->re_type), entry,
-                              value, entry->re_value_numeric);
-
-                exclusive_fulfilled = 1;
-            }
-            break;
-        }
-        case DISIR_RESTRICTION_EXC_VALUE_ENUM:
-        {
-            log_debug (9, "value (%s) enum (%s)", string_value, entry->re_value_string);
-
-            allowed_written += snprintf (allowed_values + allowed_written,
-                                         RESTRICTION_ENTRIES_BUFFER_SIZE - allowed_written,
-                                         "'%s', ", entry->re_value_string);
-            if (allowed_written >= RESTRICTION_ENTRIES_BUFFER_SIZE)
-            {
-                // Set the written property to the size of the buffer, dis-allowing any
-                // further writes.
-                allowed_written = RESTRICTION_ENTRIES_BUFFER_SIZE;
-            }
-
-            if (strcmp (string_value, entry->re_value_string) == 0)
-            {
-                // QUESTION: Check length aswell ?
-                log_debug (6, "Exclusive_restriction fulfilled (Value (%s) == %s)",
-                              string_value, entry->re_value_string);
-                exclusive_fulfilled = 1;
-            }
-            break;
-        }
-        default:
-        {
-            log_warn_context (context, "unhandled exclusive restriction check: %s",
-                                        dc_restriction_enum_string (entry->re_type));
-        }
-        }
-
-    });
+        dx_context_error_set (context, "cannot allocate memory to check restrictions");
+        return DISIR_STATUS_NO_MEMORY;
+    }
 
-    // Strip the last ', ' from allowed_values buffer
-    if (allowed_written != 0)
+    if (dc_value_type (context) == DISIR_VALUE_TYPE_ENUM)
     {
-        allowed_values[allowed_written - 2] = '\0';
+        exclusive_fulfilled = dx_restriction_table_check_enum (table, config_version,
+                                                               string_value,
+                                                               &restriction_entries_active);
+    }
+    else
+    {
+        exclusive_fulfilled = dx_restriction_table_check_numeric (table, config_version, value,
+                                                                  &restriction_entries_active);
     }
 
     // Entry did not fulfill the exclusive restrictions. Get out' here!
-    if (exclusive_fulfilled == 0 && MQ_SIZE (*queue) > restriction_entries_inactive)
+    if (exclusive_fulfilled == 0 && restriction_entries_active > 0)
     {
-        log_debug (4, "Exclusive restriction(s) violated."
-                      " Out of range (%d) vs entires (%d)",
-                      restriction_entries_inactive, MQ_SIZE (*queue));
+        log_debug (4, "Exclusive restriction(s) violated. Active entries (%d)",
+                      restriction_entries_active);
+
+        restriction_allowed_values (context, mold_keyval->kv_restrictions_queue,
+                                    config_version, allowed_values);
 
         switch (dc_value_type (context))
         {
@@ -1244,7 +1232,7 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
     if (exclusive_fulfilled == 0 &&
         status != DISIR_STATUS_RESTRICTION_VIOLATED &&
         dc_value_type (context) == DISIR_VALUE_TYPE_ENUM &&
-        MQ_SIZE(*queue) == restriction_entries_inactive)
+        restriction_entries_active == 0)
     {
         log_debug (4, "Missing enum restrictions. Keyval considered invalid.");
         dx_context_error_set (context, "Enum requires atleast one value restriction.");
@@ -1255,6 +1243,42 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
     return status;
 }
 
+//! STATIC API
+//!
+//! Consider an INCLUSIVE restriction for the entries value resolved at version.
+//! The restriction introduced closest to version, but not after it, takes effect.
+//!
+static void
+restriction_entries_closest (struct disir_restriction *entry, struct disir_version *version,
+                             int *min, int *min_closes_match, int *max, int *max_closes_match)
+{
+    int diff;
+
+    if (entry->re_type != DISIR_RESTRICTION_INC_ENTRY_MIN &&
+        entry->re_type != DISIR_RESTRICTION_INC_ENTRY_MAX)
+    {
+        return;
+    }
+
+    // XXX: This is severely flawed - the diff does not indicate
+    // how great of a version difference
+    diff = dc_version_compare  (&entry->re_introduced, version);
+    // entry is newer than target version
+    if (diff > 0)
+        return;
+
+    if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MIN && diff > *min_closes_match)
+    {
+        *min_closes_match = diff;
+        *min = entry->re_value_min;
+    }
+    else if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MAX && diff > *max_closes_match)
+    {
+        *max_closes_match = diff;
+        *max = entry->re_value_max;
+    }
+}
+
 //! INTERNAL API
 enum disir_status
 dx_restriction_entries_value (struct disir_context *context, enum disir_restriction_type type,
@@ -1266,7 +1290,10 @@ dx_restriction_entries_value (struct disir_context *context, enum disir_restrict
     int max = -1;
     int min_closes_match = INT_MIN;
     int max_closes_match = INT_MIN;
-    int diff;
+    struct disir_restriction_table *table = NULL;
+    struct disir_restriction **inclusive = NULL;
+    uint32_t inclusive_count = 0;
+    uint32_t i;
     struct disir_version *element_introduced = NULL;
     struct disir_version *element_deprecated = NULL;
 
@@ -1311,6 +1338,11 @@ dx_restriction_entries_value (struct disir_context *context, enum disir_restrict
         }
         element_deprecated = &keyval_mold->kv_deprecated;
 
+        table = dx_restriction_table_get (&keyval_mold->kv_restriction_table, *q);
+        if (table == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+        inclusive = dx_restriction_table_inclusive (table, &inclusive_count);
+
         // Get _lowest_ introduced for keyval
         struct disir_default **default_queue = &keyval_mold->kv_default_queue;
         MQ_FOREACH (*default_queue,
@@ -1353,33 +1385,23 @@ dx_restriction_entries_value (struct disir_context *context, enum disir_restrict
     }
 
     // Loop over each INCLUSIVE entry - finding max and min
-    MQ_FOREACH (*q,
+    if (table)
     {
-        if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MIN ||
-            entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MAX)
+        // Keyvals keep their inclusive entries apart from the exclusive ones
+        for (i = 0; i < inclusive_count; i++)
         {
-            // XXX: This is severely flawed - the diff does not indicate
-            // how great of a version difference
-            diff = dc_version_compare  (&entry->re_introduced, version);
-            // entry is newer than target version
-            if (diff > 0)
-            {
-                entry = entry->next;
-                continue;
-            }
-
-            if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MIN && diff > min_closes_match)
-            {
-                min_closes_match = diff;
-                min = entry->re_value_min;
-            }
-            else if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MAX && diff > max_closes_match)
-            {
-                max_closes_match = diff;
-                max = entry->re_value_max;
-            }
+            restriction_entries_closest (inclusive[i], version, &min, &min_closes_match,
+                                         &max, &max_closes_match);
         }
-    });
+    }
+    else
+    {
+        MQ_FOREACH (*q,
+        {
+            restriction_entries_closest (entry, version, &min, &min_closes_match,
+                                         &max, &max_closes_match);
+        });
+    }
 
     // Set max.
     // Maximum default is 1.
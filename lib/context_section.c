@@ -9,6 +9,7 @@
 
 // private
 #include "context_private.h"
+#include "arena.h"
 #include "section.h"
 #include "config.h"
 #include "mold.h"
@@ -16,6 +17,7 @@
 #include "log.h"
 #include "mqueue.h"
 #include "restriction.h"
+#include "generate.h"
 
 //! INTERNAL API
 enum disir_status
@@ -51,7 +53,7 @@ dx_section_begin (struct disir_context *parent, struct disir_context **section)
         return DISIR_STATUS_NO_MEMORY;
     }
 
-    context->cx_section = dx_section_create (context);
+    context->cx_section = dx_section_create (context, dx_context_arena (parent));
     if (context->cx_section == NULL)
     {
         dx_context_destroy (&context);
@@ -135,6 +137,8 @@ dx_section_finalize (struct disir_context *section)
         else
         {
             section->CONTEXT_STATE_IN_PARENT = 1;
+            dx_context_touch (section->cx_parent_context);
+            dx_generate_templates_invalidate (section);
         }
     }
 
@@ -143,23 +147,25 @@ dx_section_finalize (struct disir_context *section)
 
 //! INTERNAL API
 struct disir_section *
-dx_section_create (struct disir_context *self)
+dx_section_create (struct disir_context *self, struct disir_arena *arena)
 {
     struct disir_section *section;
 
-    section = calloc(1, sizeof (struct disir_section));
+    section = dx_arena_alloc (arena, sizeof (struct disir_section));
     if (section == NULL)
         return NULL;
 
     section->se_introduced.sv_major = 1;
     section->se_name.dv_type = DISIR_VALUE_TYPE_STRING;
     section->se_context = self;
-    section->se_elements = dx_element_storage_create ();
+    section->se_arena = arena;
+    section->se_elements = dx_element_storage_create (arena);
     if (section->se_elements == NULL)
     {
         goto error;
     }
 
+    dx_arena_incref (arena);
     return section;
 error:
     if (section && section->se_elements)
@@ -168,7 +174,7 @@ error:
     }
     if (section)
     {
-        free (section);
+        dx_arena_free (arena, section);
     }
     return NULL;
 }
@@ -182,16 +188,19 @@ dx_section_destroy (struct disir_section **section)
     struct disir_documentation *doc;
     struct disir_collection *collection;
     struct disir_restriction *restriction;
+    struct disir_arena *arena;
 
     if (section == NULL || *section == NULL)
     {
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    arena = (*section)->se_arena;
+
     // Free allocated name
     if ((*section)->se_name.dv_size != 0)
     {
-        free ((*section)->se_name.dv_string);
+        dx_arena_free (arena, (*section)->se_name.dv_string);
     }
 
     // Decref mold_equiv if set
@@ -234,9 +243,12 @@ dx_section_destroy (struct disir_section **section)
         dc_destroy (&context);
     }
 
-    free (*section);
+    dx_arena_free (arena, *section);
     *section = NULL;
 
+    // Last use of the arena - it may be released here.
+    dx_arena_decref (&arena);
+
     return DISIR_STATUS_OK;
 }
 
@@ -9,8 +9,12 @@
 
 // Private
 #include "context_private.h"
+#include "config.h"
 #include "log.h"
 #include "keyval.h"
+#include "section.h"
+#include "config.h"
+#include "mold.h"
 
 //! Array  of string representations corresponding to the
 //! disir_context_type enumeration value.
@@ -149,19 +153,66 @@ dx_context_attach (struct disir_context *parent, struct disir_context *context)
     dx_context_incref (parent);
 }
 
+//! INTERNAL API
+void
+dx_context_touch (struct disir_context *context)
+{
+    uint64_t generation;
+
+    if (context == NULL || context->cx_root_context == NULL
+        || dc_context_type (context->cx_root_context) != DISIR_CONTEXT_CONFIG)
+    {
+        return;
+    }
+
+    generation = ++context->cx_root_context->cx_config->cf_generation;
+
+    // Every ancestor validates its children - mark the whole chain.
+    for (; context != NULL; context = context->cx_parent_context)
+    {
+        context->cx_changed = generation;
+    }
+}
+
+//! INTERNAL API
+struct disir_arena *
+dx_context_arena (struct disir_context *context)
+{
+    if (context == NULL)
+        return NULL;
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_CONFIG:
+        return context->cx_config->cf_arena;
+    case DISIR_CONTEXT_MOLD:
+        return context->cx_mold->mo_arena;
+    case DISIR_CONTEXT_SECTION:
+        return context->cx_section->se_arena;
+    case DISIR_CONTEXT_KEYVAL:
+        return context->cx_keyval->kv_arena;
+    default:
+        return NULL;
+    }
+}
+
 //! INTERNAL API
 void
 dx_context_incref (struct disir_context *context)
 {
-    context->cx_refcount++;
-    log_debug_context (9, context,
-                       "(%p) increased refcount to: %d", context, context->cx_refcount);
+    int64_t refcount;
+
+    // Contexts of a mold are shared by every config (and thread) referencing it.
+    refcount = __atomic_add_fetch (&context->cx_refcount, 1, __ATOMIC_RELAXED);
+    log_debug_context (9, context, "(%p) increased refcount to: %d", context, refcount);
 }
 
 //! INTERNAL API
 void
 dx_context_decref (struct disir_context **context)
 {
+    int64_t refcount;
+
     if (context == NULL)
         return;
     if (*context == NULL)
@@ -170,19 +221,20 @@ dx_context_decref (struct disir_context **context)
         return;
     }
 
-    (*context)->cx_refcount--;
-
-    if ((*context)->cx_refcount == 0)
+    refcount = __atomic_sub_fetch (&(*context)->cx_refcount, 1, __ATOMIC_ACQ_REL);
+    if (refcount == 0)
     {
         dx_context_destroy (context);
     }
     else
     {
-        log_debug_context (9, *context, "(%p) reduced refcount to: %d",
-                           *context, (*context)->cx_refcount);
+        log_debug_context (9, *context, "(%p) reduced refcount to: %d", *context, refcount);
     }
 }
 
+//! Serial of the context created last in the process.
+static uint64_t context_serial_last;
+
 //! INTERNAL API
 struct disir_context *
 dx_context_create (enum disir_context_type type)
@@ -211,6 +263,8 @@ dx_context_create (enum disir_context_type type)
     // Set refcount to 1 - object is owned by creator.
     context->cx_refcount = 1;
 
+    context->cx_serial = __atomic_add_fetch (&context_serial_last, 1, __ATOMIC_RELAXED);
+
     return context;
 }
 
@@ -226,6 +280,7 @@ dx_context_destroy  (struct disir_context **context)
     {
         free ((*context)->cx_error_message);
     }
+    dx_context_error_forget (*context);
 
     log_debug_context (9, *context, " (%p) reached refcount zero. Freeing.", *context);
 
@@ -566,6 +621,7 @@ dc_fatal_error_va (struct disir_context *context, const char *msg, va_list args)
     if (context->CONTEXT_STATE_FINALIZED)
         return DISIR_STATUS_CONTEXT_IN_WRONG_STATE;
 
+    dx_context_touch (context);
     context->CONTEXT_STATE_FATAL = 1;
     dx_context_error_set_va (context, msg, args);
 
@@ -581,7 +637,7 @@ dc_context_error (struct disir_context *context)
     if (dc_context_type (context) == DISIR_CONTEXT_UNKNOWN)
         return NULL;
 
-    return context->cx_error_message;
+    return dx_context_error_get (context);
 }
 
 // INTERNAL API
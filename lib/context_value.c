@@ -130,7 +130,8 @@ set_value_input_check (struct disir_context *context, enum disir_value_type type
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-
+    // The caller is about to store a new value
+    dx_context_touch (context);
 
     // Use cases this function shall handle:
     // 1: Config Keyval in construction state with no mold equivalent
@@ -408,7 +409,8 @@ dc_set_value_string (struct disir_context *context, const char *value, int32_t v
         goto error;
     }
 
-    status = dx_value_set_string (value_storage, value, value_size);
+    status = dx_value_set_string_arena (value_storage, dx_context_arena (context),
+                                        value, value_size);
     if (status != DISIR_STATUS_OK)
     {
         dx_context_error_set (context,
@@ -835,7 +837,8 @@ dc_set_value_enum (struct disir_context *context, const char *value, int32_t val
         invalid = DISIR_STATUS_INVALID_CONTEXT;
     }
 
-    status = dx_value_set_string (value_storage, value, value_size);
+    status = dx_value_set_string_arena (value_storage, dx_context_arena (context),
+                                        value, value_size);
     if (status != DISIR_STATUS_OK)
     {
         dx_context_error_set (context,
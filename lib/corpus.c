@@ -0,0 +1,675 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <disir/disir.h>
+#include <disir/corpus.h>
+
+#include "log.h"
+
+
+//! Independent choices made for each keyval. Each is derived from the seed,
+//! the keyval index and its purpose, so that no choice depends on the order others are made in.
+enum corpus_purpose
+{
+    CORPUS_TYPE = 1,
+    CORPUS_INTRODUCED,
+    CORPUS_INTRODUCED_VERSION,
+    CORPUS_RESTRICTED,
+    CORPUS_RESTRICTION_KIND,
+    CORPUS_MINIMUM,
+    CORPUS_SPAN,
+    CORPUS_VALUES,
+    CORPUS_DEFAULT,
+    CORPUS_DEFAULT_CHANGED,
+    CORPUS_VALUE,
+};
+
+//! Values numeric keyvals are drawn from when they are not restricted.
+#define CORPUS_NUMERIC_LIMIT 1000000
+
+//! Shape of a single generated keyval.
+struct corpus_keyval
+{
+    enum disir_value_type   ck_type;
+    //! Major mold version the keyval is introduced in.
+    uint32_t                ck_introduced;
+    //! Whether a numeric keyval carries value restrictions.
+    int                     ck_restricted;
+    //! Number of allowed values, if this is an enum or a numeric keyval restricted to values.
+    //! Zero if a numeric keyval is restricted to, or drawn from, the range ck_min - ck_max.
+    uint32_t                ck_values;
+    //! Numeric range, or the first allowed numeric value.
+    int64_t                 ck_min;
+    int64_t                 ck_max;
+    //! Distance between the allowed numeric values.
+    int64_t                 ck_step;
+};
+
+//! Position within the mold, advanced as it is traversed depth first.
+struct corpus_position
+{
+    //! Index of the next keyval.
+    uint32_t                cp_keyval;
+    //! Index of the next section.
+    uint32_t                cp_section;
+    //! Number of keyvals not yet placed.
+    uint32_t                cp_remaining;
+};
+
+//! State of a mold or config being generated.
+struct corpus_state
+{
+    const struct disir_corpus_parameters    *cs_parameters;
+    //! Non-zero if a config is generated, zero if the mold is.
+    int                                     cs_config;
+    //! Version of the generated config.
+    struct disir_version                    cs_version;
+    //! Number of keyvals placed in the mold and in each section.
+    uint32_t                                cs_per_context;
+    //! Number of config keyvals generated, drawing their values.
+    uint64_t                                cs_instance;
+    struct corpus_position                  cs_position;
+};
+
+//! Mix seed, key and purpose into a uniformly distributed 64-bit value (splitmix64 finalizer).
+static uint64_t
+corpus_random (uint64_t seed, uint64_t key, uint64_t purpose)
+{
+    uint64_t x;
+
+    x = seed ^ (key * 0x9e3779b97f4a7c15ULL) ^ (purpose * 0xc2b2ae3d27d4eb4fULL);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
+static uint64_t
+corpus_choice (const struct disir_corpus_parameters *parameters, uint32_t keyval,
+               enum corpus_purpose purpose)
+{
+    return corpus_random (parameters->cp_seed, keyval, purpose);
+}
+
+//! Choice made for keyval once per mold version.
+static uint64_t
+corpus_choice_version (const struct disir_corpus_parameters *parameters, uint32_t keyval,
+                       enum corpus_purpose purpose, uint32_t version)
+{
+    return corpus_random (parameters->cp_seed, keyval, ((uint64_t) version << 8) | purpose);
+}
+
+static int
+corpus_parameters_valid (const struct disir_corpus_parameters *parameters)
+{
+    uint64_t weights;
+
+    weights = (uint64_t) parameters->cp_weight_string + parameters->cp_weight_integer
+              + parameters->cp_weight_float + parameters->cp_weight_boolean
+              + parameters->cp_weight_enum;
+
+    return (parameters->cp_keys != 0 && parameters->cp_repeat != 0
+            && parameters->cp_versions != 0 && parameters->cp_restrictions <= 100
+            && weights != 0);
+}
+
+//! Derive the shape of keyval index from parameters.
+static void
+corpus_keyval_describe (const struct disir_corpus_parameters *parameters, uint32_t index,
+                        struct corpus_keyval *keyval)
+{
+    uint64_t choice;
+
+    memset (keyval, 0, sizeof (*keyval));
+
+    choice = corpus_choice (parameters, index, CORPUS_TYPE)
+             % ((uint64_t) parameters->cp_weight_string + parameters->cp_weight_integer
+                + parameters->cp_weight_float + parameters->cp_weight_boolean
+                + parameters->cp_weight_enum);
+    if (choice < parameters->cp_weight_string)
+        keyval->ck_type = DISIR_VALUE_TYPE_STRING;
+    else if ((choice -= parameters->cp_weight_string) < parameters->cp_weight_integer)
+        keyval->ck_type = DISIR_VALUE_TYPE_INTEGER;
+    else if ((choice -= parameters->cp_weight_integer) < parameters->cp_weight_float)
+        keyval->ck_type = DISIR_VALUE_TYPE_FLOAT;
+    else if ((choice -= parameters->cp_weight_float) < parameters->cp_weight_boolean)
+        keyval->ck_type = DISIR_VALUE_TYPE_BOOLEAN;
+    else
+        keyval->ck_type = DISIR_VALUE_TYPE_ENUM;
+
+    // A quarter of the keyvals are introduced after the first version.
+    // The first keyval always is not, as it spans every version of the mold.
+    keyval->ck_introduced = 1;
+    if (index != 0 && parameters->cp_versions > 1
+        && corpus_choice (parameters, index, CORPUS_INTRODUCED) % 4 == 0)
+    {
+        keyval->ck_introduced = 2 + corpus_choice (parameters, index, CORPUS_INTRODUCED_VERSION)
+                                    % (parameters->cp_versions - 1);
+    }
+
+    keyval->ck_min = -CORPUS_NUMERIC_LIMIT;
+    keyval->ck_max = CORPUS_NUMERIC_LIMIT;
+    keyval->ck_step = 1;
+
+    if (keyval->ck_type == DISIR_VALUE_TYPE_ENUM)
+    {
+        keyval->ck_values = 2 + corpus_choice (parameters, index, CORPUS_VALUES) % 7;
+    }
+    else if ((keyval->ck_type == DISIR_VALUE_TYPE_INTEGER
+              || keyval->ck_type == DISIR_VALUE_TYPE_FLOAT)
+             && corpus_choice (parameters, index, CORPUS_RESTRICTED) % 100
+                < parameters->cp_restrictions)
+    {
+        keyval->ck_restricted = 1;
+        keyval->ck_min = (int64_t) (corpus_choice (parameters, index, CORPUS_MINIMUM) % 2001)
+                         - 1000;
+        // One in four restricted keyvals allow a set of values, the rest a range.
+        if (corpus_choice (parameters, index, CORPUS_RESTRICTION_KIND) % 4 == 0)
+        {
+            keyval->ck_values = 2 + corpus_choice (parameters, index, CORPUS_VALUES) % 5;
+            keyval->ck_step = 1 + corpus_choice (parameters, index, CORPUS_SPAN) % 1000;
+            keyval->ck_max = keyval->ck_min + (keyval->ck_values - 1) * keyval->ck_step;
+        }
+        else
+        {
+            keyval->ck_max = keyval->ck_min + 1
+                             + corpus_choice (parameters, index, CORPUS_SPAN) % 100000;
+        }
+    }
+}
+
+//! Draw a numeric value fulfilling the restrictions of keyval.
+//! Float keyvals use eighths of it, which every serializer represents exactly.
+static int64_t
+corpus_numeric (const struct corpus_keyval *keyval, uint64_t random)
+{
+    if (keyval->ck_values != 0)
+        return keyval->ck_min + (int64_t) (random % keyval->ck_values) * keyval->ck_step;
+
+    return keyval->ck_min + (int64_t) (random % (uint64_t) (keyval->ck_max - keyval->ck_min + 1));
+}
+
+//! Draw the text of a string or enum keyval. Enum values fulfill its restrictions.
+static void
+corpus_value_string (const struct corpus_keyval *keyval, uint64_t random,
+                     char *buffer, size_t size)
+{
+    if (keyval->ck_type == DISIR_VALUE_TYPE_ENUM)
+        snprintf (buffer, size, "option_%" PRIu64, random % keyval->ck_values);
+    else
+        snprintf (buffer, size, "value_%06" PRIx64, random & 0xffffff);
+}
+
+//! Add a default to the mold keyval context, drawn to fulfill the restrictions of keyval.
+static enum disir_status
+corpus_default_add (struct disir_context *context, const struct corpus_keyval *keyval,
+                    uint64_t random, struct disir_version *version)
+{
+    char value[32];
+
+    switch (keyval->ck_type)
+    {
+    case DISIR_VALUE_TYPE_INTEGER:
+        return dc_add_default_integer (context, corpus_numeric (keyval, random), version);
+    case DISIR_VALUE_TYPE_FLOAT:
+        return dc_add_default_float (context, corpus_numeric (keyval, random) / 8.0, version);
+    case DISIR_VALUE_TYPE_BOOLEAN:
+        return dc_add_default_boolean (context, random & 1, version);
+    default:
+        corpus_value_string (keyval, random, value, sizeof (value));
+        return dc_add_default_string (context, value, strlen (value), version);
+    }
+}
+
+//! Set the value of the config keyval context, drawn to fulfill the restrictions of keyval.
+static enum disir_status
+corpus_value_set (struct disir_context *context, const struct corpus_keyval *keyval,
+                  uint64_t random)
+{
+    char value[32];
+
+    switch (keyval->ck_type)
+    {
+    case DISIR_VALUE_TYPE_INTEGER:
+        return dc_set_value_integer (context, corpus_numeric (keyval, random));
+    case DISIR_VALUE_TYPE_FLOAT:
+        return dc_set_value_float (context, corpus_numeric (keyval, random) / 8.0);
+    case DISIR_VALUE_TYPE_BOOLEAN:
+        return dc_set_value_boolean (context, random & 1);
+    case DISIR_VALUE_TYPE_ENUM:
+        corpus_value_string (keyval, random, value, sizeof (value));
+        return dc_set_value_enum (context, value, strlen (value));
+    default:
+        corpus_value_string (keyval, random, value, sizeof (value));
+        return dc_set_value_string (context, value, strlen (value));
+    }
+}
+
+//! Add the value restrictions of keyval to context, introduced with the keyval.
+static enum disir_status
+corpus_mold_restrictions (struct disir_context *context, const struct corpus_keyval *keyval,
+                          struct disir_version *introduced)
+{
+    enum disir_status status;
+    char value[32];
+    double scale;
+    uint32_t i;
+
+    status = DISIR_STATUS_OK;
+    scale = (keyval->ck_type == DISIR_VALUE_TYPE_FLOAT) ? 8.0 : 1.0;
+
+    if (keyval->ck_type == DISIR_VALUE_TYPE_ENUM)
+    {
+        for (i = 0; i < keyval->ck_values && status == DISIR_STATUS_OK; i++)
+        {
+            snprintf (value, sizeof (value), "option_%u", i);
+            status = dc_add_restriction_value_enum (context, value, "Generated option.",
+                                                    introduced, NULL);
+        }
+    }
+    else if (keyval->ck_restricted && keyval->ck_values != 0)
+    {
+        for (i = 0; i < keyval->ck_values && status == DISIR_STATUS_OK; i++)
+        {
+            status = dc_add_restriction_value_numeric (context,
+                                                       (keyval->ck_min + i * keyval->ck_step)
+                                                       / scale,
+                                                       "Generated value.", introduced, NULL);
+        }
+    }
+    else if (keyval->ck_restricted)
+    {
+        status = dc_add_restriction_value_range (context, keyval->ck_min / scale,
+                                                 keyval->ck_max / scale,
+                                                 "Generated range.", introduced, NULL);
+    }
+
+    return status;
+}
+
+//! Add keyval index to parent in the mold. Its first default introduces the keyval,
+//! new defaults follow in some of the later versions.
+static enum disir_status
+corpus_mold_keyval (struct corpus_state *state, struct disir_context *parent, uint32_t index)
+{
+    enum disir_status status;
+    const struct disir_corpus_parameters *parameters;
+    struct corpus_keyval keyval;
+    struct disir_context *context;
+    struct disir_version version;
+    char name[32];
+    uint32_t i;
+
+    parameters = state->cs_parameters;
+    corpus_keyval_describe (parameters, index, &keyval);
+    snprintf (name, sizeof (name), "key_%u", index);
+
+    status = dc_begin (parent, DISIR_CONTEXT_KEYVAL, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    version.sv_major = keyval.ck_introduced;
+    version.sv_minor = 0;
+
+    status = dc_set_name (context, name, strlen (name));
+    if (status == DISIR_STATUS_OK)
+        status = dc_set_value_type (context, keyval.ck_type);
+    if (status == DISIR_STATUS_OK)
+        status = dc_add_documentation (context, "Generated keyval.", strlen ("Generated keyval."));
+    if (status == DISIR_STATUS_OK)
+        status = corpus_mold_restrictions (context, &keyval, &version);
+    for (i = keyval.ck_introduced; i <= parameters->cp_versions; i++)
+    {
+        if (status != DISIR_STATUS_OK)
+            break;
+
+        // The first keyval changes its default in every version
+        if (i != keyval.ck_introduced && index != 0
+            && corpus_choice_version (parameters, index, CORPUS_DEFAULT_CHANGED, i) % 2 == 0)
+        {
+            continue;
+        }
+
+        version.sv_major = i;
+        status = corpus_default_add (context, &keyval,
+                                     corpus_choice_version (parameters, index, CORPUS_DEFAULT, i),
+                                     &version);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&context);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_debug (1, "failed to generate mold keyval %s: %s", name, disir_status_string (status));
+        dc_destroy (&context);
+    }
+
+    return status;
+}
+
+//! Add keyval index to parent in the config, unless it is introduced after the config version.
+static enum disir_status
+corpus_config_keyval (struct corpus_state *state, struct disir_context *parent, uint32_t index)
+{
+    enum disir_status status;
+    struct corpus_keyval keyval;
+    struct disir_context *context;
+    char name[32];
+    uint64_t random;
+
+    corpus_keyval_describe (state->cs_parameters, index, &keyval);
+    random = corpus_random (state->cs_parameters->cp_seed, state->cs_instance++, CORPUS_VALUE);
+    if (keyval.ck_introduced > state->cs_version.sv_major)
+        return DISIR_STATUS_OK;
+
+    snprintf (name, sizeof (name), "key_%u", index);
+    status = dc_begin (parent, DISIR_CONTEXT_KEYVAL, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_set_name (context, name, strlen (name));
+    if (status == DISIR_STATUS_OK)
+        status = corpus_value_set (context, &keyval, random);
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&context);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_debug (1, "failed to generate config keyval %s: %s",
+                   name, disir_status_string (status));
+        dc_destroy (&context);
+    }
+
+    return status;
+}
+
+//! Forward declaration
+static enum disir_status
+corpus_section (struct corpus_state *state, struct disir_context *parent,
+                uint32_t level, int repeatable);
+
+//! Place the keyvals of parent at level, followed by its child sections.
+//! Configs hold cp_repeat entries of the first child section, each an identical subtree.
+static enum disir_status
+corpus_children (struct corpus_state *state, struct disir_context *parent, uint32_t level)
+{
+    enum disir_status status;
+    const struct disir_corpus_parameters *parameters;
+    struct corpus_position position;
+    uint32_t count;
+    uint32_t child;
+    uint32_t entries;
+    uint32_t i;
+
+    parameters = state->cs_parameters;
+    status = DISIR_STATUS_OK;
+
+    count = state->cs_per_context;
+    if (count > state->cs_position.cp_remaining)
+        count = state->cs_position.cp_remaining;
+    for (i = 0; i < count && status == DISIR_STATUS_OK; i++)
+    {
+        if (state->cs_config)
+            status = corpus_config_keyval (state, parent, state->cs_position.cp_keyval);
+        else
+            status = corpus_mold_keyval (state, parent, state->cs_position.cp_keyval);
+        state->cs_position.cp_keyval++;
+        state->cs_position.cp_remaining--;
+    }
+
+    for (child = 0; child < parameters->cp_fanout && level < parameters->cp_depth; child++)
+    {
+        if (status != DISIR_STATUS_OK || state->cs_position.cp_remaining == 0)
+            break;
+
+        entries = 1;
+        if (state->cs_config && child == 0)
+            entries = parameters->cp_repeat;
+
+        position = state->cs_position;
+        for (i = 0; i < entries && status == DISIR_STATUS_OK; i++)
+        {
+            state->cs_position = position;
+            status = corpus_section (state, parent, level + 1,
+                                     child == 0 && parameters->cp_repeat > 1);
+        }
+    }
+
+    return status;
+}
+
+static enum disir_status
+corpus_section (struct corpus_state *state, struct disir_context *parent,
+                uint32_t level, int repeatable)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    char name[32];
+
+    snprintf (name, sizeof (name), "section_%u", state->cs_position.cp_section++);
+
+    status = dc_begin (parent, DISIR_CONTEXT_SECTION, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_set_name (context, name, strlen (name));
+    if (status == DISIR_STATUS_OK && state->cs_config == 0)
+    {
+        status = dc_add_documentation (context, "Generated section.",
+                                       strlen ("Generated section."));
+        if (status == DISIR_STATUS_OK && repeatable)
+            status = dc_add_restriction_entries_max (context, 0, NULL);
+    }
+    if (status == DISIR_STATUS_OK)
+        status = corpus_children (state, context, level);
+    if (status == DISIR_STATUS_OK)
+        status = dc_finalize (&context);
+    if (status != DISIR_STATUS_OK)
+        dc_destroy (&context);
+
+    return status;
+}
+
+//! Prepare state to traverse the mold described by parameters from the start.
+static void
+corpus_state_init (struct corpus_state *state, const struct disir_corpus_parameters *parameters,
+                   int config)
+{
+    uint64_t contexts;
+    uint64_t level;
+    uint32_t i;
+
+    memset (state, 0, sizeof (*state));
+    state->cs_parameters = parameters;
+    state->cs_config = config;
+    state->cs_position.cp_remaining = parameters->cp_keys;
+
+    // Count the mold and every section, without counting more contexts than keyvals.
+    contexts = 1;
+    level = 1;
+    for (i = 0; i < parameters->cp_depth && contexts < parameters->cp_keys; i++)
+    {
+        level *= parameters->cp_fanout;
+        if (level == 0)
+            break;
+        contexts += level;
+        if (level >= parameters->cp_keys)
+            break;
+    }
+    if (contexts > parameters->cp_keys)
+        contexts = parameters->cp_keys;
+
+    state->cs_per_context = (parameters->cp_keys + contexts - 1) / contexts;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_corpus_parameters_default (struct disir_corpus_parameters *parameters)
+{
+    if (parameters == NULL)
+    {
+        log_debug (0, "invoked with NULL parameters");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset (parameters, 0, sizeof (*parameters));
+    parameters->cp_keys = 100;
+    parameters->cp_depth = 2;
+    parameters->cp_fanout = 4;
+    parameters->cp_repeat = 2;
+    parameters->cp_weight_string = 3;
+    parameters->cp_weight_integer = 3;
+    parameters->cp_weight_float = 1;
+    parameters->cp_weight_boolean = 2;
+    parameters->cp_weight_enum = 1;
+    parameters->cp_restrictions = 50;
+    parameters->cp_versions = 3;
+    parameters->cp_seed = 1;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_corpus_mold (const struct disir_corpus_parameters *parameters, struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct corpus_state state;
+    struct disir_context *context;
+
+    if (parameters == NULL || mold == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (parameters (%p), mold (%p))",
+                   parameters, mold);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (corpus_parameters_valid (parameters) == 0)
+    {
+        log_debug (0, "invoked with invalid corpus parameters");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dc_mold_begin (&context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    corpus_state_init (&state, parameters, 0);
+    status = corpus_children (&state, context, 0);
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    return dc_mold_finalize (&context, mold);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_corpus_config (const struct disir_corpus_parameters *parameters, struct disir_mold *mold,
+                     struct disir_version *version, struct disir_config **config)
+{
+    enum disir_status status;
+    struct corpus_state state;
+    struct disir_context *context;
+    struct disir_version mold_version;
+
+    if (parameters == NULL || mold == NULL || config == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (parameters (%p), mold (%p), config (%p))",
+                   parameters, mold, config);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (corpus_parameters_valid (parameters) == 0)
+    {
+        log_debug (0, "invoked with invalid corpus parameters");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    corpus_state_init (&state, parameters, 1);
+
+    dc_mold_get_version (mold, &mold_version);
+    if (version == NULL)
+        version = &mold_version;
+    if (dc_version_compare (version, &mold_version) > 0)
+    {
+        log_debug (0, "config version is higher than the mold version");
+        return DISIR_STATUS_CONFLICTING_SEMVER;
+    }
+    state.cs_version = *version;
+
+    status = dc_config_begin (mold, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    // Keyvals are validated against the restrictions of the config version as they are added.
+    status = dc_set_version (context, version);
+    if (status == DISIR_STATUS_OK)
+        status = corpus_children (&state, context, 0);
+    if (status == DISIR_STATUS_WRONG_CONTEXT || status == DISIR_STATUS_NOT_EXIST)
+        status = DISIR_STATUS_MOLD_MISSING;
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    return dc_config_finalize (&context, config);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_corpus_write (struct disir_instance *instance, const char *group_id,
+                    const char *entry_id, const struct disir_corpus_parameters *parameters)
+{
+    enum disir_status status;
+    struct disir_mold *mold;
+    struct disir_config *config;
+
+    if (instance == NULL || group_id == NULL || entry_id == NULL || parameters == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (instance (%p), group_id (%p),"
+                      " entry_id (%p), parameters (%p))",
+                   instance, group_id, entry_id, parameters);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = disir_corpus_mold (parameters, &mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "failed to generate corpus mold: %s",
+                         disir_status_string (status));
+        return status;
+    }
+
+    status = disir_mold_write (instance, group_id, entry_id, mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Not every plugin implements mold_write, nor registers an error when it lacks it.
+        if (disir_error (instance) == NULL)
+        {
+            disir_error_set (instance, "failed to write corpus mold '%s' in group '%s': %s",
+                             entry_id, group_id, disir_status_string (status));
+        }
+        goto out;
+    }
+
+    status = disir_corpus_config (parameters, mold, NULL, &config);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "failed to generate corpus config: %s",
+                         disir_status_string (status));
+        goto out;
+    }
+
+    status = disir_config_write (instance, group_id, entry_id, config);
+    disir_config_finished (&config);
+    // FALL-THROUGH
+out:
+    disir_mold_finished (&mold);
+    return status;
+}
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "context_private.h"
+#include "default_table.h"
+#include "mqueue.h"
+#include "log.h"
+
+struct disir_default_table
+{
+    //! Number of defaults in the table.
+    uint32_t                dt_count;
+
+    //! Defaults of the keyval, in the order of dt_versions.
+    struct disir_default    **dt_defaults;
+
+    //! Versions the defaults are introduced at, packed by default_table_pack, sorted ascending.
+    uint64_t                dt_versions[];
+};
+
+struct disir_default_view
+{
+    //! Version the view resolves defaults at, packed by default_table_pack.
+    uint64_t                dw_version;
+
+    //! Active default of each indexed keyval, by kv_default_index - 1.
+    //! NULL until the keyval is first looked up through the view.
+    struct disir_default    *dw_defaults[];
+};
+
+//! STATIC API
+//! Pack version into an integer ordered like dc_version_compare.
+static inline uint64_t
+default_table_pack (struct disir_version *version)
+{
+    return ((uint64_t) version->sv_major << 32) | version->sv_minor;
+}
+
+//! STATIC API
+//!
+//! Compile the default queue into a new table.
+//!
+//! \return NULL if allocation fails.
+//!
+static struct disir_default_table *
+default_table_compile (struct disir_default *queue)
+{
+    struct disir_default_table *table;
+    uint32_t count;
+
+    count = 0;
+    MQ_FOREACH (queue, { count++; });
+
+    // The defaults live in the same allocation, after the versions.
+    table = calloc (1, sizeof (struct disir_default_table)
+                       + count * (sizeof (uint64_t) + sizeof (struct disir_default *)));
+    if (table == NULL)
+    {
+        log_error ("failed to allocate memory for default table");
+        return NULL;
+    }
+    table->dt_defaults = (struct disir_default **) &table->dt_versions[count];
+
+    // The queue is kept sorted by introduced version.
+    MQ_FOREACH (queue,
+    {
+        table->dt_versions[table->dt_count] = default_table_pack (&entry->de_introduced);
+        table->dt_defaults[table->dt_count] = entry;
+        table->dt_count++;
+    });
+
+    return table;
+}
+
+//! STATIC API
+//! Default of table active at the packed version.
+static struct disir_default *
+default_table_lookup (struct disir_default_table *table, uint64_t version)
+{
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+
+    // Find the first default introduced after version.
+    low = 0;
+    high = table->dt_count;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (table->dt_versions[middle] <= version)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    // The default before it is active. If every default is introduced after version,
+    // the first one is used.
+    return table->dt_defaults[low > 0 ? low - 1 : 0];
+}
+
+//! STATIC API
+//!
+//! Retrieve the default view of mold at the packed version, creating it in a free slot.
+//!
+//! \return NULL if every slot holds a view of another version, or allocation fails.
+//!
+static struct disir_default_view *
+default_view_get (struct disir_mold *mold, uint64_t version)
+{
+    struct disir_default_view *view;
+    struct disir_default_view *created;
+    int i;
+
+    created = NULL;
+    for (i = 0; i < DISIR_MOLD_DEFAULT_VIEWS; i++)
+    {
+        view = __atomic_load_n (&mold->mo_default_views[i], __ATOMIC_ACQUIRE);
+        if (view == NULL)
+        {
+            if (created == NULL)
+            {
+                created = calloc (1, sizeof (struct disir_default_view)
+                                     + mold->mo_default_view_size
+                                       * sizeof (struct disir_default *));
+                if (created == NULL)
+                    return NULL;
+                created->dw_version = version;
+            }
+
+            if (__atomic_compare_exchange_n (&mold->mo_default_views[i], &view, created, 0,
+                                             __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                return created;
+            }
+            // Another thread filled the slot first - view now holds its view.
+        }
+
+        if (view->dw_version == version)
+        {
+            free (created);
+            return view;
+        }
+    }
+
+    free (created);
+    return NULL;
+}
+
+//! STATIC API
+//! Compile the tables of every keyval below context, indexing them into the views of mold.
+static enum disir_status
+default_table_compile_recursive (struct disir_mold *mold, struct disir_context *context)
+{
+    enum disir_status status;
+    enum disir_status compiled;
+    struct disir_collection *collection;
+    struct disir_context *element;
+    struct disir_keyval *keyval;
+    struct disir_default_table *table;
+
+    status = dc_get_elements (context, &collection);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    compiled = DISIR_STATUS_OK;
+    while (dc_collection_next (collection, &element) != DISIR_STATUS_EXHAUSTED)
+    {
+        if (dc_context_type (element) == DISIR_CONTEXT_SECTION)
+        {
+            status = default_table_compile_recursive (mold, element);
+            if (status != DISIR_STATUS_OK)
+                compiled = status;
+        }
+        else if (dc_context_type (element) == DISIR_CONTEXT_KEYVAL)
+        {
+            keyval = element->cx_keyval;
+            dx_default_table_invalidate (NULL, keyval);
+
+            table = NULL;
+            if (keyval->kv_default_queue != NULL)
+            {
+                table = default_table_compile (keyval->kv_default_queue);
+                if (table == NULL)
+                    compiled = DISIR_STATUS_NO_MEMORY;
+            }
+            keyval->kv_default_index = ++mold->mo_default_view_size;
+            __atomic_store_n (&keyval->kv_default_table, table, __ATOMIC_RELEASE);
+        }
+
+        dc_putcontext (&element);
+    }
+
+    dc_collection_finished (&collection);
+    return compiled;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_default_table_compile_mold (struct disir_context *context)
+{
+    struct disir_mold *mold;
+
+    mold = context->cx_mold;
+
+    dx_default_views_destroy (mold);
+    mold->mo_default_view_size = 0;
+
+    return default_table_compile_recursive (mold, context);
+}
+
+//! INTERNAL API
+struct disir_default *
+dx_default_table_get_active (struct disir_mold *mold, struct disir_keyval *keyval,
+                             struct disir_version *version)
+{
+    struct disir_default_table *table;
+    struct disir_default_view *view;
+    struct disir_default *def;
+    uint64_t packed;
+
+    table = __atomic_load_n (&keyval->kv_default_table, __ATOMIC_ACQUIRE);
+    if (table == NULL)
+        return NULL;
+
+    packed = default_table_pack (version);
+
+    view = NULL;
+    if (mold && keyval->kv_default_index > 0
+        && keyval->kv_default_index <= mold->mo_default_view_size)
+    {
+        view = default_view_get (mold, packed);
+    }
+    if (view == NULL)
+    {
+        return default_table_lookup (table, packed);
+    }
+
+    // Threads racing to fill the same entry store the same default.
+    def = __atomic_load_n (&view->dw_defaults[keyval->kv_default_index - 1], __ATOMIC_RELAXED);
+    if (def == NULL)
+    {
+        def = default_table_lookup (table, packed);
+        __atomic_store_n (&view->dw_defaults[keyval->kv_default_index - 1], def,
+                          __ATOMIC_RELAXED);
+    }
+
+    return def;
+}
+
+//! INTERNAL API
+void
+dx_default_table_invalidate (struct disir_mold *mold, struct disir_keyval *keyval)
+{
+    free (__atomic_exchange_n (&keyval->kv_default_table, NULL, __ATOMIC_ACQ_REL));
+    if (mold)
+    {
+        dx_default_views_destroy (mold);
+    }
+}
+
+//! INTERNAL API
+void
+dx_default_views_destroy (struct disir_mold *mold)
+{
+    int i;
+
+    for (i = 0; i < DISIR_MOLD_DEFAULT_VIEWS; i++)
+    {
+        free (__atomic_exchange_n (&mold->mo_default_views[i], NULL, __ATOMIC_ACQ_REL));
+    }
+}
@@ -81,7 +81,9 @@ load_plugin (struct disir_instance *instance, const char *plugin_filepath, const
     // This is not handled as part of disir_register_plugin_register, because
     // that function is a public method that may register plugins in
     // different ways than we load them from disk.
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     internal = MQ_TAIL (instance->dio_plugin_queue);
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
     if (internal == NULL)
     {
         status = DISIR_STATUS_INTERNAL_ERROR;
@@ -209,10 +211,15 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
 
     struct disir_config *libconf;
     struct disir_mold *libmold;
+    struct disir_context *context;
+    const char *log_filepath;
+    const char *trace_filepath;
+    int64_t validate_threads;
 
     status = DISIR_STATUS_OK;
     libmold = NULL;
 
+    dx_trace_initialize ();
     TRACE_ENTER ("config_filepath: %s, config: %p, instance: %p",
                  config_filepath, config, instance);
 
@@ -228,6 +235,22 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
         return DISIR_STATUS_NO_MEMORY;
     }
 
+    status = dx_instance_error_init (dis);
+    if (status != DISIR_STATUS_OK)
+    {
+        free (dis);
+        return status;
+    }
+    status = dx_stats_storage_init (&dis->dio_stats);
+    if (status != DISIR_STATUS_OK)
+    {
+        dx_instance_error_finished (dis);
+        free (dis);
+        return status;
+    }
+    pthread_rwlock_init (&dis->dio_plugin_lock, NULL);
+    dx_mold_cache_init (&dis->dio_mold_cache);
+
     // No user provided config - generate the internal mold since user cannot provide one.
     if (config == NULL)
     {
@@ -281,6 +304,35 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
     // TODO: Validate libconf
     // XXX: Validate version? Upgrade?
 
+    // Configs predating the log_filepath keyval keep logging to the default filepath,
+    // predating the validate_threads keyval leave the thread count alone,
+    // and predating the trace_filepath keyval do not trace.
+    log_filepath = NULL;
+    context = dc_config_getcontext (libconf);
+    if (context)
+    {
+        dc_config_get_keyval_string (context, &log_filepath, "log_filepath");
+        if (log_filepath != NULL && *log_filepath != '\0')
+        {
+            dx_log_filepath_set (log_filepath);
+        }
+        // Unset (-1) unless the config says otherwise. The thread count is process-wide.
+        if (dc_config_get_keyval_integer (context, &validate_threads,
+                                          "validate_threads") == DISIR_STATUS_OK)
+        {
+            dx_validate_threads_configured_set ((int) validate_threads);
+        }
+        // The environment takes precedence, so tracing may be enabled without editing it.
+        trace_filepath = NULL;
+        dc_config_get_keyval_string (context, &trace_filepath, "trace_filepath");
+        if (trace_filepath != NULL && *trace_filepath != '\0'
+            && getenv (DISIR_TRACE_FILEPATH_ENV) == NULL)
+        {
+            disir_trace_filepath_set (trace_filepath);
+        }
+        dc_putcontext (&context);
+    }
+
     status = load_plugins_from_config (dis, libconf);
     if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
     {
@@ -298,6 +350,10 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
 error:
     if (dis)
     {
+        dx_mold_cache_finished (&dis->dio_mold_cache);
+        pthread_rwlock_destroy (&dis->dio_plugin_lock);
+        dx_stats_storage_finished (&dis->dio_stats);
+        dx_instance_error_finished (dis);
         free (dis);
     }
     if (libmold)
@@ -318,6 +374,9 @@ disir_instance_destroy (struct disir_instance **instance)
     if (instance == NULL || *instance == NULL)
         return DISIR_STATUS_INVALID_ARGUMENT;
 
+    // Release cached molds before the plugins that produced them are unloaded
+    dx_mold_cache_finished (&(*instance)->dio_mold_cache);
+
     // Free loaded plugins
     while (1)
     {
@@ -357,11 +416,13 @@ disir_instance_destroy (struct disir_instance **instance)
 
     disir_config_finished(&(*instance)->libdisir_config);
 
-    // Free any error message set on instance
-    if ((*instance)->disir_error_message)
-    {
-        free ((*instance)->disir_error_message);
-    }
+    pthread_rwlock_destroy (&(*instance)->dio_plugin_lock);
+
+    // Plugins are gone - so are the counters attributed to them.
+    dx_stats_storage_finished (&(*instance)->dio_stats);
+
+    // Free any error message set on instance, by any thread
+    dx_instance_error_finished (*instance);
 
     free (*instance);
 
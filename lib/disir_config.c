@@ -30,6 +30,8 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     plugin = NULL;
 
@@ -44,7 +46,9 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
     TRACE_ENTER ("instance (%p) entry_id (%s) mold (%p) config (%p)", instance, entry_id, mold, config);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_READ, NULL, &span);
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -58,7 +62,9 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
             entry = entry->next;
             continue;
         }
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_QUERY, entry, &plugin_span);
         status = entry->pi_plugin.dp_config_query (instance, &entry->pi_plugin, entry_id, NULL);
+        dx_stats_end (&plugin_span, status);
         if (status == DISIR_STATUS_NOT_EXIST)
         {
             entry = entry->next;
@@ -68,7 +74,7 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
         {
             log_warn ("Plugin '%s' (id %s) failed to query for entry '%s': %s",
                       entry->pi_io_id, entry->pi_plugin.dp_name,
-                      entry_id), disir_status_string (status);
+                      entry_id, disir_status_string (status));
             entry = entry->next;
             continue;
         }
@@ -76,14 +82,17 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
         plugin = entry;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         if (plugin->pi_plugin.dp_config_read)
         {
             *config = NULL;
+            dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_READ, plugin, &plugin_span);
             status = plugin->pi_plugin.dp_config_read (instance, &plugin->pi_plugin,
                                                        entry_id, mold, config);
+            dx_stats_end (&plugin_span, status);
         }
         else
         {
@@ -98,6 +107,7 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
         status = DISIR_STATUS_NOT_EXIST;
     }
 
+    dx_stats_end (&span, status);
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -109,6 +119,8 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
     int entry_id_length;
 
     plugin = NULL;
@@ -134,6 +146,9 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
         return DISIR_STATUS_FS_ERROR;
     }
 
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_WRITE, NULL, &span);
+
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -145,13 +160,16 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
         plugin = entry;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         if (plugin->pi_plugin.dp_config_write)
         {
+            dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_WRITE, plugin, &plugin_span);
             status = plugin->pi_plugin.dp_config_write (instance, &plugin->pi_plugin,
                                                         entry_id, config);
+            dx_stats_end (&plugin_span, status);
         }
         else
         {
@@ -165,6 +183,8 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
         status = DISIR_STATUS_NOT_EXIST;
     }
 
+    dx_stats_end (&span, status);
+
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -176,6 +196,8 @@ disir_config_remove (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
     int entry_id_length;
 
     plugin = NULL;
@@ -200,6 +222,9 @@ disir_config_remove (struct disir_instance *instance, const char *group_id,
         return DISIR_STATUS_FS_ERROR;
     }
 
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_REMOVE, NULL, &span);
+
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -211,13 +236,16 @@ disir_config_remove (struct disir_instance *instance, const char *group_id,
         plugin = entry;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         if (plugin->pi_plugin.dp_config_write)
         {
+            dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_REMOVE, plugin, &plugin_span);
             status = plugin->pi_plugin.dp_config_remove (instance, &plugin->pi_plugin,
                                                          entry_id);
+            dx_stats_end (&plugin_span, status);
         }
         else
         {
@@ -231,6 +259,8 @@ disir_config_remove (struct disir_instance *instance, const char *group_id,
         status = DISIR_STATUS_NOT_EXIST;
     }
 
+    dx_stats_end (&span, status);
+
     if (status == DISIR_STATUS_OK)
     {
         log_info("Removed from group '%s' configuration entry_id '%s'", group_id, entry_id);
@@ -252,6 +282,8 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
     struct disir_entry *queue;
     struct disir_entry *query;
     struct disir_entry *current;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     queue = NULL;
     query = NULL;
@@ -268,6 +300,7 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
     TRACE_ENTER ("instance (%p) group_id (%s) entries (%p)", instance, group_id, entries);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_ENTRIES, NULL, &span);
 
     map = multimap_create ((int (*)(const void *, const void *)) strcmp,
                            (unsigned long (*)(const void*)) djb2);
@@ -277,6 +310,7 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
         goto out;
     }
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -291,8 +325,10 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
             continue;
         }
 
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_ENTRIES, entry, &plugin_span);
         status = entry->pi_plugin.dp_config_entries (instance,
                                                      &entry->pi_plugin, &query);
+        dx_stats_end (&plugin_span, status);
         if (status != DISIR_STATUS_OK)
         {
             log_warn ("Plugin '%s' queried for config entries failed with status: %s",
@@ -324,6 +360,7 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
             current = query;
         }
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     *entries = queue;
 
@@ -333,6 +370,7 @@ out:
     if (map)
         multimap_destroy (map, NULL, NULL);
 
+    dx_stats_end (&span, status);
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -344,6 +382,8 @@ disir_config_query (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     plugin = NULL;
 
@@ -358,7 +398,9 @@ disir_config_query (struct disir_instance *instance, const char *group_id,
                  instance, group_id, entry_id, entry_internal);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_QUERY, NULL, &span);
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -376,13 +418,16 @@ disir_config_query (struct disir_instance *instance, const char *group_id,
 
         plugin = entry;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         // QUESTION: Should this abstraction check if there is a mold available before
         // issuing the config query? Or handle it individually in the plugins?
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_CONFIG_QUERY, plugin, &plugin_span);
         status = plugin->pi_plugin.dp_config_query (instance, &plugin->pi_plugin,
                                                     entry_id, entry_internal);
+        dx_stats_end (&plugin_span, status);
         if (status != DISIR_STATUS_EXISTS && status != DISIR_STATUS_NOT_EXIST)
         {
             log_warn ("Plugin '%s' config_query failed with status: %s",
@@ -400,6 +445,8 @@ disir_config_query (struct disir_instance *instance, const char *group_id,
         status = DISIR_STATUS_GROUP_MISSING;
     }
 
+    dx_stats_end (&span, status);
+
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
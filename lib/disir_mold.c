@@ -29,6 +29,8 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     plugin = NULL;
 
@@ -44,7 +46,9 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
                  instance, group_id, entry_id, mold, mold);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_READ, NULL, &span);
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -59,7 +63,9 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
             continue;
         }
 
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_QUERY, entry, &plugin_span);
         status = entry->pi_plugin.dp_mold_query (instance, &entry->pi_plugin, entry_id, NULL);
+        dx_stats_end (&plugin_span, status);
         if (status == DISIR_STATUS_NOT_EXIST)
         {
             entry = entry->next;
@@ -69,7 +75,7 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
         {
             log_warn ("Plugin '%s' (id %s) failed to query for entry '%s': %s",
                       entry->pi_io_id, entry->pi_plugin.dp_name,
-                      entry_id), disir_status_string (status);
+                      entry_id, disir_status_string (status));
             entry = entry->next;
             continue;
         }
@@ -77,14 +83,17 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
         plugin = entry;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         if (plugin->pi_plugin.dp_mold_read)
         {
             *mold = NULL;
+            dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_READ, plugin, &plugin_span);
             status = plugin->pi_plugin.dp_mold_read (instance, &plugin->pi_plugin,
                                                      entry_id, mold);
+            dx_stats_end (&plugin_span, status);
         }
         else
         {
@@ -99,6 +108,8 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
         status = DISIR_STATUS_NOT_EXIST;
     }
 
+    dx_stats_end (&span, status);
+
     TRACE_EXIT ("status: %s", disir_status_string (status));
     return status;
 }
@@ -110,6 +121,8 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     plugin = NULL;
 
@@ -124,7 +137,9 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
                  instance, group_id, entry_id, mold);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_WRITE, NULL, &span);
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -136,13 +151,16 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
         plugin = entry;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
         if (plugin->pi_plugin.dp_mold_write)
         {
+            dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_WRITE, plugin, &plugin_span);
             status = plugin->pi_plugin.dp_mold_write (instance, &plugin->pi_plugin,
                                                       entry_id, mold);
+            dx_stats_end (&plugin_span, status);
         }
         else
         {
@@ -157,6 +175,8 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
         status = DISIR_STATUS_NOT_EXIST;
     }
 
+    dx_stats_end (&span, status);
+
     TRACE_EXIT ("status: %s", disir_status_string (status));
     return status;
 
@@ -173,6 +193,8 @@ disir_mold_entries (struct disir_instance *instance,
     struct disir_entry *queue;
     struct disir_entry *query;
     struct disir_entry *current;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     queue = NULL;
     query = NULL;
@@ -188,6 +210,7 @@ disir_mold_entries (struct disir_instance *instance,
     TRACE_ENTER ("instance (%p) group_id (%s), entries (%p)", instance, group_id, entries);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_ENTRIES, NULL, &span);
 
     map = multimap_create ((int (*)(const void *, const void *)) strcmp,
                            (unsigned long (*)(const void*)) djb2);
@@ -197,6 +220,7 @@ disir_mold_entries (struct disir_instance *instance,
         goto out;
     }
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -211,7 +235,9 @@ disir_mold_entries (struct disir_instance *instance,
             continue;
         }
 
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_ENTRIES, entry, &plugin_span);
         status = entry->pi_plugin.dp_mold_entries (instance, &entry->pi_plugin, &query);
+        dx_stats_end (&plugin_span, status);
         if (status != DISIR_STATUS_OK)
         {
             log_debug (1, "Plugin '%s' queried for mold entries failed with status: %s",
@@ -242,6 +268,7 @@ disir_mold_entries (struct disir_instance *instance,
             current = query;
         }
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     *entries = queue;
 
@@ -251,6 +278,7 @@ out:
     if (map)
         multimap_destroy (map, NULL, NULL);
 
+    dx_stats_end (&span, status);
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -262,6 +290,8 @@ disir_mold_query (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_span span;
+    struct dx_stats_span plugin_span;
 
     plugin = NULL;
 
@@ -276,7 +306,9 @@ disir_mold_query (struct disir_instance *instance, const char *group_id,
                  instance, group_id, entry_id, entry_internal);
 
     disir_error_clear (instance);
+    dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_QUERY, NULL, &span);
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -294,11 +326,14 @@ disir_mold_query (struct disir_instance *instance, const char *group_id,
 
         plugin = entry;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     if (plugin)
     {
+        dx_stats_begin (&instance->dio_stats, DISIR_STATS_MOLD_QUERY, plugin, &plugin_span);
         status = plugin->pi_plugin.dp_mold_query (instance, &plugin->pi_plugin,
                                                   entry_id, entry_internal);
+        dx_stats_end (&plugin_span, status);
         if (status != DISIR_STATUS_EXISTS && status != DISIR_STATUS_NOT_EXIST)
         {
             log_warn ("Plugin '%s' config_query failed with status: %s",
@@ -316,6 +351,8 @@ disir_mold_query (struct disir_instance *instance, const char *group_id,
         status = DISIR_STATUS_GROUP_MISSING;
     }
 
+    dx_stats_end (&span, status);
+
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -337,8 +374,7 @@ disir_mold_finished (struct disir_mold **mold)
 
     TRACE_ENTER ("mold: %p", *mold);
 
-    (*mold)->mo_reference_count--;
-    if ((*mold)->mo_reference_count == 0)
+    if (__atomic_sub_fetch (&(*mold)->mo_reference_count, 1, __ATOMIC_ACQ_REL) == 0)
     {
         log_debug (6, "Mold reached reference count 0 - destroying context.");
         context = (*mold)->mo_context;
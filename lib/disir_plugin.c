@@ -63,7 +63,9 @@ disir_plugin_register (struct disir_instance *instance, struct disir_register_pl
     log_info ("[register plugin] mold_base_id: %s", internal->pi_plugin.dp_mold_base_id);
     log_info ("[register plugin] mold_entry_type: %s", internal->pi_plugin.dp_mold_entry_type);
 
+    pthread_rwlock_wrlock (&instance->dio_plugin_lock);
     MQ_ENQUEUE (instance->dio_plugin_queue, internal);
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     return DISIR_STATUS_OK;
 
@@ -108,6 +110,7 @@ disir_plugin_registered (struct disir_instance *instance, struct disir_plugin **
     }
 
     head = NULL;
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     internal = instance->dio_plugin_queue;
     do
     {
@@ -123,6 +126,7 @@ disir_plugin_registered (struct disir_instance *instance, struct disir_plugin **
 
         internal = internal->next;
     } while (1);
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     *plugins = head;
     status = DISIR_STATUS_OK;
@@ -160,6 +164,7 @@ dx_retrieve_plugin_by_group (struct disir_instance *instance, const char *group_
 
     *plugin = NULL;
 
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -171,6 +176,7 @@ dx_retrieve_plugin_by_group (struct disir_instance *instance, const char *group_
         *plugin = &entry->pi_plugin;
         break;
     }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
 
     return DISIR_STATUS_OK;
 }
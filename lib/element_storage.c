@@ -1,13 +1,13 @@
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <disir/disir.h>
-#include <multimap.h>
-#include <list.h>
-#include <errno.h>
 
 #include "context_private.h"
 #include "collection.h"
 #include "element_storage.h"
+#include "arena.h"
 #include "log.h"
 
 //!
@@ -22,29 +22,80 @@
 //!
 //!
 
+//! Number of entries kept in a flat array, located by linear scan,
+//! before the storage is promoted to a hashed index.
+//! Most sections hold fewer entries than this.
+#define ELEMENT_STORAGE_FLAT_MAX 8
+//! Initial capacity of the entry array.
+#define ELEMENT_STORAGE_INITIAL_CAPACITY 4
+//! Initial number of slots in the hashed index. Must be a power of two.
+#define ELEMENT_STORAGE_INITIAL_INDEX 32
+
+//! A single stored element.
+struct element_storage_entry
+{
+    //! Hash of ee_name, compared before the name itself.
+    unsigned long               ee_hash;
+
+    //! Key the context is stored by. We make a copy of the key upon insertion,
+    //! since foul things may happend if we reference the name stored inside
+    //! a context object that has been freed.
+    //! All entries with an equal name share the same copy.
+    char                        *ee_name;
+
+    struct disir_context        *ee_context;
+};
+
+//! All entries stored with a single name, in the hashed index.
+struct element_storage_group
+{
+    unsigned long               eg_hash;
+
+    //! Shared key of the entries in this group. NULL marks an empty index slot.
+    char                        *eg_name;
+
+    //! Number of entries in this group.
+    uint32_t                    eg_count;
+
+    //! Capacity of eg_positions. Zero while the single position is stored inline.
+    uint32_t                    eg_capacity;
+
+    //! Positions in es_entries of the entries in this group, in insertion order.
+    union
+    {
+        uint32_t                eg_position;
+        uint32_t                *eg_positions;
+    };
+};
+
 //! Make the element storage a complete ADT to the entire library
 //! This way, we can really modify the internals without too much fuzz
 //! around the codebase on this rather important interface
 struct disir_element_storage
 {
-    // A multimap that holds all elements inserted by key.
-    // Multiple values may be associated with a key, of which are stored
-    // in insertion order.
-    // Key is a string name of the element to store. We make a copy of the key
-    // upon insertion, since foul things may happend if we reference the name
-    // stored inside a context object that has been freed.
-    // The map allows us to quickly retrieve named entries.
-    struct multimap *es_map;
-
-    // List to simply keep a insertion order of all keyval and section contexts
-    // The list lets us iterate all child context in order of insertion - important
+    // Every stored element, in insertion order.
+    // The array lets us iterate all child context in order of insertion - important
     // for the sake of consistency when exposing the raw dump of all children.
-    struct list     *es_list;
+    // While small, named lookups scan it directly.
+    struct element_storage_entry    *es_entries;
+    uint32_t                        es_numentries;
+    uint32_t                        es_capacity;
+
+    // Open addressed (linear probing) index of groups by name.
+    // Only allocated once the storage holds more than ELEMENT_STORAGE_FLAT_MAX entries.
+    // If the index cannot be allocated, we keep scanning es_entries.
+    struct element_storage_group    *es_index;
+    uint32_t                        es_index_size;
+    uint32_t                        es_index_used;
+
+    // Arena the storage structure and its keys are allocated from.
+    // NULL if they are allocated on the heap.
+    struct disir_arena              *es_arena;
 };
 
-// String hashing function for the multimap
+// String hashing function for the element names
 // http://www.cse.yorku.ca/~oz/hash.html
-static unsigned long djb2 (char *str)
+static unsigned long djb2 (const char *str)
 {
     unsigned long hash = 5381;
     char c;
@@ -54,43 +105,356 @@ static unsigned long djb2 (char *str)
     return hash;
 }
 
-//! INTERNAL API
-struct disir_element_storage *
-dx_element_storage_create (void)
+//! STATIC API
+static int
+entry_matches (struct element_storage_entry *entry, const char *name, unsigned long hash)
 {
-    struct disir_element_storage *storage;
+    return (entry->ee_hash == hash
+            && (entry->ee_name == name || strcmp (entry->ee_name, name) == 0));
+}
 
-    storage = calloc(1, sizeof (struct disir_element_storage));
-    if (storage == NULL)
+//! STATIC API
+//! Home slot of hash in an index of mask + 1 slots.
+//! djb2 hashes of similar names differ mostly in their low bits; Fibonacci hashing
+//! spreads them across the index to keep probe sequences short.
+static uint32_t
+index_slot (unsigned long hash, uint32_t mask)
+{
+    return (uint32_t) (((uint64_t) hash * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+//! STATIC API
+static uint32_t
+group_position (struct element_storage_group *group, uint32_t n)
+{
+    return (group->eg_capacity == 0 ? group->eg_position : group->eg_positions[n]);
+}
+
+//! STATIC API
+static enum disir_status
+group_append (struct element_storage_group *group, uint32_t position)
+{
+    uint32_t *positions;
+    uint32_t capacity;
+
+    if (group->eg_count == 0)
+    {
+        group->eg_position = position;
+        group->eg_count = 1;
+        return DISIR_STATUS_OK;
+    }
+
+    if (group->eg_count == group->eg_capacity || group->eg_capacity == 0)
+    {
+        capacity = (group->eg_capacity == 0 ? 4 : group->eg_capacity * 2);
+        if (group->eg_capacity == 0)
+        {
+            positions = malloc (capacity * sizeof (uint32_t));
+            if (positions == NULL)
+                return DISIR_STATUS_NO_MEMORY;
+            positions[0] = group->eg_position;
+        }
+        else
+        {
+            positions = realloc (group->eg_positions, capacity * sizeof (uint32_t));
+            if (positions == NULL)
+                return DISIR_STATUS_NO_MEMORY;
+        }
+
+        group->eg_positions = positions;
+        group->eg_capacity = capacity;
+    }
+
+    group->eg_positions[group->eg_count++] = position;
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static struct element_storage_group *
+storage_index_find (struct disir_element_storage *storage, const char *name, unsigned long hash)
+{
+    struct element_storage_group *group;
+    uint32_t mask;
+    uint32_t i;
+
+    mask = storage->es_index_size - 1;
+    for (i = index_slot (hash, mask); storage->es_index[i].eg_name != NULL; i = (i + 1) & mask)
     {
-        goto error;
+        group = &storage->es_index[i];
+        if (group->eg_hash == hash
+            && (group->eg_name == name || strcmp (group->eg_name, name) == 0))
+        {
+            return group;
+        }
     }
 
-    storage->es_map = multimap_create ((int (*)(const void *, const void*)) strcmp,
-                                       (unsigned long (*)(const void*)) djb2);
-    if (storage->es_map == NULL)
+    return NULL;
+}
+
+//! STATIC API
+static void
+storage_index_destroy (struct disir_element_storage *storage)
+{
+    uint32_t i;
+
+    if (storage->es_index == NULL)
+        return;
+
+    for (i = 0; i < storage->es_index_size; i++)
     {
-        goto error;
+        if (storage->es_index[i].eg_capacity != 0)
+            free (storage->es_index[i].eg_positions);
     }
 
-    storage->es_list = list_create ();
-    if (storage->es_list == NULL)
+    free (storage->es_index);
+    storage->es_index = NULL;
+    storage->es_index_size = 0;
+    storage->es_index_used = 0;
+}
+
+//! STATIC API
+//! Rehash every group into an index of size slots.
+static enum disir_status
+storage_index_resize (struct disir_element_storage *storage, uint32_t size)
+{
+    struct element_storage_group *index;
+    uint32_t mask;
+    uint32_t i;
+    uint32_t j;
+
+    index = calloc (size, sizeof (struct element_storage_group));
+    if (index == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    mask = size - 1;
+    for (i = 0; i < storage->es_index_size; i++)
     {
-        goto error;
+        if (storage->es_index[i].eg_name == NULL)
+            continue;
+
+        for (j = index_slot (storage->es_index[i].eg_hash, mask); index[j].eg_name != NULL; j = (j + 1) & mask)
+            ;
+        index[j] = storage->es_index[i];
     }
 
-    return storage;
-error:
-    if (storage && storage->es_map)
-        multimap_destroy (storage->es_map, NULL, NULL);
+    free (storage->es_index);
+    storage->es_index = index;
+    storage->es_index_size = size;
 
-    if (storage && storage->es_list)
-        list_destroy (&storage->es_list);
+    return DISIR_STATUS_OK;
+}
 
-    if (storage)
-        free (storage);
+//! STATIC API
+//! Add the entry at position to its group in the index.
+static enum disir_status
+storage_index_insert (struct disir_element_storage *storage, uint32_t position)
+{
+    enum disir_status status;
+    struct element_storage_entry *entry;
+    struct element_storage_group *group;
+    uint32_t mask;
+    uint32_t i;
 
-    return NULL;
+    entry = &storage->es_entries[position];
+
+    group = storage_index_find (storage, entry->ee_name, entry->ee_hash);
+    if (group == NULL)
+    {
+        // Keep the load factor at or below one half.
+        if ((storage->es_index_used + 1) * 2 > storage->es_index_size)
+        {
+            status = storage_index_resize (storage, storage->es_index_size * 2);
+            if (status != DISIR_STATUS_OK)
+                return status;
+        }
+
+        mask = storage->es_index_size - 1;
+        for (i = index_slot (entry->ee_hash, mask); storage->es_index[i].eg_name != NULL; i = (i + 1) & mask)
+            ;
+
+        group = &storage->es_index[i];
+        group->eg_hash = entry->ee_hash;
+        group->eg_name = entry->ee_name;
+        storage->es_index_used++;
+    }
+
+    return group_append (group, position);
+}
+
+//! STATIC API
+//! (Re)build the index from every entry. On failure, the storage is left without an index.
+static enum disir_status
+storage_index_build (struct disir_element_storage *storage)
+{
+    enum disir_status status;
+    uint32_t size;
+    uint32_t i;
+
+    storage_index_destroy (storage);
+
+    size = ELEMENT_STORAGE_INITIAL_INDEX;
+    while (size < storage->es_numentries * 2)
+        size *= 2;
+
+    storage->es_index = calloc (size, sizeof (struct element_storage_group));
+    if (storage->es_index == NULL)
+    {
+        log_warn ("failed to allocate element storage index - falling back to linear lookups");
+        return DISIR_STATUS_NO_MEMORY;
+    }
+    storage->es_index_size = size;
+
+    for (i = 0; i < storage->es_numentries; i++)
+    {
+        status = storage_index_insert (storage, i);
+        if (status != DISIR_STATUS_OK)
+        {
+            log_warn ("failed to populate element storage index - falling back to linear lookups");
+            storage_index_destroy (storage);
+            return status;
+        }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Remove the last entry in storage from the index.
+static void
+storage_index_remove_tail (struct disir_element_storage *storage)
+{
+    struct element_storage_entry *entry;
+    struct element_storage_group *group;
+    uint32_t mask;
+    uint32_t i;
+    uint32_t j;
+    uint32_t k;
+
+    entry = &storage->es_entries[storage->es_numentries - 1];
+    group = storage_index_find (storage, entry->ee_name, entry->ee_hash);
+    if (group == NULL)
+        return;
+
+    // The last entry is the last position in its group.
+    group->eg_count--;
+    if (group->eg_count != 0)
+    {
+        if (group->eg_count == 1)
+        {
+            k = group->eg_positions[0];
+            free (group->eg_positions);
+            group->eg_capacity = 0;
+            group->eg_position = k;
+        }
+        return;
+    }
+
+    // Backward shift deletion: move every following entry of the probe
+    // sequence whose home slot is not cyclically in (i, j] into the hole.
+    mask = storage->es_index_size - 1;
+    i = group - storage->es_index;
+    j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (storage->es_index[j].eg_name == NULL)
+            break;
+
+        k = index_slot (storage->es_index[j].eg_hash, mask);
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)))
+        {
+            storage->es_index[i] = storage->es_index[j];
+            i = j;
+        }
+    }
+
+    memset (&storage->es_index[i], 0, sizeof (struct element_storage_group));
+    storage->es_index_used--;
+}
+
+//! STATIC API
+//! Return the number of entries stored with name. Populate group with its index
+//! group if the storage is indexed, and key with the stored copy of name, if any.
+static uint32_t
+storage_lookup (struct disir_element_storage *storage, const char *name, unsigned long hash,
+                struct element_storage_group **group, char **key)
+{
+    uint32_t count;
+    uint32_t i;
+
+    *group = NULL;
+    *key = NULL;
+
+    if (storage->es_index)
+    {
+        *group = storage_index_find (storage, name, hash);
+        if (*group == NULL)
+            return 0;
+
+        *key = (*group)->eg_name;
+        return (*group)->eg_count;
+    }
+
+    count = 0;
+    for (i = 0; i < storage->es_numentries; i++)
+    {
+        if (entry_matches (&storage->es_entries[i], name, hash))
+        {
+            *key = storage->es_entries[i].ee_name;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+//! STATIC API
+//! Return the position of the nth entry stored with name, or -1 if none exist.
+static int64_t
+storage_position_nth (struct disir_element_storage *storage, const char *name,
+                      unsigned long hash, uint32_t n)
+{
+    struct element_storage_group *group;
+    uint32_t i;
+
+    if (storage->es_index)
+    {
+        group = storage_index_find (storage, name, hash);
+        if (group == NULL || n >= group->eg_count)
+            return (-1);
+
+        return group_position (group, n);
+    }
+
+    for (i = 0; i < storage->es_numentries; i++)
+    {
+        if (entry_matches (&storage->es_entries[i], name, hash))
+        {
+            if (n == 0)
+                return i;
+            n--;
+        }
+    }
+
+    return (-1);
+}
+
+//! INTERNAL API
+struct disir_element_storage *
+dx_element_storage_create (struct disir_arena *arena)
+{
+    struct disir_element_storage *storage;
+
+    // The entry array is allocated upon first insertion.
+    storage = dx_arena_alloc (arena, sizeof (struct disir_element_storage));
+    if (storage == NULL)
+    {
+        return NULL;
+    }
+
+    storage->es_arena = arena;
+
+    return storage;
 }
 
 //! INTERNAL API
@@ -99,8 +463,9 @@ error:
 enum disir_status
 dx_element_storage_destroy (struct disir_element_storage **storage)
 {
-    list_iterator_t *iter;
     struct disir_context *context;
+    uint32_t i;
+    uint32_t j;
 
     TRACE_ENTER ("stroage: %p", storage);
 
@@ -110,40 +475,46 @@ dx_element_storage_destroy (struct disir_element_storage **storage)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    iter = list_iterator_create ((*storage)->es_list, LIST_HEAD);
-    if (iter == NULL)
+    // Destroy each context stored in the element storage.
+    // We destroy from the back, such that every removal below is of the last entry.
+    for (i = (*storage)->es_numentries; i > 0; i--)
     {
-        log_warn ("list_iterator_create allocation failed.");
-        return DISIR_STATUS_NO_MEMORY;
+        // Destroying a context removes at most itself from this storage.
+        if (i > (*storage)->es_numentries)
+            i = (*storage)->es_numentries;
+        if (i == 0)
+            break;
+
+        context = (*storage)->es_entries[i - 1].ee_context;
+        log_debug(9, "destroying context %p in list belonging to storage", context);
+
+        // We are destroying a child of us - this dc_destroy call will
+        // remove our reference which we keep in the element storage.
+        // However, the dc_destroy call will reach back into this storage,
+        // removing its reference with a decref. This is to support
+        // removing children from a parent without destroying the parent.
+        // So, we actually have to incref here so that we add one references,
+        // and remove two.
+        dx_context_incref (context);
+        dc_destroy (&context);
     }
 
-    // Destroy each context stored in the element storage (through the list)
-    while ((context = list_iterator_next (iter)))
+    // Keys are allocated upon insertion - free each distinct key upon deletion.
+    for (i = 0; i < (*storage)->es_numentries; i++)
     {
-        log_debug(9, "destroying context %p in list belonging to storage", context);
-        // Ignore return code - we just want to destroy and get out of town.
-        // Destroying the context will decref our reference on it.
-        if (context)
+        for (j = 0; j < i; j++)
         {
-            // We are destroying a child of us - this dc_destroy call will
-            // remove our reference which we keep in the element storage.
-            // However, the dc_destroy call will reach back into this storage,
-            // removing its reference with a decref. This is to support
-            // removing children from a parent without destroying the parent.
-            // So, we actually have to incref here so that we add one references,
-            // and remove two.
-            dx_context_incref (context);
-            dc_destroy (&context);
+            if ((*storage)->es_entries[j].ee_name == (*storage)->es_entries[i].ee_name)
+                break;
         }
+        if (j == i)
+            dx_arena_free ((*storage)->es_arena, (*storage)->es_entries[i].ee_name);
     }
 
-    // Destroy iterator and element_storage data structures
-    // multimap key is heap allocated upon insertion - free it upon deletion.
-    list_iterator_destroy (&iter);
-    list_destroy (&(*storage)->es_list);
-    multimap_destroy ((*storage)->es_map, free, NULL);
+    storage_index_destroy (*storage);
+    free ((*storage)->es_entries);
 
-    free (*storage);
+    dx_arena_free ((*storage)->es_arena, *storage);
     *storage = NULL;
 
     TRACE_EXIT ("");
@@ -157,23 +528,26 @@ dx_element_storage_numentries (struct disir_element_storage *storage)
     if (storage == NULL)
         return (-1);
 
-    // Get the number of entries from the multimap
-    return multimap_size (storage->es_map);
+    return storage->es_numentries;
 }
 
 //! INTERNAL API
-//! Make a copy of the input name to use as key for multimap. Only allocate if no such
-//! key exist in the map.
+//! Make a copy of the input name to use as key. Only allocate if no such
+//! key exist in the storage.
 //! Will increment context refcount.
 enum disir_status
 dx_element_storage_add (struct disir_element_storage *storage,
                         const char * name,
                         struct disir_context *context)
 {
-    enum disir_status status;
-    int res;
-    int keys_in_map;
+    struct element_storage_entry *entries;
+    struct element_storage_group *group;
     char *key;
+    char *copy;
+    unsigned long hash;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t i;
 
     if (storage == NULL || name == NULL || context == NULL)
     {
@@ -182,58 +556,77 @@ dx_element_storage_add (struct disir_element_storage *storage,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    keys_in_map = multimap_contains_key (storage->es_map, name);
-    if (keys_in_map == 0)
+    hash = djb2 (name);
+    copy = NULL;
+
+    // Reject the context if it is already stored by this name.
+    count = storage_lookup (storage, name, hash, &group, &key);
+    for (i = 0; i < count; i++)
+    {
+        if (storage->es_entries[storage_position_nth (storage, name, hash, i)].ee_context
+                == context)
+        {
+            log_warn ("attempted to add context (%p) to element storage which already exists",
+                      context);
+            return DISIR_STATUS_EXISTS;
+        }
+    }
+
+    if (key == NULL)
     {
-        // Map does not contain a key with this name. Allocate space to store
+        // Storage does not contain a key with this name. Allocate space to store
         // key in, so we can safely access the key memory even if the appointed context
         // is destroyed whilst in our storage.
-        key = malloc (strlen (name) + 1); // XXX: Is there a more safe way to allocate this memory?
-        memcpy(key, name, strlen (name) + 1);
+        copy = dx_arena_alloc (storage->es_arena, strlen (name) + 1);
+        if (copy == NULL)
+        {
+            return DISIR_STATUS_NO_MEMORY;
+        }
+        memcpy (copy, name, strlen (name) + 1);
+        key = copy;
     }
 
-    // Add to map - will check if it already exists or not.
-    res = multimap_push_value (storage->es_map,
-            (keys_in_map ? name : key),
-            context);
-    if (res == (-ENOMEM))
+    if (storage->es_numentries == storage->es_capacity)
     {
-        log_warn ("multimap_push_value failed to allocate sufficient memory.");
-        status = DISIR_STATUS_NO_MEMORY;
-        goto map_error;
+        capacity = (storage->es_capacity == 0 ? ELEMENT_STORAGE_INITIAL_CAPACITY
+                                              : storage->es_capacity * 2);
+        entries = realloc (storage->es_entries,
+                           capacity * sizeof (struct element_storage_entry));
+        if (entries == NULL)
+        {
+            log_warn ("failed to allocate sufficient memory for %u element storage entries",
+                      capacity);
+            dx_arena_free (storage->es_arena, copy);
+            return DISIR_STATUS_NO_MEMORY;
+        }
+
+        storage->es_entries = entries;
+        storage->es_capacity = capacity;
     }
-    else if (res != 0)
+
+    storage->es_entries[storage->es_numentries].ee_hash = hash;
+    storage->es_entries[storage->es_numentries].ee_name = key;
+    storage->es_entries[storage->es_numentries].ee_context = context;
+    storage->es_numentries++;
+
+    // Promote to (or maintain) the hashed index once we outgrow the flat array.
+    // Failure leaves us without an index, which only makes lookups slower.
+    if (storage->es_index)
     {
-        log_warn ("attempted to add context (%p) to element storage which already exists",
-                context);
-        status = DISIR_STATUS_EXISTS;
-        goto map_error;
+        if (storage_index_insert (storage, storage->es_numentries - 1) != DISIR_STATUS_OK)
+        {
+            log_warn ("failed to update element storage index - falling back to linear lookups");
+            storage_index_destroy (storage);
+        }
     }
-
-    // Add to list for chronological ordering.
-    if (list_rpush (storage->es_list, context))
+    else if (storage->es_numentries > ELEMENT_STORAGE_FLAT_MAX)
     {
-        status = DISIR_STATUS_INTERNAL_ERROR;
-        goto list_error;
+        storage_index_build (storage);
     }
 
     dx_context_incref (context);
 
-    return DISIR_STATUS_OK;;
-list_error:
-    multimap_remove_value (storage->es_map,
-        (keys_in_map ? name : key),
-        free, // Free's the allocated memory above, if removing last element with this key name.
-        NULL);
-
-map_error:
-    if (keys_in_map == 0)
-    {
-        // Allocated on heap - free it.
-        free (key);
-    }
-
-    return status;
+    return DISIR_STATUS_OK;
 }
 
 enum disir_status
@@ -241,13 +634,60 @@ dx_element_storage_remove (struct disir_element_storage *storage,
                            const char * const name,
                            struct disir_context *context)
 {
-    multimap_remove_value (storage->es_map, name, free, context);
-    if (!list_remove (storage->es_list, context))
+    struct element_storage_group *group;
+    char *key;
+    unsigned long hash;
+    uint32_t position;
+    uint32_t count;
+    uint32_t i;
+
+    if (storage == NULL || name == NULL || context == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (storage %p, name %p, context %p)",
+                   storage, name, context);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Search from the back - contexts are mostly removed in reverse insertion order.
+    for (i = storage->es_numentries; i > 0; i--)
+    {
+        if (storage->es_entries[i - 1].ee_context == context)
+            break;
+    }
+    if (i == 0)
+    {
+        return DISIR_STATUS_OK;
+    }
+    position = i - 1;
+
+    key = storage->es_entries[position].ee_name;
+    hash = storage->es_entries[position].ee_hash;
+    count = storage_lookup (storage, key, hash, &group, &key);
+
+    if (storage->es_index && position == storage->es_numentries - 1)
+    {
+        storage_index_remove_tail (storage);
+    }
+
+    memmove (&storage->es_entries[position], &storage->es_entries[position + 1],
+             (storage->es_numentries - position - 1) * sizeof (struct element_storage_entry));
+    storage->es_numentries--;
+
+    // Positions past the removed entry have shifted.
+    if (storage->es_index && position != storage->es_numentries)
     {
-        log_debug(8, "removing context %p from storage", context);
-        dx_context_decref (&context);
+        storage_index_build (storage);
     }
 
+    // Free the key if we removed the last element with this key name.
+    if (count == 1)
+    {
+        dx_arena_free (storage->es_arena, key);
+    }
+
+    log_debug(8, "removing context %p from storage", context);
+    dx_context_decref (&context);
+
     return DISIR_STATUS_OK;
 }
 
@@ -257,47 +697,39 @@ dx_element_storage_get (struct disir_element_storage *storage,
                         struct disir_collection **collection)
 {
     enum disir_status status;
-    struct disir_context *context;
     struct disir_collection *col;
-    struct multimap_value_iterator *iter;
+    struct element_storage_group *group;
+    char *key;
+    unsigned long hash;
+    uint32_t count;
+    uint32_t i;
 
-    iter = multimap_fetch (storage->es_map, name);
-    if (iter == NULL)
+    hash = djb2 (name);
+    count = storage_lookup (storage, name, hash, &group, &key);
+    if (count == 0)
     {
         return DISIR_STATUS_NOT_EXIST;
     }
+
     col = dc_collection_create ();
-    if (collection == NULL)
+    if (col == NULL)
     {
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
+        return DISIR_STATUS_NO_MEMORY;
     }
 
-    while ((context = multimap_iterator_next (iter)))
+    for (i = 0; i < count; i++)
     {
-        status = dc_collection_push_context (col, context);
+        status = dc_collection_push_context (col,
+                storage->es_entries[storage_position_nth (storage, name, hash, i)].ee_context);
         if (status != DISIR_STATUS_OK)
         {
-            goto error;
+            dc_collection_finished (&col);
+            return status;
         }
     }
 
-    multimap_iterator_destroy (iter);
-
     *collection = col;
     return DISIR_STATUS_OK;
-error:
-
-    if (col)
-    {
-        dc_collection_finished (&col);
-    }
-    if (iter)
-    {
-        multimap_iterator_destroy (iter);
-    }
-
-    return status;
 }
 
 // INTERNAL API
@@ -306,12 +738,8 @@ dx_element_storage_get_all (struct disir_element_storage *storage,
                             struct disir_collection **collection)
 {
     enum disir_status status;
-    struct disir_context *context;
     struct disir_collection *coll;
-    struct list_iterator *iter;
-
-    coll = NULL;
-    iter = NULL;
+    uint32_t i;
 
     if (storage == NULL)
     {
@@ -324,45 +752,71 @@ dx_element_storage_get_all (struct disir_element_storage *storage,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    iter = list_iterator_create (storage->es_list, LIST_HEAD);
-    if (iter == NULL)
-    {
-        log_warn ("in element_storage (%p) - list_iterator_create failed", storage);
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
-    }
-
     coll = dc_collection_create ();
     if (coll == NULL)
     {
         log_warn (
             "in element_storage (%p) - dc_collection_create failed to allocate sufficient memory",
             storage);
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
+        return DISIR_STATUS_NO_MEMORY;
     }
 
-    while ((context = list_iterator_next (iter)))
+    for (i = 0; i < storage->es_numentries; i++)
     {
-        status = dc_collection_push_context (coll, context);
+        status = dc_collection_push_context (coll, storage->es_entries[i].ee_context);
         if (status != DISIR_STATUS_OK)
-            goto error;
+        {
+            dc_collection_finished (&coll);
+            return status;
+        }
     }
 
-    list_iterator_destroy (&iter);
-
     *collection = coll;
 
     return DISIR_STATUS_OK;
-error:
-    if (iter)
-        list_iterator_destroy (&iter);
-    if (coll)
+}
+
+//! INTERNAL API
+enum disir_status
+dx_element_storage_foreach (struct disir_element_storage *storage, const char *name,
+                            dc_visit_function callback, void *userdata)
+{
+    enum disir_status status;
+    unsigned long hash;
+    int64_t position;
+    uint32_t i;
+
+    if (storage == NULL || callback == NULL)
     {
-        dc_collection_finished (&coll);
+        log_debug (0, "invoked with NULL pointer(s) (storage %p, callback %p)",
+                   storage, callback);
+        return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    return status;
+    // The entries are re-read on every step, since callback may add to the storage.
+    if (name == NULL)
+    {
+        for (i = 0; i < storage->es_numentries; i++)
+        {
+            status = callback (storage->es_entries[i].ee_context, userdata);
+            if (status != DISIR_STATUS_OK)
+                return status;
+        }
+
+        return DISIR_STATUS_OK;
+    }
+
+    hash = djb2 (name);
+    i = 0;
+    while ((position = storage_position_nth (storage, name, hash, i)) >= 0)
+    {
+        status = callback (storage->es_entries[position].ee_context, userdata);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        i++;
+    }
+
+    return (i == 0 ? DISIR_STATUS_NOT_EXIST : DISIR_STATUS_OK);
 }
 
 //! INTERNAL API
@@ -371,16 +825,75 @@ dx_element_storage_get_first(struct disir_element_storage *storage,
                              const char *name,
                              struct disir_context **context)
 {
-    struct disir_context *keyval;
+    int64_t position;
 
-    keyval = multimap_get_first (storage->es_map, name);
-    if (keyval == NULL)
+    position = storage_position_nth (storage, name, djb2 (name), 0);
+    if (position < 0)
     {
         return DISIR_STATUS_NOT_EXIST;
     }
 
-    *context = keyval;
+    *context = storage->es_entries[position].ee_context;
     return DISIR_STATUS_OK;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_element_storage_get_nth (struct disir_element_storage *storage,
+                            const char *name, unsigned int index,
+                            struct disir_context **context)
+{
+    if (name == NULL)
+    {
+        log_debug (0, "invoked with NULL name pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    return dx_element_storage_get_nth_hashed (storage, name, djb2 (name),
+                                              index, context);
+}
 
+//! INTERNAL API
+enum disir_status
+dx_element_storage_get_nth_hashed (struct disir_element_storage *storage,
+                                   const char *name, unsigned long hash, unsigned int index,
+                                   struct disir_context **context)
+{
+    int64_t position;
+
+    if (storage == NULL || name == NULL || context == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (storage %p, name %p, context %p)",
+                   storage, name, context);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    position = storage_position_nth (storage, name, hash, index);
+    if (position < 0)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    *context = storage->es_entries[position].ee_context;
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+unsigned long
+dx_element_storage_hash (const char *name)
+{
+    return djb2 (name);
+}
+
+//! INTERNAL API
+int32_t
+dx_element_storage_count (struct disir_element_storage *storage, const char *name)
+{
+    struct element_storage_group *group;
+    char *key;
+
+    if (storage == NULL || name == NULL)
+        return (-1);
+
+    return storage_lookup (storage, name, djb2 (name), &group, &key);
+}
@@ -11,6 +11,37 @@
 // private
 #include "disir_private.h"
 #include "log.h"
+#include "mqueue.h"
+
+
+//! INTERNAL API
+enum disir_status
+dx_instance_error_init (struct disir_instance *instance)
+{
+    pthread_mutex_init (&instance->dio_error_lock, NULL);
+    instance->dio_error_queue = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_instance_error_finished (struct disir_instance *instance)
+{
+    struct disir_error_storage *storage;
+
+    // A thread exiting meanwhile either has removed its storage already,
+    // or finds it orphaned - and releases it, as any other thread will.
+    dx_thread_records_lock ();
+    while ((storage = MQ_POP (instance->dio_error_queue)) != NULL)
+    {
+        dx_thread_record_orphan (&storage->er_record);
+    }
+    dx_thread_records_unlock ();
+    dx_thread_records_prune ();
+
+    pthread_mutex_destroy (&instance->dio_error_lock);
+}
 
 
 //! PUBLIC API
@@ -47,11 +78,14 @@ disir_error_set (struct disir_instance *instance, const char *message, ...)
 void
 disir_error_clear (struct disir_instance *instance)
 {
-    if (instance->disir_error_message_size != 0)
+    struct disir_error_storage *storage;
+
+    storage = dx_instance_error_storage (instance, 0);
+    if (storage != NULL && storage->er_message_size != 0)
     {
-        instance->disir_error_message_size = 0;
-        free (instance->disir_error_message);
-        instance->disir_error_message = NULL;
+        storage->er_message_size = 0;
+        free (storage->er_message);
+        storage->er_message = NULL;
     }
 }
 
@@ -61,6 +95,8 @@ disir_error_copy (struct disir_instance *instance,
                   char *buffer, int32_t buffer_size, int32_t *bytes_written)
 {
     enum disir_status status;
+    struct disir_error_storage *storage;
+    const char *message;
     int32_t size;
 
     if (instance == NULL || buffer == NULL)
@@ -75,7 +111,15 @@ disir_error_copy (struct disir_instance *instance,
         return DISIR_STATUS_INSUFFICIENT_RESOURCES;
     }
 
-    size = instance->disir_error_message_size;
+    message = NULL;
+    size = 0;
+    storage = dx_instance_error_storage (instance, 0);
+    if (storage != NULL && storage->er_message != NULL)
+    {
+        message = storage->er_message;
+        size = storage->er_message_size;
+    }
+
     if (bytes_written)
     {
         // Write the total size of the error message
@@ -89,7 +133,8 @@ disir_error_copy (struct disir_instance *instance,
         status = DISIR_STATUS_INSUFFICIENT_RESOURCES;
     }
 
-    memcpy (buffer, instance->disir_error_message, size);
+    if (size > 0)
+        memcpy (buffer, message, size);
     if (status == DISIR_STATUS_INSUFFICIENT_RESOURCES)
     {
         sprintf (buffer + size, "...");
@@ -104,6 +149,11 @@ disir_error_copy (struct disir_instance *instance,
 const char *
 disir_error (struct disir_instance *instance)
 {
-    return instance->disir_error_message;
-}
+    struct disir_error_storage *storage;
 
+    storage = dx_instance_error_storage (instance, 0);
+    if (storage == NULL)
+        return NULL;
+
+    return storage->er_message;
+}
@@ -55,6 +55,7 @@ fslib_stat_filepath (struct disir_instance *instance,
     enum disir_status status;
     int res;
     int errsave;
+    char errbuf[256];
 
     res = stat (filepath, statbuf);
     if (res != 0)
@@ -73,10 +74,9 @@ fslib_stat_filepath (struct disir_instance *instance,
         }
         else
         {
-            // TODO: Use threadsafe strerror
             status = DISIR_STATUS_NOT_EXIST;
             disir_error_set (instance, "entry resolved to filepath '%s' does not exist: %s",
-                            filepath, strerror (errsave));
+                            filepath, fslib_strerror (errsave, errbuf, sizeof (errbuf)));
 
         }
 
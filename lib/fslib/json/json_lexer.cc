@@ -0,0 +1,743 @@
+// JSON private
+#include "json/json_lexer.h"
+
+// standard
+#include <algorithm>
+#include <iterator>
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//! Maximum nesting of values, the same limit Json::Reader enforces.
+#define JSON_LEXER_DEPTH_LIMIT 1000
+
+using namespace dio;
+
+//! STATIC API
+//!
+//! Locale independent number conversion, like the classic locale used by Json::Reader.
+//!
+static locale_t
+json_c_locale (void)
+{
+    static locale_t c_locale = newlocale (LC_ALL_MASK, "C", (locale_t) 0);
+
+    return c_locale;
+}
+
+//! STATIC API
+static void
+append_code_point (std::string& decoded, unsigned int cp)
+{
+    if (cp <= 0x7F)
+    {
+        decoded += static_cast<char> (cp);
+    }
+    else if (cp <= 0x7FF)
+    {
+        decoded += static_cast<char> (0xC0 | (0x1F & (cp >> 6)));
+        decoded += static_cast<char> (0x80 | (0x3F & cp));
+    }
+    else if (cp <= 0xFFFF)
+    {
+        decoded += static_cast<char> (0xE0 | (0xF & (cp >> 12)));
+        decoded += static_cast<char> (0x80 | (0x3F & (cp >> 6)));
+        decoded += static_cast<char> (0x80 | (0x3F & cp));
+    }
+    else if (cp <= 0x10FFFF)
+    {
+        decoded += static_cast<char> (0xF0 | (0x7 & (cp >> 18)));
+        decoded += static_cast<char> (0x80 | (0x3F & (cp >> 12)));
+        decoded += static_cast<char> (0x80 | (0x3F & (cp >> 6)));
+        decoded += static_cast<char> (0x80 | (0x3F & cp));
+    }
+}
+
+JsonLexer::JsonLexer (const char *begin, const char *end)
+{
+    m_begin = begin;
+    m_end = end;
+    m_current = begin;
+}
+
+//! PUBLIC
+bool
+JsonLexer::validate ()
+{
+    m_current = m_begin;
+    m_error = false;
+    m_depth_exceeded = false;
+    m_objects.clear ();
+    m_members.clear ();
+    m_pending.clear ();
+
+    // Anything following the root value is ignored.
+    return validate_value (0);
+}
+
+//! PUBLIC
+const struct json_object *
+JsonLexer::read_members ()
+{
+    std::vector<struct json_object>::const_iterator object;
+
+    // Objects are recorded in document order.
+    object = std::lower_bound (m_objects.begin (), m_objects.end (), m_current,
+                               [] (const struct json_object& o, const char *position) {
+                                   return o.jo_begin < position;
+                               });
+    if (object == m_objects.end () || object->jo_begin != m_current)
+        return NULL;
+
+    m_current = object->jo_end;
+    return &*object;
+}
+
+//! PUBLIC
+void
+JsonLexer::read_token (struct json_token& token)
+{
+    bool ok = true;
+    char c;
+
+    while (m_current != m_end
+           && (*m_current == ' ' || *m_current == '\t'
+               || *m_current == '\r' || *m_current == '\n'))
+    {
+        ++m_current;
+    }
+
+    token.jt_start = m_current;
+    c = (m_current != m_end ? *m_current++ : 0);
+
+    switch (c)
+    {
+    case '{':
+        token.jt_type = JSON_TOKEN_OBJECT_BEGIN;
+        break;
+    case '}':
+        token.jt_type = JSON_TOKEN_OBJECT_END;
+        break;
+    case '[':
+        token.jt_type = JSON_TOKEN_ARRAY_BEGIN;
+        break;
+    case ']':
+        token.jt_type = JSON_TOKEN_ARRAY_END;
+        break;
+    case '"':
+        token.jt_type = JSON_TOKEN_STRING;
+        ok = read_string ();
+        break;
+    case '/':
+        token.jt_type = JSON_TOKEN_COMMENT;
+        ok = read_comment ();
+        break;
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case '-':
+        token.jt_type = JSON_TOKEN_NUMBER;
+        read_number ();
+        break;
+    case 't':
+        token.jt_type = JSON_TOKEN_TRUE;
+        ok = match ("rue", 3);
+        break;
+    case 'f':
+        token.jt_type = JSON_TOKEN_FALSE;
+        ok = match ("alse", 4);
+        break;
+    case 'n':
+        token.jt_type = JSON_TOKEN_NULL;
+        ok = match ("ull", 3);
+        break;
+    case ',':
+        token.jt_type = JSON_TOKEN_ARRAY_SEPARATOR;
+        break;
+    case ':':
+        token.jt_type = JSON_TOKEN_MEMBER_SEPARATOR;
+        break;
+    case 0:
+        token.jt_type = JSON_TOKEN_END_OF_STREAM;
+        break;
+    default:
+        ok = false;
+        break;
+    }
+
+    if (!ok)
+        token.jt_type = JSON_TOKEN_ERROR;
+    token.jt_end = m_current;
+}
+
+//! PUBLIC
+void
+JsonLexer::read_token_skip_comments (struct json_token& token)
+{
+    do
+    {
+        read_token (token);
+    } while (token.jt_type == JSON_TOKEN_COMMENT);
+}
+
+//! PUBLIC
+bool
+JsonLexer::peek (char c)
+{
+    while (m_current != m_end
+           && (*m_current == ' ' || *m_current == '\t'
+               || *m_current == '\r' || *m_current == '\n'))
+    {
+        ++m_current;
+    }
+
+    return (m_current != m_end && *m_current == c);
+}
+
+//! PUBLIC
+bool
+JsonLexer::decode_string (const struct json_token& token, std::string& decoded)
+{
+    const char *current = token.jt_start + 1;
+    const char *end = token.jt_end - 1;
+    const char *run;
+    unsigned int unicode;
+    char escape;
+
+    decoded.clear ();
+    decoded.reserve (end - current);
+
+    while (current != end)
+    {
+        // Copy everything up to the next escape sequence in one go
+        run = current;
+        while (current != end && *current != '\\' && *current != '"')
+            ++current;
+        decoded.append (run, current - run);
+        if (current == end || *current == '"')
+            break;
+
+        // Skip the backslash
+        ++current;
+        if (current == end)
+            return add_error ("Empty escape sequence in string", token, current);
+
+        escape = *current++;
+        switch (escape)
+        {
+        case '"':
+            decoded += '"';
+            break;
+        case '/':
+            decoded += '/';
+            break;
+        case '\\':
+            decoded += '\\';
+            break;
+        case 'b':
+            decoded += '\b';
+            break;
+        case 'f':
+            decoded += '\f';
+            break;
+        case 'n':
+            decoded += '\n';
+            break;
+        case 'r':
+            decoded += '\r';
+            break;
+        case 't':
+            decoded += '\t';
+            break;
+        case 'u':
+            if (!decode_unicode_escape (token, current, end, unicode))
+                return false;
+            append_code_point (decoded, unicode);
+            break;
+        default:
+            return add_error ("Bad escape sequence in string", token, current);
+        }
+    }
+
+    return true;
+}
+
+//! PUBLIC
+bool
+JsonLexer::decode_number (const struct json_token& token, struct json_number& number)
+{
+    const char *current = token.jt_start;
+    bool negative;
+    uint64_t maximum;
+    uint64_t threshold;
+    uint64_t value;
+    unsigned int digit;
+    char buffer[64];
+    char *conversion_end;
+    size_t length;
+    bool valid;
+    char c;
+
+    negative = (*current == '-');
+    if (negative)
+        ++current;
+
+    maximum = (negative ? (uint64_t) INT64_MAX + 1 : UINT64_MAX);
+    threshold = maximum / 10;
+    value = 0;
+
+    while (current < token.jt_end)
+    {
+        c = *current++;
+        if (c < '0' || c > '9')
+            goto real;
+
+        digit = c - '0';
+        if (value >= threshold)
+        {
+            // Does not fit in an integer - treat it as a double instead.
+            if (value > threshold || current != token.jt_end || digit > maximum % 10)
+                goto real;
+        }
+        value = value * 10 + digit;
+    }
+
+    if (negative && value == maximum)
+    {
+        number.jn_type = JSON_NUMBER_INTEGER;
+        number.jn_integer = INT64_MIN;
+    }
+    else if (negative)
+    {
+        number.jn_type = JSON_NUMBER_INTEGER;
+        number.jn_integer = -(int64_t) value;
+    }
+    else if (value <= (uint64_t) INT64_MAX)
+    {
+        number.jn_type = JSON_NUMBER_INTEGER;
+        number.jn_integer = (int64_t) value;
+    }
+    else
+    {
+        number.jn_type = JSON_NUMBER_UNSIGNED;
+        number.jn_unsigned = value;
+    }
+    return true;
+
+real:
+    // The token is not terminated in the document; copy it out first.
+    length = token.jt_end - token.jt_start;
+    if (length < sizeof (buffer))
+    {
+        memcpy (buffer, token.jt_start, length);
+        buffer[length] = '\0';
+        number.jn_real = strtod_l (buffer, &conversion_end, json_c_locale ());
+        valid = (conversion_end != buffer && *conversion_end == '\0');
+    }
+    else
+    {
+        std::string text (token.jt_start, length);
+        number.jn_real = strtod_l (text.c_str (), &conversion_end, json_c_locale ());
+        valid = (conversion_end != text.c_str () && *conversion_end == '\0');
+    }
+
+    // Partial conversions and overflow are rejected, just like std::istream does.
+    if (!valid || isinf (number.jn_real))
+    {
+        m_error_message = "'" + std::string (token.jt_start, length) + "' is not a number.";
+        return add_error (m_error_message.c_str (), token);
+    }
+
+    number.jn_type = JSON_NUMBER_REAL;
+    return true;
+}
+
+//! PUBLIC
+std::string
+JsonLexer::error_message () const
+{
+    char buffer[128];
+    std::string message;
+    int line;
+    int column;
+
+    if (m_depth_exceeded)
+    {
+        return std::string ("Exceeded stackLimit in readValue().\n");
+    }
+    if (!m_error)
+    {
+        return message;
+    }
+
+    location (m_error_token.jt_start, line, column);
+    snprintf (buffer, sizeof (buffer), "* Line %d, Column %d\n", line, column);
+    message += buffer;
+    message += "  " + m_error_message + "\n";
+
+    if (m_error_extra)
+    {
+        location (m_error_extra, line, column);
+        snprintf (buffer, sizeof (buffer), "See Line %d, Column %d for detail.\n", line, column);
+        message += buffer;
+    }
+
+    return message;
+}
+
+//! PRIVATE
+bool
+JsonLexer::validate_value (int depth)
+{
+    struct json_token token;
+    struct json_number number;
+    std::string decoded;
+
+    if (depth >= JSON_LEXER_DEPTH_LIMIT)
+    {
+        m_depth_exceeded = true;
+        m_error = true;
+        return false;
+    }
+
+    read_token_skip_comments (token);
+
+    switch (token.jt_type)
+    {
+    case JSON_TOKEN_OBJECT_BEGIN:
+        return validate_object (depth + 1);
+    case JSON_TOKEN_ARRAY_BEGIN:
+        return validate_array (depth + 1);
+    case JSON_TOKEN_NUMBER:
+        return decode_number (token, number);
+    case JSON_TOKEN_STRING:
+        return decode_string (token, decoded);
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+    case JSON_TOKEN_NULL:
+        return true;
+    default:
+        return add_error ("Syntax error: value, object or array expected.", token);
+    }
+}
+
+//! PRIVATE
+//! Move the pending members of the object just validated into the member table.
+bool
+JsonLexer::record_object (size_t object, size_t pending)
+{
+    m_objects[object].jo_end = m_current;
+    m_objects[object].jo_first = m_members.size ();
+    m_objects[object].jo_count = m_pending.size () - pending;
+
+    std::move (m_pending.begin () + pending, m_pending.end (), std::back_inserter (m_members));
+    m_pending.resize (pending);
+
+    return true;
+}
+
+//! PRIVATE
+bool
+JsonLexer::validate_object (int depth)
+{
+    struct json_token name;
+    struct json_token colon;
+    struct json_token comma;
+    std::string decoded;
+    bool name_empty = true;
+    size_t object;
+    size_t pending;
+
+    // Reserve the slot up front, so that objects are ordered by their opening brace.
+    object = m_objects.size ();
+    m_objects.push_back ({m_current, nullptr, 0, 0});
+    pending = m_pending.size ();
+
+    while (1)
+    {
+        read_token (name);
+        while (name.jt_type == JSON_TOKEN_COMMENT)
+            read_token (name);
+
+        // An empty object - or a trailing comma after a member with an empty name.
+        if (name.jt_type == JSON_TOKEN_OBJECT_END && name_empty)
+            return record_object (object, pending);
+        if (name.jt_type != JSON_TOKEN_STRING)
+            break;
+
+        if (!decode_string (name, decoded))
+            return false;
+        name_empty = decoded.empty ();
+
+        read_token (colon);
+        if (colon.jt_type != JSON_TOKEN_MEMBER_SEPARATOR)
+            return add_error ("Missing ':' after object member name", colon);
+
+        m_pending.push_back ({decoded, m_current});
+
+        if (!validate_value (depth))
+            return false;
+
+        read_token (comma);
+        if (comma.jt_type != JSON_TOKEN_OBJECT_END
+            && comma.jt_type != JSON_TOKEN_ARRAY_SEPARATOR
+            && comma.jt_type != JSON_TOKEN_COMMENT)
+        {
+            return add_error ("Missing ',' or '}' in object declaration", comma);
+        }
+        while (comma.jt_type == JSON_TOKEN_COMMENT)
+            read_token (comma);
+        if (comma.jt_type == JSON_TOKEN_OBJECT_END)
+            return record_object (object, pending);
+    }
+
+    return add_error ("Missing '}' or object member name", name);
+}
+
+//! PRIVATE
+bool
+JsonLexer::validate_array (int depth)
+{
+    struct json_token token;
+
+    if (peek (']'))
+    {
+        read_token (token);
+        return true;
+    }
+
+    while (1)
+    {
+        if (!validate_value (depth))
+            return false;
+
+        // Accept comments after the last item in the array
+        read_token (token);
+        while (token.jt_type == JSON_TOKEN_COMMENT)
+            read_token (token);
+
+        if (token.jt_type != JSON_TOKEN_ARRAY_SEPARATOR && token.jt_type != JSON_TOKEN_ARRAY_END)
+            return add_error ("Missing ',' or ']' in array declaration", token);
+        if (token.jt_type == JSON_TOKEN_ARRAY_END)
+            return true;
+    }
+}
+
+//! PRIVATE
+bool
+JsonLexer::read_comment ()
+{
+    char c;
+
+    c = (m_current != m_end ? *m_current++ : 0);
+    if (c == '*')
+    {
+        while (m_current != m_end)
+        {
+            c = *m_current++;
+            if (c == '*' && m_current != m_end && *m_current == '/')
+                break;
+        }
+        return (m_current != m_end && *m_current++ == '/');
+    }
+    else if (c == '/')
+    {
+        while (m_current != m_end)
+        {
+            c = *m_current++;
+            if (c == '\n')
+                break;
+            if (c == '\r')
+            {
+                // Consume DOS EOL.
+                if (m_current != m_end && *m_current == '\n')
+                    ++m_current;
+                break;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+//! PRIVATE
+bool
+JsonLexer::read_string ()
+{
+    char c = '\0';
+
+    while (m_current != m_end)
+    {
+        c = *m_current++;
+        if (c == '\\')
+        {
+            if (m_current != m_end)
+                ++m_current;
+            else
+                c = '\0';
+        }
+        else if (c == '"')
+            break;
+    }
+
+    return (c == '"');
+}
+
+//! PRIVATE
+void
+JsonLexer::read_number ()
+{
+    const char *p = m_current;
+    // stopgap for the already consumed character
+    char c = '0';
+
+    // integral part
+    while (c >= '0' && c <= '9')
+        c = (m_current = p) < m_end ? *p++ : '\0';
+    // fractional part
+    if (c == '.')
+    {
+        c = (m_current = p) < m_end ? *p++ : '\0';
+        while (c >= '0' && c <= '9')
+            c = (m_current = p) < m_end ? *p++ : '\0';
+    }
+    // exponential part
+    if (c == 'e' || c == 'E')
+    {
+        c = (m_current = p) < m_end ? *p++ : '\0';
+        if (c == '+' || c == '-')
+            c = (m_current = p) < m_end ? *p++ : '\0';
+        while (c >= '0' && c <= '9')
+            c = (m_current = p) < m_end ? *p++ : '\0';
+    }
+}
+
+//! PRIVATE
+bool
+JsonLexer::match (const char *pattern, int length)
+{
+    if (m_end - m_current < length)
+        return false;
+    if (memcmp (m_current, pattern, length) != 0)
+        return false;
+
+    m_current += length;
+    return true;
+}
+
+//! PRIVATE
+bool
+JsonLexer::decode_unicode_escape (const struct json_token& token,
+                                  const char *& current, const char *end, unsigned int& unicode)
+{
+    unsigned int surrogate;
+    int i;
+    char c;
+
+    for (int half = 0; half < 2; half++)
+    {
+        if (end - current < 4)
+        {
+            return add_error ("Bad unicode escape sequence in string: four digits expected.",
+                              token, current);
+        }
+
+        surrogate = 0;
+        for (i = 0; i < 4; i++)
+        {
+            c = *current++;
+            surrogate *= 16;
+            if (c >= '0' && c <= '9')
+                surrogate += c - '0';
+            else if (c >= 'a' && c <= 'f')
+                surrogate += c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                surrogate += c - 'A' + 10;
+            else
+                return add_error ("Bad unicode escape sequence in string: "
+                                  "hexadecimal digit expected.", token, current);
+        }
+
+        if (half == 1)
+        {
+            unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (surrogate & 0x3FF);
+            break;
+        }
+
+        unicode = surrogate;
+        if (unicode < 0xD800 || unicode > 0xDBFF)
+            break;
+
+        // surrogate pairs
+        if (end - current < 6)
+        {
+            return add_error ("additional six characters expected to parse "
+                              "unicode surrogate pair.", token, current);
+        }
+        if (*(current++) != '\\' || *(current++) != 'u')
+        {
+            return add_error ("expecting another \\u token to begin the second half of "
+                              "a unicode surrogate pair", token, current);
+        }
+    }
+
+    return true;
+}
+
+//! PRIVATE
+bool
+JsonLexer::add_error (const char *message, const struct json_token& token, const char *extra)
+{
+    // Only the first error is reported; everything after it is a consequence.
+    if (m_error)
+        return false;
+
+    m_error = true;
+    if (message != m_error_message.c_str ())
+        m_error_message = message;
+    m_error_token = token;
+    m_error_extra = extra;
+
+    return false;
+}
+
+//! PRIVATE
+void
+JsonLexer::location (const char *position, int& line, int& column) const
+{
+    const char *current = m_begin;
+    const char *line_start = current;
+    char c;
+
+    line = 0;
+    while (current < position && current != m_end)
+    {
+        c = *current++;
+        if (c == '\r')
+        {
+            if (current != m_end && *current == '\n')
+                ++current;
+            line_start = current;
+            ++line;
+        }
+        else if (c == '\n')
+        {
+            line_start = current;
+            ++line;
+        }
+    }
+
+    // column & line start at 1
+    column = (int) (position - line_start) + 1;
+    ++line;
+}
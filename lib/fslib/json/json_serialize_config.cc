@@ -5,9 +5,11 @@
 #include <disir/disir.h>
 
 // standard
+#include <algorithm>
 #include <iostream>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 
 using namespace dio;
@@ -30,44 +32,47 @@ enum disir_status
 ConfigWriter::serialize (struct disir_config *config, std::ostream& stream)
 {
     enum disir_status status;
-    Json::StyledWriter writer;
-    std::string outputJson;
+    JsonWriter writer (stream);
 
-    status = DISIR_STATUS_OK;
-
-    // Retrieving the config's context object
-    m_contextConfig = dc_config_getcontext (config);
-    if (m_contextConfig == NULL )
+    status = serialize (config, writer);
+    if (writer.flush () == false && status == DISIR_STATUS_OK)
     {
-        disir_error_set (m_disir, "could not retrieve cconfig context object");
-        return DISIR_STATUS_INTERNAL_ERROR;
+        disir_error_set (m_disir, "failed to write serialized config to stream");
+        status = DISIR_STATUS_FS_ERROR;
     }
 
-    status = set_config_version (m_contextConfig, m_configRoot);
-    if (status != DISIR_STATUS_OK)
+    return status;
+}
+
+enum disir_status
+ConfigWriter::serialize (struct disir_config *config, std::string& output)
+{
+    enum disir_status status;
+
+    output.clear ();
+
     {
-        goto end;
+        JsonWriter writer (output);
+
+        status = serialize (config, writer);
+        writer.flush ();
     }
 
-    status = _serialize_context (m_contextConfig, m_configRoot[ATTRIBUTE_KEY_CONFIG]);
     if (status != DISIR_STATUS_OK)
     {
-        goto end;
+        output.clear ();
     }
 
-    stream << writer.writeOrdered (m_configRoot);
-
-end:
-    dc_putcontext (&m_contextConfig);
     return status;
 }
 
+//! PRIVATE
 enum disir_status
-ConfigWriter::serialize (struct disir_config *config, std::string& output)
+ConfigWriter::serialize (struct disir_config *config, JsonWriter& writer)
 {
     enum disir_status status;
-    Json::StyledWriter writer;
-    std::string outputJson;
+    std::vector<struct config_element> elements;
+    std::string version;
 
     // Retrieving the config's context object
     m_contextConfig = dc_config_getcontext (config);
@@ -77,35 +82,60 @@ ConfigWriter::serialize (struct disir_config *config, std::string& output)
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    status = set_config_version (m_contextConfig, m_configRoot);
+    status = set_config_version (m_contextConfig, version);
     if (status != DISIR_STATUS_OK)
     {
         goto end;
     }
 
-    status = _serialize_context (m_contextConfig, m_configRoot[ATTRIBUTE_KEY_CONFIG]);
+    status = get_elements (m_contextConfig, elements);
     if (status != DISIR_STATUS_OK)
     {
         goto end;
     }
 
-    output = writer.writeOrdered (m_configRoot);
+    writer.write_with_indent ("{");
+    writer.indent ();
+    writer.write_with_indent ("\"" ATTRIBUTE_KEY_VERSION "\"");
+    writer.write (" : ", 3);
+    writer.write (version);
+    writer.write (",", 1);
+    writer.write_with_indent ("\"" ATTRIBUTE_KEY_CONFIG "\"");
+    writer.write (" : ", 3);
+
+    // A config without any elements has always been written as null
+    if (elements.empty ())
+    {
+        writer.write ("null", 4);
+    }
+    else
+    {
+        status = write_object (writer, elements, true);
+        if (status != DISIR_STATUS_OK)
+        {
+            goto end;
+        }
+    }
 
+    writer.unindent ();
+    writer.write_with_indent ("}");
+    writer.write ("\n", 1);
 
 end:
+    put_elements (elements);
     dc_putcontext (&m_contextConfig);
     return status;
 }
 
 enum disir_status
-ConfigWriter::set_config_version (struct disir_context *context_config, Json::Value& root)
+ConfigWriter::set_config_version (struct disir_context *context_config, std::string& version)
 {
-    struct disir_version version;
+    struct disir_version config_version;
     enum disir_status status;
     char buf[500];
     char *temp;
 
-    status = dc_get_version (context_config, &version);
+    status = dc_get_version (context_config, &config_version);
     if (status != DISIR_STATUS_OK)
     {
         disir_error_set (m_disir, "Could not read config version: (%s)",
@@ -113,85 +143,310 @@ ConfigWriter::set_config_version (struct disir_context *context_config, Json::Va
         return status;
     }
 
-    temp = dc_version_string ((char *)buf, (int32_t)500, &version);
+    temp = dc_version_string ((char *)buf, (int32_t)500, &config_version);
     if (temp == NULL)
     {
         disir_error_set (m_disir, "Error retrieving semantic version string");
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    root[ATTRIBUTE_KEY_VERSION] = buf;
+    JsonWriter::format_string (version, buf);
 
     return status;
 }
 
-// Mapping child node (section) to key (section name)
+//! Elements being retrieved by ConfigWriter::get_elements.
+struct ConfigWriter::config_element_visit
+{
+    struct disir_instance *cv_disir;
+    std::vector<struct config_element> *cv_elements;
+};
+
 enum disir_status
-ConfigWriter::set_section_keyname (struct disir_context *context, Json::Value& parent,
-                                   Json::Value& sectionVal)
+ConfigWriter::visit_config_element (struct disir_context *context, void *userdata)
 {
-    std::string name;
+    struct config_element_visit *visit;
+    struct config_element element;
     enum disir_status status;
 
-    status = get_context_key (context, name);
+    visit = static_cast<struct config_element_visit *> (userdata);
+
+    element.ce_type = dc_context_type (context);
+    if (element.ce_type != DISIR_CONTEXT_SECTION && element.ce_type != DISIR_CONTEXT_KEYVAL)
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    status = dc_get_name (context, &element.ce_name, &element.ce_name_size);
     if (status != DISIR_STATUS_OK)
     {
-        // logged
+        // Should not happen
+        disir_error_set (visit->cv_disir, "Disir returned an error from dc_get_name: %s",
+                                          disir_status_string (status));
         return status;
     }
 
-    serialize_duplicate_entries (parent, sectionVal, name);
+    element.ce_context = context;
+    element.ce_index = visit->cv_elements->size ();
+    element.ce_retrieved = false;
+    visit->cv_elements->push_back (std::move (element));
 
-    return status;
+    return DISIR_STATUS_OK;
 }
 
 enum disir_status
-ConfigWriter::get_context_key (struct disir_context *context, std::string& key)
+ConfigWriter::get_elements (struct disir_context *context,
+                            std::vector<struct config_element>& elements)
+{
+    struct config_element_visit visit;
+
+    // The contexts are borrowed - the config is held for as long as they are written.
+    visit.cv_disir = m_disir;
+    visit.cv_elements = &elements;
+    return dc_foreach_element (context, NULL, visit_config_element, &visit);
+}
+
+enum disir_status
+ConfigWriter::get_children (struct config_element& element)
+{
+    if (element.ce_retrieved)
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    element.ce_retrieved = true;
+    return get_elements (element.ce_context, element.ce_children);
+}
+
+void
+ConfigWriter::put_elements (std::vector<struct config_element>& elements)
+{
+    // The contexts are borrowed; only the elements themselves are released.
+    elements.clear ();
+}
+
+//! Order elements by name, the way Json::Value orders its members.
+static bool
+config_element_name_less (const char *name, int32_t size, const char *other, int32_t other_size)
+{
+    int comparison;
+
+    comparison = memcmp (name, other, (size < other_size ? size : other_size));
+    if (comparison != 0)
+    {
+        return comparison < 0;
+    }
+
+    return size < other_size;
+}
+
+enum disir_status
+ConfigWriter::write_object (JsonWriter& writer, std::vector<struct config_element>& elements,
+                            bool ordered)
 {
-    const char *name;
-    int32_t size;
     enum disir_status status;
+    std::vector<struct config_element *> sorted;
+    std::vector<std::pair<size_t, size_t>> groups;
+    std::vector<struct config_element *> entries;
+    std::string name;
+    size_t start;
+    size_t i;
 
-    status = dc_get_name (context, &name, &size);
-    if (status != DISIR_STATUS_OK) {
-        // Should not happen
-        disir_error_set (m_disir, "Disir returned an error from dc_get_name: %s",
-                                   disir_status_string (status));
-        return status;
+    // Group elements of identical name. The groups are written in order of name,
+    // or in order of the first element in each group.
+    sorted.reserve (elements.size ());
+    for (auto& element : elements)
+    {
+        sorted.push_back (&element);
+    }
+
+    std::stable_sort (sorted.begin (), sorted.end (),
+                      [] (struct config_element *a, struct config_element *b)
+                      {
+                          return config_element_name_less (a->ce_name, a->ce_name_size,
+                                                           b->ce_name, b->ce_name_size);
+                      });
+
+    start = 0;
+    for (i = 1; i <= sorted.size (); i++)
+    {
+        if (i == sorted.size ()
+            || config_element_name_less (sorted[start]->ce_name, sorted[start]->ce_name_size,
+                                         sorted[i]->ce_name, sorted[i]->ce_name_size))
+        {
+            groups.push_back (std::make_pair (start, i));
+            start = i;
+        }
+    }
+
+    if (ordered)
+    {
+        std::sort (groups.begin (), groups.end (),
+                   [&sorted] (const std::pair<size_t, size_t>& a,
+                              const std::pair<size_t, size_t>& b)
+                   {
+                       return sorted[a.first]->ce_index < sorted[b.first]->ce_index;
+                   });
+    }
+
+    writer.write_with_indent ("{");
+    writer.indent ();
+
+    status = DISIR_STATUS_OK;
+    for (i = 0; i < groups.size (); i++)
+    {
+        if (i > 0)
+        {
+            writer.write (",", 1);
+        }
+
+        struct config_element& first = *sorted[groups[i].first];
+
+        name.assign (first.ce_name, first.ce_name_size);
+        m_value.clear ();
+        JsonWriter::format_string (m_value, name.c_str ());
+        writer.write_with_indent (m_value);
+        writer.write (" : ", 3);
+
+        if (groups[i].second - groups[i].first == 1)
+        {
+            status = write_element (writer, first, ordered);
+        }
+        else
+        {
+            entries.assign (sorted.begin () + groups[i].first,
+                            sorted.begin () + groups[i].second);
+            status = write_entries (writer, entries);
+        }
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
     }
 
-    key = std::string (name, size);
+    writer.unindent ();
+    writer.write_with_indent ("}");
 
     return status;
 }
 
-void
-ConfigWriter::serialize_duplicate_entries (Json::Value& parent,
-                                           Json::Value& child, const std::string name)
+enum disir_status
+ConfigWriter::write_element (JsonWriter& writer, struct config_element& element, bool ordered)
 {
-    Json::Value entries;
+    enum disir_status status;
+
+    if (element.ce_type == DISIR_CONTEXT_KEYVAL)
+    {
+        status = format_keyval (element.ce_context);
+        if (status == DISIR_STATUS_OK)
+        {
+            writer.write (m_value);
+        }
+        return status;
+    }
 
-    if (parent[name].isArray())
+    status = get_children (element);
+    if (status != DISIR_STATUS_OK)
     {
-        parent[name].append (child);
+        return status;
     }
-    else if (parent[name].isNull() == false)
+
+    // A section without any children is written as an empty object, that way
+    // we indicate in the serialized configuration that this section exists.
+    if (element.ce_children.empty ())
     {
-        entries = Json::arrayValue;
-        entries.append (parent[name]);
-        entries.append (child);
-        child = entries;
-        parent[name] = child;
+        writer.write ("{}", 2);
     }
     else
     {
-        parent[name] = child;
+        status = write_object (writer, element.ce_children, ordered);
     }
+
+    // The children are not needed any more once written
+    put_elements (element.ce_children);
+
+    return status;
+}
+
+enum disir_status
+ConfigWriter::write_entries (JsonWriter& writer, std::vector<struct config_element *>& entries)
+{
+    enum disir_status status;
+    std::vector<std::string> values;
+    bool multiline;
+    size_t i;
+
+    // An array is written on multiple lines if it holds too many values,
+    // if any of them is a non-empty section, or if the line would be too long.
+    multiline = (entries.size () * 3 >= JSON_WRITER_RIGHT_MARGIN);
+    for (i = 0; i < entries.size () && multiline == false; i++)
+    {
+        if (entries[i]->ce_type == DISIR_CONTEXT_SECTION)
+        {
+            status = get_children (*entries[i]);
+            if (status != DISIR_STATUS_OK)
+            {
+                return status;
+            }
+            if (entries[i]->ce_children.empty () == false)
+            {
+                multiline = true;
+                break;
+            }
+            values.push_back ("{}");
+        }
+        else
+        {
+            status = format_keyval (entries[i]->ce_context);
+            if (status != DISIR_STATUS_OK)
+            {
+                return status;
+            }
+            values.push_back (m_value);
+        }
+    }
+
+    if (multiline == false && JsonWriter::fits_single_line (values))
+    {
+        writer.write ("[ ", 2);
+        for (i = 0; i < values.size (); i++)
+        {
+            if (i > 0)
+            {
+                writer.write (", ", 2);
+            }
+            writer.write (values[i]);
+        }
+        writer.write (" ]", 2);
+        return DISIR_STATUS_OK;
+    }
+
+    writer.write_with_indent ("[");
+    writer.indent ();
+    for (i = 0; i < entries.size (); i++)
+    {
+        if (i > 0)
+        {
+            writer.write (",", 1);
+        }
+
+        // Sections within arrays have their members ordered by name
+        writer.write_indent ();
+        status = write_element (writer, *entries[i], false);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+    }
+    writer.unindent ();
+    writer.write_with_indent ("]");
+
+    return DISIR_STATUS_OK;
 }
 
 // Wraps libdisir dc_get_value to handle arbitrary value sizes
 enum disir_status
-ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json::Value& node)
+ConfigWriter::format_keyval (struct disir_context *context)
 {
     enum disir_status status;
     enum disir_value_type type;
@@ -199,9 +454,10 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
     double floatval;
     int64_t intval;
     const char *stringval;
+    const char *name;
     uint8_t boolval;
-    std::string buf;
-    Json::Value keyval;
+
+    m_value.clear ();
 
     status = dc_get_value_type (context, &type);
     if (status != DISIR_STATUS_OK)
@@ -219,7 +475,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = stringval;
+            JsonWriter::format_string (m_value, stringval);
             break;
         case DISIR_VALUE_TYPE_INTEGER:
             status = dc_get_value_integer (context, &intval);
@@ -228,7 +484,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = (Json::Int64)intval;
+            JsonWriter::format_integer (m_value, intval);
             break;
         case DISIR_VALUE_TYPE_FLOAT:
             status = dc_get_value_float (context, &floatval);
@@ -237,7 +493,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = floatval;
+            JsonWriter::format_real (m_value, floatval);
             break;
         case DISIR_VALUE_TYPE_BOOLEAN:
             status = dc_get_value_boolean (context, &boolval);
@@ -246,7 +502,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = !!boolval;
+            m_value = (boolval ? "true" : "false");
             break;
         case DISIR_VALUE_TYPE_ENUM:
             status = dc_get_value_enum (context, &stringval, NULL);
@@ -254,110 +510,27 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
             {
                 goto error;
             }
-            keyval = stringval;
+
+            JsonWriter::format_string (m_value, stringval);
             break;
         case DISIR_VALUE_TYPE_UNKNOWN:
             // If type is not know, we mark it
             // as unkwnown
-            keyval = dc_value_type_string (context);
+            JsonWriter::format_string (m_value, dc_value_type_string (context));
             break;
         default:
             // HUH? Type not supported?
             disir_error_set (m_disir, "Got an unsupported disir value type: %s",
                                        dc_value_type_string (context));
+            m_value = "null";
             break;
     }
 
-    serialize_duplicate_entries (node, keyval, name);
-
     return status;
 error:
+    name = "";
+    dc_get_name (context, &name, &size);
     disir_error_set (m_disir, "Unable to fetch value from keyval with name: %s and type %s",
-                               name.c_str(), dc_value_type_string (context));
+                               name, dc_value_type_string (context));
     return status;
 }
-
-enum disir_status
-ConfigWriter::serialize_keyval (struct disir_context *context, Json::Value& node)
-{
-    enum disir_status status;
-    std::string name;
-    status = get_context_key (context, name);
-    if (status != DISIR_STATUS_OK)
-    {
-       return status;
-    }
-
-    return set_keyval (context, name, node);
-}
-
-enum disir_status
-ConfigWriter::_serialize_context (struct disir_context *parent_context, Json::Value& parent)
-{
-    struct disir_collection *collection;
-    struct disir_context *child_context;
-    enum disir_status status;
-
-    child_context = NULL;
-
-    status = dc_get_elements (parent_context, &collection);
-    if (status != DISIR_STATUS_OK)
-    {
-        goto end;
-    }
-
-    status = DISIR_STATUS_OK;
-
-    while (dc_collection_next (collection, &child_context)
-           != DISIR_STATUS_EXHAUSTED)
-    {
-        // per-iteration such that child values
-        // never have old references to pre-marshaled
-        // context objects
-        Json::Value child;
-
-        switch (dc_context_type (child_context))
-        {
-            case DISIR_CONTEXT_SECTION:
-
-                // Initialize child to an empty object, that way we indicate
-                // in the serialized configuration that this section exists,
-                // it just didnt have any children
-                child = Json::objectValue;
-                status = _serialize_context (child_context, child);
-                if (status != DISIR_STATUS_OK)
-                {
-                    goto end;
-                }
-
-                status = set_section_keyname (child_context, parent, child);
-                if (status != DISIR_STATUS_OK)
-                {
-                    // logged
-                    return status;
-                }
-                break;
-            case DISIR_CONTEXT_KEYVAL:
-                status = serialize_keyval (child_context, parent);
-                if (status != DISIR_STATUS_OK)
-                {
-                    goto end;
-                }
-                break;
-            default:
-                break;
-        }
-        dc_putcontext (&child_context);
-    }
-
-end:
-    if (child_context)
-    {
-        dc_putcontext (&child_context);
-    }
-
-    dc_collection_finished (&collection);
-
-    return status;
-}
-
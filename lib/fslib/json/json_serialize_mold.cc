@@ -77,7 +77,6 @@ MoldWriter::serialize (struct disir_mold *mold, std::string& mold_json)
 {
     struct disir_context *context_mold;
     enum disir_status status;
-    Json::StyledWriter writer;
     Json::Value root;
 
     if (mold == NULL)
@@ -102,7 +101,11 @@ MoldWriter::serialize (struct disir_mold *mold, std::string& mold_json)
     if (status != DISIR_STATUS_OK)
         goto end;
 
-    mold_json = writer.writeOrdered (root);
+    mold_json.clear ();
+    {
+        JsonWriter writer (mold_json);
+        writer.write_document (root);
+    }
 
 end:
     dc_putcontext (&context_mold);
@@ -114,7 +117,6 @@ MoldWriter::serialize (struct disir_mold *mold, std::ostream& stream)
 {
     struct disir_context *context_mold;
     enum disir_status status;
-    Json::StyledWriter writer;
     Json::Value root;
 
     context_mold = dc_mold_getcontext (mold);
@@ -133,7 +135,17 @@ MoldWriter::serialize (struct disir_mold *mold, std::ostream& stream)
     if (status != DISIR_STATUS_OK)
         goto end;
 
-    stream << writer.writeOrdered (root);
+    {
+        // Laid out directly into the stream, without an intermediate string
+        JsonWriter writer (stream);
+
+        writer.write_document (root);
+        if (writer.flush () == false)
+        {
+            disir_error_set (m_disir, "failed to write serialized mold to stream");
+            status = DISIR_STATUS_FS_ERROR;
+        }
+    }
 
 end:
     dc_putcontext (&context_mold);
@@ -368,77 +380,81 @@ out:
     return status;
 }
 
+//! Element being serialized by MoldWriter::_serialize_mold_contexts.
+struct mold_element_visit
+{
+    MoldWriter *mv_writer;
+    Json::Value *mv_parent;
+};
+
 enum disir_status
-MoldWriter::_serialize_mold_contexts (struct disir_context *parent_context, Json::Value& parent)
+MoldWriter::visit_mold_element (struct disir_context *context, void *userdata)
+{
+    struct mold_element_visit *visit;
+
+    visit = static_cast<struct mold_element_visit *> (userdata);
+
+    return visit->mv_writer->serialize_mold_element (context, *visit->mv_parent);
+}
+
+enum disir_status
+MoldWriter::serialize_mold_element (struct disir_context *context, Json::Value& parent)
 {
-    struct disir_collection *coll;
-    struct disir_context *context;
     enum disir_status status;
     Json::Value child;
     const char *name;
     int32_t size;
 
-    status = DISIR_STATUS_OK;
-
-    status = dc_get_elements (parent_context, &coll);
-    if (status != DISIR_STATUS_OK)
+    switch (dc_context_type (context))
     {
-        return status;
-    }
+        case DISIR_CONTEXT_KEYVAL:
+            status = serialize_mold_keyval (context, child);
+            if (status != DISIR_STATUS_OK)
+                return status;
 
-    while (dc_collection_next (coll, &context)
-            != DISIR_STATUS_EXHAUSTED)
-    {
-        switch (dc_context_type (context))
-        {
-            case DISIR_CONTEXT_KEYVAL:
-                status = serialize_mold_keyval (context, child);
-                if (status != DISIR_STATUS_OK)
-                    goto end;
-
-                break;
-            case DISIR_CONTEXT_SECTION:
-                status = serialize_attributes (context, child, DISIR_CONTEXT_SECTION);
-                if (status != DISIR_STATUS_OK)
-                {
-                    return status;
-                }
-
-                status = serialize_restrictions (context, child);
-                if (status != DISIR_STATUS_OK)
-                {
-                    return status;
-                }
-
-                status = _serialize_mold_contexts (context, child[ATTRIBUTE_KEY_ELEMENTS]);
-                if (status != DISIR_STATUS_OK)
-                    goto end;
-
-                break;
-            default:
-                disir_error_set (m_disir, "Got unrecognizable context object: %s",
-                                           dc_value_type_string (context));
-                goto end;
-        }
+            break;
+        case DISIR_CONTEXT_SECTION:
+            status = serialize_attributes (context, child, DISIR_CONTEXT_SECTION);
+            if (status != DISIR_STATUS_OK)
+            {
+                return status;
+            }
 
-        status = dc_get_name (context, &name, &size);
-        if (status != DISIR_STATUS_OK)
-            goto end;
+            status = serialize_restrictions (context, child);
+            if (status != DISIR_STATUS_OK)
+            {
+                return status;
+            }
 
-        parent[name] = child;
-        child = Json::nullValue;
+            status = _serialize_mold_contexts (context, child[ATTRIBUTE_KEY_ELEMENTS]);
+            if (status != DISIR_STATUS_OK)
+                return status;
 
-        dc_putcontext (&context);
-    }
-end:
-    if (context)
-    {
-        dc_putcontext (&context);
+            break;
+        default:
+            disir_error_set (m_disir, "Got unrecognizable context object: %s",
+                                       dc_value_type_string (context));
+            return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    dc_collection_finished (&coll);
+    status = dc_get_name (context, &name, &size);
+    if (status != DISIR_STATUS_OK)
+        return status;
 
-    return status;
+    parent[name] = child;
+
+    return DISIR_STATUS_OK;
+}
+
+enum disir_status
+MoldWriter::_serialize_mold_contexts (struct disir_context *parent_context, Json::Value& parent)
+{
+    struct mold_element_visit visit;
+
+    // The elements are borrowed from the mold being serialized.
+    visit.mv_writer = this;
+    visit.mv_parent = &parent;
+    return dc_foreach_element (parent_context, NULL, visit_mold_element, &visit);
 }
 
 // Wraps libdisir dc_get_value to handle arbitrary value sizes
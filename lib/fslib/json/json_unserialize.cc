@@ -15,13 +15,40 @@ enum disir_status
 dio_json_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config)
 {
+    enum disir_status status;
+    struct fslib_file_buffer buffer;
+
     disir_log_user (instance, "TRACE ENTER dio_json_unserialize_config");
+
+    status = fslib_file_buffer_read (instance, input, &buffer);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = dio_json_unserialize_config_buffer (instance, buffer.fb_data, buffer.fb_size,
+                                                 mold, config);
+
+    fslib_file_buffer_release (&buffer);
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+dio_json_unserialize_config_buffer (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config)
+{
+    if (instance == NULL || (data == NULL && size != 0) || mold == NULL || config == NULL)
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
     try
     {
-        boost::fdistream file(fileno(input));
         dio::ConfigReader reader (instance, mold);
 
-        return reader.unserialize (config, file);
+        return reader.unserialize (config, data, data + size);
     }
     catch (std::exception& e)
     {
@@ -37,22 +64,31 @@ enum disir_status
 dio_json_unserialize_mold (struct disir_instance *instance,
                            FILE *input, struct disir_mold **mold)
 {
+    enum disir_status status;
+    struct fslib_file_buffer buffer;
+
     disir_log_user (instance, "TRACE ENTER dio_json_unserialize_mold");
 
+    status = fslib_file_buffer_read (instance, input, &buffer);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
     try
     {
-        boost::fdistream file(fileno(input));
         dio::MoldReader reader (instance);
 
-        return reader.unserialize (file, mold);
+        status = reader.unserialize (buffer.fb_data, buffer.fb_data + buffer.fb_size, mold);
     }
     catch (std::exception& e)
     {
         disir_log_user (instance, "JSON: fatal exception in unserialize_mold");
-        return DISIR_STATUS_INTERNAL_ERROR;
+        status = DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    return DISIR_STATUS_OK;
+    fslib_file_buffer_release (&buffer);
+    return status;
 }
 
 enum disir_status
@@ -114,6 +150,7 @@ dio_json_unserialize_mold_filepath (struct disir_instance *instance,
     struct stat statbuf;
     FILE *mold_file = NULL;
     FILE *override_file = NULL;
+    char errbuf[256];
 
     disir_log_user (instance, "TRACE ENTER dio_json_unserialize_mold");
 
@@ -127,7 +164,8 @@ dio_json_unserialize_mold_filepath (struct disir_instance *instance,
     mold_file = fopen (filepath, "r");
     if (mold_file == NULL)
     {
-        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+        disir_error_set (instance, "opening for reading %s: %s", filepath,
+                         fslib_strerror (errno, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
@@ -136,7 +174,8 @@ dio_json_unserialize_mold_filepath (struct disir_instance *instance,
         override_file = fopen (override_filepath, "r");
         if (override_file == NULL)
         {
-            disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+            disir_error_set (instance, "opening for reading %s: %s", filepath,
+                             fslib_strerror (errno, errbuf, sizeof (errbuf)));
             status = DISIR_STATUS_FS_ERROR;
             goto out;
         }
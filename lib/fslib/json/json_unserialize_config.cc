@@ -7,7 +7,9 @@
 // standard
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <stdint.h>
+#include <unordered_map>
 
 
 #define VERSION "version"
@@ -26,47 +28,79 @@ ConfigReader::ConfigReader (struct disir_instance *disir, struct disir_mold *mol
 enum disir_status
 ConfigReader::unserialize (struct disir_config **config, std::istream& stream)
 {
-    Json::Reader reader;
-    Json::Value root;
+    std::string document ((std::istreambuf_iterator<char> (stream)),
+                          std::istreambuf_iterator<char> ());
 
-    bool success = reader.parse (stream, root);
-
-    if (!success)
-    {
-        disir_error_set (m_disir, "Parse error: %s",
-                                   reader.getFormattedErrorMessages ().c_str());
-        return DISIR_STATUS_FS_ERROR;
-    }
-
-    return construct_config (root, config);
+    return unserialize (config, document.data (), document.data () + document.size ());
 }
 
 //! PUBLIC
 enum disir_status
 ConfigReader::unserialize (struct disir_config **config, const std::string string)
 {
-    Json::Reader reader;
-    Json::Value root;
+    return unserialize (config, string.data (), string.data () + string.size ());
+}
+
+//! PUBLIC
+enum disir_status
+ConfigReader::unserialize (struct disir_config **config, const char *begin, const char *end)
+{
+    JsonLexer lexer (begin, end);
 
-    bool success = reader.parse (string, root);
-    if (!success)
+    // Validate the whole document first, so no context is created for a broken one.
+    if (lexer.validate () == false)
     {
-        disir_error_set (m_disir, "Parse error: %s",
-                                   reader.getFormattedErrorMessages ().c_str());
+        if (lexer.depth_exceeded ())
+        {
+            disir_log_user (m_disir, "JSON: %s", lexer.error_message ().c_str ());
+            return DISIR_STATUS_INTERNAL_ERROR;
+        }
+
+        disir_error_set (m_disir, "Parse error: %s", lexer.error_message ().c_str ());
         return DISIR_STATUS_FS_ERROR;
     }
 
-    return construct_config (root, config);
+    lexer.seek (begin);
+    return construct_config (lexer, config);
 }
 
 enum disir_status
-ConfigReader::construct_config (Json::Value& root, struct disir_config **config)
+ConfigReader::construct_config (JsonLexer& lexer, struct disir_config **config)
 {
     enum disir_status status;
     struct disir_context *context_config = NULL;
+    const struct json_object *object = NULL;
+    const struct json_member *version = NULL;
+    const struct json_member *config_root = NULL;
+    struct json_token token;
+    size_t i;
 
     *config = NULL;
 
+    // Only an object can hold the config. A null document reads as an empty object.
+    lexer.read_token_skip_comments (token);
+    if (token.jt_type != JSON_TOKEN_OBJECT_BEGIN && token.jt_type != JSON_TOKEN_NULL)
+    {
+        disir_log_user (m_disir, "JSON: config document is not an object");
+        return DISIR_STATUS_INTERNAL_ERROR;
+    }
+
+    if (token.jt_type == JSON_TOKEN_OBJECT_BEGIN)
+    {
+        object = lexer.read_members ();
+    }
+
+    // The last occurrence of a duplicate member is the one that counts.
+    for (i = 0; object != NULL && i < object->jo_count; i++)
+    {
+        const struct json_member& member = lexer.member (object->jo_first + i);
+
+        if (member.jm_name == VERSION)
+            version = &member;
+        else if (member.jm_name == ATTRIBUTE_KEY_CONFIG)
+            config_root = &member;
+    }
+
     status = dc_config_begin (m_mold, &context_config);
     if (status != DISIR_STATUS_OK)
     {
@@ -74,7 +108,11 @@ ConfigReader::construct_config (Json::Value& root, struct disir_config **config)
         goto error;
     }
 
-    status = set_config_version (context_config, root[VERSION]);
+    if (version)
+    {
+        lexer.seek (version->jm_value);
+    }
+    status = set_config_version (context_config, (version ? &lexer : NULL));
     if (status != DISIR_STATUS_OK && status == DISIR_STATUS_INVALID_CONTEXT)
     {
        goto finalize;
@@ -84,13 +122,18 @@ ConfigReader::construct_config (Json::Value& root, struct disir_config **config)
         goto error;
     }
 
-    if (assert_json_value_type (root[ATTRIBUTE_KEY_CONFIG], Json::objectValue))
+    if (config_root)
+    {
+        lexer.seek (config_root->jm_value);
+        lexer.read_token_skip_comments (token);
+    }
+    if (config_root == NULL || token.jt_type != JSON_TOKEN_OBJECT_BEGIN)
     {
         dc_fatal_error (context_config, "config does not contain config element");
         goto finalize;
     }
 
-    status = _unserialize_node (context_config, root[ATTRIBUTE_KEY_CONFIG]);
+    status = _unserialize_node (context_config, lexer);
     if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
         goto error;
 
@@ -114,36 +157,36 @@ error:
 }
 
 enum disir_status
-ConfigReader::set_config_version (struct disir_context *context_config, Json::Value& ver)
+ConfigReader::set_config_version (struct disir_context *context_config, JsonLexer *lexer)
 {
     struct disir_version version;
     struct disir_version mold_version;
     enum disir_status status;
-    const char *version_string;
+    struct json_token token;
+    struct json_number number;
+    Json::ValueType type;
+
+    type = Json::nullValue;
+    if (lexer)
+    {
+        lexer->read_token_skip_comments (token);
+        type = token_value_type (*lexer, token, number);
+    }
 
-    if (assert_json_value_type (ver, Json::stringValue) != DISIR_STATUS_OK)
+    if (type != Json::stringValue)
     {
         dc_fatal_error (context_config, "config version should be string, got %s",
-                                        json_valuetype_stringify (ver.type()));
+                                        json_valuetype_stringify (type));
         return DISIR_STATUS_INVALID_CONTEXT;
     }
 
-    // Absent version keyval
-    if (ver.isNull () || !ver.isString ())
+    lexer->decode_string (token, m_value);
+    status = dc_version_convert (m_value.c_str (), &version);
+    if (status != DISIR_STATUS_OK)
     {
-        version.sv_major = 1;
-        version.sv_minor = 0;
+        return status;
     }
-    else
-    {
-        version_string = ver.asCString ();
 
-        status = dc_version_convert (version_string, &version);
-        if (status != DISIR_STATUS_OK)
-        {
-            return status;
-        }
-    }
     status = dc_mold_get_version (m_mold, &mold_version);
     if (status != DISIR_STATUS_OK)
     {
@@ -159,14 +202,42 @@ ConfigReader::set_config_version (struct disir_context *context_config, Json::Va
     return dc_set_version (context_config, &version);
 }
 
+//! PRIVATE
+Json::ValueType
+ConfigReader::token_value_type (JsonLexer& lexer, struct json_token& token,
+                                struct json_number& number)
+{
+    switch (token.jt_type)
+    {
+    case JSON_TOKEN_OBJECT_BEGIN:
+        return Json::objectValue;
+    case JSON_TOKEN_ARRAY_BEGIN:
+        return Json::arrayValue;
+    case JSON_TOKEN_STRING:
+        return Json::stringValue;
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+        return Json::booleanValue;
+    case JSON_TOKEN_NUMBER:
+        lexer.decode_number (token, number);
+        if (number.jn_type == JSON_NUMBER_INTEGER)
+            return Json::intValue;
+        else if (number.jn_type == JSON_NUMBER_UNSIGNED)
+            return Json::uintValue;
+        return Json::realValue;
+    case JSON_TOKEN_NULL:
+    default:
+        return Json::nullValue;
+    }
+}
+
 //! PRIVATE
 enum disir_status
-ConfigReader::set_keyval (struct disir_context *parent_context,
-                          std::string name, Json::Value& keyval)
+ConfigReader::set_keyval (struct disir_context *parent_context, std::string& name,
+                          JsonLexer& lexer, struct json_token& token, struct json_number& number)
 {
     enum disir_status status;
     struct disir_context *context_keyval = NULL;
-    Json::Value val;
 
     status = dc_begin (parent_context, DISIR_CONTEXT_KEYVAL, &context_keyval);
     if (status != DISIR_STATUS_OK)
@@ -185,9 +256,45 @@ ConfigReader::set_keyval (struct disir_context *parent_context,
         goto error;
     }
 
+    // Same conversions as set_value applies to a Json::Value
+    switch (token.jt_type)
+    {
+    case JSON_TOKEN_NUMBER:
+        if (number.jn_type == JSON_NUMBER_REAL)
+        {
+            status = dc_set_value_float (context_keyval, number.jn_real);
+        }
+        else if (dc_value_type (context_keyval) == DISIR_VALUE_TYPE_FLOAT)
+        {
+            status = dc_set_value_float (context_keyval, (double) number.jn_integer);
+        }
+        else
+        {
+            status = dc_set_value_integer (context_keyval, number.jn_integer);
+        }
+        break;
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+        status = dc_set_value_boolean (context_keyval, token.jt_type == JSON_TOKEN_TRUE);
+        break;
+    case JSON_TOKEN_STRING:
+        lexer.decode_string (token, m_value);
+        if (dc_value_type (context_keyval) == DISIR_VALUE_TYPE_ENUM)
+        {
+            status = dc_set_value_enum (context_keyval, m_value.c_str (), m_value.size ());
+        }
+        else
+        {
+            status = dc_set_value_string (context_keyval, m_value.c_str (), m_value.size ());
+        }
+        break;
+    default:
+        status = DISIR_STATUS_WRONG_VALUE_TYPE;
+        break;
+    }
+
     // If wrong value type is set, we can continue
     // , but set_value returns invalid context
-    status = set_value (context_keyval, keyval);
     if (status != DISIR_STATUS_OK &&
         status != DISIR_STATUS_INVALID_CONTEXT &&
         status != DISIR_STATUS_WRONG_VALUE_TYPE)
@@ -222,29 +329,46 @@ error:
 
 
 enum disir_status
-ConfigReader::unserialize_array (struct disir_context *parent, Json::Value& array, std::string& name)
+ConfigReader::unserialize_array (struct disir_context *parent, JsonLexer& lexer,
+                                 std::string& name)
 {
     enum disir_status status;
-    unsigned int i;
+    struct json_token token;
 
-    for (i = 0; i < array.size (); ++i)
+    // The document is already validated; only the shape of the walk matters here.
+    if (lexer.peek (']'))
     {
-        status = unserialize_type (parent, array[i], name);
+        lexer.read_token (token);
+        return DISIR_STATUS_OK;
+    }
+
+    while (1)
+    {
+        status = unserialize_type (parent, lexer, name);
         if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
         {
             return status;
         }
+
+        lexer.read_token_skip_comments (token);
+        if (token.jt_type == JSON_TOKEN_ARRAY_END)
+            break;
     }
     return DISIR_STATUS_OK;
 }
 
 enum disir_status
-ConfigReader::unserialize_type (struct disir_context *context, Json::Value& value, std::string& name)
+ConfigReader::unserialize_type (struct disir_context *context, JsonLexer& lexer,
+                                std::string& name)
 {
    struct disir_context *child_context = NULL;
    enum disir_status status;
+   struct json_token token;
+   struct json_number number;
 
-    switch (value.type ())
+    lexer.read_token_skip_comments (token);
+
+    switch (token_value_type (lexer, token, number))
     {
     case Json::objectValue:
         status = dc_begin (context, DISIR_CONTEXT_SECTION, &child_context);
@@ -265,11 +389,11 @@ ConfigReader::unserialize_type (struct disir_context *context, Json::Value& valu
             goto error;
         }
 
-        status = _unserialize_node (child_context, value);
+        status = _unserialize_node (child_context, lexer);
         if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
         {
             // logged
-            return status;
+            goto error;
         }
 
         status = dc_finalize (&child_context);
@@ -289,7 +413,7 @@ ConfigReader::unserialize_type (struct disir_context *context, Json::Value& valu
         }
         break;
     case Json::arrayValue:
-        status = unserialize_array (context, value, name);
+        status = unserialize_array (context, lexer, name);
         if (status != DISIR_STATUS_OK)
         {
             // logged
@@ -297,10 +421,10 @@ ConfigReader::unserialize_type (struct disir_context *context, Json::Value& valu
         }
         break;
     case Json::intValue:
-    case Json::stringValue:
     case Json::realValue:
+    case Json::stringValue:
     case Json::booleanValue:
-        status = set_keyval (context, name, value);
+        status = set_keyval (context, name, lexer, token, number);
         if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
         {
             goto error;
@@ -321,27 +445,45 @@ error:
 
 //! PRIVATE
 enum disir_status
-ConfigReader::_unserialize_node (struct disir_context *parent_context, Json::Value& parent)
+ConfigReader::_unserialize_node (struct disir_context *parent_context, JsonLexer& lexer)
 {
     enum disir_status status;
-    Json::Value child_node;
+    const struct json_object *object;
+    std::unordered_map<std::string, size_t> last;
+    std::unordered_map<std::string, size_t>::iterator it;
+    std::string name;
+    const char *end;
+    size_t i;
 
     status = DISIR_STATUS_OK;
 
-    Json::OrderedValueIterator iter = parent.beginOrdered ();
+    object = lexer.read_members ();
+    if (object == NULL)
+        return DISIR_STATUS_INTERNAL_ERROR;
+    end = lexer.position ();
 
-    for (; iter != parent.endOrdered (); ++iter)
+    // As when the document was read into a Json::Value, a duplicate member
+    // keeps the position of its first occurrence and the value of its last.
+    for (i = object->jo_first; i < object->jo_first + object->jo_count; i++)
     {
-        // Getting value of element
-        child_node = *iter;
+        last[lexer.member (i).jm_name] = i;
+    }
+
+    for (i = object->jo_first; i < object->jo_first + object->jo_count; i++)
+    {
+        it = last.find (lexer.member (i).jm_name);
+        if (it->second == SIZE_MAX)
+            continue;
 
-        auto name = iter.name ();
+        name = it->first;
+        lexer.seek (lexer.member (it->second).jm_value);
+        it->second = SIZE_MAX;
 
-        status = unserialize_type (parent_context, child_node, name);
+        status = unserialize_type (parent_context, lexer, name);
         if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
             break;
     }
 
+    lexer.seek (end);
     return status;
 }
-
@@ -61,6 +61,23 @@ MoldReader::unserialize (std::string mold_json, struct disir_mold **mold)
     return construct_mold (mold);
 }
 
+//! PUBLIC
+enum disir_status
+MoldReader::unserialize (const char *begin, const char *end, struct disir_mold **mold)
+{
+    Json::Reader reader;
+
+    bool success = reader.parse (begin, end, m_moldRoot);
+    if (!success)
+    {
+        disir_error_set (m_disir, "Parse error: %s",
+                                  reader.getFormattedErrorMessages().c_str());
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return construct_mold (mold);
+}
+
 //! PUBLIC
 enum disir_status
 MoldReader::unserialize (std::istream& stream, struct disir_mold **mold)
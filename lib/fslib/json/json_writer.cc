@@ -0,0 +1,385 @@
+// JSON private
+#include "json/json_writer.h"
+
+// standard
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace dio;
+
+JsonWriter::JsonWriter (std::ostream& stream)
+    : m_buffer (JSON_WRITER_BUFFER_SIZE), m_stream (&stream)
+{
+}
+
+JsonWriter::JsonWriter (std::string& output)
+    : m_buffer (JSON_WRITER_BUFFER_SIZE), m_output (&output)
+{
+}
+
+JsonWriter::~JsonWriter ()
+{
+    flush ();
+}
+
+bool
+JsonWriter::flush ()
+{
+    if (m_used == 0 || m_failed)
+    {
+        m_used = 0;
+        return !m_failed;
+    }
+
+    if (m_output)
+    {
+        m_output->append (m_buffer.data (), m_used);
+    }
+    else
+    {
+        m_stream->write (m_buffer.data (), m_used);
+        m_failed = m_stream->fail ();
+    }
+
+    m_used = 0;
+    return !m_failed;
+}
+
+void
+JsonWriter::write (const char *data, size_t size)
+{
+    size_t chunk;
+
+    if (size == 0)
+        return;
+
+    m_last = data[size - 1];
+
+    while (size > 0)
+    {
+        if (m_used == m_buffer.size ())
+        {
+            flush ();
+        }
+
+        chunk = m_buffer.size () - m_used;
+        if (chunk > size)
+        {
+            chunk = size;
+        }
+
+        memcpy (m_buffer.data () + m_used, data, chunk);
+        m_used += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void
+JsonWriter::write_indent ()
+{
+    if (m_last != 0)
+    {
+        // Already indented
+        if (m_last == ' ')
+            return;
+        if (m_last != '\n')
+            write ("\n", 1);
+    }
+
+    write (m_indent);
+}
+
+void
+JsonWriter::write_with_indent (const std::string& string)
+{
+    write_indent ();
+    write (string);
+}
+
+void
+JsonWriter::indent ()
+{
+    m_indent.append (JSON_WRITER_INDENT_SIZE, ' ');
+}
+
+void
+JsonWriter::unindent ()
+{
+    m_indent.resize (m_indent.size () - JSON_WRITER_INDENT_SIZE);
+}
+
+void
+JsonWriter::write_document (const Json::Value& root)
+{
+    write_value (root, true);
+    write ("\n", 1);
+}
+
+//! PRIVATE
+void
+JsonWriter::write_value (const Json::Value& value, bool ordered)
+{
+    std::string scalar;
+
+    switch (value.type ())
+    {
+    case Json::arrayValue:
+        write_array (value);
+        break;
+    case Json::objectValue:
+    {
+        // Members of objects within arrays are ordered by name, as Json::StyledWriter does.
+        Json::Value::Members members (ordered ? value.getMemberNamesOrdered ()
+                                              : value.getMemberNames ());
+        if (members.empty ())
+        {
+            write ("{}", 2);
+            break;
+        }
+
+        write_with_indent ("{");
+        indent ();
+        for (auto it = members.begin (); it != members.end (); ++it)
+        {
+            if (it != members.begin ())
+            {
+                write (",", 1);
+            }
+
+            scalar.clear ();
+            format_string (scalar, it->c_str ());
+            write_with_indent (scalar);
+            write (" : ", 3);
+            write_value (value[*it], ordered);
+        }
+        unindent ();
+        write_with_indent ("}");
+        break;
+    }
+    default:
+        format_scalar (scalar, value);
+        write (scalar);
+        break;
+    }
+}
+
+//! PRIVATE
+void
+JsonWriter::write_array (const Json::Value& value)
+{
+    std::vector<std::string> values;
+    Json::ArrayIndex index;
+    bool multiline;
+
+    if (value.size () == 0)
+    {
+        write ("[]", 2);
+        return;
+    }
+
+    multiline = false;
+    for (index = 0; index < value.size (); index++)
+    {
+        const Json::Value& child = value[index];
+
+        if ((child.isArray () || child.isObject ()) && child.size () > 0)
+        {
+            multiline = true;
+            break;
+        }
+
+        values.emplace_back ();
+        if (child.isArray ())
+            values.back () = "[]";
+        else if (child.isObject ())
+            values.back () = "{}";
+        else
+            format_scalar (values.back (), child);
+    }
+
+    if (multiline || fits_single_line (values) == false)
+    {
+        write_with_indent ("[");
+        indent ();
+        for (index = 0; index < value.size (); index++)
+        {
+            if (index > 0)
+            {
+                write (",", 1);
+            }
+            write_indent ();
+            write_value (value[index], false);
+        }
+        unindent ();
+        write_with_indent ("]");
+        return;
+    }
+
+    write ("[ ", 2);
+    for (index = 0; index < values.size (); index++)
+    {
+        if (index > 0)
+        {
+            write (", ", 2);
+        }
+        write (values[index]);
+    }
+    write (" ]", 2);
+}
+
+//! PRIVATE
+void
+JsonWriter::format_scalar (std::string& out, const Json::Value& value)
+{
+    switch (value.type ())
+    {
+    case Json::intValue:
+        format_integer (out, value.asLargestInt ());
+        break;
+    case Json::uintValue:
+        format_unsigned (out, value.asLargestUInt ());
+        break;
+    case Json::realValue:
+        format_real (out, value.asDouble ());
+        break;
+    case Json::stringValue:
+        format_string (out, value.asCString ());
+        break;
+    case Json::booleanValue:
+        out += (value.asBool () ? "true" : "false");
+        break;
+    default:
+        out += "null";
+        break;
+    }
+}
+
+bool
+JsonWriter::fits_single_line (const std::vector<std::string>& values)
+{
+    size_t length;
+
+    if (values.size () * 3 >= JSON_WRITER_RIGHT_MARGIN)
+    {
+        return false;
+    }
+
+    // '[ ' + ', ' between each value + ' ]'
+    length = 4 + (values.size () - 1) * 2;
+    for (auto& value : values)
+    {
+        length += value.size ();
+    }
+
+    return length < JSON_WRITER_RIGHT_MARGIN;
+}
+
+void
+JsonWriter::format_string (std::string& out, const char *value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    const char *plain;
+
+    out += '"';
+
+    plain = value;
+    for (; *value != '\0'; value++)
+    {
+        const char *escape;
+        char unicode[7];
+
+        switch (*value)
+        {
+        case '"':   escape = "\\\""; break;
+        case '\\':  escape = "\\\\"; break;
+        case '\b':  escape = "\\b"; break;
+        case '\f':  escape = "\\f"; break;
+        case '\n':  escape = "\\n"; break;
+        case '\r':  escape = "\\r"; break;
+        case '\t':  escape = "\\t"; break;
+        default:
+            // Bytes above 0x7f are negative, and pass through like jsoncpp does
+            if (*value > 0 && *value <= 0x1f)
+            {
+                unicode[0] = '\\';
+                unicode[1] = 'u';
+                unicode[2] = '0';
+                unicode[3] = '0';
+                unicode[4] = hex[(*value >> 4) & 0xf];
+                unicode[5] = hex[*value & 0xf];
+                unicode[6] = '\0';
+                escape = unicode;
+                break;
+            }
+            continue;
+        }
+
+        out.append (plain, value - plain);
+        out += escape;
+        plain = value + 1;
+    }
+
+    out.append (plain, value - plain);
+    out += '"';
+}
+
+void
+JsonWriter::format_unsigned (std::string& out, uint64_t value)
+{
+    char buffer[24];
+    char *current;
+
+    current = buffer + sizeof (buffer);
+    do
+    {
+        *--current = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    out.append (current, buffer + sizeof (buffer) - current);
+}
+
+void
+JsonWriter::format_integer (std::string& out, int64_t value)
+{
+    if (value < 0)
+    {
+        out += '-';
+        format_unsigned (out, (uint64_t)0 - (uint64_t)value);
+        return;
+    }
+
+    format_unsigned (out, (uint64_t)value);
+}
+
+void
+JsonWriter::format_real (std::string& out, double value)
+{
+    char buffer[32];
+    int length;
+    int i;
+
+    if (isfinite (value))
+    {
+        length = snprintf (buffer, sizeof (buffer), "%.16g", value);
+    }
+    else if (value != value)
+    {
+        length = snprintf (buffer, sizeof (buffer), "null");
+    }
+    else
+    {
+        length = snprintf (buffer, sizeof (buffer), value < 0 ? "-1e+9999" : "1e+9999");
+    }
+
+    // Decimal separator of the current locale
+    for (i = 0; i < length; i++)
+    {
+        if (buffer[i] == ',')
+            buffer[i] = '.';
+    }
+
+    out.append (buffer, length);
+}
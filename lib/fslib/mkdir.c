@@ -10,6 +10,8 @@
 static enum disir_status
 handle_mkdir_errno (struct disir_instance *instance, const char *path, int errsave)
 {
+    char errbuf[256];
+
     if (errsave == EACCES)
     {
         disir_error_set (instance, "Insufficient access creating directory %s", path);
@@ -17,9 +19,8 @@ handle_mkdir_errno (struct disir_instance *instance, const char *path, int errsa
     }
     else if (errsave != EEXIST)
     {
-        // TODO: Use threadsafe strerror variant
         disir_error_set (instance, "Error creating directory %s: %s",
-                         path, strerror (errsave));
+                         path, fslib_strerror (errsave, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
@@ -6,11 +6,53 @@
 
 // system
 #include <algorithm>
+#include <condition_variable>
 #include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include <iostream>
 
+//! Upper limit on the number of threads scanning a single directory tree.
+#define FSLIB_SCAN_THREADS_MAX 8
+
+//! Regular files with the scanned suffix found in a single directory.
+struct scan_directory
+{
+    //! Path relative to the scan root, with a trailing slash. Empty for the root itself.
+    std::string             sd_path;
+    //! Names of the matching files in this directory, suffix included.
+    std::vector<std::string> sd_files;
+};
+
+//! State shared by all threads scanning the same directory tree.
+struct scan_state
+{
+    //! Directory descriptor of the scan root. Every scanned path is relative to it.
+    int                         ss_root;
+    //! Suffix a regular file must have to be reported.
+    const std::string           *ss_suffix;
+
+    std::mutex                  ss_mutex;
+    std::condition_variable     ss_cond;
+
+    //! Directories discovered, but not yet scanned.
+    std::vector<std::string>    ss_pending;
+    //! Number of threads currently scanning a directory.
+    int                         ss_active;
+    //! Directories holding at least one matching file.
+    std::vector<struct scan_directory> ss_directories;
+    //! The first directory we failed to open, if any.
+    std::string                 ss_failed;
+};
+
 //! STATIC API
 bool
 validate_entry_id_characters(std::string& entry_id)
@@ -30,34 +72,208 @@ validate_entry_id_characters(std::string& entry_id)
     return (illegal == entry_id.end());
 }
 
-//! FSLIB API
-enum disir_status
-fslib_config_query_entries (struct disir_instance *instance, struct disir_register_plugin *plugin,
-                            const char *basedir, struct disir_entry **entries)
+//! STATIC API
+//!
+//! Read a single directory, relative to the root directory descriptor.
+//! Matching files are added to directory, subdirectories to subdirectories.
+//!
+//! \return false if the directory could not be opened.
+//!
+static bool
+scan_read_directory (int root, const std::string& suffix, struct scan_directory& directory,
+                     std::vector<std::string>& subdirectories)
 {
-    enum disir_status status;
-    DIR *directory;
+    DIR *handle;
     struct dirent *dp;
-    struct disir_entry *entry;
-    struct disir_entry *mold_entry;
     struct stat statbuf;
+    size_t length;
+    int fd;
+    int type;
 
-    // File extension is always without the leading dot - add 1 for it
-    std::stringstream suffix_stream;
-    suffix_stream << "." << plugin->dp_config_entry_type;
-    std::string suffix = suffix_stream.str();
+    fd = openat (root, directory.sd_path.empty () ? "." : directory.sd_path.c_str (),
+                 O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
 
-    // Directory is a combinarion of plugin config_base_id and input basedir
-    std::stringstream sd;
-    sd << plugin->dp_config_base_id;
-    if (basedir)
+    handle = fdopendir (fd);
+    if (handle == NULL)
     {
-        sd << '/';
-        sd << basedir;
+        close (fd);
+        return false;
     }
-    std::string searchdir = sd.str();
 
-    // Stat if directory exists. If it does not, we try to create it
+    while ((dp = readdir (handle)) != NULL)
+    {
+        if (strcmp (dp->d_name, ".") == 0 || strcmp (dp->d_name, "..") == 0)
+            continue;
+
+        type = dp->d_type;
+        if (type == DT_UNKNOWN)
+        {
+            // Not every filesystem reports the entry type through readdir
+            if (fstatat (dirfd (handle), dp->d_name, &statbuf, AT_SYMLINK_NOFOLLOW) != 0)
+                continue;
+
+            if (S_ISREG (statbuf.st_mode))
+                type = DT_REG;
+            else if (S_ISDIR (statbuf.st_mode))
+                type = DT_DIR;
+        }
+
+        if (type == DT_REG)
+        {
+            length = strlen (dp->d_name);
+            if (length > suffix.size ()
+                && suffix.compare (0, suffix.size (), dp->d_name + length - suffix.size ()) == 0)
+            {
+                directory.sd_files.push_back (std::string (dp->d_name));
+            }
+        }
+        else if (type == DT_DIR)
+        {
+            subdirectories.push_back (directory.sd_path + dp->d_name + "/");
+        }
+    }
+
+    closedir (handle);
+
+    return true;
+}
+
+//! STATIC API
+//!
+//! Scan pending directories until every directory of the tree is scanned.
+//! Run by every thread participating in the scan, including the caller.
+//!
+static void
+scan_worker (struct scan_state *state)
+{
+    std::unique_lock<std::mutex> lock (state->ss_mutex);
+
+    while (1)
+    {
+        // Another thread may still discover more subdirectories while active.
+        state->ss_cond.wait (lock, [state] {
+            return (state->ss_pending.empty () == false || state->ss_active == 0);
+        });
+        if (state->ss_pending.empty ())
+            break;
+
+        struct scan_directory directory;
+        std::vector<std::string> subdirectories;
+        bool opened;
+
+        directory.sd_path = std::move (state->ss_pending.back ());
+        state->ss_pending.pop_back ();
+        state->ss_active++;
+
+        lock.unlock ();
+        opened = scan_read_directory (state->ss_root, *state->ss_suffix,
+                                      directory, subdirectories);
+        lock.lock ();
+
+        state->ss_active--;
+        if (opened == false && state->ss_failed.empty ())
+        {
+            state->ss_failed = directory.sd_path;
+        }
+        if (directory.sd_files.empty () == false)
+        {
+            state->ss_directories.push_back (std::move (directory));
+        }
+        for (auto& subdirectory : subdirectories)
+        {
+            state->ss_pending.push_back (std::move (subdirectory));
+        }
+
+        state->ss_cond.notify_all ();
+    }
+}
+
+//! STATIC API
+//!
+//! Recursively find every regular file ending with suffix beneath searchdir.
+//! The root directory is read by the calling thread. Its subdirectories are fanned out
+//! over a pool of up to FSLIB_SCAN_THREADS_MAX threads.
+//!
+//! \return DISIR_STATUS_FS_ERROR if searchdir cannot be opened.
+//! \return DISIR_STATUS_OK on success. A subdirectory that cannot be opened is
+//!     reported through the instance error, but is otherwise skipped.
+//!
+static enum disir_status
+scan_directory_tree (struct disir_instance *instance, const std::string& searchdir,
+                     const std::string& suffix, std::vector<struct scan_directory>& directories)
+{
+    struct scan_state state;
+    struct scan_directory root;
+    std::vector<std::thread> threads;
+    unsigned int count;
+
+    state.ss_root = open (searchdir.c_str (), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (state.ss_root == -1
+        || scan_read_directory (state.ss_root, suffix, root, state.ss_pending) == false)
+    {
+        if (state.ss_root != -1)
+            close (state.ss_root);
+        disir_error_set (instance, "Unable to open directory: %s", searchdir.c_str());
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    state.ss_suffix = &suffix;
+    state.ss_active = 0;
+    if (root.sd_files.empty () == false)
+    {
+        state.ss_directories.push_back (std::move (root));
+    }
+
+    // Only fan out when there is more than one directory left to scan.
+    count = std::thread::hardware_concurrency ();
+    count = std::min (count, (unsigned int) FSLIB_SCAN_THREADS_MAX);
+    count = std::min (count, (unsigned int) state.ss_pending.size ());
+    for (unsigned int i = 1; i < count; i++)
+    {
+        try
+        {
+            threads.push_back (std::thread (scan_worker, &state));
+        }
+        catch (const std::system_error&)
+        {
+            // Continue with the threads we have.
+            break;
+        }
+    }
+
+    scan_worker (&state);
+    for (auto& thread : threads)
+    {
+        thread.join ();
+    }
+
+    close (state.ss_root);
+
+    if (state.ss_failed.empty () == false)
+    {
+        disir_error_set (instance, "Unable to open directory: %s/%s",
+                         searchdir.c_str(), state.ss_failed.c_str());
+    }
+
+    directories = std::move (state.ss_directories);
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! Stat the search directory of a query, creating it if it does not exist.
+//!
+static enum disir_status
+scan_prepare_directory (struct disir_instance *instance, const std::string& searchdir)
+{
+    enum disir_status status;
+    struct stat statbuf;
+
     status = fslib_stat_filepath (instance, searchdir.c_str(), &statbuf);
     if (status == DISIR_STATUS_NOT_EXIST)
     {
@@ -65,68 +281,212 @@ fslib_config_query_entries (struct disir_instance *instance, struct disir_regist
         disir_error_clear (instance);
         status = fslib_mkdir_p (instance, searchdir.c_str());
     }
+
+    // Error already set
+    return status;
+}
+
+//! STATIC API
+//!
+//! Enqueue a new entry for every name in found, in sorted order.
+//!
+static enum disir_status
+scan_enqueue_entries (const std::map<std::string, unsigned int>& found,
+                      struct disir_entry **entries)
+{
+    struct disir_entry *entry;
+
+    for (const auto& it : found)
+    {
+        entry = (struct disir_entry *) calloc (1, sizeof (struct disir_entry));
+        if (entry == NULL)
+        {
+            return DISIR_STATUS_NO_MEMORY;
+        }
+
+        entry->de_entry_name = strdup (it.first.c_str());
+        if (entry->de_entry_name == NULL)
+        {
+            free (entry);
+            return DISIR_STATUS_NO_MEMORY;
+        }
+
+        entry->de_attributes = it.second;
+        MQ_ENQUEUE (*entries, entry);
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! Build an index of every mold entry available through plugin, from a single
+//! call to dp_mold_entries.
+//!
+//! \return false if the plugin cannot enumerate its mold entries.
+//!
+static bool
+scan_mold_index (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                 std::map<std::string, unsigned int>& index)
+{
+    enum disir_status status;
+    struct disir_entry *mold_entries;
+    struct disir_entry *next;
+
+    if (plugin->dp_mold_entries == NULL)
+        return false;
+
+    mold_entries = NULL;
+    status = plugin->dp_mold_entries (instance, plugin, &mold_entries);
     if (status != DISIR_STATUS_OK)
     {
-        // Error already set
-        return status;
+        disir_error_clear (instance);
+        return false;
     }
 
-    directory = opendir (searchdir.c_str());
-    if (directory == NULL)
+    while (mold_entries != NULL)
     {
-        disir_error_set (instance, "Unable to open directory: %s", searchdir.c_str());
-        return DISIR_STATUS_FS_ERROR;
+        next = mold_entries->next;
+        index[std::string (mold_entries->de_entry_name)] = mold_entries->de_attributes;
+        disir_entry_finished (&mold_entries);
+        mold_entries = next;
     }
-    while ((dp = readdir(directory)) != NULL)
+
+    return true;
+}
+
+//! STATIC API
+//!
+//! Find the attributes of the mold covering config entry_name, either through
+//! the pre-scanned mold index or, if there is none, by querying the plugin.
+//!
+//! \return false if there is no mold covering entry_name.
+//!
+static bool
+scan_mold_lookup (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                  const std::map<std::string, unsigned int> *index, std::string& entry_name,
+                  unsigned int *attributes)
+{
+    enum disir_status status;
+    struct disir_entry *mold_entry;
+    char namespace_entry[PATH_MAX];
+
+    if (index == NULL)
     {
-        // entry file, relative to basedir
-        std::stringstream ef;
-        if (basedir)
+        if (plugin->dp_mold_query == NULL)
+            return false;
+
+        status = plugin->dp_mold_query (instance, plugin, entry_name.c_str(), &mold_entry);
+        if (status != DISIR_STATUS_EXISTS)
         {
-            ef << basedir;
-            ef << '/';
+            // We dont really care what happened here...
+            return false;
         }
-        ef << dp->d_name;
-        std::string name = ef.str();
 
-        if (dp->d_type == DT_REG)
-        {
-            // Check that our file extension (suffix) is valid for this file entry
-            if (name.size() > suffix.size()
-                && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
-            {
-                //! Check if we have a mold entry for this directory entry
-                std::string entry_name(name, 0, name.size() - suffix.size());
-                status = plugin->dp_mold_query (instance, plugin, entry_name.c_str(), &mold_entry);
-                if (status != DISIR_STATUS_EXISTS)
-                {
-                    // We dont really care what happened here...
-                    continue;
-                }
+        *attributes = mold_entry->de_attributes;
+        disir_entry_finished (&mold_entry);
+        return true;
+    }
 
-                entry = (struct disir_entry *) calloc (1, sizeof (struct disir_entry));
-                entry->de_entry_name = strdup(entry_name.c_str());
-                entry->de_attributes = mold_entry->de_attributes;
-                MQ_ENQUEUE (*entries, entry);
+    if (!validate_entry_id_characters (entry_name))
+        return false;
 
-                disir_entry_finished (&mold_entry);
-            }
+    auto found = index->find (entry_name);
+    if (found == index->end ())
+    {
+        // Not a nominal mold - check if it is covered by a namespace entry
+        if (fslib_namespace_entry (entry_name.c_str(), namespace_entry) == NULL)
+        {
+            strcpy (namespace_entry, "/");
         }
-        else if (dp->d_type == DT_DIR)
+        found = index->find (std::string (namespace_entry));
+    }
+    if (found == index->end ())
+        return false;
+
+    *attributes = found->second;
+    return true;
+}
+
+//! STATIC API
+static unsigned int
+mold_entry_attributes (bool namespace_entry, bool override_entry)
+{
+    struct disir_entry entry;
+
+    entry.de_attributes = 0;
+    // TODO: stat entry to get READABLE and WRITABLE
+    entry.flag.DE_READABLE = 1;
+    entry.flag.DE_WRITABLE = 1;
+    entry.flag.DE_NAMESPACE_ENTRY = namespace_entry;
+    entry.flag.DE_OVERRIDE = override_entry;
+
+    return entry.de_attributes;
+}
+
+//! FSLIB API
+//
+// The directory tree is scanned once, in parallel. Each config file found is matched
+// against an index of mold entries built from a single dp_mold_entries call.
+// Plugins unable to enumerate their molds are queried through dp_mold_query instead.
+//
+enum disir_status
+fslib_config_query_entries (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                            const char *basedir, struct disir_entry **entries)
+{
+    enum disir_status status;
+    std::vector<struct scan_directory> directories;
+    std::map<std::string, unsigned int> index;
+    std::map<std::string, unsigned int> found;
+    unsigned int attributes;
+    bool indexed;
+
+    // File extension is always without the leading dot - add 1 for it
+    std::string suffix = std::string (".") + plugin->dp_config_entry_type;
+
+    // Directory is a combinarion of plugin config_base_id and input basedir
+    std::string searchdir (plugin->dp_config_base_id);
+    std::string prefix;
+    if (basedir)
+    {
+        searchdir += '/';
+        searchdir += basedir;
+        prefix = std::string (basedir) + '/';
+    }
+
+    // Stat if directory exists. If it does not, we try to create it
+    status = scan_prepare_directory (instance, searchdir);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = scan_directory_tree (instance, searchdir, suffix, directories);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    indexed = scan_mold_index (instance, plugin, index);
+
+    for (const auto& directory : directories)
+    {
+        for (const auto& file : directory.sd_files)
         {
-            // Must be a better way to check this..
-            if (strcmp (dp->d_name, ".") == 0) {}
-            else if (strcmp (dp->d_name, "..") == 0) {}
-            else
+            // entry name, relative to the config base directory
+            std::string entry_name = prefix + directory.sd_path
+                                     + file.substr (0, file.size() - suffix.size());
+
+            //! Check if we have a mold entry for this directory entry
+            if (scan_mold_lookup (instance, plugin, (indexed ? &index : NULL),
+                                  entry_name, &attributes))
             {
-                fslib_config_query_entries (instance, plugin, name.c_str(), entries);
+                found[entry_name] = attributes;
             }
         }
     }
 
-    closedir (directory);
-
-    return DISIR_STATUS_OK;
+    return scan_enqueue_entries (found, entries);
 }
 
 //! FSLIB API
@@ -139,175 +499,126 @@ fslib_config_query_entries (struct disir_instance *instance, struct disir_regist
 // entry_name.suffix + entry_name.o.suffix = OK
 // entry_name.o.suffix = IGNORED
 //
+// Entries with an override entry alongside are flagged DE_OVERRIDE.
+//
 enum disir_status
 fslib_mold_query_entries (struct disir_instance *instance, struct disir_register_plugin *plugin,
                           const char *basedir, struct disir_entry **entries)
 {
     enum disir_status status;
-    bool has_namespace = false;
-    DIR *directory;
-    struct dirent *dp;
-    struct disir_entry *entry;
-    struct stat statbuf;
+    std::vector<struct scan_directory> directories;
+    std::map<std::string, unsigned int> found;
 
     // File extension is always without the leading dot - add 1 for it
-    std::stringstream suffix_stream;
-    suffix_stream << "." << plugin->dp_mold_entry_type;
-    std::string suffix = suffix_stream.str();
+    std::string suffix = std::string (".") + plugin->dp_mold_entry_type;
 
     // The namespace override entry has a fixed suffix with a leading dot
     std::string oid(".o");
 
-    // Directory is a combinarion of plugin config_base_id and input basedir
-    std::stringstream sd;
-    sd << plugin->dp_mold_base_id;
+    // Directory is a combinarion of plugin mold_base_id and input basedir
+    std::string searchdir (plugin->dp_mold_base_id);
+    std::string prefix;
     if (basedir)
     {
-        sd << '/';
-        sd << basedir;
+        searchdir += '/';
+        searchdir += basedir;
+        prefix = std::string (basedir) + '/';
     }
-    std::string searchdir = sd.str();
 
     // Stat if directory exists. If it does not, we try to create it
-    status = fslib_stat_filepath (instance, searchdir.c_str(), &statbuf);
-    if (status == DISIR_STATUS_NOT_EXIST)
-    {
-        // lets create it
-        disir_error_clear (instance);
-        status = fslib_mkdir_p (instance, searchdir.c_str());
-    }
+    status = scan_prepare_directory (instance, searchdir);
     if (status != DISIR_STATUS_OK)
     {
-        // Error already set
         return status;
     }
 
-    directory = opendir (searchdir.c_str());
-    if (directory == NULL)
-    {
-        disir_error_set (instance, "Unable to open directory: %s", searchdir.c_str());
-        return DISIR_STATUS_FS_ERROR;
-    }
-
-    // Check ONCE if we have a namespace entry in this directory
-    std::stringstream nspath_stream;
-    nspath_stream << searchdir << "/__namespace" << suffix;
-    std::string nspath = nspath_stream.str();
-    if (fslib_stat_filepath (instance, nspath.c_str(), &statbuf) == DISIR_STATUS_OK)
+    status = scan_directory_tree (instance, searchdir, suffix, directories);
+    if (status != DISIR_STATUS_OK)
     {
-        has_namespace = true;
+        return status;
     }
 
-    while ((dp = readdir(directory)) != NULL)
+    for (const auto& directory : directories)
     {
-        // entry file, relative to basedir
-        std::stringstream ef;
-        if (basedir)
+        // Entry names in this directory, without suffix
+        std::set<std::string> names;
+        for (const auto& file : directory.sd_files)
         {
-            ef << basedir;
-            ef << '/';
+            names.insert (file.substr (0, file.size() - suffix.size()));
         }
-        ef << dp->d_name;
-        std::string name = ef.str();
 
-        if (dp->d_type == DT_REG)
+        bool has_namespace = (names.count ("__namespace") != 0);
+
+        // Nominal and namespace entries first
+        for (const auto& name : names)
         {
-            // Check that our file extension (suffix) is valid for this file entry
-            if (name.size() > suffix.size()
-                && name.compare (name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            if (name.size() > oid.size()
+                && name.compare (name.size() - oid.size(), oid.size(), oid) == 0)
             {
-                std::string entry_name(name, 0, name.size() - suffix.size());
-                bool namespace_entry = false;
+                continue;
+            }
 
-                std::string direntry (dp->d_name);
-                // Check if the direntry is namespace
-                if (direntry.compare (0, direntry.size() - suffix.size(), "__namespace") == 0)
+            std::string entry_name = prefix + directory.sd_path;
+            bool namespace_entry = (name == "__namespace");
+            if (namespace_entry)
+            {
+                if (entry_name.empty ())
                 {
-                    namespace_entry = true;
-                    std::size_t found = entry_name.find_last_of('/');
-                    if (found != std::string::npos)
-                    {
-                        entry_name.resize(found+1);
-                    }
-                    else
-                    {
-                        entry_name = std::string("/");
-                    }
+                    entry_name = std::string("/");
                 }
-                // Check if this entry is a namespace override entry
-                else if (direntry.size() > oid.size() + suffix.size()
-                         && direntry.compare (direntry.size() - oid.size() - suffix.size(),
-                                              oid.size(), oid) == 0)
-                {
+            }
+            else
+            {
+                entry_name += name;
+            }
 
-                    // Here we handle the case where we have:
-                    //     entry_name.oe.suffix
-                    //     __namespace + entry_name.oe.suffix
-                    // The remainder of the cases  is handled in the else clause
-
-                    // Strip away the override entry suffix
-                    // Check if this exists - if it does, ignore this and move to the next
-                    std::stringstream oestripped_stream;
-                    oestripped_stream << searchdir
-                                      << entry_name.substr(0, entry_name.size() - oid.size())
-                                      << suffix;
-                    std::string oestripped = oestripped_stream.str();
-                    if (fslib_stat_filepath (instance, oestripped.c_str(), &statbuf)
-                            == DISIR_STATUS_OK)
-                    {
-                        continue;
-                    }
-
-                    // if has_namespace is false, we move to the next,
-                    // since we have neither a namespace nor an original entry name.
-                    if (!has_namespace)
-                    {
-                        continue;
-                    }
-
-                    entry_name = entry_name.substr(0, entry_name.size() - oid.size());
-                }
-                else
-                {
-                    // We handle the following cases here
-                    //     __namespace + entry_name.suffix + entry_name.oe.suffix
-                    //     entry_name.suffix
-                    //     entry_name.suffix + entry_name.oe.suffix
-                    // In reality, we dont have to check for anything else here because
-                    // we know we are already a valid entry which is NOT a namespace entry.
-                    // Simply let it pass through
-                }
+            if (!validate_entry_id_characters(entry_name))
+            {
+                continue;
+            }
+
+            found[entry_name] = mold_entry_attributes (namespace_entry, false);
+        }
+
+        // Then the override entries
+        for (const auto& name : names)
+        {
+            if (name.size() <= oid.size()
+                || name.compare (name.size() - oid.size(), oid.size(), oid) != 0)
+            {
+                continue;
+            }
 
-                if (!validate_entry_id_characters(entry_name))
+            std::string stripped (name, 0, name.size() - oid.size());
+            std::string entry_name = prefix + directory.sd_path + stripped;
+
+            // entry_name.suffix + entry_name.o.suffix
+            if (names.count (stripped) != 0)
+            {
+                auto nominal = found.find (entry_name);
+                if (nominal != found.end ())
                 {
-                    continue;
+                    nominal->second = mold_entry_attributes (false, true);
                 }
-
-                entry = (struct disir_entry *) calloc (1, sizeof (struct disir_entry));
-                entry->de_entry_name = strdup(entry_name.c_str());
-                // TODO: stat entry to get READABLE and WRITABLE
-                entry->flag.DE_READABLE = 1;
-                entry->flag.DE_WRITABLE = 1;
-                entry->flag.DE_NAMESPACE_ENTRY = namespace_entry;
-                MQ_ENQUEUE (*entries, entry);
+                continue;
             }
-        }
-        else if (dp->d_type == DT_DIR)
-        {
-            // Must be a better way to check this..
-            if (strcmp (dp->d_name, ".") == 0) {}
-            else if (strcmp (dp->d_name, "..") == 0) {}
-            else
+
+            // If we have neither a namespace nor an original entry, we ignore it.
+            if (!has_namespace)
             {
+                continue;
+            }
 
-                fslib_mold_query_entries (instance, plugin, name.c_str(), entries);
+            if (!validate_entry_id_characters(entry_name))
+            {
+                continue;
             }
+
+            found[entry_name] = mold_entry_attributes (false, true);
         }
     }
 
-    closedir (directory);
-
-    return DISIR_STATUS_OK;
+    return scan_enqueue_entries (found, entries);
 }
 
 //! FSLIB API
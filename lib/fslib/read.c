@@ -1,10 +1,106 @@
+// private
+#include "disir_private.h"
+
 // public
 #include <disir/fslib/util.h>
 
 // system
 #include <errno.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//! Initial buffer size when reading a file of unknown size.
+#define FSLIB_READ_CHUNK 4096
+
+//! FSLIB API
+enum disir_status
+fslib_file_buffer_read (struct disir_instance *instance, FILE *file,
+                        struct fslib_file_buffer *buffer)
+{
+    struct stat statbuf;
+    off_t offset;
+    char *data;
+    char *resized;
+    size_t capacity;
+    size_t size;
+    ssize_t bytes;
+    int regular;
+    int fd;
+    char errbuf[256];
+
+    if (instance == NULL || file == NULL || buffer == NULL)
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
 
+    memset (buffer, 0, sizeof (struct fslib_file_buffer));
+
+    fd = fileno (file);
+    offset = lseek (fd, 0, SEEK_CUR);
+    regular = (offset >= 0 && fstat (fd, &statbuf) == 0 && S_ISREG (statbuf.st_mode)
+               && statbuf.st_size >= offset);
+
+    // Read everything into a single buffer, sized up front when the size is known.
+    // The file is never mapped: a writer truncating it would crash us with SIGBUS.
+    capacity = (regular ? (size_t) (statbuf.st_size - offset) + 1 : FSLIB_READ_CHUNK);
+    data = malloc (capacity);
+    if (data == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    size = 0;
+    while (1)
+    {
+        if (size + 1 == capacity)
+        {
+            resized = realloc (data, capacity * 2);
+            if (resized == NULL)
+            {
+                free (data);
+                return DISIR_STATUS_NO_MEMORY;
+            }
+            data = resized;
+            capacity *= 2;
+        }
+
+        bytes = read (fd, data + size, capacity - size - 1);
+        if (bytes == 0)
+            break;
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            disir_error_set (instance, "reading file: %s",
+                             fslib_strerror (errno, errbuf, sizeof (errbuf)));
+            free (data);
+            return DISIR_STATUS_FS_ERROR;
+        }
+        size += bytes;
+    }
+
+    data[size] = '\0';
+    buffer->fb_memory = data;
+    buffer->fb_data = data;
+    buffer->fb_size = size;
+
+    dx_stats_bytes (size, 0);
+
+    return DISIR_STATUS_OK;
+}
+
+//! FSLIB API
+void
+fslib_file_buffer_release (struct fslib_file_buffer *buffer)
+{
+    if (buffer == NULL)
+        return;
+
+    free (buffer->fb_memory);
+    memset (buffer, 0, sizeof (struct fslib_file_buffer));
+}
 
 //! FSLIB API
 enum disir_status
@@ -17,6 +113,7 @@ fslib_plugin_config_read (struct disir_instance *instance,
     char filepath[PATH_MAX];
     struct stat statbuf;
     struct disir_mold *resolved_mold;
+    char errbuf[256];
 
     status = fslib_config_resolve_filepath (instance, plugin, entry_id, filepath);
     if (status != DISIR_STATUS_OK)
@@ -33,10 +130,10 @@ fslib_plugin_config_read (struct disir_instance *instance,
         return status;
     }
 
-    // Locate mold from plugin
+    // Locate mold from plugin, through the instance mold cache
     if (mold == NULL)
     {
-        status = plugin->dp_mold_read (instance, plugin, entry_id, &resolved_mold);
+        status = dx_mold_cache_read (instance, plugin, entry_id, &resolved_mold);
         if (status != DISIR_STATUS_OK)
         {
             if (status == DISIR_STATUS_INVALID_CONTEXT)
@@ -59,8 +156,8 @@ fslib_plugin_config_read (struct disir_instance *instance,
     if (file == NULL)
     {
         // TODO: Check errno and set appropriate error
-        // TODO: Use threadsafe strerror, or refactor entirely
-        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+        disir_error_set (instance, "opening for reading %s: %s", filepath,
+                         fslib_strerror (errno, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
@@ -89,6 +186,7 @@ fslib_plugin_mold_read (struct disir_instance *instance,
     struct stat statbuf;
     int namespace_entry;
     FILE *file;
+    char errbuf[256];
 
     namespace_entry = 0;
 
@@ -103,8 +201,8 @@ fslib_plugin_mold_read (struct disir_instance *instance,
     if (file == NULL)
     {
         // TODO: Check errno and set appropriate error
-        // TODO: Use threadsafe strerror, or refactor entirely
-        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+        disir_error_set (instance, "opening for reading %s: %s", filepath,
+                         fslib_strerror (errno, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
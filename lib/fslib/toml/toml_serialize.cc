@@ -106,159 +106,146 @@ toml_serialize_keyval (struct disir_context *context, toml::Value* current, cons
     return status;
 }
 
+//! Elements visited while serializing the elements of tv_parent into tv_current.
+struct toml_visit
+{
+    struct disir_context *tv_parent;
+    toml::Value *tv_current;
+    //! Name of the elements visited by toml_serialize_inner.
+    const char *tv_name;
+    //! Number of elements counted by toml_count_element.
+    int32_t tv_count;
+};
+
+//! STATIC API
 static enum disir_status
-toml_serialize_inner (struct disir_context *parent,
-                      toml::Value* current, const char *name)
+toml_count_element (struct disir_context *element, void *userdata)
+{
+    (void) element;
+
+    static_cast<struct toml_visit *> (userdata)->tv_count++;
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Serialize a single entry of the elements named tv_name.
+static enum disir_status
+toml_serialize_entry (struct disir_context *element, void *userdata)
 {
     enum disir_status status;
-    struct disir_collection *key_collection;
-    struct disir_context *key_element;
+    struct toml_visit *visit;
     toml::Value *table;
 
-    key_element = NULL;
+    visit = static_cast<struct toml_visit *> (userdata);
 
-    // Get all elements from the parent
-    status = dc_find_elements (parent, name, &key_collection);
-    if (status != DISIR_STATUS_OK)
+    switch (dc_context_type (element))
     {
-        disir_log_user (NULL, "find elements on existing name (%s) failed. Ouch. status: %s",
-                   name, disir_status_string (status));
-        goto out;
-    }
-
-    // Create an array storage if needed.
-    if (dc_collection_size (key_collection) > 1)
+    case DISIR_CONTEXT_KEYVAL:
     {
-        current = current->setChild (name, (toml::Array()));
+        status = toml_serialize_keyval (element, visit->tv_current, visit->tv_name);
+        break;
     }
-
-    do
+    case DISIR_CONTEXT_SECTION:
     {
-        status = dc_collection_next (key_collection, &key_element);
-        if (status == DISIR_STATUS_EXHAUSTED)
+        if (visit->tv_current->type() == toml::Value::Type::ARRAY_TYPE)
         {
-            break;
+            table = visit->tv_current->push ((toml::Table()));
         }
-        if (status != DISIR_STATUS_OK)
+        else
         {
-            disir_log_user (NULL, "collection next failed with non-OK status: %s",
-                       disir_status_string (status));
-            break;
+            table = visit->tv_current->setChild (visit->tv_name, (toml::Table()));
         }
 
-        switch (dc_context_type (key_element))
-        {
-        case DISIR_CONTEXT_KEYVAL:
-        {
-            status = toml_serialize_keyval (key_element, current, name);
-            break;
-        }
-        case DISIR_CONTEXT_SECTION:
-        {
-            if (current->type() == toml::Value::Type::ARRAY_TYPE)
-            {
-                table = current->push ((toml::Table()));
-            }
-            else
-            {
-                table = current->setChild (name, (toml::Table()));
-            }
+        status = toml_serialize_elements (element, table);
+        break;
+    }
+    default:
+    {
+        disir_log_user (NULL, "Unhandled child of elements: %s", dc_context_type_string (element));
+        status = DISIR_STATUS_INTERNAL_ERROR;
+    }
+    }
 
-            status = toml_serialize_elements (key_element, table);
-            break;
-        }
-        default:
-        {
-            disir_log_user (NULL, "Unhandled child of elements: %s", dc_context_type_string (key_element));
-            status = DISIR_STATUS_INTERNAL_ERROR;
-            goto out;
-        }
-        }
+    return status;
+}
 
-        // Bail if the serialization goes awry
-        if (status != DISIR_STATUS_OK)
-        {
-            goto out;
-        }
+//! STATIC API
+static enum disir_status
+toml_serialize_inner (struct disir_context *parent,
+                      toml::Value* current, const char *name)
+{
+    enum disir_status status;
+    struct toml_visit visit;
 
-        dc_putcontext (&key_element);
+    visit.tv_parent = parent;
+    visit.tv_current = current;
+    visit.tv_name = name;
+    visit.tv_count = 0;
 
-    } while (1);
+    // Count the elements with name
+    status = dc_foreach_element (parent, name, toml_count_element, &visit);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_log_user (NULL, "find elements on existing name (%s) failed. Ouch. status: %s",
+                   name, disir_status_string (status));
+        return status;
+    }
 
-    status = DISIR_STATUS_OK;
-    // FALL-THROUGH
-out:
-    if (key_collection)
-        dc_collection_finished (&key_collection);
-    if (key_element)
-        dc_putcontext (&key_element);
-    return status;
+    // Create an array storage if needed.
+    if (visit.tv_count > 1)
+    {
+        visit.tv_current = current->setChild (name, (toml::Array()));
+    }
+
+    return dc_foreach_element (parent, name, toml_serialize_entry, &visit);
 }
 
 //! STATIC API
+//! Serialize every element named as element, unless they are already serialized.
 static enum disir_status
-toml_serialize_elements (struct disir_context *context, toml::Value* current)
+toml_serialize_element (struct disir_context *element, void *userdata)
 {
     enum disir_status status;
+    struct toml_visit *visit;
     const char *name;
-    struct disir_context *element;
-    struct disir_collection *collection;
 
-    collection = NULL;
-    element = NULL;
+    visit = static_cast<struct toml_visit *> (userdata);
 
-    status = dc_get_elements (context, &collection);
+    status = dc_get_name (element, &name, NULL);
     if (status != DISIR_STATUS_OK)
     {
-        disir_log_user (NULL, "Get elements failed with status: %s", disir_status_string (status));
-        goto out;
+        disir_log_user (NULL, "Failed to retrieve keyval name: %s", disir_status_string (status));
+        return status;
     }
 
-    do
-    {
-        status = dc_collection_next (collection, &element);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            break;
-        }
-        if (status != DISIR_STATUS_OK)
-        {
-            // log error - get out of town.
-            disir_log_user (NULL, "Collection returned non-OK status: %s", disir_status_string (status));
-            goto out;
-        }
+    // Check if this element already exists in the current TOML value.
+    // If it does, we have already added it (since there are more than one entry of it.)
+    if (visit->tv_current->has (name))
+        return DISIR_STATUS_OK;
 
-        status = dc_get_name (element, &name, NULL);
-        if (status != DISIR_STATUS_OK)
-        {
-            disir_log_user (NULL, "Failed to retrieve keyval name: %s", disir_status_string (status));
-            goto out;
-        }
-
-        // Check if this element already exists in the current TOML value.
-        // If it does, we have already added it (since there are more than one entry of it.)
-        if (current->has (name))
-            continue;
-
-        status = toml_serialize_inner (context, current, name);
-        if (status != DISIR_STATUS_OK)
-            goto out;
+    return toml_serialize_inner (visit->tv_parent, visit->tv_current, name);
+}
 
-        dc_putcontext (&element);
+//! STATIC API
+static enum disir_status
+toml_serialize_elements (struct disir_context *context, toml::Value* current)
+{
+    enum disir_status status;
+    struct toml_visit visit;
 
-    } while (1);
+    visit.tv_parent = context;
+    visit.tv_current = current;
+    visit.tv_name = NULL;
+    visit.tv_count = 0;
 
-    status = DISIR_STATUS_OK;
-    // FALL-THROUGH
-out:
-    if (collection)
-    {
-        dc_collection_finished (&collection);
-    }
-    if (element)
+    // The elements are borrowed from the config being serialized.
+    status = dc_foreach_element (context, NULL, toml_serialize_element, &visit);
+    if (status != DISIR_STATUS_OK)
     {
-        dc_putcontext (&element);
+        disir_log_user (NULL, "Serializing elements failed with status: %s",
+                        disir_status_string (status));
     }
+
     return status;
 }
 
@@ -5,13 +5,27 @@
 
 #include <disir/disir.h>
 #include <disir/fslib/toml.h>
+#include <disir/fslib/util.h>
 
 #include "tinytoml/toml.h"
-#include "fdstream.hpp"
 
 #define ATTRIBUTE_KEY_DISIR_CONFIG_VERSION "@DISIR_CONFIG_VERSION"
 #define ATTRIBUTE_KEY_DISIR_CONFIG_VERSION_QUOTED "\"@DISIR_CONFIG_VERSION\""
 
+//! Read-only stream buffer over memory owned by someone else.
+//! Lets tinytoml read the document in place, without copying it into the stream.
+class toml_memory_buffer : public std::streambuf
+{
+public:
+    toml_memory_buffer (const char *data, size_t size)
+    {
+        char *begin = const_cast<char *> (data);
+
+        // The get area is never written through.
+        setg (begin, begin, begin + size);
+    }
+};
+
 // Forward declare
 static enum disir_status
 dio_toml_unserialize_all (struct disir_instance *instance, const char *key,
@@ -236,7 +250,7 @@ dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config)
 {
     enum disir_status status;
-    struct disir_context *context_config;
+    struct fslib_file_buffer buffer;
 
     if (instance == NULL || input == NULL || mold == NULL || config == NULL)
     {
@@ -244,10 +258,38 @@ dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    status = fslib_file_buffer_read (instance, input, &buffer);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = dio_toml_unserialize_config_buffer (instance, buffer.fb_data, buffer.fb_size,
+                                                 mold, config);
+
+    fslib_file_buffer_release (&buffer);
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+dio_toml_unserialize_config_buffer (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config)
+{
+    enum disir_status status;
+    struct disir_context *context_config;
+
+    if (instance == NULL || (data == NULL && size != 0) || mold == NULL || config == NULL)
+    {
+        // LOG debug 0
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
     disir_log_user (instance, "TRACE ENTER dio_toml_unserialize_config");
 
-    boost::fdistream file(fileno(input));
-    // XXX: Check file
+    toml_memory_buffer document (data, size);
+    std::istream file (&document);
 
     // Pare the TOML formatted file and extract it into a toml::Value object
     toml::ParseResult pr = toml::parse (file);
@@ -0,0 +1,22 @@
+#include <string.h>
+#include <stdio.h>
+
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+
+
+//! FSLIB API
+const char *
+fslib_strerror (int errnum, char *buffer, size_t buffer_size)
+{
+#if defined (_GNU_SOURCE)
+    // GNU variant may return a static string instead of populating buffer.
+    return strerror_r (errnum, buffer, buffer_size);
+#else
+    if (strerror_r (errnum, buffer, buffer_size) != 0)
+    {
+        snprintf (buffer, buffer_size, "Unknown error %d", errnum);
+    }
+    return buffer;
+#endif
+}
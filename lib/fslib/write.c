@@ -1,3 +1,6 @@
+// private
+#include "stats.h"
+
 // public
 #include <disir/fslib/util.h>
 
@@ -15,6 +18,8 @@ fslib_plugin_config_write (struct disir_instance *instance, struct disir_registe
     enum disir_status status;
     char filepath[PATH_MAX];
     struct stat statbuf;
+    char errbuf[256];
+    long written;
 
     status = plugin->dp_mold_query (instance, plugin, entry_id, NULL);
     if (status == DISIR_STATUS_NOT_EXIST)
@@ -92,12 +97,17 @@ fslib_plugin_config_write (struct disir_instance *instance, struct disir_registe
     if (file == NULL)
     {
         // TODO: Check errno and set appropriate error
-        // TODO: Use threadsafe strerror, or refactor entirely
-        disir_error_set (instance, "opening for writing %s: %s", filepath, strerror (errno));
+        disir_error_set (instance, "opening for writing %s: %s", filepath,
+                         fslib_strerror (errno, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
     status = func_serialize (instance, config, file);
+    written = ftell (file);
+    if (written > 0)
+    {
+        dx_stats_bytes (0, written);
+    }
     fclose (file);
 
     return status;
@@ -112,6 +122,8 @@ fslib_plugin_mold_write (struct disir_instance *instance, struct disir_register_
     enum disir_status status;
     char filepath[PATH_MAX];
     struct stat statbuf;
+    char errbuf[256];
+    long written;
 
     status = fslib_mold_resolve_filepath (instance, plugin, entry_id, filepath);
     if (status != DISIR_STATUS_OK)
@@ -176,12 +188,17 @@ fslib_plugin_mold_write (struct disir_instance *instance, struct disir_register_
     if (file == NULL)
     {
         // TODO: Check errno and set appropriate error
-        // TODO: Use threadsafe strerror, or refactor entirely
-        disir_error_set (instance, "opening for writing %s: %s", filepath, strerror (errno));
+        disir_error_set (instance, "opening for writing %s: %s", filepath,
+                         fslib_strerror (errno, errbuf, sizeof (errbuf)));
         return DISIR_STATUS_FS_ERROR;
     }
 
     status = func_serialize (instance, mold, file);
+    written = ftell (file);
+    if (written > 0)
+    {
+        dx_stats_bytes (0, written);
+    }
     fclose (file);
 
     return status;
@@ -19,6 +19,39 @@
 #include "log.h"
 #include "mqueue.h"
 #include "restriction.h"
+#include "element_storage.h"
+#include "generate.h"
+
+//! Element of the mold, as laid out in a generate template.
+struct generate_template_node
+{
+    //! Mold KEYVAL or SECTION this node generates entries of.
+    struct disir_context            *tn_equiv;
+
+    //! Name of tn_equiv. Lives as long as the mold.
+    const char                      *tn_name;
+    int32_t                         tn_name_size;
+
+    //! Number of entries generated of tn_equiv: its minimum entries at the template version.
+    int32_t                         tn_entries;
+
+    //! Default value of a KEYVAL node active at the template version. NULL for sections.
+    struct disir_value              *tn_value;
+
+    //! Index of the node following the last node below this one.
+    uint32_t                        tn_end;
+};
+
+struct disir_generate_template
+{
+    //! Version the entries and defaults of the nodes are resolved at.
+    struct disir_version            gt_version;
+
+    //! Every element of the mold, in document order.
+    struct generate_template_node   *gt_nodes;
+    uint32_t                        gt_count;
+    uint32_t                        gt_capacity;
+};
 
 
 // INTERNAL STATIC
@@ -92,7 +125,9 @@ generate_config_from_mold_recursive_step (struct disir_context *mold_parent,
 
                 dx_default_get_active (equiv, version, &def);
 
-                status = dx_value_copy (&context->cx_keyval->kv_value, &def->de_value);
+                dx_context_touch (context);
+                status = dx_value_copy_arena (&context->cx_keyval->kv_value,
+                                              context->cx_keyval->kv_arena, &def->de_value);
                 if (status != DISIR_STATUS_OK)
                 {
                     log_debug (2, "failed to copy value: %s", disir_status_string (status));
@@ -127,6 +162,343 @@ error:
 
 }
 
+//! STATIC API
+static void
+generate_template_destroy (struct disir_generate_template *template)
+{
+    if (template == NULL)
+        return;
+
+    free (template->gt_nodes);
+    free (template);
+}
+
+//! STATIC API
+//!
+//! Append a node for every element below mold_parent, and the elements below them.
+//! Sections of the mold are assigned their se_generate_index, the one-based index of their node.
+//!
+static enum disir_status
+generate_template_build_recursive (struct disir_generate_template *template,
+                                   struct disir_context *mold_parent)
+{
+    enum disir_status status;
+    struct disir_collection *collection;
+    struct disir_context *equiv;
+    struct generate_template_node *nodes;
+    struct generate_template_node *node;
+    struct disir_default *def;
+    uint32_t index;
+
+    status = dc_get_elements (mold_parent, &collection);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    while (dc_collection_next (collection, &equiv) != DISIR_STATUS_EXHAUSTED)
+    {
+        if (template->gt_count == template->gt_capacity)
+        {
+            template->gt_capacity = (template->gt_capacity ? template->gt_capacity * 2 : 64);
+            nodes = realloc (template->gt_nodes,
+                             template->gt_capacity * sizeof (struct generate_template_node));
+            if (nodes == NULL)
+            {
+                status = DISIR_STATUS_NO_MEMORY;
+                dc_putcontext (&equiv);
+                break;
+            }
+            template->gt_nodes = nodes;
+        }
+
+        index = template->gt_count++;
+        node = &template->gt_nodes[index];
+        memset (node, 0, sizeof (struct generate_template_node));
+        node->tn_equiv = equiv;
+
+        status = dc_get_name (equiv, &node->tn_name, &node->tn_name_size);
+        if (status == DISIR_STATUS_OK)
+        {
+            status = dx_restriction_entries_value (equiv, DISIR_RESTRICTION_INC_ENTRY_MIN,
+                                                   &template->gt_version, &node->tn_entries);
+        }
+        if (status == DISIR_STATUS_OK && dc_context_type (equiv) == DISIR_CONTEXT_KEYVAL)
+        {
+            dx_default_get_active (equiv, &template->gt_version, &def);
+            if (def == NULL)
+            {
+                // The mold is invalid - leave it to the regular generation.
+                status = DISIR_STATUS_DEFAULT_MISSING;
+            }
+            else
+            {
+                node->tn_value = &def->de_value;
+            }
+        }
+        else if (status == DISIR_STATUS_OK)
+        {
+            // Every template lays out the mold the same way.
+            __atomic_store_n (&equiv->cx_section->se_generate_index, index + 1,
+                              __ATOMIC_RELAXED);
+            status = generate_template_build_recursive (template, equiv);
+        }
+
+        // The template is discarded with the mold, so it needs no reference.
+        dc_putcontext (&equiv);
+        if (status != DISIR_STATUS_OK)
+            break;
+
+        template->gt_nodes[index].tn_end = template->gt_count;
+    }
+
+    dc_collection_finished (&collection);
+    return status;
+}
+
+//! STATIC API
+//!
+//! Retrieve the generate template of mold at version, building it in a free slot.
+//!
+//! \return NULL if the mold is not finalized, every slot holds a template of another version,
+//!     or the template could not be built.
+//!
+static struct disir_generate_template *
+generate_template_get (struct disir_mold *mold, struct disir_version *version)
+{
+    enum disir_status status;
+    struct disir_generate_template *template;
+    struct disir_generate_template *built;
+    int i;
+
+    if (mold->mo_context->CONTEXT_STATE_FINALIZED == 0)
+        return NULL;
+
+    built = NULL;
+    for (i = 0; i < DISIR_MOLD_GENERATE_TEMPLATES; i++)
+    {
+        template = __atomic_load_n (&mold->mo_generate_templates[i], __ATOMIC_ACQUIRE);
+        if (template == NULL)
+        {
+            if (built == NULL)
+            {
+                built = calloc (1, sizeof (struct disir_generate_template));
+                if (built == NULL)
+                    return NULL;
+                dc_version_set (&built->gt_version, version);
+
+                status = generate_template_build_recursive (built, mold->mo_context);
+                if (status != DISIR_STATUS_OK)
+                {
+                    log_debug (2, "failed to build generate template: %s",
+                               disir_status_string (status));
+                    generate_template_destroy (built);
+                    return NULL;
+                }
+            }
+
+            if (__atomic_compare_exchange_n (&mold->mo_generate_templates[i], &template, built,
+                                             0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                return built;
+            }
+            // Another thread filled the slot first - template now holds its template.
+        }
+
+        if (dc_version_compare (&template->gt_version, version) == 0)
+        {
+            generate_template_destroy (built);
+            return template;
+        }
+    }
+
+    generate_template_destroy (built);
+    return NULL;
+}
+
+//! STATIC API
+static enum disir_status
+generate_template_clone (struct disir_generate_template *template,
+                         uint32_t begin, uint32_t end, struct disir_context *parent);
+
+//! STATIC API
+//!
+//! Construct a finalized entry of the node at index as a child of parent.
+//! The entry is added to parent without being validated.
+//!
+static enum disir_status
+generate_template_entry (struct disir_generate_template *template, uint32_t index,
+                         struct disir_context *parent)
+{
+    enum disir_status status;
+    struct generate_template_node *node;
+    struct disir_element_storage *storage;
+    struct disir_context *context;
+    struct disir_value *name;
+
+    node = &template->gt_nodes[index];
+
+    status = dx_context_element_storage (parent, &storage);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_begin (parent, dc_context_type (node->tn_equiv), &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
+    {
+        name = &context->cx_keyval->kv_name;
+        context->cx_keyval->kv_mold_equiv = node->tn_equiv;
+        context->cx_keyval->kv_value.dv_type = node->tn_equiv->cx_keyval->kv_value.dv_type;
+        dx_context_incref (node->tn_equiv);
+
+        status = dx_value_set_string_arena (name, context->cx_keyval->kv_arena,
+                                            node->tn_name, node->tn_name_size);
+        if (status == DISIR_STATUS_OK)
+        {
+            status = dx_value_copy_arena (&context->cx_keyval->kv_value,
+                                          context->cx_keyval->kv_arena, node->tn_value);
+        }
+    }
+    else
+    {
+        name = &context->cx_section->se_name;
+        context->cx_section->se_mold_equiv = node->tn_equiv;
+        dx_context_incref (node->tn_equiv);
+
+        status = dx_value_set_string_arena (name, context->cx_section->se_arena,
+                                            node->tn_name, node->tn_name_size);
+        if (status == DISIR_STATUS_OK)
+        {
+            status = generate_template_clone (template, index + 1, node->tn_end, context);
+        }
+    }
+
+    if (status == DISIR_STATUS_OK)
+    {
+        status = dx_element_storage_add (storage, name->dv_string, context);
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context);
+        return status;
+    }
+
+    // Finalized as by dc_finalize - the reference is held by the parent storage.
+    context->CONTEXT_STATE_IN_PARENT = 1;
+    context->CONTEXT_STATE_FINALIZED = 1;
+    context->CONTEXT_STATE_CONSTRUCTING = 0;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Construct the entries of every node from begin up to end, not below another node, in parent.
+static enum disir_status
+generate_template_clone (struct disir_generate_template *template,
+                         uint32_t begin, uint32_t end, struct disir_context *parent)
+{
+    enum disir_status status;
+    uint32_t index;
+    int32_t i;
+
+    index = begin;
+    while (index < end)
+    {
+        for (i = 0; i < template->gt_nodes[index].tn_entries; i++)
+        {
+            status = generate_template_entry (template, index, parent);
+            if (status != DISIR_STATUS_OK)
+                return status;
+        }
+
+        index = template->gt_nodes[index].tn_end;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! Generate the children of config_parent, whose mold equivalent is mold_parent,
+//! at the version of its config.
+//! Clones the generate template of the mold into config_parent while it is constructing
+//! and empty; otherwise, or if no template is available, the mold is walked instead.
+//!
+static enum disir_status
+generate_config_parent (struct disir_context *mold_parent, struct disir_context *config_parent)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct disir_generate_template *template;
+    struct disir_version *version;
+    uint32_t begin;
+    uint32_t end;
+
+    version = &config_parent->cx_root_context->cx_config->cf_version;
+
+    template = NULL;
+    if (mold_parent != NULL && config_parent->CONTEXT_STATE_FINALIZED == 0
+        && dx_context_element_storage (config_parent, &storage) == DISIR_STATUS_OK
+        && dx_element_storage_numentries (storage) == 0)
+    {
+        template = generate_template_get (config_parent->cx_root_context->cx_config->cf_mold,
+                                          version);
+    }
+
+    if (template == NULL)
+    {
+        // We do not generate children whose minimum entry count is zero
+        return generate_config_from_mold_recursive_step (mold_parent, config_parent, version, 0);
+    }
+
+    begin = 0;
+    end = template->gt_count;
+    if (dc_context_type (mold_parent) == DISIR_CONTEXT_SECTION)
+    {
+        begin = __atomic_load_n (&mold_parent->cx_section->se_generate_index, __ATOMIC_RELAXED);
+        if (begin == 0)
+        {
+            return generate_config_from_mold_recursive_step (mold_parent, config_parent,
+                                                             version, 0);
+        }
+        end = template->gt_nodes[begin - 1].tn_end;
+    }
+
+    status = generate_template_clone (template, begin, end, config_parent);
+    dx_context_touch (config_parent);
+
+    return status;
+}
+
+//! INTERNAL API
+void
+dx_generate_templates_invalidate (struct disir_context *context)
+{
+    struct disir_context *root;
+
+    root = context->cx_root_context;
+    if (root && root->CONTEXT_STATE_DESTROYED == 0
+        && dx_context_type_sanify (root->cx_type) == DISIR_CONTEXT_MOLD)
+    {
+        dx_generate_templates_destroy (root->cx_mold);
+    }
+}
+
+//! INTERNAL API
+void
+dx_generate_templates_destroy (struct disir_mold *mold)
+{
+    int i;
+
+    for (i = 0; i < DISIR_MOLD_GENERATE_TEMPLATES; i++)
+    {
+        generate_template_destroy (__atomic_exchange_n (&mold->mo_generate_templates[i], NULL,
+                                                        __ATOMIC_ACQ_REL));
+    }
+}
+
 //! PUBLIC API
 enum disir_status
 disir_generate_config_from_mold (struct disir_mold *mold, struct disir_version *config_version,
@@ -180,7 +552,7 @@ disir_generate_config_from_mold (struct disir_mold *mold, struct disir_version *
         return status;
     }
 
-    generate_config_from_mold_recursive_step (mold->mo_context, config_context, &version, 0);
+    generate_config_parent (mold->mo_context, config_context);
 
     status = dc_config_finalize (&config_context, config);
     if (status != DISIR_STATUS_OK)
@@ -191,11 +563,11 @@ disir_generate_config_from_mold (struct disir_mold *mold, struct disir_version *
 
     if (config_version)
     {
-        dc_version_set (&(*config)->cf_version, config_version);
+        dx_config_set_version (*config, config_version);
     }
     else
     {
-        dc_version_set (&(*config)->cf_version, &mold->mo_version);
+        dx_config_set_version (*config, &mold->mo_version);
     }
     log_debug (6, "sat config version to: %s",
                dc_version_string (buffer, 32, &(*config)->cf_version));
@@ -217,7 +589,6 @@ dc_generate_from_config_root (struct disir_context *context)
 {
     enum disir_status status;
     struct disir_context *mold_equiv;
-    struct disir_version *version;
 
     status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
     if (status != DISIR_STATUS_OK)
@@ -245,8 +616,6 @@ dc_generate_from_config_root (struct disir_context *context)
     {
         mold_equiv = context->cx_section->se_mold_equiv;
     }
-    version = &context->cx_root_context->cx_config->cf_version;
 
-    // We do not generate children whose minimum entry count is zero
-    return generate_config_from_mold_recursive_step (mold_equiv, context, version, 0);
+    return generate_config_parent (mold_equiv, context);
 }
@@ -0,0 +1,75 @@
+#ifndef _LIBDISIR_PRIVATE_ARENA_H
+#define _LIBDISIR_PRIVATE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Bump allocator backing the element tree of a single top-level context.
+//!
+//! Memory is carved sequentially out of chunks that double in size as the arena
+//! grows. Each block is preceded by a header recording its size. Freed blocks are
+//! kept in free lists by size and handed out again by later allocations, so that
+//! elements added to and removed from a live tree do not grow the arena.
+//! Chunks are only released, all together, when the last reference to the arena is dropped.
+//! The top-level context (config or mold) holds one reference, and every section
+//! and keyval allocated from the arena holds another, so that a child context
+//! kept alive by the user outlives the destruction of its root.
+//!
+//! Every function accepts a NULL arena, in which case allocations fall back
+//! to the system heap.
+struct disir_arena;
+
+//! Allocation statistics of a single arena.
+struct disir_arena_stats
+{
+    //! Number of allocations served from the arena.
+    uint64_t    as_allocations;
+    //! Number of chunks requested from the system heap.
+    uint64_t    as_chunks;
+    //! Bytes currently handed out to callers, including alignment padding.
+    //! Freed blocks are not counted, nor are the block headers.
+    uint64_t    as_bytes_used;
+    //! Bytes requested from the system heap for chunks.
+    uint64_t    as_bytes_reserved;
+};
+
+//! \brief Allocate a new arena, with a reference count of one.
+//!
+//! \return NULL if the allocation failed.
+//!
+struct disir_arena *
+dx_arena_create (void);
+
+//! \brief Add a reference to the arena. NULL is ignored.
+void
+dx_arena_incref (struct disir_arena *arena);
+
+//! \brief Remove a reference from the arena, releasing every chunk when the count reaches zero.
+//!
+//! \param[in,out] arena Arena to decref. The pointer is set to NULL. NULL is ignored.
+//!
+void
+dx_arena_decref (struct disir_arena **arena);
+
+//! \brief Allocate zeroed memory from the arena, aligned for any type.
+//!
+//! \return NULL if the allocation failed.
+//!
+void *
+dx_arena_alloc (struct disir_arena *arena, size_t size);
+
+//! \brief Return memory previously allocated with dx_arena_alloc.
+//!
+//! If arena is NULL, the memory is freed to the system heap. Otherwise the block
+//! is kept by the arena, to serve later allocations of the same size.
+//! The same arena ptr was allocated from must be passed.
+//!
+void
+dx_arena_free (struct disir_arena *arena, void *ptr);
+
+//! \brief Retrieve the allocation statistics of the arena.
+void
+dx_arena_stats (struct disir_arena *arena, struct disir_arena_stats *stats);
+
+
+#endif // _LIBDISIR_PRIVATE_ARENA_H
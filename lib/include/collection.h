@@ -9,8 +9,10 @@
 //! have an incremented reference count - only when the collection
 //! is freed or a coalesce operation is required will invalid contexts
 //! be decref'ed and removed from the collection.
+//! A coalesce is only required when a context has been destroyed since
+//! the collection was last coalesced, tracked by a global destroy generation.
 //! The collection has an in-built iterator, which returns the context
-//! as they were inputted to the collection.
+//! as they were inputted to the collection, skipping destroyed contexts.
 struct disir_collection
 {
     // Dynamically allocated array of disir_context objects.
@@ -25,6 +27,10 @@ struct disir_collection
 
     //! Index into cc_collection the iterator is presently at.
     int32_t         cc_iterator_index;
+
+    //! Destroy generation the collection was last coalesced at.
+    //! Zero if the collection may hold destroyed contexts regardless.
+    uint64_t        cc_generation;
 };
 
 //! INTERNAL API
@@ -33,6 +39,11 @@ struct disir_collection
 //! Decref and lose invalid context pointers.
 enum disir_status dx_collection_coalesce (struct disir_collection *collection);
 
+//! INTERNAL API
+//! Advance the destroy generation, so that every collection is coalesced before
+//! its size is next reported. Invoked whenever a context is destroyed.
+void dx_collection_context_destroyed (void);
+
 //! \brief Return the next entry in the collection without coalescing.
 //!
 //! This function is used to potentially retrieve destroyed contexts
@@ -25,6 +25,18 @@ struct disir_config
     //!     * DISIR_CONTEXT_KEYVAL
     //!     * DISIR_CONTEXT_SECTION.
     struct disir_element_storage    *cf_elements;
+
+    //! Arena every section and keyval in this config is allocated from.
+    //! NULL if libdisir is built without DISIR_CONTEXT_ARENA.
+    struct disir_arena              *cf_arena;
+
+    //! Incremented every time a context in this config is modified.
+    //! Starts at 1, since a cx_validated generation of zero means never validated.
+    uint64_t                        cf_generation;
+
+    //! Generation at which cf_version last changed.
+    //! Validation results computed before this generation are stale.
+    uint64_t                        cf_version_generation;
 };
 
 //! \brief Create a new disir_config structure with the input as its context representation
@@ -45,6 +57,13 @@ struct disir_config *dx_config_create (struct disir_context *context);
 //!
 enum disir_status dx_config_destroy (struct disir_config **config);
 
+//! \brief Set the version of config, invalidating every cached validation result.
+//!
+//! Restrictions are resolved against the config version, so any change to it
+//! may change the validity of every context in the config.
+//!
+void dx_config_set_version (struct disir_config *config, struct disir_version *version);
+
 
 #endif // _LIBDISIR_PRIVATE_CONFIG_H
 
@@ -57,11 +57,25 @@ struct disir_context
     //! is in possession of.
     int64_t                     cx_refcount;
 
+    //! Identity of the context, never reused by another context of the process.
+    uint64_t                    cx_serial;
+
     //! Allocated and populated if an error message occurs.
     //! Should probably be a stack of messages, with a counter.
     //! and a state counter!
     char                        *cx_error_message;
     int32_t                     cx_error_message_size;
+
+    //! Generation of the root CONFIG when this context, or any context below it,
+    //! was last modified. Unused for contexts whose root is MOLD.
+    uint64_t                    cx_changed;
+
+    //! Generation of the root CONFIG when cx_validity was computed. Zero if never.
+    uint64_t                    cx_validated;
+
+    //! Outcome of the last validation of this context.
+    //! Reused by dx_validate_context until cx_changed moves past cx_validated.
+    enum disir_status           cx_validity;
 };
 
 //
@@ -109,6 +123,19 @@ void dx_context_decref (struct disir_context **context);
 //! Attach 'parent' as parent context to 'context'
 void dx_context_attach (struct disir_context *parent, struct disir_context *context);
 
+//! \brief Record that 'context' is about to be modified.
+//!
+//! Advances the generation of the root CONFIG and marks 'context' and every
+//! ancestor as changed, so that their cached validation results are recomputed.
+//! Nothing is done for contexts whose root is not CONFIG.
+//!
+void dx_context_touch (struct disir_context *context);
+
+//! Return the arena the sections and keyvals below 'context' are allocated from.
+//! \return NULL if context is not a CONFIG, MOLD, SECTION or KEYVAL context,
+//!     or its elements are allocated on the heap.
+struct disir_arena *dx_context_arena (struct disir_context *context);
+
 //! Return the string representation of the disir_context_type enumeration
 const char * dx_context_type_string (enum disir_context_type type);
 
@@ -188,6 +215,21 @@ dx_get_mold_equiv (struct disir_context *context, struct disir_context **equiv);
 enum disir_status dx_get_mold_equiv_type (struct disir_context *parent,
                                           const char *name, enum disir_context_type *type);
 
+//! \brief Count the child elements of context matching name.
+//!
+//! Unlike dc_find_elements(), no collection is allocated.
+//!
+//! \param context CONFIG, MOLD or SECTION context to count child elements of.
+//! \param name Name of the child elements to count.
+//! \param[out] count Number of child elements matching name. Zero if none exist.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if name or count are NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is not CONFIG, MOLD or SECTION.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status dx_context_element_count (struct disir_context *context,
+                                            const char *name, int32_t *count);
+
 //! \brief Validate the input context for any erroneous state
 //!
 //! TODO: Implement error report.
@@ -215,6 +257,13 @@ enum disir_status dx_get_mold_equiv_type (struct disir_context *parent,
 //!
 enum disir_status dx_validate_context (struct disir_context *context);
 
+//! \brief Apply the validate_threads keyval of a libdisir config.
+//!
+//! The number of threads set by disir_validate_threads_set takes precedence.
+//! A negative number of threads is ignored.
+//!
+void dx_validate_threads_configured_set (int threads);
+
 //! \brief Retrieve all elements that are invalid.
 enum disir_status
 dx_invalid_elements (struct disir_context *context, struct disir_collection *collection);
@@ -225,6 +274,16 @@ dx_context_error_set (struct disir_context *context, const char *fmt_message, ..
 //! \brief Set the input message to the error string of context from va_list args
 void
 dx_context_error_set_va (struct disir_context *context, const char *fmt_message, va_list args);
+//! \brief Return the error message of context, as observed by the calling thread.
+//!
+//! Contexts of a finalized mold may be shared between threads, so any error message
+//! set on them afterwards is kept per thread, and the context itself is left untouched.
+const char *
+dx_context_error_get (struct disir_context *context);
+//! \brief Drop the error message the calling thread keeps for context, if any.
+//! Invoked when context is destroyed.
+void
+dx_context_error_forget (struct disir_context *context);
 
 
 //! Check that the passed context is either of the passed
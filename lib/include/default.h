@@ -39,6 +39,8 @@ enum disir_status dx_default_destroy (struct disir_default **def);
 //! \brief Query a keyval context, whose root is mold, for the active default entry for version.
 //!
 //! Internal function - No input validation is performed.
+//! Once the mold is finalized, the default is resolved through the default table
+//! of keyval, or the default view of the mold at version.
 //!
 //! \param[in] keyval Context KEYVAL whose root must be MOLD.
 //! \param[in] version Version to retrieve active default entry for. NULL indicates the greatest.
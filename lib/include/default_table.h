@@ -0,0 +1,73 @@
+#ifndef _LIBDISIR_PRIVATE_DEFAULT_TABLE_H
+#define _LIBDISIR_PRIVATE_DEFAULT_TABLE_H
+
+#include <disir/context.h>
+
+#include "default.h"
+#include "keyval.h"
+#include "mold.h"
+
+//! Forward declare Disir Default Table structure.
+//!
+//! The default entries of a mold KEYVAL, compiled for lookup.
+//! The versions the defaults are introduced at are packed into 64-bit integers
+//! and stored in a sorted array apart from the defaults they map to, so that
+//! resolving the active default of a version is a binary search over the packed versions.
+//!
+//! The table must be invalidated whenever the defaults of its keyval change.
+struct disir_default_table;
+
+//! Forward declare Disir Default View structure.
+//!
+//! The active default of every keyval in a mold at a single version.
+//! Views are kept in the mold, indexed by the kv_default_index of each keyval,
+//! and are filled in as keyvals are looked up at their version.
+struct disir_default_view;
+
+//! \brief Compile the default table of every keyval in the mold.
+//!
+//! Each keyval is assigned its kv_default_index into the default views of the mold.
+//! Any views previously created for the mold are discarded.
+//! Invoked when the mold is finalized.
+//!
+//! \param[in] context Context of the mold to compile.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if a table could not be allocated.
+//!     The keyvals without a table resolve their defaults from the default queue.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_default_table_compile_mold (struct disir_context *context);
+
+//! \brief Retrieve the default of keyval active at version, through its compiled table.
+//!
+//! The default is resolved through the default view of the mold at version, if it has one.
+//! Views are created for the first DISIR_MOLD_DEFAULT_VIEWS versions looked up;
+//! other versions are resolved through the table alone.
+//!
+//! \param[in] mold Mold keyval belongs to. May be NULL, in which case no view is used.
+//! \param[in] keyval Mold keyval to retrieve the default of.
+//! \param[in] version Version to resolve the active default at.
+//!
+//! \return NULL if keyval has no compiled table.
+//! \return the active default on success.
+//!
+struct disir_default *
+dx_default_table_get_active (struct disir_mold *mold, struct disir_keyval *keyval,
+                             struct disir_version *version);
+
+//! \brief Destroy the compiled table of keyval, and the default views of the mold, if any.
+//!
+//! The defaults of keyval are resolved from its default queue until the mold is compiled anew.
+//!
+//! \param[in] mold Mold keyval belongs to. May be NULL.
+//! \param[in] keyval Keyval whose defaults changed.
+//!
+void
+dx_default_table_invalidate (struct disir_mold *mold, struct disir_keyval *keyval);
+
+//! \brief Destroy every default view of the mold.
+void
+dx_default_views_destroy (struct disir_mold *mold);
+
+#endif // _LIBDISIR_PRIVATE_DEFAULT_TABLE_H
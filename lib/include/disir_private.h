@@ -1,9 +1,15 @@
 #ifndef _LIBDISIR_PRIVATE_DISIR_H
 #define _LIBDISIR_PRIVATE_DISIR_H
 
+#include <pthread.h>
+
 #include <disir/disir.h>
 #include <disir/plugin.h>
 
+#include "mold_cache.h"
+#include "stats.h"
+#include "thread_state.h"
+
 //! Internal plugin structure
 struct disir_register_plugin_internal
 {
@@ -24,23 +30,72 @@ struct disir_register_plugin_internal
     struct disir_register_plugin_internal *next, *prev;
 };
 
+//! Error message storage of a single thread operating on an instance.
+struct disir_error_storage
+{
+    //! Registration with the thread. Must be the first member.
+    struct dx_thread_record         er_record;
+    //! Error message sat on the disir instance by this thread.
+    char                            *er_message;
+    //! Bytes allocated/occupied by er_message.
+    int32_t                         er_message_size;
+
+    //! Instance this storage belongs to.
+    struct disir_instance           *er_instance;
+
+    struct disir_error_storage      *next, *prev;
+};
+
 //! \brief The main libdisir instance structure. All I/O operations requires an instance of it.
+//!
+//! The instance may be shared between threads. Members are either immutable after
+//! disir_instance_create(), or protected by the lock documented alongside them.
 struct disir_instance
 {
     //! Double-linked list queue loaded plugins
+    //! Plugins are only ever added (under write lock) and never removed before
+    //! the instance is destroyed. Traverse the queue under read lock.
     struct disir_register_plugin_internal    *dio_plugin_queue;
+    //! Protects dio_plugin_queue.
+    pthread_rwlock_t                dio_plugin_lock;
 
     //! Active configuration based of libdisir_mold
     struct disir_config             *libdisir_config;
 
-    //! Error message sat on the disir instance.
+    //! Error message sat on the disir instance, one per thread.
     //! Set with disir_error_set() and clear with disir_error_clear()
     //! Retrievable through disir_error() and disir_error_copy()
-    char                            *disir_error_message;
-    //! Bytes allocated/occupied by the disir_error_message.
-    int32_t                         disir_error_message_size;
+    //! The storage of the calling thread is found through dx_thread_record_find().
+    struct disir_error_storage      *dio_error_queue;
+    //! Protects dio_error_queue.
+    pthread_mutex_t                 dio_error_lock;
+
+    //! Molds read on behalf of config entries, shared between reads.
+    struct disir_mold_cache         dio_mold_cache;
+
+    //! Per-thread counters of the I/O operations invoked on this instance.
+    //! Retrieved through disir_instance_stats().
+    struct dx_stats_storage         dio_stats;
 };
 
+//! \brief Initialize the per-thread error storage of instance.
+enum disir_status
+dx_instance_error_init (struct disir_instance *instance);
+
+//! \brief Release the error storage of every thread that operated on instance.
+void
+dx_instance_error_finished (struct disir_instance *instance);
+
+//! \brief Retrieve the error storage of the calling thread on instance.
+//!
+//! \param[in] create Allocate the storage if the calling thread has none.
+//!
+//! \return NULL if the calling thread has no storage (and create is zero),
+//!     or if allocation failed.
+//!
+struct disir_error_storage *
+dx_instance_error_storage (struct disir_instance *instance, int create);
+
 //! \brief get disir_register_plugin by group id
 enum disir_status
 dx_retrieve_plugin_by_group (struct disir_instance *instance, const char *group_id,
@@ -5,15 +5,20 @@
 
 #include "collection.h"
 
+struct disir_arena;
+
 //! Forward declare Disir Element Storage structure.
 //! This is a private structure, even to the internals of Disir.
 struct disir_element_storage;
 
 //! \brief Allocate a new instance of the Disir Element Storage
 //!
+//! \param[in] arena Arena to allocate the storage and its keys from. NULL allocates on the heap.
+//!     The caller must keep a reference to the arena until the storage is destroyed.
+//!
 //! \return Pointer to the newly allocated instance. NULL if the allocation failed.
 struct disir_element_storage *
-dx_element_storage_create (void);
+dx_element_storage_create (struct disir_arena *arena);
 
 //! \brief Destroy a previously allocated instance of Disir Element Storage
 //!
@@ -97,6 +102,26 @@ dx_element_storage_get_all (struct disir_element_storage *storage,
                             struct disir_collection **collection);
 
 
+//! \brief Invoke callback on the contexts in storage, in insertion order.
+//!
+//! The contexts are passed borrowed - their reference count is not incremented.
+//! Contexts added to the storage by callback are visited as well, but
+//! contexts must not be removed from the storage while it is visited.
+//!
+//! \param[in] storage Storage to visit contexts of.
+//! \param[in] name Only visit the contexts stored with name. NULL visits every context.
+//! \param[in] callback Function invoked on each context.
+//! \param[in] userdata Passed through to callback.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if storage or callback are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if name is given and no context is stored with it.
+//! \return the first non-OK status returned by callback.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_element_storage_foreach (struct disir_element_storage *storage, const char *name,
+                            dc_visit_function callback, void *userdata);
+
 //! \brief Convenience method to get the first context with input name from storage.
 //!
 //! \param[in] storage Query storage to retrieve context from.
@@ -111,5 +136,57 @@ dx_element_storage_get_first (struct disir_element_storage *storage,
                               const char *name,
                               struct disir_context **context);
 
+//! \brief Get the context at position index of all contexts with input name in storage.
+//!
+//! Looks the context up directly in the storage, without allocating a collection.
+//! The reference count of the output context is NOT incremented.
+//!
+//! \param[in] storage Query storage to retrieve context from.
+//! \param[in] name Query parameter to locate context by in storage
+//! \param[in] index Position (in insertion order) among the contexts matching name.
+//! \param[out] context Populated context on success (if found in storage)
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if storage, name or context are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if no entry exists with name at index.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_element_storage_get_nth (struct disir_element_storage *storage,
+                            const char *name, unsigned int index,
+                            struct disir_context **context);
+
+//! \brief Same as dx_element_storage_get_nth(), with the name hashed up front.
+//!
+//! \param[in] hash Hash of name, as computed by dx_element_storage_hash().
+//!
+enum disir_status
+dx_element_storage_get_nth_hashed (struct disir_element_storage *storage,
+                                   const char *name, unsigned long hash, unsigned int index,
+                                   struct disir_context **context);
+
+//! \brief Compute the hash the element storage locates name by.
+//!
+//! The hash may be computed once and reused with dx_element_storage_get_nth_hashed()
+//! against any element storage.
+//!
+unsigned long
+dx_element_storage_hash (const char *name);
+
+//! \brief Return the number of contexts stored with input name.
+//!
+//! \return number of contexts matching name. -1 is returned if storage or name is NULL.
+//!
+int32_t
+dx_element_storage_count (struct disir_element_storage *storage, const char *name);
+
+//! \brief Retrieve the element storage of a CONFIG, MOLD or SECTION context.
+//!
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is of any other type.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_context_element_storage (struct disir_context *context,
+                            struct disir_element_storage **storage);
+
 #endif // _LIBDISIR_PRIVATE_ELEMENT_STORAGE_H
 
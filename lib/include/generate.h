@@ -0,0 +1,34 @@
+#ifndef _LIBDISIR_PRIVATE_GENERATE_H
+#define _LIBDISIR_PRIVATE_GENERATE_H
+
+#include <disir/context.h>
+
+#include "mold.h"
+
+//! Forward declare Disir Generate Template structure.
+//!
+//! Everything generating a config from a finalized mold at one version resolves,
+//! laid out once: every element of the mold in document order, each with its name,
+//! the number of entries generated of it and, for keyvals, the default value active
+//! at the version. Sections are followed by the elements below them.
+//!
+//! Cloning a template into an empty CONFIG or SECTION constructs its contexts directly
+//! from the nodes, without walking the mold, resolving names, restrictions and defaults,
+//! or validating each context as it is added. The contexts are validated once, when the
+//! config or section they are cloned into is finalized.
+struct disir_generate_template;
+
+//! \brief Discard the generate templates of the mold context belongs to.
+//!
+//! Invoked whenever an element, default or restriction is added to a mold,
+//! since either may change what is generated from it.
+//! Nothing is done unless the root of context is a MOLD.
+//!
+void
+dx_generate_templates_invalidate (struct disir_context *context);
+
+//! \brief Destroy every generate template of the mold.
+void
+dx_generate_templates_destroy (struct disir_mold *mold);
+
+#endif // _LIBDISIR_PRIVATE_GENERATE_H
@@ -0,0 +1,205 @@
+#ifndef DIO_JSON_LEXER_H
+#define DIO_JSON_LEXER_H
+
+// cpp standard
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace dio
+{
+    //! Type of a token read by JsonLexer.
+    enum json_token_type
+    {
+        JSON_TOKEN_END_OF_STREAM,
+        JSON_TOKEN_OBJECT_BEGIN,
+        JSON_TOKEN_OBJECT_END,
+        JSON_TOKEN_ARRAY_BEGIN,
+        JSON_TOKEN_ARRAY_END,
+        JSON_TOKEN_STRING,
+        JSON_TOKEN_NUMBER,
+        JSON_TOKEN_TRUE,
+        JSON_TOKEN_FALSE,
+        JSON_TOKEN_NULL,
+        JSON_TOKEN_ARRAY_SEPARATOR,
+        JSON_TOKEN_MEMBER_SEPARATOR,
+        JSON_TOKEN_COMMENT,
+        JSON_TOKEN_ERROR,
+    };
+
+    //! A token, referring directly into the document.
+    struct json_token
+    {
+        enum json_token_type    jt_type;
+        const char              *jt_start;
+        const char              *jt_end;
+    };
+
+    //! Type of a decoded JSON number.
+    enum json_number_type
+    {
+        JSON_NUMBER_INTEGER,
+        JSON_NUMBER_UNSIGNED,
+        JSON_NUMBER_REAL,
+    };
+
+    //! A decoded JSON number.
+    struct json_number
+    {
+        enum json_number_type   jn_type;
+        union
+        {
+            int64_t             jn_integer;
+            uint64_t            jn_unsigned;
+            double              jn_real;
+        };
+    };
+
+    //! A member of a JSON object.
+    struct json_member
+    {
+        std::string             jm_name;
+        //! Position of the first token of the member value.
+        const char              *jm_value;
+    };
+
+    //! The members of a JSON object, as recorded by JsonLexer::validate().
+    struct json_object
+    {
+        //! Position right after the opening '{'.
+        const char              *jo_begin;
+        //! Position right after the closing '}'.
+        const char              *jo_end;
+        //! Index of the first member in the member table of the lexer.
+        size_t                  jo_first;
+        //! Number of members, duplicate names included, in document order.
+        size_t                  jo_count;
+    };
+
+    //! \brief Tokenizer for JSON documents held in memory.
+    //!
+    //! Accepts the same documents as Json::Reader with its default features,
+    //! and reports the first error with the same message and location.
+    //! Decoding never allocates, except for the strings handed to the caller.
+    class JsonLexer
+    {
+    public:
+        //! \brief Construct a lexer for the document in [begin, end)
+        JsonLexer (const char *begin, const char *end);
+
+        //! \brief Validate the syntax of the complete document.
+        //!
+        //! The members of every object are recorded along the way,
+        //! such that read_members() never has to scan an object twice.
+        //!
+        //! \return false on syntax error. The error is available through error_message().
+        //!
+        bool
+        validate ();
+
+        //! \brief Look up the members of the object whose '{' was just read.
+        //!
+        //! Leaves the lexer past the closing '}'. The document must already be validated.
+        //!
+        //! \return NULL if no object was recorded at the current position.
+        //!
+        const struct json_object *
+        read_members ();
+
+        //! \brief Member at index in the member table. See struct json_object.
+        const struct json_member&
+        member (size_t index) const { return m_members[index]; }
+
+        //! \brief Read the next token, comments included.
+        void
+        read_token (struct json_token& token);
+
+        //! \brief Read the next token that is not a comment.
+        void
+        read_token_skip_comments (struct json_token& token);
+
+        //! \brief Skip whitespace and report whether the next character is c.
+        bool
+        peek (char c);
+
+        //! \brief Decode the string token into decoded, without the surrounding quotes.
+        bool
+        decode_string (const struct json_token& token, std::string& decoded);
+
+        //! \brief Decode the number token the same way Json::Reader does.
+        bool
+        decode_number (const struct json_token& token, struct json_number& number);
+
+        //! \brief Continue reading from position
+        void
+        seek (const char *position) { m_current = position; }
+
+        //! \brief Position of the next character to read.
+        const char *
+        position () const { return m_current; }
+
+        //! \brief Whether validate() stopped because the document nests too deep.
+        bool
+        depth_exceeded () const { return m_depth_exceeded; }
+
+        //! \brief Formatted the same way as Json::Reader::getFormattedErrorMessages.
+        std::string
+        error_message () const;
+
+    private:
+        bool
+        validate_value (int depth);
+
+        bool
+        validate_object (int depth);
+
+        bool
+        record_object (size_t object, size_t pending);
+
+        bool
+        validate_array (int depth);
+
+        bool
+        read_comment ();
+
+        bool
+        read_string ();
+
+        void
+        read_number ();
+
+        bool
+        match (const char *pattern, int length);
+
+        bool
+        decode_unicode_escape (const struct json_token& token,
+                               const char *& current, const char *end, unsigned int& unicode);
+
+        bool
+        add_error (const char *message, const struct json_token& token,
+                   const char *extra = nullptr);
+
+        void
+        location (const char *position, int& line, int& column) const;
+
+    private:
+        const char      *m_begin;
+        const char      *m_end;
+        const char      *m_current;
+
+        bool            m_depth_exceeded = false;
+        bool            m_error = false;
+        std::string     m_error_message;
+        struct json_token m_error_token;
+        const char      *m_error_extra = nullptr;
+
+        //! Every object in the document, ordered by position.
+        std::vector<struct json_object> m_objects;
+        //! Members of every object. The members of one object are adjacent.
+        std::vector<struct json_member> m_members;
+        //! Members of the objects currently being validated, innermost last.
+        std::vector<struct json_member> m_pending;
+    };
+}
+
+#endif
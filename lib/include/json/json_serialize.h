@@ -2,8 +2,11 @@
 #define DIO_JSON_OUTPUT_H
 
 #include "dplugin_json.h"
+#include "json_writer.h"
 #include <json/json.h>
 
+#include <vector>
+
 namespace dio
 {
     // A Class implementing o a
@@ -36,40 +39,71 @@ namespace dio
         serialize (struct disir_config *config, std::ostream& stream);
 
      private:
+        //! A section or keyval below the context being written.
+        struct config_element
+        {
+            struct disir_context        *ce_context;
+            enum disir_context_type     ce_type;
+            const char                  *ce_name;
+            int32_t                     ce_name_size;
+            //! Position among its siblings.
+            size_t                      ce_index;
+            //! Children of a section, once retrieved.
+            std::vector<struct config_element> ce_children;
+            bool                        ce_retrieved;
+        };
+
         // Variables
-        Json::Value m_configRoot;
         struct disir_context *m_contextConfig;
+        std::string m_value;
 
-        //! \brief Retrive context name
+        //! \brief Write the complete config document to writer
         enum disir_status
-        get_context_key (struct disir_context *context, std::string& key);
+        serialize (struct disir_config *config, JsonWriter& writer);
 
-        //! \brief Serialize section name
+        //! \brief Serialize config version
         enum disir_status
-        set_section_keyname (struct disir_context *context, Json::Value& parent,
-                             Json::Value& sectionVal);
+        set_config_version (struct disir_context *context_config, std::string& version);
 
-        // \brief Serialize keyval value
+        //! \brief Retrieve the sections and keyvals of context into elements
         enum disir_status
-        set_keyval (struct disir_context *context, std::string name, Json::Value& node);
+        get_elements (struct disir_context *context, std::vector<struct config_element>& elements);
+
+        //! Elements being retrieved by get_elements.
+        struct config_element_visit;
 
-        // \brief Serialize keyval name and value
+        //! \brief dc_visit_function appending each borrowed section and keyval to the elements
+        static enum disir_status
+        visit_config_element (struct disir_context *context, void *userdata);
+
+        //! \brief Retrieve the children of the section element, unless already retrieved
         enum disir_status
-        serialize_keyval (struct disir_context *context, Json::Value& parent);
+        get_children (struct config_element& element);
 
-        //! \brief Serialize config version
+        //! \brief Release elements and their children, once written
+        void
+        put_elements (std::vector<struct config_element>& elements);
+
+        //! \brief Format the value of keyval context into m_value
         enum disir_status
-        set_config_version (struct disir_context *context_config, Json::Value& root);
+        format_keyval (struct disir_context *context);
 
-        //! \brief recursive function that extracts an entire config starting from root
+        //! \brief Write elements as the members of an object.
+        //!
+        //! Elements with identical names under the same parent are merged into an array,
+        //! at the position of the first of them. If not ordered, members are written
+        //! sorted by name, the way Json::StyledWriter writes objects within arrays.
         enum disir_status
-        _serialize_context (struct disir_context *parent_context, Json::Value& parent);
+        write_object (JsonWriter& writer, std::vector<struct config_element>& elements,
+                      bool ordered);
 
-        //! \brief if a config has keyvals or sections with identical names
-        //! under the same root, we merge them into an array.
-        void
-        serialize_duplicate_entries (Json::Value& parent, Json::Value& child,
-                                     const std::string name);
+        //! \brief Write a single keyval value or section
+        enum disir_status
+        write_element (JsonWriter& writer, struct config_element& element, bool ordered);
+
+        //! \brief Write elements with identical names as an array
+        enum disir_status
+        write_entries (JsonWriter& writer, std::vector<struct config_element *>& entries);
     };
 
     // Class implementing outputting a
@@ -127,6 +161,14 @@ namespace dio
         enum disir_status
         _serialize_mold_contexts (struct disir_context *parent_context, Json::Value& parent);
 
+        //! \brief Serialize a single keyval or section into parent, by its name
+        enum disir_status
+        serialize_mold_element (struct disir_context *context, Json::Value& parent);
+
+        //! \brief dc_visit_function serializing each element of _serialize_mold_contexts
+        static enum disir_status
+        visit_mold_element (struct disir_context *context, void *userdata);
+
         //! \brief fetch all default contexts from keyval and serialize them into an array
         enum disir_status
         serialize_default (struct disir_context *context, Json::Value& defaults);
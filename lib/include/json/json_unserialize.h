@@ -4,9 +4,11 @@
 #include "dplugin_json.h"
 #include <json/json.h>
 #include "json/json_mold_override.h"
+#include "json/json_lexer.h"
 
 // cpp standard
 #include <memory>
+#include <vector>
 
 namespace dio
 {
@@ -31,43 +33,61 @@ namespace dio
         enum disir_status
         unserialize (struct disir_config **config, const std::string Json);
 
+        //! \brief Read a disir_config from the JSON document in [begin, end)
+        //!
+        //! The document is validated in full before any context is created.
+        //! Contexts are then constructed directly from the tokens of the document,
+        //! without building an intermediate Json::Value tree.
+        //!
+        //! \return DISIR_STATUS_OK on success.
+        //! \return DISIR_STATUS_INVALID_CONTEXT if the config is constructed but invalid.
+        //! \return DISIR_STATUS_FS_ERROR if the document is not valid JSON.
+        //! \return DISIR_STATUS_INTERNAL_ERROR if the document nests too deep,
+        //!     or holds values that cannot be represented in a config.
+        //!
+        enum disir_status
+        unserialize (struct disir_config **config, const char *begin, const char *end);
+
     private:
 
         //! \brief Sets a version on the config
         //!
         //! \param[in] context_config the config to which the version is set.
-        //! \param[in] ver json object containing the version string
+        //! \param[in] lexer lexer positioned at the version value, or NULL if absent.
         //!
         enum disir_status
-        set_config_version (struct disir_context *context_config, Json::Value& ver);
+        set_config_version (struct disir_context *context_config, JsonLexer *lexer);
 
         //! \brief populates parent context with value type of keyval
         enum disir_status
-        set_keyval (struct disir_context *parent_context, std::string name, Json::Value& keyval);
+        set_keyval (struct disir_context *parent_context, std::string& name,
+                    JsonLexer& lexer, struct json_token& token, struct json_number& number);
 
-        //! \brief Unserializes primitives according to the json type
+        //! \brief Unserializes the value at the lexer according to its json type
         enum disir_status
-        unserialize_type (struct disir_context *context, Json::Value& value, std::string& name);
+        unserialize_type (struct disir_context *context, JsonLexer& lexer, std::string& name);
 
         //! \brief Unserialize multiple values of a keyval
         enum disir_status
-        unserialize_array (struct disir_context *parent, Json::Value& array, std::string& name);
+        unserialize_array (struct disir_context *parent, JsonLexer& lexer, std::string& name);
 
-        //! \brief Constructs a disir_keyval object from a Json::Value object
-        //! The parameter is of type iterator and not Value to provide the function with
-        //! the keyname
+        //! \brief After validating the document, this constructs the config.
         enum disir_status
-        unserialize_keyval_entry (struct disir_context *parent_context,
-                                  Json::OrderedValueIterator& keyval_entry);
+        construct_config (JsonLexer& lexer, struct disir_config **config);
 
-        //! \brief After unserialization into internal m_configRoot, this constructs the config.
+        //! \brief reads the members of a json object, after its opening brace,
+        //!     and populates parent_context accordingly
         enum disir_status
-        construct_config (Json::Value& root, struct disir_config **config);
+        _unserialize_node (struct disir_context *parent_context, JsonLexer& lexer);
 
-        //! \brief recursively reads a json config starting from root and
-        //!     populated a disir_config accordingly
-        enum disir_status
-        _unserialize_node (struct disir_context *parent_context, Json::Value& parent);
+        //! \brief The json type the value token would have been read as.
+        //!     Number tokens are decoded into number.
+        Json::ValueType
+        token_value_type (JsonLexer& lexer, struct json_token& token,
+                          struct json_number& number);
+
+        //! Decoded string values, reused between keyvals
+        std::string m_value;
 
     public:
         //! holding the mold reference
@@ -109,6 +129,16 @@ namespace dio
             enum disir_status
             unserialize (std::string mold_json, struct disir_mold **mold);
 
+            //! \brief Construct a disir_mold from the JSON document in [begin, end)
+            //!
+            //! \return DISIR_STATUS_OK on success.
+            //! \return DISIR_STATUS_INVALID_CONTEXT if serialized mold
+            //!     contains elements that are not according to spesification.
+            //! \return DISIR_STATUS_FS_ERROR if json object is unparasable.
+            //!
+            enum disir_status
+            unserialize (const char *begin, const char *end, struct disir_mold **mold);
+
             //! \brief Set mold override
             //!
             //! param[in] stream Mold override
@@ -0,0 +1,118 @@
+#ifndef DIO_JSON_WRITER_H
+#define DIO_JSON_WRITER_H
+
+// 3party
+#include <json/json.h>
+
+// cpp standard
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//! Number of bytes collected by JsonWriter before they are handed to the output.
+#define JSON_WRITER_BUFFER_SIZE (64 * 1024)
+
+//! Indentation and line width used by Json::StyledWriter.
+#define JSON_WRITER_INDENT_SIZE 3
+#define JSON_WRITER_RIGHT_MARGIN 74
+
+namespace dio
+{
+    //! \brief Buffered JSON output, laid out the same way as Json::StyledWriter.
+    //!
+    //! Output is collected in a fixed size buffer that is handed to the stream
+    //! or string each time it fills up. The complete document is never held in memory.
+    //! Callers lay out objects and arrays with the indentation primitives below,
+    //! which behave exactly like their namesakes in Json::StyledWriter.
+    class JsonWriter
+    {
+    public:
+        //! \brief Construct a writer that flushes to stream.
+        JsonWriter (std::ostream& stream);
+
+        //! \brief Construct a writer that appends to output.
+        JsonWriter (std::string& output);
+
+        //! \brief Flushes any remaining output.
+        ~JsonWriter ();
+
+        //! \brief Write size bytes of data as is.
+        void
+        write (const char *data, size_t size);
+
+        //! \brief Write string as is.
+        void
+        write (const std::string& string) { write (string.data (), string.size ()); }
+
+        //! \brief Start a new line at the current indentation, unless already there.
+        void
+        write_indent ();
+
+        //! \brief Write string as is, on a new line at the current indentation.
+        void
+        write_with_indent (const std::string& string);
+
+        //! \brief Increase the indentation of the following lines.
+        void
+        indent ();
+
+        //! \brief Decrease the indentation of the following lines.
+        void
+        unindent ();
+
+        //! \brief Write root followed by a newline, like Json::StyledWriter::writeOrdered.
+        void
+        write_document (const Json::Value& root);
+
+        //! \brief Hand all buffered output to the stream or string.
+        //!
+        //! \return false if the stream has failed, now or during an earlier flush.
+        //!
+        bool
+        flush ();
+
+        //! \brief Append the quoted and escaped value to out.
+        static void
+        format_string (std::string& out, const char *value);
+
+        //! \brief Append the decimal representation of value to out.
+        static void
+        format_integer (std::string& out, int64_t value);
+
+        //! \brief Append the decimal representation of value to out.
+        static void
+        format_unsigned (std::string& out, uint64_t value);
+
+        //! \brief Append value, with 16 significant digits, to out.
+        static void
+        format_real (std::string& out, double value);
+
+        //! \brief Whether an array of the single line values would be written on a
+        //! single line by Json::StyledWriter.
+        static bool
+        fits_single_line (const std::vector<std::string>& values);
+
+    private:
+        void
+        write_value (const Json::Value& value, bool ordered);
+
+        void
+        write_array (const Json::Value& value);
+
+        void
+        format_scalar (std::string& out, const Json::Value& value);
+
+    private:
+        std::vector<char> m_buffer;
+        size_t          m_used = 0;
+        //! Last character written, zero before anything is written.
+        char            m_last = 0;
+        bool            m_failed = false;
+        std::string     m_indent;
+        std::ostream    *m_stream = nullptr;
+        std::string     *m_output = nullptr;
+    };
+}
+
+#endif
@@ -37,6 +37,21 @@ struct disir_keyval
     uint32_t                    kv_disabled;
 
     struct disir_restriction    *kv_restrictions_queue;
+
+    //! Exclusive restrictions of kv_restrictions_queue compiled for lookup.
+    //! Compiled on first use by a config KEYVAL whose mold equivalent this is.
+    struct disir_restriction_table *kv_restriction_table;
+
+    //! Default entries of kv_default_queue compiled for lookup.
+    //! Compiled when the mold is finalized. NULL resolves defaults from the queue.
+    struct disir_default_table  *kv_default_table;
+
+    //! One-based index of this keyval into the default views of its mold. Zero if not indexed.
+    uint32_t                    kv_default_index;
+
+    //! Arena of the top-level context this keyval is allocated from.
+    //! The keyval, its name and its string value live in it. Holds a reference.
+    struct disir_arena          *kv_arena;
 };
 
 //! Construct a DISIR_CONTEXT_KEYVAL as a child of parent.
@@ -45,8 +60,8 @@ enum disir_status dx_keyval_begin (struct disir_context *parent, struct disir_co
 //! Finalize the construction of a DISIR_CONTEXT_KEYVAL
 enum disir_status dx_keyval_finalize (struct disir_context *keyval);
 
-//! Allocate a disir_keyval structure
-struct disir_keyval *dx_keyval_create (struct disir_context *parent);
+//! Allocate a disir_keyval structure from arena (NULL allocates on the heap)
+struct disir_keyval *dx_keyval_create (struct disir_context *parent, struct disir_arena *arena);
 
 //! Destroy a disir_keyval structure, freeing all associated
 //! memory and unhooking from linked list storage.
@@ -5,6 +5,8 @@
 
 #include <disir/context.h>
 
+#include "trace.h"
+
 //! All defined LOG LEVELS for disir logging
 enum disir_log_level {
     //! Nothing will be logged! O-oh..
@@ -38,6 +40,32 @@ enum disir_log_level {
     DISIR_LOG_LEVEL_TRACE_EXIT = 52,
 };
 
+//! Highest log level compiled into libdisir. Log statements above this level
+//! are removed entirely by the compiler. Configured through the CMake cache
+//! variable DISIR_LOG_LEVEL_MAX. Note that TRACE (51, 52) sorts between DEBUG_05 and DEBUG_06.
+#ifndef DISIR_LOG_LEVEL_MAX
+#define DISIR_LOG_LEVEL_MAX DISIR_LOG_LEVEL_DEBUG_10
+#endif
+
+//! Active log level. Entries above this level are not logged.
+extern enum disir_log_level runtime_loglevel;
+//! Let TRACE entries through regardless of runtime_loglevel.
+extern int force_enable_trace;
+
+//! Resolve the effective log level of a DEBUG entry with severity 1-10 to DEBUG_XX.
+#define DX_LOG_LEVEL_RESOLVE(level, severity) \
+    ((level) == DISIR_LOG_LEVEL_DEBUG && (severity) >= 1 && (severity) <= 10 \
+        ? (severity) * 10 : (int) (level))
+
+#define DX_LOG_LEVEL_IS_TRACE(level) \
+    ((level) == DISIR_LOG_LEVEL_TRACE_ENTER || (level) == DISIR_LOG_LEVEL_TRACE_EXIT)
+
+//! Evaluates to true if an entry at level/severity would be logged.
+//! With constant level and severity, the compile-time part folds away entirely.
+#define DX_LOG_ENABLED(level, severity) \
+    (DX_LOG_LEVEL_RESOLVE (level, severity) <= DISIR_LOG_LEVEL_MAX \
+     && (DX_LOG_LEVEL_RESOLVE (level, severity) <= (int) runtime_loglevel \
+         || (DX_LOG_LEVEL_IS_TRACE (level) && force_enable_trace)))
 
 //! Generic function signature for all logging methods
 void dx_log_disir (enum disir_log_level dll,
@@ -75,13 +103,21 @@ void dx_log_disir_va (enum disir_log_level dll,
                  prefix, \
                  ##__VA_ARGS__)
 
+// Only log if the level is enabled - no arguments are evaluated otherwise.
+// Entries storing an error message on a context or instance must never be filtered.
+#define _log_disir_filtered(level, severity, context, ...) \
+    do { \
+        if (DX_LOG_ENABLED (level, severity)) \
+            _log_disir_full (level, severity, context, NULL, 0, NULL, ##__VA_ARGS__); \
+    } while (0)
+
 // Hide away some details for log_disir
 #define _log_disir_level(level, ...) \
-    _log_disir_full (level, 0, NULL, NULL, 0, NULL, ##__VA_ARGS__)
+    _log_disir_filtered (level, 0, NULL, ##__VA_ARGS__)
 #define _log_disir_level_context(level, severity, context, ...) \
-    _log_disir_full (level, severity, context, NULL, 0, NULL, ##__VA_ARGS__)
+    _log_disir_filtered (level, severity, context, ##__VA_ARGS__)
 #define _log_disir_level_debug(severity, ...) \
-    _log_disir_full (DISIR_LOG_LEVEL_DEBUG, severity, NULL, NULL, 0, NULL, ##__VA_ARGS__)
+    _log_disir_filtered (DISIR_LOG_LEVEL_DEBUG, severity, NULL, ##__VA_ARGS__)
 
 
 #define log_fatal_context(context, ...) \
@@ -102,8 +138,17 @@ void dx_log_disir_va (enum disir_log_level dll,
 #define log_test(...) _log_disir_level(DISIR_LOG_LEVEL_TEST, ##__VA_ARGS__)
 #define log_info(...) _log_disir_level(DISIR_LOG_LEVEL_INFO, ##__VA_ARGS__)
 #define log_debug(severity, ...) _log_disir_level_debug(severity, ##__VA_ARGS__)
-#define TRACE_ENTER(...) _log_disir_level(DISIR_LOG_LEVEL_TRACE_ENTER, ##__VA_ARGS__)
-#define TRACE_EXIT(...) _log_disir_level(DISIR_LOG_LEVEL_TRACE_EXIT, ##__VA_ARGS__)
+
+// TRACE entries are also recorded as spans while tracing is enabled, regardless of log level.
+// The span is scoped to the enclosing block - it is closed on every return, with or without
+// TRACE_EXIT. Thus, TRACE_ENTER is a declaration: once per block, and never jumped over.
+#define TRACE_ENTER(...) \
+    struct dx_trace_scope _trace_scope __attribute__ ((cleanup (dx_trace_scope_close))) = \
+        (__atomic_load_n (&dx_trace_enabled, __ATOMIC_RELAXED) \
+         ? dx_trace_enter (__func__) : DX_TRACE_SCOPE_NONE); \
+    _log_disir_level(DISIR_LOG_LEVEL_TRACE_ENTER, ##__VA_ARGS__)
+#define TRACE_EXIT(...) \
+    _log_disir_level(DISIR_LOG_LEVEL_TRACE_EXIT, ##__VA_ARGS__)
 
 
 // Log specially to context
@@ -112,6 +157,12 @@ void dx_log_disir_va (enum disir_log_level dll,
     _log_disir_full(DISIR_LOG_LEVEL_ERROR, 0, context, NULL, 1, NULL, ##__VA_ARGS__)
 
 
+//! \brief Redirect the log sink to the input filepath.
+//!
+//! Pending log lines are flushed to the previous file before it is closed.
+//! The new file is opened (in append mode) on the next flush.
+void dx_log_filepath_set (const char *filepath);
+
 //! Crash and burn.. Output message on stderr before it aborts.
 //! USE WITH EXTREME CARE
 void dx_crash_and_burn(const char* message, ...);
@@ -5,6 +5,15 @@
 #include "documentation.h"
 #include "element_storage.h"
 
+//! Number of versions the active defaults of a mold are cached for.
+#define DISIR_MOLD_DEFAULT_VIEWS 8
+
+//! Number of versions configs generated from a mold are templated for.
+#define DISIR_MOLD_GENERATE_TEMPLATES 4
+
+struct disir_default_view;
+struct disir_generate_template;
+
 //! Represents a complete mold instance.
 struct disir_mold
 {
@@ -12,6 +21,8 @@ struct disir_mold
     struct disir_context                            *mo_context;
 
     //! Count of how many ADT structure pointers the user posesses.
+    //! Molds are shared between threads (e.g. through the instance mold cache);
+    //! only modify it through dx_mold_incref() and disir_mold_finished().
     int                             mo_reference_count;
 
     //! Version of this mold.
@@ -24,6 +35,21 @@ struct disir_mold
 
     //! Documentation associated with the disir_mold.
     struct disir_documentation      *mo_documentation_queue;
+
+    //! Arena every section and keyval in this mold is allocated from.
+    //! NULL if libdisir is built without DISIR_CONTEXT_ARENA.
+    struct disir_arena              *mo_arena;
+
+    //! Active defaults of every keyval, for each of the first versions looked up.
+    //! Created by dx_default_table_get_active; slots are filled once and never replaced.
+    struct disir_default_view       *mo_default_views[DISIR_MOLD_DEFAULT_VIEWS];
+
+    //! Number of keyvals indexed into the default views when the mold was finalized.
+    uint32_t                        mo_default_view_size;
+
+    //! Templates of the config generated from this mold, for each of the first versions
+    //! generated at. Built by the generate operations; slots are filled once and never replaced.
+    struct disir_generate_template  *mo_generate_templates[DISIR_MOLD_GENERATE_TEMPLATES];
 };
 
 //! INTERNAL API
@@ -34,6 +60,10 @@ struct disir_mold *dx_mold_create (struct disir_context *context);
 //! Destroy the passed struct disir_mold
 enum disir_status dx_mold_destroy (struct disir_mold **mold);
 
+//! INTERNAL API
+//! Atomically increment the reference count of mold.
+void dx_mold_incref (struct disir_mold *mold);
+
 //! \brief Conditionally update the version number of the mold if input version is greater.
 //!
 //! \param mold Input mold to update the version number of
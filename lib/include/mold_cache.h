@@ -0,0 +1,93 @@
+#ifndef _LIBDISIR_PRIVATE_MOLD_CACHE_H
+#define _LIBDISIR_PRIVATE_MOLD_CACHE_H
+
+#include <sys/types.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <disir/disir.h>
+#include <disir/plugin.h>
+
+//! Identity of a file on disk at the time a mold was read from it.
+//! All members are zero if the file did not exist.
+struct disir_mold_cache_file
+{
+    dev_t               mcf_dev;
+    ino_t               mcf_ino;
+    off_t               mcf_size;
+    struct timespec     mcf_mtime;
+};
+
+//! A single mold held by the instance mold cache.
+//! The entry owns one reference (mo_reference_count) to mce_mold.
+struct disir_mold_cache_entry
+{
+    //! Group the plugin that read this mold is registered to.
+    char                            *mce_group_id;
+    //! Resolved filepath of the (possibly namespace) mold entry.
+    char                            *mce_filepath;
+    //! Resolved filepath of the override entry. Empty string if none.
+    char                            *mce_override_filepath;
+
+    //! Stat of mce_filepath when the mold was read.
+    struct disir_mold_cache_file    mce_stat;
+    //! Stat of mce_override_filepath when the mold was read.
+    struct disir_mold_cache_file    mce_override_stat;
+
+    //! The cached mold.
+    struct disir_mold               *mce_mold;
+
+    struct disir_mold_cache_entry   *next, *prev;
+};
+
+//! Cache of parsed molds owned by a struct disir_instance.
+struct disir_mold_cache
+{
+    //! Double-linked list of cached molds.
+    struct disir_mold_cache_entry   *mc_queue;
+
+    //! Number of lookups served from the cache.
+    uint64_t                        mc_hits;
+    //! Number of lookups that required the plugin to read the mold.
+    uint64_t                        mc_misses;
+    //! Number of entries dropped because the file(s) on disk changed.
+    uint64_t                        mc_invalidations;
+
+    //! Protects every member above. Never held while a plugin reads a mold.
+    pthread_mutex_t                 mc_lock;
+};
+
+//! \brief Initialize an empty mold cache.
+void
+dx_mold_cache_init (struct disir_mold_cache *cache);
+
+//! \brief Release every mold held by the cache, and the cache lock.
+void
+dx_mold_cache_finished (struct disir_mold_cache *cache);
+
+//! \brief Read the mold covering entry_id through the instance mold cache.
+//!
+//! The mold entry is resolved on the filesystem relative to the plugin mold_base_id.
+//! If a cached mold exists for the (group_id, mold filepath, override filepath)
+//! and neither file has changed (device, inode, size or mtime) since it was read,
+//! the cached mold is returned with its reference count incremented.
+//! Otherwise, the mold is read through plugin->dp_mold_read and stored in the cache.
+//!
+//! Plugins whose mold entries cannot be resolved on the filesystem, or plugins
+//! not registered with the instance, bypass the cache entirely.
+//!
+//! The caller must invoke disir_mold_finished() on the returned mold.
+//!
+//! \return DISIR_STATUS_OK on success.
+//! \return status of plugin->dp_mold_read on failure.
+//!
+enum disir_status
+dx_mold_cache_read (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                    const char *entry_id, struct disir_mold **mold);
+
+//! \brief Release every mold held by the cache. Counters are left untouched.
+void
+dx_mold_cache_clear (struct disir_mold_cache *cache);
+
+#endif // _LIBDISIR_PRIVATE_MOLD_CACHE_H
+
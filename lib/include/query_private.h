@@ -1,6 +1,28 @@
 #ifndef _LIBDISIR_PRIVATE_QUERY_H
 #define _LIBDISIR_PRIVATE_QUERY_H
 
+//! A single pre-parsed name of a compiled query.
+struct disir_query_component
+{
+    //! Name of the element.
+    char            *qc_name;
+    //! Hash of qc_name, as located by the element storage.
+    unsigned long   qc_hash;
+    //! Index of the element among elements of the same name.
+    unsigned int    qc_index;
+};
+
+//! A compiled query - see dc_query_compile().
+struct disir_query
+{
+    //! The query name the handle was compiled from.
+    char                            *qu_name;
+    //! Array of names to resolve, in order from the root.
+    struct disir_query_component    *qu_components;
+    //! Number of entries in qu_components.
+    int                             qu_numcomponents;
+};
+
 //! \brief Resolve a heirarchical name structure by extracting first name and index
 //!
 //! \param[in] parent The context errors on this query should be logged to
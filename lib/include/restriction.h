@@ -61,6 +61,13 @@ enum disir_status dx_restriction_destroy (struct disir_restriction **restriction
 enum disir_status
 dx_restriction_get_queue (struct disir_context *context, struct disir_restriction ***queue);
 
+//! \brief Invalidate what is compiled from the restrictions of the parent of context.
+//!
+//! Must be invoked whenever a restriction is added to, removed from or modified
+//! within the restriction queue of a KEYVAL.
+//!
+void dx_restriction_parent_changed (struct disir_context *context);
+
 
 //! \brief Check KEYVAL context value type if within restriction bounds.
 //!
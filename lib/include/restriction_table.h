@@ -0,0 +1,95 @@
+#ifndef _LIBDISIR_PRIVATE_RESTRICTION_TABLE_H
+#define _LIBDISIR_PRIVATE_RESTRICTION_TABLE_H
+
+#include <disir/context.h>
+
+#include "restriction.h"
+
+//! Forward declare Disir Restriction Table structure.
+//!
+//! The exclusive value restrictions of a mold KEYVAL, compiled for lookup.
+//! The versions restrictions are introduced and deprecated at divide the version
+//! line into segments with a constant set of active restrictions. Each segment holds
+//! a hash set of its enum values, its value ranges merged into a sorted array of
+//! disjoint intervals, and its exact numeric values in a sorted array.
+//! The inclusive restrictions are kept apart, so they can be resolved without
+//! traversing the exclusive ones.
+//!
+//! Enum values reference the strings of the restrictions they are compiled from.
+//! The table must be invalidated whenever the restrictions of its keyval change.
+struct disir_restriction_table;
+
+//! \brief Retrieve the compiled table of the restrictions in queue, compiling it on first use.
+//!
+//! Mold contexts are shared between threads. Concurrent callers may both compile the
+//! table; only one of them is stored in 'table', the other is discarded.
+//!
+//! \param[in,out] table Location the compiled table is stored at.
+//! \param[in] queue Restriction queue of the mold KEYVAL owning 'table'.
+//!
+//! \return NULL if memory could not be allocated.
+//! \return the compiled table on success.
+//!
+struct disir_restriction_table *
+dx_restriction_table_get (struct disir_restriction_table **table,
+                          struct disir_restriction *queue);
+
+//! \brief Destroy the compiled table, if any. It is compiled anew on next retrieval.
+//!
+//! \param[in,out] table Location the compiled table is stored at. Sat to NULL.
+//!
+void
+dx_restriction_table_invalidate (struct disir_restriction_table **table);
+
+//! \brief Check a numeric value against the exclusive restrictions active at version.
+//!
+//! \param[in] table Compiled table to query.
+//! \param[in] version Version to resolve active restrictions at.
+//! \param[in] value Value to check. INTEGER values are checked as their double.
+//! \param[out] active Populated with the number of exclusive restrictions active at version.
+//!
+//! \return 1 if value fulfills any of the active VALUE_RANGE or VALUE_NUMERIC restrictions.
+//! \return 0 if it does not.
+//!
+int
+dx_restriction_table_check_numeric (struct disir_restriction_table *table,
+                                    struct disir_version *version,
+                                    double value, uint32_t *active);
+
+//! \brief Check an enum value against the exclusive restrictions active at version.
+//!
+//! \param[in] table Compiled table to query.
+//! \param[in] version Version to resolve active restrictions at.
+//! \param[in] value Value to check. NULL never fulfills a restriction.
+//! \param[out] active Populated with the number of exclusive restrictions active at version.
+//!
+//! \return 1 if value equals any of the active VALUE_ENUM restrictions.
+//! \return 0 if it does not.
+//!
+int
+dx_restriction_table_check_enum (struct disir_restriction_table *table,
+                                 struct disir_version *version,
+                                 const char *value, uint32_t *active);
+
+//! \brief Retrieve the inclusive restrictions of the queue the table is compiled from.
+//!
+//! \param[in] table Compiled table to query.
+//! \param[out] count Populated with the number of inclusive restrictions.
+//!
+//! \return array of count INC_ENTRY_MIN and INC_ENTRY_MAX restrictions, in queue order.
+//!
+struct disir_restriction **
+dx_restriction_table_inclusive (struct disir_restriction_table *table, uint32_t *count);
+
+//! \brief Whether the restriction is active at version.
+//!
+//! A restriction is active from the version it is introduced,
+//! up to the version it is deprecated, if any.
+//!
+//! \return 1 if restriction is active at version.
+//! \return 0 if it is not.
+//!
+int
+dx_restriction_is_active (struct disir_restriction *restriction, struct disir_version *version);
+
+#endif // _LIBDISIR_PRIVATE_RESTRICTION_TABLE_H
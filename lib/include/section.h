@@ -26,6 +26,14 @@ struct disir_section
     struct disir_element_storage        *se_elements;
 
     struct disir_restriction            *se_restrictions_queue;
+
+    //! Arena of the top-level context this section is allocated from.
+    //! The section, its name and its element storage live in it. Holds a reference.
+    struct disir_arena                  *se_arena;
+
+    //! For top-level context MOLD, one-based index of this section in the generate
+    //! templates of the mold. Zero until the first template is built.
+    uint32_t                            se_generate_index;
 };
 
 //! Construct a DISIR_CONTEXT_SECTION as a child of parent.
@@ -35,8 +43,9 @@ enum disir_status dx_section_begin (struct disir_context *parent, struct disir_c
 //! Finalize the construction of a DISIR_CONTEXT_SECTION
 enum disir_status dx_section_finalize (struct disir_context *section);
 
-//! Allocate a disir_section structure
-struct disir_section *dx_section_create (struct disir_context *parent);
+//! Allocate a disir_section structure from arena (NULL allocates on the heap)
+struct disir_section *dx_section_create (struct disir_context *parent,
+                                         struct disir_arena *arena);
 
 //! Destroy a disir_section structure, freeing all associated
 //! memory and unhooking from linked list storage.
@@ -0,0 +1,45 @@
+#ifndef _LIBDISIR_PRIVATE_SNAPSHOT_H
+#define _LIBDISIR_PRIVATE_SNAPSHOT_H
+
+#include <disir/disir.h>
+
+//! A single keyval held by a snapshot.
+//! String members are offsets into sn_strings.
+struct disir_snapshot_entry
+{
+    //! Fully resolved name of the keyval, with an explicit index on every component.
+    uint32_t                    sne_key;
+
+    //! Value type of the keyval.
+    enum disir_value_type       sne_type;
+
+    //! Value of the keyval, interpreted by sne_type.
+    //! Enum and string values are stored as an interned sne_string.
+    union
+    {
+        uint32_t                sne_string;
+        uint8_t                 sne_boolean;
+        double                  sne_float;
+        int64_t                 sne_integer;
+    };
+};
+
+//! Immutable, flat copy of a finalized config.
+//! The structure, its entries and its strings are a single allocation.
+struct disir_snapshot
+{
+    //! Version of the config this snapshot was created from.
+    struct disir_version            sn_version;
+
+    //! Number of entries in sn_entries.
+    uint32_t                        sn_numentries;
+
+    //! Entries sorted on sne_key by component (name, then index).
+    struct disir_snapshot_entry     *sn_entries;
+
+    //! Interned keys and string values, each NUL-terminated.
+    char                            *sn_strings;
+};
+
+
+#endif // _LIBDISIR_PRIVATE_SNAPSHOT_H
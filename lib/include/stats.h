@@ -0,0 +1,106 @@
+#ifndef _LIBDISIR_PRIVATE_STATS_H
+#define _LIBDISIR_PRIVATE_STATS_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <disir/disir.h>
+
+#include "thread_state.h"
+
+// Forward declaration
+struct disir_register_plugin_internal;
+
+//! Counters of the operations one thread invoked on a single plugin.
+struct dx_stats_plugin
+{
+    //! Plugin the counters belong to.
+    struct disir_register_plugin_internal   *sp_plugin;
+    //! Counters indexed by enum disir_stats_operation.
+    struct disir_stats_counter              sp_operations[DISIR_STATS_OPERATION_UNKNOWN];
+
+    //! Only ever appended to by the owning thread.
+    struct dx_stats_plugin                  *sp_next;
+};
+
+//! Counters of every operation one thread invoked.
+//! Only the owning thread writes the counters. Readers load them atomically.
+struct dx_stats_thread
+{
+    //! Registration with the thread. Must be the first member.
+    struct dx_thread_record         th_record;
+    //! Storage this thread is registered with.
+    struct dx_stats_storage         *th_storage;
+    //! Counters indexed by enum disir_stats_operation.
+    struct disir_stats_counter      th_operations[DISIR_STATS_OPERATION_UNKNOWN];
+    //! Singly-linked list of plugin counters.
+    struct dx_stats_plugin          *th_plugins;
+
+    struct dx_stats_thread          *next, *prev;
+};
+
+//! Per-thread counters of an instance, or of the process.
+struct dx_stats_storage
+{
+    //! Counters of every thread that has operated on this storage and is still running.
+    struct dx_stats_thread          *ss_threads;
+    //! Counters of threads that have exited, folded into one.
+    struct dx_stats_thread          ss_retired;
+    //! Protects ss_threads and ss_retired.
+    pthread_mutex_t                 ss_lock;
+};
+
+//! A single timed operation, kept on the stack of the calling thread
+//! between dx_stats_begin() and dx_stats_end().
+struct dx_stats_span
+{
+    //! Counter the operation is accounted to. NULL if counting is unavailable.
+    struct disir_stats_counter      *sp_counter;
+    enum disir_stats_operation      sp_operation;
+    //! Monotonic start time, in nanoseconds.
+    uint64_t                        sp_start;
+    //! Enclosing span of the calling thread.
+    struct dx_stats_span            *sp_outer;
+};
+
+//! \brief Initialize empty statistics storage.
+enum disir_status
+dx_stats_storage_init (struct dx_stats_storage *storage);
+
+//! \brief Release the counters of every thread held by storage.
+void
+dx_stats_storage_finished (struct dx_stats_storage *storage);
+
+//! \brief Storage of the operations performed without an instance.
+struct dx_stats_storage *
+dx_stats_process (void);
+
+//! \brief Start timing operation.
+//!
+//! The operation is accounted to the calling thread in storage, and to plugin
+//! if it is non-NULL. Each span must be closed by dx_stats_end() in the reverse
+//! order it was started.
+void
+dx_stats_begin (struct dx_stats_storage *storage, enum disir_stats_operation operation,
+                struct disir_register_plugin_internal *plugin, struct dx_stats_span *span);
+
+//! \brief Stop timing the operation of span, and count it.
+//!
+//! The call is counted as an error unless status is DISIR_STATUS_OK.
+//! Query operations also count DISIR_STATUS_EXISTS and DISIR_STATUS_NOT_EXIST as successful.
+void
+dx_stats_end (struct dx_stats_span *span, enum disir_status status);
+
+//! \brief Account bytes read from or written to disk to every open span of the calling thread.
+void
+dx_stats_bytes (uint64_t bytes_read, uint64_t bytes_written);
+
+//! \brief Sum the counters of every thread in storage into operations.
+//!
+//! If plugin is non-NULL, only the counters of that plugin are summed.
+void
+dx_stats_storage_sum (struct dx_stats_storage *storage,
+                      struct disir_register_plugin_internal *plugin,
+                      struct disir_stats_counter *operations);
+
+#endif // _LIBDISIR_PRIVATE_STATS_H
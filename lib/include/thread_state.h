@@ -0,0 +1,63 @@
+#ifndef _LIBDISIR_PRIVATE_THREAD_STATE_H
+#define _LIBDISIR_PRIVATE_THREAD_STATE_H
+
+#include <disir/disir.h>
+
+//! State a single thread keeps on behalf of an owner, e.g., the error storage
+//! of an instance. Embedded as the first member of the state it describes.
+//!
+//! The records of every thread hang off a single process-wide pthread key,
+//! no matter how many instances exist.
+struct dx_thread_record
+{
+    //! Owner of the record. Cleared by dx_thread_record_orphan() once the owner is
+    //! torn down - from then on, only the thread that registered it references it.
+    void                        *tr_owner;
+    //! Invoked when the thread exits while the owner is still alive.
+    //! Runs with the thread records locked, so the owner cannot be torn down meanwhile.
+    void                        (*tr_exit) (struct dx_thread_record *record);
+    //! Release the memory of the record.
+    void                        (*tr_release) (struct dx_thread_record *record);
+
+    //! Next record of the same thread. Only ever touched by that thread.
+    struct dx_thread_record     *tr_thread_next;
+};
+
+//! \brief Register record with the calling thread, on behalf of owner.
+//!
+//! tr_exit and tr_release must be populated.
+//!
+//! \return DISIR_STATUS_INSUFFICIENT_RESOURCES if no thread-specific key is available.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_thread_record_register (struct dx_thread_record *record, void *owner);
+
+//! \brief Record the calling thread registered on behalf of owner. NULL if there is none.
+//!
+//! Records of owners since torn down are released along the way.
+//!
+struct dx_thread_record *
+dx_thread_record_find (const void *owner);
+
+//! \brief Lock out threads exiting concurrently. Required by dx_thread_record_orphan().
+void
+dx_thread_records_lock (void);
+
+//! \brief Counterpart to dx_thread_records_lock().
+void
+dx_thread_records_unlock (void);
+
+//! \brief Detach record from its owner, as the owner is torn down.
+//!
+//! The thread records must be locked. The record is released by the thread that
+//! registered it, and must not be referenced by the owner afterwards.
+//!
+void
+dx_thread_record_orphan (struct dx_thread_record *record);
+
+//! \brief Release the records of the calling thread that were orphaned.
+void
+dx_thread_records_prune (void);
+
+#endif // _LIBDISIR_PRIVATE_THREAD_STATE_H
@@ -0,0 +1,48 @@
+#ifndef _LIBDISIR_PRIVATE_TRACE_H
+#define _LIBDISIR_PRIVATE_TRACE_H
+
+#include <stdint.h>
+
+//! Environment variable holding the filepath spans are recorded to.
+//! Takes precedence over the trace_filepath keyval of the libdisir config.
+#define DISIR_TRACE_FILEPATH_ENV "DISIR_TRACE_FILEPATH"
+
+//! Non-zero while spans are recorded. Checked by TRACE_ENTER and TRACE_EXIT
+//! before anything else is evaluated.
+extern int dx_trace_enabled;
+
+//! \brief Apply DISIR_TRACE_FILEPATH_ENV from the environment, once per process.
+void
+dx_trace_initialize (void);
+
+//! A span opened by TRACE_ENTER, closed as it goes out of scope.
+struct dx_trace_scope
+{
+    //! Position of the span on the stack of the calling thread. Negative if none was opened.
+    int                 tsc_depth;
+    //! Recording period the span was opened in.
+    uint32_t            tsc_generation;
+};
+
+//! Scope of a TRACE_ENTER that opened no span.
+#define DX_TRACE_SCOPE_NONE ((struct dx_trace_scope) { -1, 0 })
+
+//! \brief Open a span of function on the calling thread.
+struct dx_trace_scope
+dx_trace_enter (const char *function);
+
+//! \brief Close the span opened by scope, and record it.
+//!
+//! Nothing is recorded if tracing was enabled anew since the span was opened.
+void
+dx_trace_exit (struct dx_trace_scope *scope);
+
+//! \brief Cleanup handler of the scope declared by TRACE_ENTER.
+static inline void
+dx_trace_scope_close (struct dx_trace_scope *scope)
+{
+    if (scope->tsc_depth >= 0)
+        dx_trace_exit (scope);
+}
+
+#endif // _LIBDISIR_PRIVATE_TRACE_H
@@ -24,6 +24,52 @@ struct disir_update
     char                        *up_mold_value;
 };
 
+//! A mold keyval whose default changed between the source and target version of a plan.
+struct dx_update_plan_entry
+{
+    //! Name of the keyval resolved from the mold root, e.g., `section.keyval`.
+    char                        *pe_name;
+    //! Default active at the source version. Owned by the mold of the plan.
+    struct disir_value          *pe_source;
+    //! Default active at the target version. Owned by the mold of the plan.
+    struct disir_value          *pe_target;
+    char                        *pe_source_string;
+    char                        *pe_target_string;
+};
+
+//! A mold element on the path to at least one changed keyval.
+struct dx_update_plan_node
+{
+    //! Name of the element. Owned by the mold of the plan.
+    const char                  *pn_name;
+    //! Hash of pn_name, as computed by dx_element_storage_hash().
+    unsigned long               pn_hash;
+    //! Index into pl_entries for keyvals. -1 for sections.
+    int32_t                     pn_entry;
+
+    //! Children of a section, in no particular order.
+    struct dx_update_plan_node  *pn_children;
+    struct dx_update_plan_node  *pn_next;
+};
+
+//! The changed defaults of a mold between two versions, ready to apply to any
+//! number of configs of that mold at the source version. Immutable once created.
+struct disir_update_plan
+{
+    //! Mold the plan was computed from. Holds a reference.
+    struct disir_mold           *pl_mold;
+    struct disir_version        pl_source;
+    struct disir_version        pl_target;
+
+    //! Changed keyvals, in mold order.
+    struct dx_update_plan_entry *pl_entries;
+    int32_t                     pl_entries_count;
+    int32_t                     pl_entries_capacity;
+
+    //! Root of the tree of elements leading to the changed keyvals.
+    struct dx_update_plan_node  pl_root;
+};
+
 enum disir_status
 dx_update_config_with_changes (struct disir_config **config, int discard_violations);
 
@@ -1,6 +1,8 @@
 #ifndef _LIBDISIR_PRIVATE_VALUE_H
 #define _LIBDISIR_PRIVATE_VALUE_H
 
+struct disir_arena;
+
 struct disir_value
 {
     enum disir_value_type dv_type;
@@ -76,6 +78,15 @@ int dx_value_compare (struct disir_value *v1, struct disir_value *v2);
 //!
 enum disir_status dx_value_copy (struct disir_value *destination, struct disir_value *source);
 
+//! \brief Copy source value into destination value, allocating strings from arena.
+//!
+//! \see dx_value_copy
+//! \see dx_value_set_string_arena
+//!
+enum disir_status dx_value_copy_arena (struct disir_value *destination,
+                                       struct disir_arena *arena,
+                                       struct disir_value *source);
+
 
 //! \brief Set the input 'value' with the contents of the input 'input'
 //!
@@ -97,6 +108,16 @@ enum disir_status dx_value_copy (struct disir_value *destination, struct disir_v
 enum disir_status
 dx_value_set_string (struct disir_value *value, const char *input, int32_t size);
 
+//! \brief Set the input 'value' with the contents of 'input', allocated from 'arena'.
+//!
+//! Identical to dx_value_set_string, except that the string is allocated
+//! from (and any previous string returned to) the passed arena. A NULL arena
+//! allocates on the heap. The same arena must be used for every string stored in 'value'.
+//!
+enum disir_status
+dx_value_set_string_arena (struct disir_value *value, struct disir_arena *arena,
+                           const char *input, int32_t size);
+
 //! \brief Reterieve the string type stored in value
 //!
 //! \param[in] value Value object to retrieve the string value from.
@@ -17,6 +17,12 @@
 #define LOG_FILEPATH_DOCSTRING "The full filepath to the logfile libdisir will output to."
 #define MOLD_DIRPATH_DOCSTRING "The full directory path where libdisir will locate " \
             "it the installed molds to match against installed configuration files."
+#define VALIDATE_THREADS_DOCSTRING "The number of threads validating the top-level sections " \
+            "of a config. 1 validates serially. 0 uses one thread per online processor. " \
+            "-1 leaves it to the application. The number set by the application takes precedence."
+#define TRACE_FILEPATH_DOCSTRING "The full filepath libdisir writes its API calls to, " \
+            "as Chrome trace event JSON. Empty disables tracing. " \
+            "The DISIR_TRACE_FILEPATH environment variable takes precedence."
 
 
 //! PUBLIC API
@@ -26,6 +32,7 @@ disir_libdisir_mold (struct disir_mold **mold)
     enum disir_status status;
     struct disir_context *context;
     struct disir_context *context_section;
+    struct disir_context *context_keyval;
 
     context = NULL;
 
@@ -86,6 +93,40 @@ disir_libdisir_mold (struct disir_mold **mold)
     if (status != DISIR_STATUS_OK)
         goto error;
 
+    // The keyvals below were added to the libdisir mold without a new mold version.
+    // Existing libdisir configs lack them, so each takes an entries_min of 0 to keep
+    // those configs valid. This also leaves them out of generated configs.
+    status = dc_add_keyval_string (context, "log_filepath", "/var/log/disir.log",
+                                   LOG_FILEPATH_DOCSTRING, NULL, &context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+    status = dc_add_restriction_entries_min (context_keyval, 0, NULL);
+    dc_putcontext (&context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    status = dc_add_keyval_integer (context, "validate_threads", -1,
+                                    VALIDATE_THREADS_DOCSTRING, NULL, &context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+    status = dc_add_restriction_entries_min (context_keyval, 0, NULL);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = dc_add_restriction_value_range (context_keyval, -1, 64,
+                                                 "Supported number of threads.", NULL, NULL);
+    }
+    dc_putcontext (&context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    status = dc_add_keyval_string (context, "trace_filepath", "",
+                                   TRACE_FILEPATH_DOCSTRING, NULL, &context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+    status = dc_add_restriction_entries_min (context_keyval, 0, NULL);
+    dc_putcontext (&context_keyval);
+    if (status != DISIR_STATUS_OK)
+        goto error;
 
     status = dc_mold_finalize (&context, mold);
     if (status != DISIR_STATUS_OK)
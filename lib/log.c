@@ -1,14 +1,22 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 #include <disir/disir.h>
 
 #include "log.h"
 #include "context_private.h"
 #include "disir_private.h"
+#include "mqueue.h"
 
 
 //! Variable to control the loglevel
@@ -20,6 +28,399 @@ enum disir_log_level runtime_loglevel = DISIR_LOG_LEVEL_DEBUG_01;
 //! Hardcode default for now.
 int force_enable_trace = 0;
 
+//! Default filepath of the log sink, unless configured otherwise.
+#define LOG_DEFAULT_FILEPATH "/var/log/disir.log"
+//! Maximum size of a single formatted log line, including newline.
+#define LOG_LINE_MAX 4096
+//! Size in bytes of the per-thread log ring.
+#define LOG_RING_SIZE (64 * 1024)
+//! Maximum number of thread rings flushed with a single write.
+#define LOG_FLUSH_BATCH 64
+//! Interval the writer thread sleeps between flushes, in milliseconds.
+#define LOG_FLUSH_INTERVAL_MS 200
+
+//! Single-producer, single-consumer byte ring holding formatted log lines
+//! of one thread, waiting to be written by the log writer thread.
+struct log_ring
+{
+    char                lr_buffer[LOG_RING_SIZE];
+    //! Total bytes ever pushed by the owning thread.
+    _Atomic uint64_t    lr_head;
+    //! Total bytes ever consumed by the writer.
+    _Atomic uint64_t    lr_tail;
+    //! Set when the owning thread has exited.
+    _Atomic int         lr_orphaned;
+
+    struct log_ring     *next;
+};
+
+//! The process wide log sink. Keeps a single file descriptor open
+//! and flushes the rings of every thread in batches.
+static struct
+{
+    //! Protects ls_rings, ls_fd, ls_filepath and writes to ls_fd.
+    pthread_mutex_t     ls_mutex;
+    pthread_cond_t      ls_cond;
+    pthread_key_t       ls_ring_key;
+    pthread_t           ls_writer;
+    _Atomic int         ls_writer_running;
+    int                 ls_writer_stop;
+    //! Set when the process is exiting. No more lines are accepted once set.
+    _Atomic int         ls_closed;
+
+    //! Singly-linked list of all registered thread rings.
+    struct log_ring     *ls_rings;
+
+    int                 ls_fd;
+    char                ls_filepath[PATH_MAX];
+
+    _Atomic uint64_t    ls_written;
+    _Atomic uint64_t    ls_dropped;
+    _Atomic uint64_t    ls_flushes;
+    _Atomic uint64_t    ls_bytes;
+} log_sink = {
+    .ls_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .ls_cond = PTHREAD_COND_INITIALIZER,
+    .ls_fd = -1,
+    .ls_filepath = LOG_DEFAULT_FILEPATH,
+};
+
+static pthread_once_t log_sink_once = PTHREAD_ONCE_INIT;
+
+//! Log ring owned by the calling thread.
+static __thread struct log_ring *thread_ring;
+//! Set once the ring of the calling thread has been handed back during thread exit.
+//! Lines logged afterwards (e.g., from other TLS destructors) are written directly.
+static __thread int thread_ring_released;
+//! Timestamp string cached for the second thread_timestamp_time.
+static __thread char thread_timestamp[32];
+static __thread size_t thread_timestamp_size;
+static __thread time_t thread_timestamp_time = -1;
+
+//! STATIC USAGE
+//! Write every pending byte from all rings in one batch.
+//! Caller must hold log_sink.ls_mutex.
+static void
+log_sink_drain_locked (void)
+{
+    struct iovec iov[LOG_FLUSH_BATCH * 2];
+    struct log_ring *ring;
+    struct log_ring **link;
+    uint64_t heads[LOG_FLUSH_BATCH];
+    struct log_ring *rings[LOG_FLUSH_BATCH];
+    uint64_t head;
+    uint64_t tail;
+    size_t offset;
+    size_t length;
+    ssize_t res;
+    int iovcnt;
+    int ringcnt;
+    int i;
+
+    if (log_sink.ls_fd < 0)
+    {
+        log_sink.ls_fd = open (log_sink.ls_filepath,
+                               O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    }
+
+    ring = log_sink.ls_rings;
+    while (ring != NULL)
+    {
+        iovcnt = 0;
+        ringcnt = 0;
+
+        // Gather a batch of ring segments
+        for (; ring != NULL && ringcnt < LOG_FLUSH_BATCH; ring = ring->next)
+        {
+            tail = atomic_load_explicit (&ring->lr_tail, memory_order_relaxed);
+            head = atomic_load_explicit (&ring->lr_head, memory_order_acquire);
+            if (head == tail)
+                continue;
+
+            offset = tail % LOG_RING_SIZE;
+            length = head - tail;
+            if (offset + length > LOG_RING_SIZE)
+            {
+                iov[iovcnt].iov_base = ring->lr_buffer + offset;
+                iov[iovcnt].iov_len = LOG_RING_SIZE - offset;
+                iovcnt++;
+                iov[iovcnt].iov_base = ring->lr_buffer;
+                iov[iovcnt].iov_len = length - (LOG_RING_SIZE - offset);
+                iovcnt++;
+            }
+            else
+            {
+                iov[iovcnt].iov_base = ring->lr_buffer + offset;
+                iov[iovcnt].iov_len = length;
+                iovcnt++;
+            }
+
+            rings[ringcnt] = ring;
+            heads[ringcnt] = head;
+            ringcnt++;
+        }
+
+        if (ringcnt == 0)
+            break;
+
+        if (log_sink.ls_fd >= 0)
+        {
+            res = writev (log_sink.ls_fd, iov, iovcnt);
+            if (res > 0)
+            {
+                atomic_fetch_add_explicit (&log_sink.ls_bytes, res, memory_order_relaxed);
+            }
+            atomic_fetch_add_explicit (&log_sink.ls_flushes, 1, memory_order_relaxed);
+        }
+
+        // Release the consumed bytes back to the producers.
+        // Should the file not be writable, the lines are simply discarded.
+        for (i = 0; i < ringcnt; i++)
+        {
+            atomic_store_explicit (&rings[i]->lr_tail, heads[i], memory_order_release);
+        }
+    }
+
+    // Free drained rings of threads that have exited
+    link = &log_sink.ls_rings;
+    while (*link != NULL)
+    {
+        ring = *link;
+        if (atomic_load_explicit (&ring->lr_orphaned, memory_order_acquire)
+            && atomic_load_explicit (&ring->lr_head, memory_order_acquire)
+               == atomic_load_explicit (&ring->lr_tail, memory_order_relaxed))
+        {
+            *link = ring->next;
+            free (ring);
+            continue;
+        }
+        link = &ring->next;
+    }
+}
+
+//! STATIC USAGE
+static void
+log_sink_drain (void)
+{
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    log_sink_drain_locked ();
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! STATIC USAGE
+//! Background writer. Flushes all thread rings every LOG_FLUSH_INTERVAL_MS,
+//! or earlier when woken by a producer whose ring is filling up.
+static void *
+log_sink_writer (void *arg)
+{
+    struct timespec deadline;
+
+    (void) &arg;
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    while (log_sink.ls_writer_stop == 0)
+    {
+        clock_gettime (CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait (&log_sink.ls_cond, &log_sink.ls_mutex, &deadline);
+
+        log_sink_drain_locked ();
+    }
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+
+    return NULL;
+}
+
+//! STATIC USAGE
+//! Invoked when a thread owning a log ring exits.
+//! The writer frees the ring once drained, so the thread must never touch it again.
+static void
+log_ring_orphan (void *ring)
+{
+    thread_ring = NULL;
+    thread_ring_released = 1;
+    atomic_store_explicit (&((struct log_ring *) ring)->lr_orphaned, 1, memory_order_release);
+}
+
+//! STATIC USAGE
+//! Start the background writer. Caller must hold log_sink.ls_mutex.
+static void
+log_sink_writer_start_locked (void)
+{
+    sigset_t all;
+    sigset_t previous;
+
+    if (atomic_load (&log_sink.ls_writer_running) || log_sink.ls_writer_stop)
+        return;
+
+    // The writer shall never be the target of process directed signals.
+    sigfillset (&all);
+    pthread_sigmask (SIG_SETMASK, &all, &previous);
+    if (pthread_create (&log_sink.ls_writer, NULL, log_sink_writer, NULL) == 0)
+    {
+        atomic_store (&log_sink.ls_writer_running, 1);
+    }
+    pthread_sigmask (SIG_SETMASK, &previous, NULL);
+}
+
+//! STATIC USAGE
+//! Stop the writer and flush whatever is left when the process exits.
+static void
+log_sink_shutdown (void)
+{
+    // Refuse new lines first, so the final drain below is really final.
+    atomic_store (&log_sink.ls_closed, 1);
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    log_sink.ls_writer_stop = 1;
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+
+    if (atomic_load (&log_sink.ls_writer_running))
+    {
+        pthread_cond_signal (&log_sink.ls_cond);
+        pthread_join (log_sink.ls_writer, NULL);
+        atomic_store (&log_sink.ls_writer_running, 0);
+    }
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    log_sink_drain_locked ();
+    if (log_sink.ls_fd >= 0)
+    {
+        close (log_sink.ls_fd);
+        log_sink.ls_fd = -1;
+    }
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! STATIC USAGE
+//! Hold the sink lock across fork, so the child never inherits it mid-update.
+static void
+log_sink_fork_prepare (void)
+{
+    pthread_mutex_lock (&log_sink.ls_mutex);
+}
+
+//! STATIC USAGE
+static void
+log_sink_fork_parent (void)
+{
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! STATIC USAGE
+//! Only the forking thread exists in the child. Its writer is gone, and every pending
+//! line still belongs to the parent, which writes it. Discard those and let the next
+//! line start a new writer.
+static void
+log_sink_fork_child (void)
+{
+    struct log_ring *ring;
+
+    pthread_cond_init (&log_sink.ls_cond, NULL);
+    atomic_store (&log_sink.ls_writer_running, 0);
+
+    for (ring = log_sink.ls_rings; ring != NULL; ring = ring->next)
+    {
+        atomic_store (&ring->lr_tail, atomic_load (&ring->lr_head));
+        if (ring != thread_ring)
+        {
+            atomic_store (&ring->lr_orphaned, 1);
+        }
+    }
+
+    // Taken by log_sink_fork_prepare in the thread that is now the only one.
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! STATIC USAGE
+static void
+log_sink_initialize (void)
+{
+    pthread_key_create (&log_sink.ls_ring_key, log_ring_orphan);
+    pthread_atfork (log_sink_fork_prepare, log_sink_fork_parent, log_sink_fork_child);
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    log_sink_writer_start_locked ();
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+
+    atexit (log_sink_shutdown);
+}
+
+//! STATIC USAGE
+//! Write a single line straight to the log file, bypassing the rings.
+//! Used by threads that have already released their ring during thread exit.
+static void
+log_sink_write_direct (const char *line, size_t length)
+{
+    ssize_t res;
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    log_sink_drain_locked ();
+    if (log_sink.ls_fd >= 0)
+    {
+        res = write (log_sink.ls_fd, line, length);
+        if (res > 0)
+        {
+            atomic_fetch_add_explicit (&log_sink.ls_bytes, res, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit (&log_sink.ls_written, 1, memory_order_relaxed);
+    }
+    else
+    {
+        atomic_fetch_add_explicit (&log_sink.ls_dropped, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! INTERNAL API
+void
+dx_log_filepath_set (const char *filepath)
+{
+    if (filepath == NULL || *filepath == '\0')
+        return;
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    if (strcmp (filepath, log_sink.ls_filepath) != 0)
+    {
+        // Flush pending lines to the previous file before switching.
+        log_sink_drain_locked ();
+        if (log_sink.ls_fd >= 0)
+        {
+            close (log_sink.ls_fd);
+            log_sink.ls_fd = -1;
+        }
+        snprintf (log_sink.ls_filepath, sizeof (log_sink.ls_filepath), "%s", filepath);
+    }
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+}
+
+//! PUBLIC API
+void
+disir_log_flush (void)
+{
+    log_sink_drain ();
+}
+
+//! PUBLIC API
+enum disir_status
+disir_log_stats (struct disir_log_stats *stats)
+{
+    if (stats == NULL)
+        return DISIR_STATUS_INVALID_ARGUMENT;
+
+    stats->ls_written = atomic_load_explicit (&log_sink.ls_written, memory_order_relaxed);
+    stats->ls_dropped = atomic_load_explicit (&log_sink.ls_dropped, memory_order_relaxed);
+    stats->ls_flushes = atomic_load_explicit (&log_sink.ls_flushes, memory_order_relaxed);
+    stats->ls_bytes = atomic_load_explicit (&log_sink.ls_bytes, memory_order_relaxed);
+
+    return DISIR_STATUS_OK;
+}
+
 //! STATIC USAGE
 static const char *
 map_dll_to_string (enum disir_log_level dll)
@@ -63,6 +464,104 @@ dx_crash_and_burn (const char* message, ...)
     abort ();
 }
 
+//! STATIC USAGE
+//! Allocate and register the log ring of the calling thread.
+static struct log_ring *
+log_ring_acquire (void)
+{
+    struct log_ring *ring;
+
+    if (thread_ring)
+        return thread_ring;
+
+    pthread_once (&log_sink_once, log_sink_initialize);
+
+    ring = calloc (1, sizeof (struct log_ring));
+    if (ring == NULL)
+        return NULL;
+
+    pthread_mutex_lock (&log_sink.ls_mutex);
+    ring->next = log_sink.ls_rings;
+    log_sink.ls_rings = ring;
+    pthread_mutex_unlock (&log_sink.ls_mutex);
+
+    // Mark the ring orphaned when this thread exits - the writer frees it once drained.
+    pthread_setspecific (log_sink.ls_ring_key, ring);
+    thread_ring = ring;
+
+    return ring;
+}
+
+//! STATIC USAGE
+//! Copy the formatted log line into the ring of the calling thread.
+//! The line is dropped if the ring cannot fit it.
+static void
+log_ring_push (const char *line, size_t length)
+{
+    struct log_ring *ring;
+    uint64_t head;
+    uint64_t tail;
+    size_t offset;
+    size_t first;
+
+    // The sink is shutting down - nothing logged now would be written anyway.
+    if (atomic_load_explicit (&log_sink.ls_closed, memory_order_acquire))
+    {
+        atomic_fetch_add_explicit (&log_sink.ls_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    if (thread_ring_released)
+    {
+        log_sink_write_direct (line, length);
+        return;
+    }
+
+    ring = log_ring_acquire ();
+    if (ring == NULL)
+    {
+        atomic_fetch_add_explicit (&log_sink.ls_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    head = atomic_load_explicit (&ring->lr_head, memory_order_relaxed);
+    tail = atomic_load_explicit (&ring->lr_tail, memory_order_acquire);
+    if (head - tail + length > LOG_RING_SIZE)
+    {
+        atomic_fetch_add_explicit (&log_sink.ls_dropped, 1, memory_order_relaxed);
+        pthread_cond_signal (&log_sink.ls_cond);
+        return;
+    }
+
+    offset = head % LOG_RING_SIZE;
+    first = LOG_RING_SIZE - offset;
+    if (first > length)
+        first = length;
+    memcpy (ring->lr_buffer + offset, line, first);
+    memcpy (ring->lr_buffer, line + first, length - first);
+
+    atomic_store_explicit (&ring->lr_head, head + length, memory_order_release);
+    atomic_fetch_add_explicit (&log_sink.ls_written, 1, memory_order_relaxed);
+
+    // Wake the writer early once the ring is half full.
+    if (head - tail + length > LOG_RING_SIZE / 2)
+    {
+        pthread_cond_signal (&log_sink.ls_cond);
+    }
+    // Writer thread unavailable (e.g., in a forked child) - start a new one,
+    // or flush inline to not lose everything.
+    if (atomic_load_explicit (&log_sink.ls_writer_running, memory_order_relaxed) == 0)
+    {
+        pthread_mutex_lock (&log_sink.ls_mutex);
+        log_sink_writer_start_locked ();
+        if (atomic_load (&log_sink.ls_writer_running) == 0)
+        {
+            log_sink_drain_locked ();
+        }
+        pthread_mutex_unlock (&log_sink.ls_mutex);
+    }
+}
+
 //! implements the actual stream logging
 //! prefix is injected between the fmt message and the timestamp/loglevel
 //! Ignored if null
@@ -70,80 +569,42 @@ static void
 dx_log_format (enum disir_log_level dll, int severity, const char *prefix,
                const char *suffix, const char* fmt_message, va_list args)
 {
-    char buffer[512];
+    char buffer[LOG_LINE_MAX];
     size_t time_written;
+    size_t written;
     int res;
     size_t buffer_size;
-    FILE *stream;
     time_t now;
-    struct tm *utctime;
+    struct tm utctime;
     char dll_prefix[10];
 
-    buffer_size = 512;
-
-    // Normalize debug level
-    if (dll == DISIR_LOG_LEVEL_DEBUG)
-    {
-        switch (severity)
-        {
-        case 0:
-            dll = DISIR_LOG_LEVEL_DEBUG;
-            break;
-        case 1:
-            dll = DISIR_LOG_LEVEL_DEBUG_01;
-            break;
-        case 2:
-            dll = DISIR_LOG_LEVEL_DEBUG_02;
-            break;
-        case 3:
-            dll = DISIR_LOG_LEVEL_DEBUG_03;
-            break;
-        case 4:
-            dll = DISIR_LOG_LEVEL_DEBUG_04;
-            break;
-        case 5:
-            dll = DISIR_LOG_LEVEL_DEBUG_05;
-            break;
-        case 6:
-            dll = DISIR_LOG_LEVEL_DEBUG_06;
-            break;
-        case 7:
-            dll = DISIR_LOG_LEVEL_DEBUG_07;
-            break;
-        case 8:
-            dll = DISIR_LOG_LEVEL_DEBUG_08;
-            break;
-        case 9:
-            dll = DISIR_LOG_LEVEL_DEBUG_09;
-            break;
-        case 10:
-            dll = DISIR_LOG_LEVEL_DEBUG_10;
-            break;
-        }
-    }
+    buffer_size = LOG_LINE_MAX;
 
     // Dont log anything if loglevel doesnt match
     // Let TRACE messages through if force_enable_trace is set
-    if (dll != DISIR_LOG_LEVEL_TRACE_ENTER && dll != DISIR_LOG_LEVEL_TRACE_EXIT)
-    {
-        if (dll > runtime_loglevel)
-            return;
-    }
-    else if (dll > runtime_loglevel && !force_enable_trace)
-    {
+    if (!DX_LOG_ENABLED (dll, severity))
         return;
-    }
 
-    // Get UTC time
-    time (&now);
-    utctime = gmtime (&now);
+    // Normalize debug level
+    dll = (enum disir_log_level) DX_LOG_LEVEL_RESOLVE (dll, severity);
 
-    time_written = strftime (buffer, buffer_size, "[%Y-%m-%d %H:%M:%S]", utctime);
-    if (time_written >= buffer_size || time_written == 0)
+    // Get UTC time - only re-format the timestamp when the second changes
+    time (&now);
+    if (now != thread_timestamp_time)
     {
-        dx_crash_and_burn ("strftime returned: %d - not within buffer size: %d",
-            time_written, buffer_size);
+        gmtime_r (&now, &utctime);
+        time_written = strftime (thread_timestamp, sizeof (thread_timestamp),
+                                 "[%Y-%m-%d %H:%M:%S]", &utctime);
+        if (time_written >= sizeof (thread_timestamp) || time_written == 0)
+        {
+            dx_crash_and_burn ("strftime returned: %d - not within buffer size: %d",
+                time_written, sizeof (thread_timestamp));
+        }
+        thread_timestamp_time = now;
+        thread_timestamp_size = time_written;
     }
+    time_written = thread_timestamp_size;
+    memcpy (buffer, thread_timestamp, time_written);
 
     // Prepare the log level prefix string
     if (dll >= DISIR_LOG_LEVEL_DEBUG &&
@@ -177,32 +638,31 @@ dx_log_format (enum disir_log_level dll, int severity, const char *prefix,
         dx_crash_and_burn ("snprintf() returned res: %d - size: %d",
             res, buffer_size - time_written);
     }
+    written = time_written + res;
 
-    // Prepare outgoing stream
-    stream = fopen ("/var/log/disir.log", "a");
-
-    // Cant open file output stream! Bleh!
-    if (stream == NULL)
+    // Write incomming log message. Leave room for the newline.
+    res = vsnprintf (buffer + written, buffer_size - written - 1, fmt_message, args);
+    if (res > 0)
     {
-      // Throw a tantrum?
-      return;
+        written += ((size_t) res < buffer_size - written - 1 ? (size_t) res
+                                                              : buffer_size - written - 2);
     }
 
-    // Output buffer with time, loglevel and context
-    fwrite (buffer, time_written + res, sizeof (char), stream);
-
-    // Write incomming log message
-    vfprintf (stream, fmt_message, args);
-
     // Write suffix
-    if (suffix != NULL)
-        fwrite (suffix, strlen (suffix), sizeof (char), stream); // XXX
+    if (suffix != NULL && *suffix != '\0')
+    {
+        res = snprintf (buffer + written, buffer_size - written - 1, "%s", suffix);
+        if (res > 0)
+        {
+            written += ((size_t) res < buffer_size - written - 1 ? (size_t) res
+                                                                  : buffer_size - written - 2);
+        }
+    }
 
     // Append newline to log message
-    fprintf (stream, "\n");
+    buffer[written++] = '\n';
 
-    // close output stream. We dont want to keep it open forever, atleast not yet.
-    fclose (stream);
+    log_ring_push (buffer, written);
 }
 
 //! INTERNAL API
@@ -256,6 +716,64 @@ dx_internal_log_to_storage (char **error_message, int32_t *error_message_size,
     }
 }
 
+//! STATIC API
+static void
+error_storage_release (struct dx_thread_record *record)
+{
+    struct disir_error_storage *storage;
+
+    storage = (struct disir_error_storage *) record;
+    free (storage->er_message);
+    free (storage);
+}
+
+//! STATIC API
+//! Invoked when a thread holding error storage on a live instance exits.
+static void
+error_storage_thread_exit (struct dx_thread_record *record)
+{
+    struct disir_error_storage *storage;
+    struct disir_instance *instance;
+
+    storage = (struct disir_error_storage *) record;
+    instance = storage->er_instance;
+
+    pthread_mutex_lock (&instance->dio_error_lock);
+    MQ_REMOVE (instance->dio_error_queue, storage);
+    pthread_mutex_unlock (&instance->dio_error_lock);
+}
+
+//! INTERNAL API
+//! Lives alongside the logger, since logging to an instance populates it.
+struct disir_error_storage *
+dx_instance_error_storage (struct disir_instance *instance, int create)
+{
+    struct disir_error_storage *storage;
+
+    storage = (struct disir_error_storage *) dx_thread_record_find (instance);
+    if (storage != NULL || create == 0)
+        return storage;
+
+    storage = calloc (1, sizeof (struct disir_error_storage));
+    if (storage == NULL)
+        return NULL;
+
+    storage->er_instance = instance;
+    storage->er_record.tr_exit = error_storage_thread_exit;
+    storage->er_record.tr_release = error_storage_release;
+    if (dx_thread_record_register (&storage->er_record, instance) != DISIR_STATUS_OK)
+    {
+        free (storage);
+        return NULL;
+    }
+
+    pthread_mutex_lock (&instance->dio_error_lock);
+    MQ_ENQUEUE (instance->dio_error_queue, storage);
+    pthread_mutex_unlock (&instance->dio_error_lock);
+
+    return storage;
+}
+
 //! INTERNAL API
 void
 dx_context_error_set (struct disir_context *context, const char *fmt_message, ...)
@@ -266,15 +784,211 @@ dx_context_error_set (struct disir_context *context, const char *fmt_message, ..
     va_end (args);
 }
 
+//! Error message set by a thread on a context of a finalized mold.
+struct mold_context_error
+{
+    //! Serial of the context - never reused, unlike the address of the context.
+    uint64_t                    me_serial;
+    char                        *me_message;
+    int32_t                     me_message_size;
+};
+
+//! Error messages a single thread set on contexts of finalized molds.
+struct mold_errors
+{
+    //! Registered on behalf of mold_errors_owner. Must be the first member.
+    struct dx_thread_record     mr_record;
+
+    struct mold_context_error   *mr_entries;
+    int                         mr_count;
+    int                         mr_capacity;
+};
+
+//! Owner of the mold_errors of every thread. It is never torn down.
+static char mold_errors_owner;
+
+//! Finalized molds are shared between threads (e.g., through the instance mold cache),
+//! so the error messages set on their contexts are kept by each thread instead.
+static __thread struct mold_errors *thread_mold_errors;
+
+//! STATIC USAGE
+static void
+mold_errors_release (struct dx_thread_record *record)
+{
+    struct mold_errors *errors;
+    int i;
+
+    errors = (struct mold_errors *) record;
+    for (i = 0; i < errors->mr_count; i++)
+    {
+        free (errors->mr_entries[i].me_message);
+    }
+    free (errors->mr_entries);
+    free (errors);
+
+    thread_mold_errors = NULL;
+}
+
+//! STATIC USAGE
+static void
+mold_errors_thread_exit (struct dx_thread_record *record)
+{
+    // Nothing is shared - the messages are released with the record.
+    (void) record;
+}
+
+//! STATIC USAGE
+//! A context is shared once the mold it belongs to is finalized. It is never modified again.
+//! A destroyed context may have outlived its root, which is therefore not looked at.
+//! Until it is destroyed, a context keeps a reference on its parent, and thus its root.
+static int
+context_in_finalized_mold (const struct disir_context *context)
+{
+    if (context->CONTEXT_STATE_DESTROYED)
+        return 0;
+
+    return (context->cx_root_context != NULL
+            && context->cx_root_context->cx_type == DISIR_CONTEXT_MOLD
+            && context->cx_root_context->CONTEXT_STATE_FINALIZED);
+}
+
+//! STATIC USAGE
+static struct mold_context_error *
+mold_errors_find (const struct disir_context *context)
+{
+    int i;
+
+    if (thread_mold_errors == NULL)
+        return NULL;
+
+    for (i = 0; i < thread_mold_errors->mr_count; i++)
+    {
+        if (thread_mold_errors->mr_entries[i].me_serial == context->cx_serial)
+            return &thread_mold_errors->mr_entries[i];
+    }
+
+    return NULL;
+}
+
+//! STATIC USAGE
+//! Entry of the calling thread for context, added if it has none.
+//! Entries are only dropped when their context is destroyed, so that no message
+//! vanishes before it is read. Returns NULL if out of memory.
+static struct mold_context_error *
+mold_errors_add (const struct disir_context *context)
+{
+    struct mold_context_error *entries;
+    struct mold_context_error *entry;
+    int capacity;
+    int i;
+
+    entry = mold_errors_find (context);
+    if (entry != NULL)
+        return entry;
+
+    if (thread_mold_errors == NULL)
+    {
+        thread_mold_errors = calloc (1, sizeof (*thread_mold_errors));
+        if (thread_mold_errors == NULL)
+            return NULL;
+
+        thread_mold_errors->mr_record.tr_exit = mold_errors_thread_exit;
+        thread_mold_errors->mr_record.tr_release = mold_errors_release;
+        if (dx_thread_record_register (&thread_mold_errors->mr_record,
+                                       &mold_errors_owner) != DISIR_STATUS_OK)
+        {
+            free (thread_mold_errors);
+            thread_mold_errors = NULL;
+            return NULL;
+        }
+    }
+
+    // Reuse the entry of a context since destroyed by this thread.
+    for (i = 0; i < thread_mold_errors->mr_count; i++)
+    {
+        if (thread_mold_errors->mr_entries[i].me_serial == 0)
+        {
+            thread_mold_errors->mr_entries[i].me_serial = context->cx_serial;
+            return &thread_mold_errors->mr_entries[i];
+        }
+    }
+
+    if (thread_mold_errors->mr_count == thread_mold_errors->mr_capacity)
+    {
+        capacity = thread_mold_errors->mr_capacity ? thread_mold_errors->mr_capacity * 2 : 16;
+        entries = realloc (thread_mold_errors->mr_entries, capacity * sizeof (*entries));
+        if (entries == NULL)
+            return NULL;
+
+        thread_mold_errors->mr_entries = entries;
+        thread_mold_errors->mr_capacity = capacity;
+    }
+
+    entry = &thread_mold_errors->mr_entries[thread_mold_errors->mr_count++];
+    memset (entry, 0, sizeof (*entry));
+    entry->me_serial = context->cx_serial;
+
+    return entry;
+}
+
 //! INTERNAL API
 void
 dx_context_error_set_va (struct disir_context *context, const char* fmt_message, va_list args)
 {
+    struct mold_context_error *entry;
+
     if (context == NULL)
         return;
 
-    dx_internal_log_to_storage (&context->cx_error_message,
-                                &context->cx_error_message_size, fmt_message, args);
+    if (context_in_finalized_mold (context) == 0)
+    {
+        dx_internal_log_to_storage (&context->cx_error_message,
+                                    &context->cx_error_message_size, fmt_message, args);
+        return;
+    }
+
+    entry = mold_errors_add (context);
+    if (entry == NULL)
+        return;
+
+    dx_internal_log_to_storage (&entry->me_message, &entry->me_message_size, fmt_message, args);
+}
+
+//! INTERNAL API
+const char *
+dx_context_error_get (struct disir_context *context)
+{
+    struct mold_context_error *entry;
+
+    if (context_in_finalized_mold (context))
+    {
+        entry = mold_errors_find (context);
+        if (entry != NULL)
+            return entry->me_message;
+    }
+
+    // Messages set while the mold was constructed are kept on the context itself.
+    return context->cx_error_message;
+}
+
+//! INTERNAL API
+void
+dx_context_error_forget (struct disir_context *context)
+{
+    struct mold_context_error *entry;
+
+    // Entries other threads keep for context are never matched again, since its
+    // serial is not reused. They are released when those threads exit.
+    entry = mold_errors_find (context);
+    if (entry == NULL)
+        return;
+
+    // Keep the buffer for the next message.
+    entry->me_serial = 0;
+    if (entry->me_message)
+    {
+        entry->me_message[0] = '\0';
+    }
 }
 
 void
@@ -310,6 +1024,7 @@ dx_log_disir (enum disir_log_level dll,
             const char *fmt_message,
             va_list args)
 {
+    struct disir_error_storage *error_storage;
     char *prefix;
     char *suffix;
     char buffer[60];
@@ -334,13 +1049,20 @@ dx_log_disir (enum disir_log_level dll,
 
     if (instance != NULL)
     {
-        va_copy (args_copy, args);
-
-        dx_internal_log_to_storage (&instance->disir_error_message,
-                                    &instance->disir_error_message_size, fmt_message, args_copy);
-        va_end (args_copy);
+        error_storage = dx_instance_error_storage (instance, 1);
+        if (error_storage != NULL)
+        {
+            va_copy (args_copy, args);
+            dx_internal_log_to_storage (&error_storage->er_message,
+                                        &error_storage->er_message_size, fmt_message, args_copy);
+            va_end (args_copy);
+        }
     }
 
+    // Error message storage above is never filtered - the log stream may be.
+    if (!DX_LOG_ENABLED (dll, severity))
+        return;
+
     if (context)
     {
         //! Prepare the log prefix message.
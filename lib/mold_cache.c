@@ -0,0 +1,271 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+
+#include "disir_private.h"
+#include "log.h"
+#include "mold.h"
+#include "mold_cache.h"
+#include "mqueue.h"
+
+
+//! STATIC API
+//! Populate file identity of filepath. Zeroed if filepath is empty or does not exist.
+static void
+mold_cache_file_stat (const char *filepath, struct disir_mold_cache_file *file)
+{
+    struct stat statbuf;
+
+    memset (file, 0, sizeof (*file));
+
+    if (filepath == NULL || *filepath == '\0')
+        return;
+
+    if (stat (filepath, &statbuf) != 0)
+        return;
+
+    file->mcf_dev = statbuf.st_dev;
+    file->mcf_ino = statbuf.st_ino;
+    file->mcf_size = statbuf.st_size;
+    file->mcf_mtime = statbuf.st_mtim;
+}
+
+//! STATIC API
+static int
+mold_cache_file_equal (struct disir_mold_cache_file *a, struct disir_mold_cache_file *b)
+{
+    return (a->mcf_dev == b->mcf_dev
+            && a->mcf_ino == b->mcf_ino
+            && a->mcf_size == b->mcf_size
+            && a->mcf_mtime.tv_sec == b->mcf_mtime.tv_sec
+            && a->mcf_mtime.tv_nsec == b->mcf_mtime.tv_nsec);
+}
+
+//! STATIC API
+static void
+mold_cache_entry_destroy (struct disir_mold_cache_entry **entry)
+{
+    if ((*entry)->mce_mold)
+        disir_mold_finished (&(*entry)->mce_mold);
+    if ((*entry)->mce_group_id)
+        free ((*entry)->mce_group_id);
+    if ((*entry)->mce_filepath)
+        free ((*entry)->mce_filepath);
+    if ((*entry)->mce_override_filepath)
+        free ((*entry)->mce_override_filepath);
+
+    free (*entry);
+    *entry = NULL;
+}
+
+//! STATIC API
+//! Locate the group_id the input plugin is registered with in instance.
+static const char *
+mold_cache_plugin_group (struct disir_instance *instance, struct disir_register_plugin *plugin)
+{
+    struct disir_register_plugin_internal *internal;
+
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
+    internal = MQ_FIND (instance->dio_plugin_queue, &entry->pi_plugin == plugin);
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
+    if (internal == NULL)
+        return NULL;
+
+    // Registered plugins are never removed while the instance lives.
+    return internal->pi_group_id;
+}
+
+//! STATIC API
+//! Locate the cached entry for the (group_id, filepath, override_filepath) triplet.
+//! The caller must hold cache->mc_lock.
+static struct disir_mold_cache_entry *
+mold_cache_find (struct disir_mold_cache *cache, const char *group_id,
+                 const char *filepath, const char *override_filepath)
+{
+    return MQ_FIND (cache->mc_queue,
+                    strcmp (entry->mce_filepath, filepath) == 0
+                    && strcmp (entry->mce_override_filepath, override_filepath) == 0
+                    && strcmp (entry->mce_group_id, group_id) == 0);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_mold_cache_read (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                    const char *entry_id, struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct disir_mold_cache *cache;
+    struct disir_mold_cache_entry *cached;
+    struct disir_mold_cache_file file;
+    struct disir_mold_cache_file override_file;
+    struct stat statbuf;
+    char filepath[PATH_MAX];
+    char override_filepath[PATH_MAX];
+    const char *group_id;
+    int namespace_entry;
+
+    cache = &instance->dio_mold_cache;
+    namespace_entry = 0;
+
+    group_id = mold_cache_plugin_group (instance, plugin);
+    if (group_id == NULL)
+    {
+        log_debug (4, "plugin (%p) not registered with instance - bypassing mold cache", plugin);
+        return plugin->dp_mold_read (instance, plugin, entry_id, mold);
+    }
+
+    status = fslib_mold_resolve_entry_id (instance, plugin, entry_id,
+                                          filepath, override_filepath,
+                                          &statbuf, &namespace_entry);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Not resolvable on the filesystem - let the plugin deal with it.
+        disir_error_clear (instance);
+        return plugin->dp_mold_read (instance, plugin, entry_id, mold);
+    }
+
+    mold_cache_file_stat (filepath, &file);
+    mold_cache_file_stat (override_filepath, &override_file);
+
+    pthread_mutex_lock (&cache->mc_lock);
+    cached = mold_cache_find (cache, group_id, filepath, override_filepath);
+    if (cached)
+    {
+        if (mold_cache_file_equal (&cached->mce_stat, &file)
+            && mold_cache_file_equal (&cached->mce_override_stat, &override_file))
+        {
+            cache->mc_hits++;
+            dx_mold_incref (cached->mce_mold);
+            *mold = cached->mce_mold;
+            pthread_mutex_unlock (&cache->mc_lock);
+            log_debug (6, "mold cache hit for entry '%s' (%s)", entry_id, filepath);
+            return DISIR_STATUS_OK;
+        }
+
+        log_debug (6, "mold cache entry '%s' changed on disk - invalidating", filepath);
+        cache->mc_invalidations++;
+        MQ_REMOVE (cache->mc_queue, cached);
+        mold_cache_entry_destroy (&cached);
+    }
+
+    cache->mc_misses++;
+    pthread_mutex_unlock (&cache->mc_lock);
+
+    // The mold is read without holding the cache lock, such that reads
+    // of different entries proceed concurrently.
+    status = plugin->dp_mold_read (instance, plugin, entry_id, mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    cached = calloc (1, sizeof (struct disir_mold_cache_entry));
+    if (cached == NULL)
+    {
+        // We still have a perfectly good mold to hand out - just do not cache it.
+        return DISIR_STATUS_OK;
+    }
+
+    cached->mce_group_id = strdup (group_id);
+    cached->mce_filepath = strdup (filepath);
+    cached->mce_override_filepath = strdup (override_filepath);
+    if (cached->mce_group_id == NULL || cached->mce_filepath == NULL
+        || cached->mce_override_filepath == NULL)
+    {
+        mold_cache_entry_destroy (&cached);
+        return DISIR_STATUS_OK;
+    }
+
+    // Record the file identities sampled before the read. Should the file change
+    // while it is read, the next lookup will simply invalidate this entry.
+    cached->mce_stat = file;
+    cached->mce_override_stat = override_file;
+
+    // The cache holds its own reference
+    cached->mce_mold = *mold;
+    dx_mold_incref (cached->mce_mold);
+
+    pthread_mutex_lock (&cache->mc_lock);
+    if (mold_cache_find (cache, group_id, filepath, override_filepath) != NULL)
+    {
+        // Another thread cached this entry while we were reading it. Keep theirs.
+        pthread_mutex_unlock (&cache->mc_lock);
+        mold_cache_entry_destroy (&cached);
+        return DISIR_STATUS_OK;
+    }
+    MQ_ENQUEUE (cache->mc_queue, cached);
+    pthread_mutex_unlock (&cache->mc_lock);
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_mold_cache_init (struct disir_mold_cache *cache)
+{
+    memset (cache, 0, sizeof (*cache));
+    pthread_mutex_init (&cache->mc_lock, NULL);
+}
+
+//! INTERNAL API
+void
+dx_mold_cache_finished (struct disir_mold_cache *cache)
+{
+    dx_mold_cache_clear (cache);
+    pthread_mutex_destroy (&cache->mc_lock);
+}
+
+//! INTERNAL API
+void
+dx_mold_cache_clear (struct disir_mold_cache *cache)
+{
+    struct disir_mold_cache_entry *entry;
+
+    pthread_mutex_lock (&cache->mc_lock);
+    while ((entry = MQ_POP (cache->mc_queue)) != NULL)
+    {
+        mold_cache_entry_destroy (&entry);
+    }
+    pthread_mutex_unlock (&cache->mc_lock);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_cache_stats (struct disir_instance *instance, struct disir_mold_cache_stats *stats)
+{
+    if (instance == NULL || stats == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), stats (%p)",
+                      instance, stats);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    pthread_mutex_lock (&instance->dio_mold_cache.mc_lock);
+    stats->mcs_hits = instance->dio_mold_cache.mc_hits;
+    stats->mcs_misses = instance->dio_mold_cache.mc_misses;
+    stats->mcs_invalidations = instance->dio_mold_cache.mc_invalidations;
+    stats->mcs_entries = MQ_SIZE (instance->dio_mold_cache.mc_queue);
+    pthread_mutex_unlock (&instance->dio_mold_cache.mc_lock);
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_cache_clear (struct disir_instance *instance)
+{
+    if (instance == NULL)
+    {
+        log_debug (0, "invoked with NULL instance pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    dx_mold_cache_clear (&instance->dio_mold_cache);
+
+    return DISIR_STATUS_OK;
+}
+
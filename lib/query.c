@@ -6,9 +6,11 @@
 #include <disir/disir.h>
 
 #include "context_private.h"
+#include "element_storage.h"
 #include "query_private.h"
 #include "restriction.h"
 #include "log.h"
+#include "stats.h"
 
 
 //! INTERNAL API
@@ -172,18 +174,12 @@ dx_query_ensure_ancestors (struct disir_context *config,
         status = dc_find_element (parent_context, current_element, current_index, &current_context);
         if (status == DISIR_STATUS_NOT_EXIST)
         {
-            int num_elements = 0;
+            int32_t num_elements = 0;
             // Can we create this element?
             // find out how many elements there are, to ensure that we are
             // referecing the index that should be created.
-            struct disir_collection *collection;
-            status = dc_find_elements (parent_context, current_element, &collection);
-            if (status == DISIR_STATUS_OK)
-            {
-                num_elements = dc_collection_size (collection);
-                dc_collection_finished (&collection);
-            }
-            else if (status != DISIR_STATUS_NOT_EXIST)
+            status = dx_context_element_count (parent_context, current_element, &num_elements);
+            if (status != DISIR_STATUS_OK)
             {
                 // internal error
                 log_warn ("unknown error: %s", disir_status_string (status));
@@ -429,11 +425,10 @@ dx_query_resolve_parent_context (struct disir_context *parent, struct disir_cont
     va_list args_copy;
     char *next;
     int index;
-    struct disir_collection *collection;
+    int32_t num_elements;
     char *keyval_entry;
 
     section = NULL;
-    collection = NULL;
 
     va_copy (args_copy, args);
     vsnprintf (buffer, 2048, query, args_copy);
@@ -478,17 +473,16 @@ dx_query_resolve_parent_context (struct disir_context *parent, struct disir_cont
     status = dx_query_resolve_name (section, keyval_entry, resolved, &next, &index);
     if (status == DISIR_STATUS_OK)
     {
-        // Query section for the collection of entries matching keyval name.
-        // We let the NOT_EXIST go through, so that the collection size == 0 is valid
-        status = dc_find_elements (section, keyval_entry, &collection);
-        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
+        // Count the entries matching keyval name - zero entries is valid.
+        status = dx_context_element_count (section, keyval_entry, &num_elements);
+        if (status != DISIR_STATUS_OK)
         {
             goto error;
         }
 
         // If the size equals the index (that is the index is refering to size + 1 th entry
         // then this is a valid query
-        if (dc_collection_size (collection) != index)
+        if (num_elements != index)
         {
             status = DISIR_STATUS_NOT_EXIST;
             goto error;
@@ -507,10 +501,6 @@ error:
     {
         dc_putcontext (&section);
     }
-    if (collection)
-    {
-        dc_collection_finished (&collection);
-    }
 
     return status;
 }
@@ -530,10 +520,10 @@ dc_query_resolve_context (struct disir_context *parent, const char *name,
     return status;
 }
 
-//! PUBLIC API
-enum disir_status
-dc_query_resolve_context_va (struct disir_context *parent, const char *name,
-                             struct disir_context **out, va_list args)
+//! STATIC API
+static enum disir_status
+query_resolve_context_va (struct disir_context *parent, const char *name,
+                          struct disir_context **out, va_list args)
 {
     enum disir_status status;
     char buffer[2048];
@@ -577,4 +567,267 @@ dc_query_resolve_context_va (struct disir_context *parent, const char *name,
     return DISIR_STATUS_OK;
 }
 
+//! PUBLIC API
+enum disir_status
+dc_query_resolve_context_va (struct disir_context *parent, const char *name,
+                             struct disir_context **out, va_list args)
+{
+    enum disir_status status;
+    struct dx_stats_span span;
+
+    dx_stats_begin (dx_stats_process (), DISIR_STATS_QUERY_RESOLVE, NULL, &span);
+    status = query_resolve_context_va (parent, name, out, args);
+    dx_stats_end (&span, status);
 
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_query_compile (struct disir_context *context, const char *name, struct disir_query **query)
+{
+    enum disir_status status;
+    char buffer[2048];
+    char resolved[2048];
+    char *current;
+    char *next;
+    const char *probe;
+    int index;
+    int num_components;
+    struct disir_query *compiled;
+    struct disir_query_component *component;
+    struct disir_context *mold_parent;
+    struct disir_context *mold_element;
+    enum disir_context_type mold_element_type;
+
+    compiled = NULL;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+    status = CONTEXT_TYPE_CHECK (context, DISIR_CONTEXT_MOLD,
+                                          DISIR_CONTEXT_CONFIG,
+                                          DISIR_CONTEXT_SECTION);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+    if (name == NULL || query == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (name %p, query %p)", name, query);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (strlen (name) >= sizeof (buffer))
+    {
+        dx_log_context (context, "Insufficient buffer. Name request exceeded 2048 bytes.");
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+    }
+    strcpy (buffer, name);
+
+    // Names are validated against the mold, regardless of what context we compile from.
+    mold_parent = context;
+    if (dc_context_type (context->cx_root_context) == DISIR_CONTEXT_CONFIG)
+    {
+        mold_parent = NULL;
+        dx_get_mold_equiv (context, &mold_parent);
+        if (mold_parent == NULL)
+        {
+            dx_log_context (context, "missing mold equivalent to compile query against.");
+            return DISIR_STATUS_MOLD_MISSING;
+        }
+    }
+
+    // Upper bound on the number of names in the query.
+    num_components = 1;
+    for (probe = name; *probe != '\0'; probe++)
+    {
+        if (*probe == '.')
+            num_components++;
+    }
+
+    compiled = calloc (1, sizeof (struct disir_query));
+    if (compiled == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+    compiled->qu_components = calloc (num_components, sizeof (struct disir_query_component));
+    compiled->qu_name = strdup (name);
+    if (compiled->qu_components == NULL || compiled->qu_name == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
+    resolved[0] = '\0';
+    current = buffer;
+    do
+    {
+        if (*current == '\0')
+        {
+            dx_log_context (context, "'%s' missing key after key seperator.", resolved);
+            status = DISIR_STATUS_INVALID_ARGUMENT;
+            goto error;
+        }
+
+        status = dx_query_resolve_name (context, current, resolved, &next, &index);
+        if (status != DISIR_STATUS_OK)
+        {
+            // Already logged
+            goto error;
+        }
+        if (index < 0)
+        {
+            dx_log_context (context, "'%s' has a negative index.", resolved);
+            status = DISIR_STATUS_INVALID_ARGUMENT;
+            goto error;
+        }
+
+        status = dc_find_element (mold_parent, current, 0, &mold_element);
+        if (status != DISIR_STATUS_OK)
+        {
+            dx_log_context (context, "'%s' does not exist in mold.", resolved);
+            status = DISIR_STATUS_MOLD_MISSING;
+            goto error;
+        }
+        mold_element_type = dc_context_type (mold_element);
+        // The mold holds on to the element - we only keep a borrowed reference.
+        mold_parent = mold_element;
+        dc_putcontext (&mold_element);
+
+        if (next != NULL && mold_element_type != DISIR_CONTEXT_SECTION)
+        {
+            dx_log_context (context, "expected '%s' to be a section, is %s.",
+                            resolved, dc_context_type_string (mold_parent));
+            status = DISIR_STATUS_CONFLICT;
+            goto error;
+        }
+
+        component = &compiled->qu_components[compiled->qu_numcomponents];
+        component->qc_name = strdup (current);
+        if (component->qc_name == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto error;
+        }
+        component->qc_hash = dx_element_storage_hash (current);
+        component->qc_index = (unsigned int) index;
+        compiled->qu_numcomponents++;
+
+        current = next;
+    } while (current != NULL);
+
+    *query = compiled;
+    return DISIR_STATUS_OK;
+error:
+    if (compiled)
+    {
+        dc_query_finished (&compiled);
+    }
+
+    return status;
+}
+
+//! STATIC API
+static enum disir_status
+query_resolve (struct disir_context *parent, struct disir_query *query,
+               struct disir_context **out)
+{
+    enum disir_status status;
+    struct disir_context *current;
+    struct disir_element_storage *storage;
+    struct disir_query_component *component;
+    int i;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (parent);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+    if (query == NULL || out == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (query %p, out %p)", query, out);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Walk borrowed references down the tree - only the resolved context is incref'ed.
+    current = parent;
+    for (i = 0; i < query->qu_numcomponents; i++)
+    {
+        component = &query->qu_components[i];
+
+        status = dx_context_element_storage (current, &storage);
+        if (status != DISIR_STATUS_OK)
+        {
+            // Already logged
+            return status;
+        }
+
+        status = dx_element_storage_get_nth_hashed (storage, component->qc_name,
+                                                    component->qc_hash, component->qc_index,
+                                                    &current);
+        if (status != DISIR_STATUS_OK)
+        {
+            log_debug (5, "element '%s@%u' of query '%s' not found",
+                       component->qc_name, component->qc_index, query->qu_name);
+            return status;
+        }
+    }
+
+    dx_context_incref (current);
+    *out = current;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_query_resolve (struct disir_context *parent, struct disir_query *query,
+                  struct disir_context **out)
+{
+    enum disir_status status;
+    struct dx_stats_span span;
+
+    dx_stats_begin (dx_stats_process (), DISIR_STATS_QUERY_RESOLVE, NULL, &span);
+    status = query_resolve (parent, query, out);
+    dx_stats_end (&span, status);
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_query_finished (struct disir_query **query)
+{
+    int i;
+
+    if (query == NULL || *query == NULL)
+    {
+        log_debug (0, "invoked with NULL query pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if ((*query)->qu_components)
+    {
+        for (i = 0; i < (*query)->qu_numcomponents; i++)
+        {
+            free ((*query)->qu_components[i].qc_name);
+        }
+        free ((*query)->qu_components);
+    }
+    if ((*query)->qu_name)
+    {
+        free ((*query)->qu_name);
+    }
+
+    free (*query);
+    *query = NULL;
+
+    return DISIR_STATUS_OK;
+}
@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <disir/disir.h>
+
+#include "restriction_table.h"
+#include "mqueue.h"
+#include "log.h"
+
+//! Minimum number of slots in the enum set of a segment. Must be a power of two.
+#define RESTRICTION_TABLE_MIN_ENUM_SLOTS 8
+
+//! Restrictions active from one version up to the next segment.
+struct restriction_table_segment
+{
+    //! Lowest version this segment applies to.
+    struct disir_version        ts_version;
+
+    //! Number of exclusive restrictions active in this segment.
+    uint32_t                    ts_active;
+
+    //! Disjoint inclusive intervals sorted ascending, stored as min/max pairs.
+    double                      *ts_ranges;
+    uint32_t                    ts_ranges_count;
+
+    //! Exact values sorted ascending.
+    double                      *ts_numerics;
+    uint32_t                    ts_numerics_count;
+
+    //! Open addressed set of enum values. NULL marks an empty slot.
+    const char                  **ts_enums;
+    uint32_t                    ts_enums_mask;
+};
+
+struct disir_restriction_table
+{
+    //! Segments sorted by ascending version. The first applies from version 0.0.
+    struct restriction_table_segment    *rt_segments;
+    uint32_t                            rt_segments_count;
+
+    //! INC_ENTRY_MIN and INC_ENTRY_MAX restrictions of the queue, in queue order.
+    struct disir_restriction            **rt_inclusive;
+    uint32_t                            rt_inclusive_count;
+};
+
+//! STATIC API
+//! Whether restriction is an exclusive value restriction.
+static int
+restriction_is_exclusive (struct disir_restriction *restriction)
+{
+    return (restriction->re_type == DISIR_RESTRICTION_EXC_VALUE_RANGE
+            || restriction->re_type == DISIR_RESTRICTION_EXC_VALUE_NUMERIC
+            || restriction->re_type == DISIR_RESTRICTION_EXC_VALUE_ENUM);
+}
+
+// String hashing function for the enum values
+// http://www.cse.yorku.ca/~oz/hash.html
+static unsigned long
+enum_hash (const char *value)
+{
+    unsigned long hash = 5381;
+    int c;
+    while ((c = (unsigned char) *value++))
+        hash = ((hash << 5) + hash) + c;
+
+    return hash;
+}
+
+//! STATIC API
+//! Home slot of value in a set of mask + 1 slots.
+static uint32_t
+enum_slot (const char *value, uint32_t mask)
+{
+    return (uint32_t) (((uint64_t) enum_hash (value) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+//! STATIC API
+static int
+version_compare_qsort (const void *lhs, const void *rhs)
+{
+    struct disir_version l = *(const struct disir_version *) lhs;
+    struct disir_version r = *(const struct disir_version *) rhs;
+
+    return dc_version_compare (&l, &r);
+}
+
+//! STATIC API
+static int
+double_compare_qsort (const void *lhs, const void *rhs)
+{
+    double l = *(const double *) lhs;
+    double r = *(const double *) rhs;
+
+    return (l > r) - (l < r);
+}
+
+//! STATIC API
+static void
+segment_destroy (struct restriction_table_segment *segment)
+{
+    free (segment->ts_ranges);
+    free (segment->ts_numerics);
+    free (segment->ts_enums);
+}
+
+//! STATIC API
+//!
+//! Compile the exclusive restrictions of queue active at the segment version.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if allocation fails.
+//! \return DISIR_STATUS_OK on success.
+//!
+static enum disir_status
+segment_compile (struct restriction_table_segment *segment, struct disir_restriction *queue)
+{
+    uint32_t enums;
+    uint32_t slots;
+    uint32_t slot;
+    uint32_t merged;
+    uint32_t i;
+
+    enums = 0;
+    MQ_FOREACH (queue,
+    {
+        if (restriction_is_exclusive (entry)
+            && dx_restriction_is_active (entry, &segment->ts_version))
+        {
+            segment->ts_active++;
+            switch (entry->re_type)
+            {
+            case DISIR_RESTRICTION_EXC_VALUE_RANGE:
+                segment->ts_ranges_count++;
+                break;
+            case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
+                segment->ts_numerics_count++;
+                break;
+            default:
+                enums++;
+                break;
+            }
+        }
+    });
+
+    if (segment->ts_ranges_count)
+    {
+        segment->ts_ranges = malloc (sizeof (double) * 2 * segment->ts_ranges_count);
+        if (segment->ts_ranges == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+    }
+    if (segment->ts_numerics_count)
+    {
+        segment->ts_numerics = malloc (sizeof (double) * segment->ts_numerics_count);
+        if (segment->ts_numerics == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+    }
+    if (enums)
+    {
+        slots = RESTRICTION_TABLE_MIN_ENUM_SLOTS;
+        while (slots < enums * 2)
+            slots *= 2;
+        segment->ts_enums = calloc (slots, sizeof (const char *));
+        if (segment->ts_enums == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+        segment->ts_enums_mask = slots - 1;
+    }
+
+    segment->ts_ranges_count = 0;
+    segment->ts_numerics_count = 0;
+    MQ_FOREACH (queue,
+    {
+        if (restriction_is_exclusive (entry)
+            && dx_restriction_is_active (entry, &segment->ts_version))
+        {
+            switch (entry->re_type)
+            {
+            case DISIR_RESTRICTION_EXC_VALUE_RANGE:
+                // Ranges with a NaN bound or min above max never match any value.
+                if (entry->re_value_min <= entry->re_value_max)
+                {
+                    segment->ts_ranges[2 * segment->ts_ranges_count] = entry->re_value_min;
+                    segment->ts_ranges[2 * segment->ts_ranges_count + 1] = entry->re_value_max;
+                    segment->ts_ranges_count++;
+                }
+                break;
+            case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
+                // NaN never equals any value.
+                if (entry->re_value_numeric == entry->re_value_numeric)
+                {
+                    segment->ts_numerics[segment->ts_numerics_count++] = entry->re_value_numeric;
+                }
+                break;
+            default:
+                if (entry->re_value_string == NULL)
+                    break;
+                slot = enum_slot (entry->re_value_string, segment->ts_enums_mask);
+                while (segment->ts_enums[slot] != NULL
+                       && strcmp (segment->ts_enums[slot], entry->re_value_string) != 0)
+                {
+                    slot = (slot + 1) & segment->ts_enums_mask;
+                }
+                segment->ts_enums[slot] = entry->re_value_string;
+                break;
+            }
+        }
+    });
+
+    // Sort intervals by their minimum and merge the overlapping ones.
+    if (segment->ts_ranges_count > 1)
+    {
+        qsort (segment->ts_ranges, segment->ts_ranges_count, sizeof (double) * 2,
+               double_compare_qsort);
+
+        merged = 0;
+        for (i = 1; i < segment->ts_ranges_count; i++)
+        {
+            if (segment->ts_ranges[2 * i] <= segment->ts_ranges[2 * merged + 1])
+            {
+                if (segment->ts_ranges[2 * i + 1] > segment->ts_ranges[2 * merged + 1])
+                    segment->ts_ranges[2 * merged + 1] = segment->ts_ranges[2 * i + 1];
+                continue;
+            }
+
+            merged++;
+            segment->ts_ranges[2 * merged] = segment->ts_ranges[2 * i];
+            segment->ts_ranges[2 * merged + 1] = segment->ts_ranges[2 * i + 1];
+        }
+        segment->ts_ranges_count = merged + 1;
+    }
+
+    if (segment->ts_numerics_count > 1)
+    {
+        qsort (segment->ts_numerics, segment->ts_numerics_count, sizeof (double),
+               double_compare_qsort);
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Destroy table and every segment compiled into it.
+static void
+table_destroy (struct disir_restriction_table *table)
+{
+    uint32_t i;
+
+    if (table == NULL)
+        return;
+
+    for (i = 0; i < table->rt_segments_count; i++)
+    {
+        segment_destroy (&table->rt_segments[i]);
+    }
+    free (table->rt_segments);
+    free (table->rt_inclusive);
+    free (table);
+}
+
+//! STATIC API
+//!
+//! Compile the exclusive restrictions of queue into a new table.
+//!
+//! \return NULL if allocation fails.
+//!
+static struct disir_restriction_table *
+table_compile (struct disir_restriction *queue)
+{
+    struct disir_restriction_table *table;
+    struct disir_version *versions;
+    uint32_t inclusive;
+    uint32_t count;
+    uint32_t unique;
+    uint32_t i;
+
+    table = NULL;
+    versions = NULL;
+
+    // Every version restrictions are introduced or deprecated at starts a segment.
+    count = 1;
+    inclusive = 0;
+    MQ_FOREACH (queue,
+    {
+        if (restriction_is_exclusive (entry))
+            count += 2;
+        else
+            inclusive++;
+    });
+
+    versions = calloc (count, sizeof (struct disir_version));
+    if (versions == NULL)
+        goto error;
+
+    count = 1;
+    MQ_FOREACH (queue,
+    {
+        if (restriction_is_exclusive (entry))
+        {
+            versions[count++] = entry->re_introduced;
+            if (entry->re_deprecated.sv_major != 0 || entry->re_deprecated.sv_minor != 0)
+                versions[count++] = entry->re_deprecated;
+        }
+    });
+
+    qsort (versions, count, sizeof (struct disir_version), version_compare_qsort);
+    unique = 1;
+    for (i = 1; i < count; i++)
+    {
+        if (dc_version_compare (&versions[i], &versions[unique - 1]) != 0)
+            versions[unique++] = versions[i];
+    }
+
+    table = calloc (1, sizeof (struct disir_restriction_table));
+    if (table == NULL)
+        goto error;
+    table->rt_segments = calloc (unique, sizeof (struct restriction_table_segment));
+    if (table->rt_segments == NULL)
+        goto error;
+    if (inclusive)
+    {
+        table->rt_inclusive = calloc (inclusive, sizeof (struct disir_restriction *));
+        if (table->rt_inclusive == NULL)
+            goto error;
+    }
+
+    MQ_FOREACH (queue,
+    {
+        if (restriction_is_exclusive (entry) == 0)
+            table->rt_inclusive[table->rt_inclusive_count++] = entry;
+    });
+
+    for (i = 0; i < unique; i++)
+    {
+        table->rt_segments[i].ts_version = versions[i];
+        table->rt_segments_count++;
+        if (segment_compile (&table->rt_segments[i], queue) != DISIR_STATUS_OK)
+            goto error;
+    }
+
+    free (versions);
+    return table;
+error:
+    log_error ("failed to allocate memory for restriction table");
+    free (versions);
+    table_destroy (table);
+    return NULL;
+}
+
+//! STATIC API
+//! Segment of table that applies to version.
+static struct restriction_table_segment *
+table_segment (struct disir_restriction_table *table, struct disir_version *version)
+{
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+
+    // The first segment starts at version 0.0, and always applies.
+    low = 0;
+    high = table->rt_segments_count;
+    while (high - low > 1)
+    {
+        middle = low + (high - low) / 2;
+        if (dc_version_compare (&table->rt_segments[middle].ts_version, version) <= 0)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return &table->rt_segments[low];
+}
+
+//! INTERNAL API
+struct disir_restriction_table *
+dx_restriction_table_get (struct disir_restriction_table **table,
+                          struct disir_restriction *queue)
+{
+    struct disir_restriction_table *compiled;
+    struct disir_restriction_table *expected;
+
+    compiled = __atomic_load_n (table, __ATOMIC_ACQUIRE);
+    if (compiled)
+        return compiled;
+
+    compiled = table_compile (queue);
+    if (compiled == NULL)
+        return NULL;
+
+    expected = NULL;
+    if (__atomic_compare_exchange_n (table, &expected, compiled, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == 0)
+    {
+        // Another thread compiled it first
+        table_destroy (compiled);
+        return expected;
+    }
+
+    return compiled;
+}
+
+//! INTERNAL API
+void
+dx_restriction_table_invalidate (struct disir_restriction_table **table)
+{
+    table_destroy (__atomic_exchange_n (table, NULL, __ATOMIC_ACQ_REL));
+}
+
+//! INTERNAL API
+int
+dx_restriction_table_check_numeric (struct disir_restriction_table *table,
+                                    struct disir_version *version,
+                                    double value, uint32_t *active)
+{
+    struct restriction_table_segment *segment;
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+
+    segment = table_segment (table, version);
+    *active = segment->ts_active;
+
+    // NaN fulfills nothing
+    if (value != value)
+        return 0;
+
+    // Last interval whose minimum is at or below value
+    low = 0;
+    high = segment->ts_ranges_count;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (segment->ts_ranges[2 * middle] <= value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low > 0 && value <= segment->ts_ranges[2 * (low - 1) + 1])
+        return 1;
+
+    low = 0;
+    high = segment->ts_numerics_count;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (segment->ts_numerics[middle] < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < segment->ts_numerics_count && segment->ts_numerics[low] == value)
+        return 1;
+
+    return 0;
+}
+
+//! INTERNAL API
+int
+dx_restriction_table_check_enum (struct disir_restriction_table *table,
+                                 struct disir_version *version,
+                                 const char *value, uint32_t *active)
+{
+    struct restriction_table_segment *segment;
+    uint32_t slot;
+
+    segment = table_segment (table, version);
+    *active = segment->ts_active;
+
+    if (value == NULL || segment->ts_enums == NULL)
+        return 0;
+
+    for (slot = enum_slot (value, segment->ts_enums_mask);
+         segment->ts_enums[slot] != NULL;
+         slot = (slot + 1) & segment->ts_enums_mask)
+    {
+        if (strcmp (segment->ts_enums[slot], value) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+//! INTERNAL API
+struct disir_restriction **
+dx_restriction_table_inclusive (struct disir_restriction_table *table, uint32_t *count)
+{
+    *count = table->rt_inclusive_count;
+    return table->rt_inclusive;
+}
+
+//! INTERNAL API
+int
+dx_restriction_is_active (struct disir_restriction *restriction, struct disir_version *version)
+{
+    // Introduced later than version
+    if (dc_version_compare (version, &restriction->re_introduced) < 0)
+        return 0;
+
+    // Deprecated at or before version
+    if ((restriction->re_deprecated.sv_major != 0 || restriction->re_deprecated.sv_minor != 0)
+        && dc_version_compare (version, &restriction->re_deprecated) >= 0)
+    {
+        return 0;
+    }
+
+    return 1;
+}
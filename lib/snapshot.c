@@ -0,0 +1,720 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <disir/disir.h>
+#include <disir/snapshot.h>
+
+#include "context_private.h"
+#include "element_storage.h"
+#include "config.h"
+#include "section.h"
+#include "keyval.h"
+#include "snapshot.h"
+#include "log.h"
+#include <multimap.h>
+
+
+//! A keyval collected from the config while the snapshot is built.
+struct snapshot_build_entry
+{
+    //! Allocated, fully resolved name of the keyval.
+    char                        *sbe_key;
+    //! Value owned by the config keyval.
+    struct disir_value          *sbe_value;
+    //! Offset of sbe_key in the snapshot string table.
+    uint32_t                    sbe_key_offset;
+    //! Offset of the interned string value, if sbe_value is an enum or string.
+    uint32_t                    sbe_string_offset;
+};
+
+//! State kept while walking the config.
+struct snapshot_build
+{
+    struct snapshot_build_entry *sb_entries;
+    uint32_t                    sb_numentries;
+    uint32_t                    sb_capacity;
+
+    //! Resolved name of the section currently walked.
+    char                        *sb_path;
+    size_t                      sb_pathlen;
+    size_t                      sb_pathcapacity;
+};
+
+
+//! STATIC API
+//!
+//! Parse the next component "name@index" of key at cursor, advancing cursor past it.
+//! An omitted index is 0.
+//!
+//! \return 1 if a component was parsed.
+//! \return 0 if cursor is at the end of key.
+//! \return -1 if the component is malformed.
+//!
+static int
+snapshot_key_component (const char **cursor, const char **name, size_t *namesize,
+                        uint32_t *index)
+{
+    const char *p;
+
+    p = *cursor;
+    if (*p == '\0')
+        return 0;
+
+    *name = p;
+    while (*p != '\0' && *p != '.' && *p != '@')
+        p++;
+    *namesize = p - *name;
+    if (*namesize == 0)
+        return -1;
+
+    *index = 0;
+    if (*p == '@')
+    {
+        p++;
+        if (*p < '0' || *p > '9')
+            return -1;
+        while (*p >= '0' && *p <= '9')
+        {
+            if (*index > (UINT32_MAX - 9) / 10)
+                return -1;
+            *index = *index * 10 + (*p - '0');
+            p++;
+        }
+    }
+
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '\0')
+            return -1;
+    }
+    else if (*p != '\0')
+    {
+        return -1;
+    }
+
+    *cursor = p;
+    return 1;
+}
+
+//! STATIC API
+static int
+snapshot_key_valid (const char *key)
+{
+    const char *name;
+    size_t namesize;
+    uint32_t index;
+    int res;
+
+    if (*key == '\0')
+        return 0;
+
+    do
+    {
+        res = snapshot_key_component (&key, &name, &namesize, &index);
+    } while (res == 1);
+
+    return (res == 0);
+}
+
+//! STATIC API
+//!
+//! Order two well-formed keys component by component; by name first, then by index.
+//! "a.b" and "a@0.b@0" are thus equal.
+//!
+static int
+snapshot_key_compare (const char *lhs, const char *rhs)
+{
+    const char *lhs_name;
+    const char *rhs_name;
+    size_t lhs_namesize;
+    size_t rhs_namesize;
+    uint32_t lhs_index;
+    uint32_t rhs_index;
+    int lhs_res;
+    int rhs_res;
+    int res;
+
+    while (1)
+    {
+        lhs_res = snapshot_key_component (&lhs, &lhs_name, &lhs_namesize, &lhs_index);
+        rhs_res = snapshot_key_component (&rhs, &rhs_name, &rhs_namesize, &rhs_index);
+        if (lhs_res != 1 || rhs_res != 1)
+            return lhs_res - rhs_res;
+
+        res = memcmp (lhs_name, rhs_name,
+                      (lhs_namesize < rhs_namesize ? lhs_namesize : rhs_namesize));
+        if (res != 0)
+            return res;
+        if (lhs_namesize != rhs_namesize)
+            return (lhs_namesize < rhs_namesize ? -1 : 1);
+        if (lhs_index != rhs_index)
+            return (lhs_index < rhs_index ? -1 : 1);
+    }
+}
+
+//! STATIC API
+static int
+snapshot_build_entry_compare (const void *lhs, const void *rhs)
+{
+    return snapshot_key_compare (((const struct snapshot_build_entry *) lhs)->sbe_key,
+                                 ((const struct snapshot_build_entry *) rhs)->sbe_key);
+}
+
+//! STATIC API
+//! Append "name@index" to the current path of build.
+static enum disir_status
+snapshot_build_path_push (struct snapshot_build *build, const char *name, uint32_t index)
+{
+    size_t required;
+    char *path;
+    int written;
+
+    // separator, name, '@', index digits and terminator
+    required = build->sb_pathlen + 1 + strlen (name) + 1 + 10 + 1;
+    if (required > build->sb_pathcapacity)
+    {
+        path = realloc (build->sb_path, required * 2);
+        if (path == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+        build->sb_path = path;
+        build->sb_pathcapacity = required * 2;
+    }
+
+    written = sprintf (build->sb_path + build->sb_pathlen, "%s%s@%u",
+                       (build->sb_pathlen == 0 ? "" : "."), name, index);
+    build->sb_pathlen += written;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Record the keyval value at the current path of build.
+static enum disir_status
+snapshot_build_add (struct snapshot_build *build, struct disir_value *value)
+{
+    struct snapshot_build_entry *entries;
+    uint32_t capacity;
+    char *key;
+
+    if (build->sb_numentries == build->sb_capacity)
+    {
+        if (build->sb_capacity >= UINT32_MAX / 2)
+            return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+
+        capacity = (build->sb_capacity == 0 ? 32 : build->sb_capacity * 2);
+        entries = realloc (build->sb_entries, capacity * sizeof (*entries));
+        if (entries == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+        build->sb_entries = entries;
+        build->sb_capacity = capacity;
+    }
+
+    key = strdup (build->sb_path);
+    if (key == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    build->sb_entries[build->sb_numentries].sbe_key = key;
+    build->sb_entries[build->sb_numentries].sbe_value = value;
+    build->sb_numentries++;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Recursively collect every keyval found in storage.
+static enum disir_status
+snapshot_build_elements (struct snapshot_build *build, struct disir_element_storage *storage)
+{
+    enum disir_status status;
+    struct disir_collection *collection;
+    struct disir_context *element;
+    struct disir_context *first;
+    struct disir_context *nth;
+    const char *name;
+    size_t pathlen;
+    int32_t count;
+    int32_t index;
+
+    element = NULL;
+
+    status = dx_element_storage_get_all (storage, &collection);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    while (dc_collection_next (collection, &element) == DISIR_STATUS_OK)
+    {
+        // Visit each name once, when first encountered, with all its indexed entries.
+        name = dx_context_name (element);
+        status = dx_element_storage_get_nth (storage, name, 0, &first);
+        if (status != DISIR_STATUS_OK)
+            goto error;
+        if (first != element)
+        {
+            dc_putcontext (&element);
+            continue;
+        }
+
+        count = dx_element_storage_count (storage, name);
+        for (index = 0; index < count; index++)
+        {
+            status = dx_element_storage_get_nth (storage, name, index, &nth);
+            if (status != DISIR_STATUS_OK)
+                goto error;
+
+            pathlen = build->sb_pathlen;
+            status = snapshot_build_path_push (build, name, index);
+            if (status != DISIR_STATUS_OK)
+                goto error;
+
+            if (nth->cx_type == DISIR_CONTEXT_KEYVAL)
+            {
+                status = snapshot_build_add (build, &nth->cx_keyval->kv_value);
+            }
+            else if (nth->cx_type == DISIR_CONTEXT_SECTION)
+            {
+                status = snapshot_build_elements (build, nth->cx_section->se_elements);
+            }
+
+            build->sb_pathlen = pathlen;
+            build->sb_path[pathlen] = '\0';
+
+            if (status != DISIR_STATUS_OK)
+                goto error;
+        }
+
+        dc_putcontext (&element);
+    }
+
+    dc_collection_finished (&collection);
+    return DISIR_STATUS_OK;
+error:
+    if (element)
+        dc_putcontext (&element);
+    dc_collection_finished (&collection);
+    return status;
+}
+
+//! STATIC API
+static const char *
+snapshot_value_string (struct disir_value *value)
+{
+    return (value->dv_string ? value->dv_string : "");
+}
+
+//! STATIC API
+//! Assign offsets into the string table to every key and unique string value.
+static enum disir_status
+snapshot_build_layout (struct snapshot_build *build, size_t *strings_size)
+{
+    enum disir_status status;
+    struct multimap *interned;
+    struct snapshot_build_entry *entry;
+    struct snapshot_build_entry *existing;
+    const char *string;
+    uint64_t offset;
+    uint32_t i;
+
+    status = DISIR_STATUS_OK;
+    offset = 0;
+
+    interned = multimap_create ((int (*)(const void *, const void*)) strcmp,
+                                (unsigned long (*)(const void*)) dx_element_storage_hash);
+    if (interned == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    for (i = 0; i < build->sb_numentries; i++)
+    {
+        entry = &build->sb_entries[i];
+        entry->sbe_key_offset = offset;
+        offset += strlen (entry->sbe_key) + 1;
+        if (offset > UINT32_MAX)
+        {
+            status = DISIR_STATUS_INSUFFICIENT_RESOURCES;
+            goto out;
+        }
+    }
+
+    for (i = 0; i < build->sb_numentries; i++)
+    {
+        entry = &build->sb_entries[i];
+        if (entry->sbe_value->dv_type != DISIR_VALUE_TYPE_STRING &&
+            entry->sbe_value->dv_type != DISIR_VALUE_TYPE_ENUM)
+        {
+            continue;
+        }
+
+        string = snapshot_value_string (entry->sbe_value);
+        existing = multimap_get_first (interned, string);
+        if (existing)
+        {
+            entry->sbe_string_offset = existing->sbe_string_offset;
+            continue;
+        }
+
+        entry->sbe_string_offset = offset;
+        offset += strlen (string) + 1;
+        if (offset > UINT32_MAX)
+        {
+            status = DISIR_STATUS_INSUFFICIENT_RESOURCES;
+            goto out;
+        }
+        if (multimap_push_value (interned, string, entry) != 0)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto out;
+        }
+    }
+
+    *strings_size = offset;
+out:
+    multimap_destroy (interned, NULL, NULL);
+    return status;
+}
+
+//! STATIC API
+static void
+snapshot_build_destroy (struct snapshot_build *build)
+{
+    uint32_t i;
+
+    for (i = 0; i < build->sb_numentries; i++)
+    {
+        free (build->sb_entries[i].sbe_key);
+    }
+    free (build->sb_entries);
+    free (build->sb_path);
+}
+
+//! STATIC API
+//! Locate the entry with key in snapshot.
+static enum disir_status
+snapshot_lookup (struct disir_snapshot *snapshot, const char *key,
+                 enum disir_value_type type, struct disir_snapshot_entry **entry)
+{
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+    int res;
+
+    if (snapshot == NULL || key == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (snapshot (%p), key (%p))",
+                      snapshot, key);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (snapshot_key_valid (key) == 0)
+    {
+        log_debug (0, "invoked with malformed key '%s'", key);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    low = 0;
+    high = snapshot->sn_numentries;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        res = snapshot_key_compare (key,
+                                    snapshot->sn_strings + snapshot->sn_entries[middle].sne_key);
+        if (res == 0)
+        {
+            *entry = &snapshot->sn_entries[middle];
+            if (type != DISIR_VALUE_TYPE_UNKNOWN && (*entry)->sne_type != type)
+                return DISIR_STATUS_WRONG_VALUE_TYPE;
+            return DISIR_STATUS_OK;
+        }
+        if (res < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return DISIR_STATUS_NOT_EXIST;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_create (struct disir_config *config, struct disir_snapshot **snapshot)
+{
+    enum disir_status status;
+    struct snapshot_build build;
+    struct snapshot_build_entry *source;
+    struct disir_snapshot_entry *destination;
+    struct disir_snapshot *output;
+    size_t strings_size;
+    uint32_t i;
+
+    if (config == NULL || snapshot == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (config (%p), snapshot (%p))",
+                      config, snapshot);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset (&build, 0, sizeof (build));
+    strings_size = 0;
+
+    build.sb_pathcapacity = 128;
+    build.sb_path = calloc (1, build.sb_pathcapacity);
+    if (build.sb_path == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    status = snapshot_build_elements (&build, config->cf_elements);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    qsort (build.sb_entries, build.sb_numentries, sizeof (*build.sb_entries),
+           snapshot_build_entry_compare);
+
+    status = snapshot_build_layout (&build, &strings_size);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    // One allocation: the snapshot, followed by its entries, followed by its strings.
+    output = malloc (sizeof (*output) + build.sb_numentries * sizeof (*destination)
+                     + strings_size);
+    if (output == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    output->sn_version = config->cf_version;
+    output->sn_numentries = build.sb_numentries;
+    output->sn_entries = (struct disir_snapshot_entry *) (output + 1);
+    output->sn_strings = (char *) (output->sn_entries + build.sb_numentries);
+
+    for (i = 0; i < build.sb_numentries; i++)
+    {
+        source = &build.sb_entries[i];
+        destination = &output->sn_entries[i];
+
+        memset (destination, 0, sizeof (*destination));
+        destination->sne_key = source->sbe_key_offset;
+        strcpy (output->sn_strings + source->sbe_key_offset, source->sbe_key);
+
+        destination->sne_type = source->sbe_value->dv_type;
+        switch (destination->sne_type)
+        {
+        case DISIR_VALUE_TYPE_ENUM:
+            // FALL-THROUGH
+        case DISIR_VALUE_TYPE_STRING:
+            destination->sne_string = source->sbe_string_offset;
+            strcpy (output->sn_strings + source->sbe_string_offset,
+                    snapshot_value_string (source->sbe_value));
+            break;
+        case DISIR_VALUE_TYPE_BOOLEAN:
+            destination->sne_boolean = source->sbe_value->dv_boolean;
+            break;
+        case DISIR_VALUE_TYPE_FLOAT:
+            destination->sne_float = source->sbe_value->dv_float;
+            break;
+        case DISIR_VALUE_TYPE_INTEGER:
+            destination->sne_integer = source->sbe_value->dv_integer;
+            break;
+        case DISIR_VALUE_TYPE_UNKNOWN:
+            break;
+        }
+    }
+
+    *snapshot = output;
+out:
+    snapshot_build_destroy (&build);
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_finished (struct disir_snapshot **snapshot)
+{
+    if (snapshot == NULL || *snapshot == NULL)
+    {
+        log_debug (0, "invoked with NULL snapshot pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    free (*snapshot);
+    *snapshot = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_version (struct disir_snapshot *snapshot, struct disir_version *version)
+{
+    if (snapshot == NULL || version == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (snapshot (%p), version (%p))",
+                      snapshot, version);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    *version = snapshot->sn_version;
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+uint32_t
+disir_snapshot_numentries (struct disir_snapshot *snapshot)
+{
+    if (snapshot == NULL)
+        return 0;
+
+    return snapshot->sn_numentries;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_type (struct disir_snapshot *snapshot, enum disir_value_type *type,
+                         const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (type == NULL)
+    {
+        log_debug (0, "invoked with NULL type pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_UNKNOWN, &entry);
+    if (status == DISIR_STATUS_OK)
+        *type = entry->sne_type;
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_keyval_string (struct disir_snapshot *snapshot, const char **value,
+                                  const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (value == NULL)
+    {
+        log_debug (0, "invoked with NULL value pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_STRING, &entry);
+    if (status == DISIR_STATUS_OK)
+        *value = snapshot->sn_strings + entry->sne_string;
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_keyval_enum (struct disir_snapshot *snapshot, const char **value,
+                                const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (value == NULL)
+    {
+        log_debug (0, "invoked with NULL value pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_ENUM, &entry);
+    if (status == DISIR_STATUS_OK)
+        *value = snapshot->sn_strings + entry->sne_string;
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_keyval_boolean (struct disir_snapshot *snapshot, uint8_t *value,
+                                   const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (value == NULL)
+    {
+        log_debug (0, "invoked with NULL value pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_BOOLEAN, &entry);
+    if (status == DISIR_STATUS_OK)
+        *value = entry->sne_boolean;
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_keyval_float (struct disir_snapshot *snapshot, double *value,
+                                 const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (value == NULL)
+    {
+        log_debug (0, "invoked with NULL value pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_FLOAT, &entry);
+    if (status == DISIR_STATUS_OK)
+        *value = entry->sne_float;
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_snapshot_get_keyval_integer (struct disir_snapshot *snapshot, int64_t *value,
+                                   const char *key)
+{
+    enum disir_status status;
+    struct disir_snapshot_entry *entry;
+
+    if (value == NULL)
+    {
+        log_debug (0, "invoked with NULL value pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = snapshot_lookup (snapshot, key, DISIR_VALUE_TYPE_INTEGER, &entry);
+    if (status == DISIR_STATUS_OK)
+        *value = entry->sne_integer;
+
+    return status;
+}
+
+//! PUBLIC API
+struct disir_snapshot *
+disir_snapshot_publish (struct disir_snapshot **slot, struct disir_snapshot *snapshot)
+{
+    if (slot == NULL)
+    {
+        log_debug (0, "invoked with NULL slot pointer");
+        return NULL;
+    }
+
+    return __atomic_exchange_n (slot, snapshot, __ATOMIC_ACQ_REL);
+}
+
+//! PUBLIC API
+struct disir_snapshot *
+disir_snapshot_acquire (struct disir_snapshot **slot)
+{
+    if (slot == NULL)
+        return NULL;
+
+    return __atomic_load_n (slot, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,535 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <disir/disir.h>
+
+#include "disir_private.h"
+#include "log.h"
+#include "mqueue.h"
+#include "stats.h"
+
+
+//! Statistics of the operations performed on contexts, without an instance.
+static struct dx_stats_storage stats_process;
+static pthread_once_t stats_process_once = PTHREAD_ONCE_INIT;
+
+//! Innermost open span of the calling thread.
+static __thread struct dx_stats_span *stats_span_top;
+//! Counters of the calling thread in stats_process.
+static __thread struct dx_stats_thread *stats_process_thread;
+//! Number of sampled operations the calling thread has started.
+static __thread uint32_t stats_sample_count;
+
+//! STATIC API
+static uint64_t
+stats_now (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+//! STATIC API
+//! Add value to a counter only ever written by the calling thread.
+//! A plain load and store is sufficient - readers merely need untorn values.
+static inline void
+stats_add (uint64_t *counter, uint64_t value)
+{
+    __atomic_store_n (counter, __atomic_load_n (counter, __ATOMIC_RELAXED) + value,
+                      __ATOMIC_RELAXED);
+}
+
+//! STATIC API
+//! Add every counter of from to the counters of to.
+static void
+stats_counter_sum (struct disir_stats_counter *to, struct disir_stats_counter *from)
+{
+    int i;
+
+    to->sc_calls += __atomic_load_n (&from->sc_calls, __ATOMIC_RELAXED);
+    to->sc_errors += __atomic_load_n (&from->sc_errors, __ATOMIC_RELAXED);
+    to->sc_bytes_read += __atomic_load_n (&from->sc_bytes_read, __ATOMIC_RELAXED);
+    to->sc_bytes_written += __atomic_load_n (&from->sc_bytes_written, __ATOMIC_RELAXED);
+    to->sc_timed += __atomic_load_n (&from->sc_timed, __ATOMIC_RELAXED);
+    to->sc_nanoseconds += __atomic_load_n (&from->sc_nanoseconds, __ATOMIC_RELAXED);
+    for (i = 0; i < DISIR_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        to->sc_histogram[i] += __atomic_load_n (&from->sc_histogram[i], __ATOMIC_RELAXED);
+    }
+}
+
+//! STATIC API
+static void
+stats_operations_sum (struct disir_stats_counter *to, struct disir_stats_counter *from)
+{
+    int i;
+
+    for (i = 0; i < DISIR_STATS_OPERATION_UNKNOWN; i++)
+    {
+        stats_counter_sum (&to[i], &from[i]);
+    }
+}
+
+//! STATIC API
+//! Locate the plugin counters of thread, or allocate them if create is set.
+static struct dx_stats_plugin *
+stats_thread_plugin (struct dx_stats_thread *thread,
+                     struct disir_register_plugin_internal *plugin, int create)
+{
+    struct dx_stats_plugin *current;
+    struct dx_stats_plugin **link;
+
+    link = &thread->th_plugins;
+    while ((current = __atomic_load_n (link, __ATOMIC_ACQUIRE)) != NULL)
+    {
+        if (current->sp_plugin == plugin)
+            return current;
+        link = &current->sp_next;
+    }
+
+    if (create == 0)
+        return NULL;
+
+    current = calloc (1, sizeof (struct dx_stats_plugin));
+    if (current == NULL)
+        return NULL;
+
+    current->sp_plugin = plugin;
+    // Readers may walk the list concurrently - publish the zeroed counters.
+    __atomic_store_n (link, current, __ATOMIC_RELEASE);
+
+    return current;
+}
+
+//! STATIC API
+static void
+stats_thread_destroy (struct dx_stats_thread *thread)
+{
+    struct dx_stats_plugin *plugin;
+
+    while ((plugin = thread->th_plugins) != NULL)
+    {
+        thread->th_plugins = plugin->sp_next;
+        free (plugin);
+    }
+    free (thread);
+}
+
+//! STATIC API
+static void
+stats_thread_release (struct dx_thread_record *record)
+{
+    stats_thread_destroy ((struct dx_stats_thread *) record);
+}
+
+//! STATIC API
+//! Invoked when a thread holding counters in a live storage exits.
+//! Its counters are folded into the retired counters of the storage.
+static void
+stats_thread_exit (struct dx_thread_record *record)
+{
+    struct dx_stats_thread *thread;
+    struct dx_stats_storage *storage;
+    struct dx_stats_plugin *plugin;
+    struct dx_stats_plugin *retired;
+
+    thread = (struct dx_stats_thread *) record;
+    storage = thread->th_storage;
+    if (thread == stats_process_thread)
+    {
+        stats_process_thread = NULL;
+    }
+
+    pthread_mutex_lock (&storage->ss_lock);
+    stats_operations_sum (storage->ss_retired.th_operations, thread->th_operations);
+    for (plugin = thread->th_plugins; plugin != NULL; plugin = plugin->sp_next)
+    {
+        retired = stats_thread_plugin (&storage->ss_retired, plugin->sp_plugin, 1);
+        if (retired != NULL)
+        {
+            stats_operations_sum (retired->sp_operations, plugin->sp_operations);
+        }
+    }
+    MQ_REMOVE (storage->ss_threads, thread);
+    pthread_mutex_unlock (&storage->ss_lock);
+}
+
+//! STATIC API
+//! Retrieve the counters of the calling thread in storage, allocating them on first use.
+static struct dx_stats_thread *
+stats_thread_acquire (struct dx_stats_storage *storage)
+{
+    struct dx_stats_thread *thread;
+
+    if (storage == &stats_process && stats_process_thread != NULL)
+        return stats_process_thread;
+
+    thread = (struct dx_stats_thread *) dx_thread_record_find (storage);
+    if (thread != NULL)
+        return thread;
+
+    thread = calloc (1, sizeof (struct dx_stats_thread));
+    if (thread == NULL)
+        return NULL;
+
+    thread->th_storage = storage;
+    thread->th_record.tr_exit = stats_thread_exit;
+    thread->th_record.tr_release = stats_thread_release;
+    if (dx_thread_record_register (&thread->th_record, storage) != DISIR_STATUS_OK)
+    {
+        free (thread);
+        return NULL;
+    }
+
+    pthread_mutex_lock (&storage->ss_lock);
+    MQ_ENQUEUE (storage->ss_threads, thread);
+    pthread_mutex_unlock (&storage->ss_lock);
+
+    if (storage == &stats_process)
+    {
+        stats_process_thread = thread;
+    }
+
+    return thread;
+}
+
+//! STATIC API
+static void
+stats_process_initialize (void)
+{
+    dx_stats_storage_init (&stats_process);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_stats_storage_init (struct dx_stats_storage *storage)
+{
+    memset (storage, 0, sizeof (struct dx_stats_storage));
+
+    pthread_mutex_init (&storage->ss_lock, NULL);
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_stats_storage_finished (struct dx_stats_storage *storage)
+{
+    struct dx_stats_thread *thread;
+    struct dx_stats_plugin *plugin;
+
+    // A thread exiting meanwhile either has folded its counters already,
+    // or finds its counters orphaned - and releases them, as any other thread will.
+    dx_thread_records_lock ();
+    while ((thread = MQ_POP (storage->ss_threads)) != NULL)
+    {
+        dx_thread_record_orphan (&thread->th_record);
+    }
+    dx_thread_records_unlock ();
+    dx_thread_records_prune ();
+    while ((plugin = storage->ss_retired.th_plugins) != NULL)
+    {
+        storage->ss_retired.th_plugins = plugin->sp_next;
+        free (plugin);
+    }
+
+    pthread_mutex_destroy (&storage->ss_lock);
+}
+
+//! INTERNAL API
+struct dx_stats_storage *
+dx_stats_process (void)
+{
+    pthread_once (&stats_process_once, stats_process_initialize);
+    return &stats_process;
+}
+
+//! INTERNAL API
+void
+dx_stats_begin (struct dx_stats_storage *storage, enum disir_stats_operation operation,
+                struct disir_register_plugin_internal *plugin, struct dx_stats_span *span)
+{
+    struct dx_stats_thread *thread;
+    struct dx_stats_plugin *counters;
+
+    span->sp_counter = NULL;
+    span->sp_operation = operation;
+    span->sp_outer = stats_span_top;
+    stats_span_top = span;
+
+    thread = stats_thread_acquire (storage);
+    if (thread == NULL)
+        return;
+
+    if (plugin != NULL)
+    {
+        counters = stats_thread_plugin (thread, plugin, 1);
+        if (counters == NULL)
+            return;
+        span->sp_counter = &counters->sp_operations[operation];
+    }
+    else
+    {
+        span->sp_counter = &thread->th_operations[operation];
+    }
+
+    // Reading the clock costs as much as resolving a query - only time a sample of them.
+    span->sp_start = 0;
+    if (operation != DISIR_STATS_QUERY_RESOLVE
+        || stats_sample_count++ % DISIR_STATS_SAMPLE_RATE == 0)
+    {
+        span->sp_start = stats_now ();
+    }
+}
+
+//! INTERNAL API
+void
+dx_stats_end (struct dx_stats_span *span, enum disir_status status)
+{
+    struct disir_stats_counter *counter;
+    uint64_t elapsed;
+    int bucket;
+    int error;
+
+    stats_span_top = span->sp_outer;
+
+    counter = span->sp_counter;
+    if (counter == NULL)
+        return;
+
+    error = (status != DISIR_STATUS_OK);
+    if ((span->sp_operation == DISIR_STATS_CONFIG_QUERY
+         || span->sp_operation == DISIR_STATS_MOLD_QUERY)
+        && (status == DISIR_STATUS_EXISTS || status == DISIR_STATUS_NOT_EXIST))
+    {
+        error = 0;
+    }
+
+    stats_add (&counter->sc_calls, 1);
+    stats_add (&counter->sc_errors, error);
+
+    if (span->sp_start == 0)
+        return;
+
+    elapsed = stats_now () - span->sp_start;
+
+    // Bucket by the position of the most significant bit.
+    bucket = (elapsed > 1 ? 63 - __builtin_clzll (elapsed) : 0);
+    if (bucket >= DISIR_STATS_HISTOGRAM_BUCKETS)
+    {
+        bucket = DISIR_STATS_HISTOGRAM_BUCKETS - 1;
+    }
+
+    stats_add (&counter->sc_timed, 1);
+    stats_add (&counter->sc_nanoseconds, elapsed);
+    stats_add (&counter->sc_histogram[bucket], 1);
+}
+
+//! INTERNAL API
+void
+dx_stats_bytes (uint64_t bytes_read, uint64_t bytes_written)
+{
+    struct dx_stats_span *span;
+
+    for (span = stats_span_top; span != NULL; span = span->sp_outer)
+    {
+        if (span->sp_counter == NULL)
+            continue;
+
+        stats_add (&span->sp_counter->sc_bytes_read, bytes_read);
+        stats_add (&span->sp_counter->sc_bytes_written, bytes_written);
+    }
+}
+
+//! INTERNAL API
+void
+dx_stats_storage_sum (struct dx_stats_storage *storage,
+                      struct disir_register_plugin_internal *plugin,
+                      struct disir_stats_counter *operations)
+{
+    struct dx_stats_plugin *counters;
+
+    pthread_mutex_lock (&storage->ss_lock);
+    MQ_FOREACH (storage->ss_threads,
+    ({
+        if (plugin == NULL)
+        {
+            stats_operations_sum (operations, entry->th_operations);
+        }
+        else if ((counters = stats_thread_plugin (entry, plugin, 0)) != NULL)
+        {
+            stats_operations_sum (operations, counters->sp_operations);
+        }
+    }));
+
+    if (plugin == NULL)
+    {
+        stats_operations_sum (operations, storage->ss_retired.th_operations);
+    }
+    else if ((counters = stats_thread_plugin (&storage->ss_retired, plugin, 0)) != NULL)
+    {
+        stats_operations_sum (operations, counters->sp_operations);
+    }
+    pthread_mutex_unlock (&storage->ss_lock);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_instance_stats (struct disir_instance *instance, struct disir_stats **stats)
+{
+    enum disir_status status;
+    struct disir_stats *result;
+    struct disir_plugin_stats *plugin;
+
+    if (instance == NULL || stats == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), stats (%p)",
+                   instance, stats);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) stats (%p)", instance, stats);
+
+    result = calloc (1, sizeof (struct disir_stats));
+    if (result == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    dx_stats_storage_sum (&instance->dio_stats, NULL, result->st_operations);
+    dx_stats_storage_sum (dx_stats_process (), NULL, result->st_operations);
+
+    status = DISIR_STATUS_OK;
+    pthread_rwlock_rdlock (&instance->dio_plugin_lock);
+    MQ_FOREACH (instance->dio_plugin_queue,
+    ({
+        plugin = calloc (1, sizeof (struct disir_plugin_stats));
+        if (plugin == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            break;
+        }
+        MQ_ENQUEUE (result->st_plugins, plugin);
+
+        plugin->ps_io_id = strdup (entry->pi_io_id);
+        plugin->ps_group_id = strdup (entry->pi_group_id);
+        if (plugin->ps_io_id == NULL || plugin->ps_group_id == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            break;
+        }
+
+        dx_stats_storage_sum (&instance->dio_stats, entry, plugin->ps_operations);
+    }));
+    pthread_rwlock_unlock (&instance->dio_plugin_lock);
+
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_stats_finished (&result);
+        goto out;
+    }
+
+    *stats = result;
+    // FALL-THROUGH
+out:
+    TRACE_EXIT ("%s", disir_status_string (status));
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_stats_finished (struct disir_stats **stats)
+{
+    struct disir_plugin_stats *plugin;
+
+    if (stats == NULL || *stats == NULL)
+        return DISIR_STATUS_INVALID_ARGUMENT;
+
+    while ((plugin = MQ_POP ((*stats)->st_plugins)) != NULL)
+    {
+        free (plugin->ps_io_id);
+        free (plugin->ps_group_id);
+        free (plugin);
+    }
+
+    free (*stats);
+    *stats = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+const char *
+disir_stats_operation_string (enum disir_stats_operation operation)
+{
+    switch (operation)
+    {
+    case DISIR_STATS_CONFIG_READ:
+        return "config_read";
+    case DISIR_STATS_CONFIG_WRITE:
+        return "config_write";
+    case DISIR_STATS_CONFIG_REMOVE:
+        return "config_remove";
+    case DISIR_STATS_CONFIG_QUERY:
+        return "config_query";
+    case DISIR_STATS_CONFIG_ENTRIES:
+        return "config_entries";
+    case DISIR_STATS_MOLD_READ:
+        return "mold_read";
+    case DISIR_STATS_MOLD_WRITE:
+        return "mold_write";
+    case DISIR_STATS_MOLD_QUERY:
+        return "mold_query";
+    case DISIR_STATS_MOLD_ENTRIES:
+        return "mold_entries";
+    case DISIR_STATS_VALIDATE:
+        return "validate";
+    case DISIR_STATS_QUERY_RESOLVE:
+        return "query_resolve";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+//! PUBLIC API
+uint64_t
+disir_stats_percentile (const struct disir_stats_counter *counter, double percentile)
+{
+    uint64_t total;
+    uint64_t target;
+    uint64_t seen;
+    int i;
+
+    if (counter == NULL)
+        return 0;
+
+    total = 0;
+    for (i = 0; i < DISIR_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        total += counter->sc_histogram[i];
+    }
+    if (total == 0)
+        return 0;
+
+    if (percentile < 0)
+        percentile = 0;
+    if (percentile > 100)
+        percentile = 100;
+
+    target = (uint64_t) (total * percentile / 100.0);
+    if (target == 0)
+        target = 1;
+
+    seen = 0;
+    for (i = 0; i < DISIR_STATS_HISTOGRAM_BUCKETS - 1; i++)
+    {
+        seen += counter->sc_histogram[i];
+        if (seen >= target)
+            break;
+    }
+
+    return (uint64_t) 2 << i;
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <disir/disir.h>
+
+#include "log.h"
+#include "thread_state.h"
+
+
+//! One key for the whole process - its destructor walks thread_records.
+static pthread_key_t thread_records_key;
+static pthread_once_t thread_records_once = PTHREAD_ONCE_INIT;
+static int thread_records_key_valid;
+
+//! Serializes threads exiting against owners being torn down.
+static pthread_mutex_t thread_records_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! Records registered by the calling thread, most recent first.
+static __thread struct dx_thread_record *thread_records;
+
+//! STATIC API
+//! Invoked when a thread holding records exits.
+static void
+thread_records_exit (void *data)
+{
+    struct dx_thread_record *record;
+
+    (void) data;
+
+    pthread_mutex_lock (&thread_records_mutex);
+    for (record = thread_records; record != NULL; record = record->tr_thread_next)
+    {
+        if (__atomic_load_n (&record->tr_owner, __ATOMIC_ACQUIRE) != NULL)
+        {
+            record->tr_exit (record);
+        }
+    }
+    pthread_mutex_unlock (&thread_records_mutex);
+
+    while ((record = thread_records) != NULL)
+    {
+        thread_records = record->tr_thread_next;
+        record->tr_release (record);
+    }
+}
+
+//! STATIC API
+static void
+thread_records_initialize (void)
+{
+    if (pthread_key_create (&thread_records_key, thread_records_exit) != 0)
+    {
+        log_error ("failed to allocate thread-specific records key");
+        return;
+    }
+
+    thread_records_key_valid = 1;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_thread_record_register (struct dx_thread_record *record, void *owner)
+{
+    pthread_once (&thread_records_once, thread_records_initialize);
+    if (thread_records_key_valid == 0)
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+
+    // Any non-NULL value makes the destructor run - it only needs thread_records.
+    if (thread_records == NULL
+        && pthread_setspecific (thread_records_key, &thread_records) != 0)
+    {
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    record->tr_owner = owner;
+    record->tr_thread_next = thread_records;
+    thread_records = record;
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+struct dx_thread_record *
+dx_thread_record_find (const void *owner)
+{
+    struct dx_thread_record **link;
+    struct dx_thread_record *record;
+    void *current;
+
+    link = &thread_records;
+    while ((record = *link) != NULL)
+    {
+        current = __atomic_load_n (&record->tr_owner, __ATOMIC_ACQUIRE);
+        if (current == NULL)
+        {
+            *link = record->tr_thread_next;
+            record->tr_release (record);
+            continue;
+        }
+        if (current == owner)
+            return record;
+
+        link = &record->tr_thread_next;
+    }
+
+    return NULL;
+}
+
+//! INTERNAL API
+void
+dx_thread_records_lock (void)
+{
+    pthread_mutex_lock (&thread_records_mutex);
+}
+
+//! INTERNAL API
+void
+dx_thread_records_unlock (void)
+{
+    pthread_mutex_unlock (&thread_records_mutex);
+}
+
+//! INTERNAL API
+void
+dx_thread_record_orphan (struct dx_thread_record *record)
+{
+    __atomic_store_n (&record->tr_owner, NULL, __ATOMIC_RELEASE);
+}
+
+//! INTERNAL API
+void
+dx_thread_records_prune (void)
+{
+    // No record has a NULL owner but the orphaned ones, which are released on the way.
+    dx_thread_record_find (NULL);
+}
@@ -0,0 +1,439 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <disir/disir.h>
+
+#include "log.h"
+#include "trace.h"
+
+
+//! Number of spans held by a single chunk of a thread buffer.
+#define TRACE_CHUNK_EVENTS 1024
+//! Maximum number of chunks allocated by the process. Spans beyond are dropped.
+#define TRACE_CHUNKS_MAX 4096
+//! Maximum number of spans a thread may have open at once.
+#define TRACE_STACK_MAX 256
+
+//! A single closed span.
+struct trace_event
+{
+    //! Name of the traced function. Points to its static __func__ string.
+    const char          *te_function;
+    //! Monotonic start time, in nanoseconds.
+    uint64_t            te_start;
+    uint64_t            te_duration;
+};
+
+//! Fixed size block of spans. Only the owning thread appends to it.
+struct trace_chunk
+{
+    struct trace_event  tc_events[TRACE_CHUNK_EVENTS];
+    //! Number of spans published by the owning thread. Written with release semantics.
+    uint32_t            tc_count;
+    //! Next chunk of the same thread. Written with release semantics.
+    struct trace_chunk  *tc_next;
+};
+
+//! A span opened by TRACE_ENTER, waiting for its TRACE_EXIT.
+struct trace_frame
+{
+    const char          *tf_function;
+    uint64_t            tf_start;
+};
+
+//! Span buffer of a single thread.
+struct trace_thread
+{
+    //! Kernel thread identifier, as shown by the trace viewer.
+    pid_t               tt_tid;
+    //! First chunk of spans. Written with release semantics.
+    struct trace_chunk  *tt_chunks;
+    //! Chunk currently appended to. Owning thread only.
+    struct trace_chunk  *tt_last;
+
+    //! Recording period the open spans belong to. Owning thread only.
+    uint32_t            tt_generation;
+    int                 tt_depth;
+    struct trace_frame  tt_stack[TRACE_STACK_MAX];
+
+    struct trace_thread *next;
+};
+
+//! The process wide trace sink.
+static struct
+{
+    //! Protects ts_threads, ts_filepath and writes to the trace file.
+    pthread_mutex_t     ts_mutex;
+    pthread_key_t       ts_thread_key;
+
+    //! Singly-linked list of every thread that recorded a span.
+    struct trace_thread *ts_threads;
+
+    char                ts_filepath[PATH_MAX];
+    //! Monotonic time tracing was last enabled. Only spans started since are written,
+    //! with timestamps relative to it.
+    uint64_t            ts_origin;
+    //! Incremented every time tracing is enabled, discarding spans left open.
+    uint32_t            ts_generation;
+    int                 ts_atexit;
+
+    uint64_t            ts_chunks;
+    uint64_t            ts_dropped;
+} trace_sink = {
+    .ts_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+int dx_trace_enabled = 0;
+
+static pthread_once_t trace_sink_once = PTHREAD_ONCE_INIT;
+static pthread_once_t trace_environment_once = PTHREAD_ONCE_INIT;
+
+//! Span buffer of the calling thread.
+static __thread struct trace_thread *thread_trace;
+
+//! STATIC API
+static uint64_t
+trace_now (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+//! STATIC API
+//! Invoked when a thread owning a span buffer exits.
+//! Buffers holding spans are kept until the process exits, so they can be written.
+static void
+trace_thread_release (void *data)
+{
+    struct trace_thread *trace;
+    struct trace_thread **link;
+
+    trace = data;
+    thread_trace = NULL;
+
+    if (__atomic_load_n (&trace->tt_chunks, __ATOMIC_RELAXED) != NULL)
+        return;
+
+    pthread_mutex_lock (&trace_sink.ts_mutex);
+    for (link = &trace_sink.ts_threads; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == trace)
+        {
+            *link = trace->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock (&trace_sink.ts_mutex);
+
+    free (trace);
+}
+
+//! STATIC API
+static void
+trace_sink_initialize (void)
+{
+    pthread_key_create (&trace_sink.ts_thread_key, trace_thread_release);
+}
+
+//! STATIC API
+//! Allocate and register the span buffer of the calling thread.
+static struct trace_thread *
+trace_thread_acquire (void)
+{
+    struct trace_thread *trace;
+
+    if (thread_trace)
+        return thread_trace;
+
+    pthread_once (&trace_sink_once, trace_sink_initialize);
+
+    trace = calloc (1, sizeof (struct trace_thread));
+    if (trace == NULL)
+        return NULL;
+
+    trace->tt_tid = (pid_t) syscall (SYS_gettid);
+
+    pthread_mutex_lock (&trace_sink.ts_mutex);
+    trace->next = trace_sink.ts_threads;
+    trace_sink.ts_threads = trace;
+    pthread_mutex_unlock (&trace_sink.ts_mutex);
+
+    pthread_setspecific (trace_sink.ts_thread_key, trace);
+    thread_trace = trace;
+
+    return trace;
+}
+
+//! STATIC API
+//! Discard the open spans of trace if they were opened in a previous recording period.
+static void
+trace_thread_synchronize (struct trace_thread *trace)
+{
+    uint32_t generation;
+
+    generation = __atomic_load_n (&trace_sink.ts_generation, __ATOMIC_RELAXED);
+    if (trace->tt_generation != generation)
+    {
+        trace->tt_generation = generation;
+        trace->tt_depth = 0;
+    }
+}
+
+//! STATIC API
+//! Append a closed span to the buffer of the calling thread, and publish it.
+static void
+trace_record (struct trace_thread *trace, const char *function,
+              uint64_t start, uint64_t duration)
+{
+    struct trace_chunk *chunk;
+    struct trace_event *event;
+    uint32_t count;
+
+    chunk = trace->tt_last;
+    if (chunk == NULL || chunk->tc_count == TRACE_CHUNK_EVENTS)
+    {
+        if (__atomic_fetch_add (&trace_sink.ts_chunks, 1, __ATOMIC_RELAXED) >= TRACE_CHUNKS_MAX
+            || (chunk = calloc (1, sizeof (struct trace_chunk))) == NULL)
+        {
+            __atomic_fetch_add (&trace_sink.ts_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        if (trace->tt_last == NULL)
+        {
+            __atomic_store_n (&trace->tt_chunks, chunk, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            __atomic_store_n (&trace->tt_last->tc_next, chunk, __ATOMIC_RELEASE);
+        }
+        trace->tt_last = chunk;
+    }
+
+    count = chunk->tc_count;
+    event = &chunk->tc_events[count];
+    event->te_function = function;
+    event->te_start = start;
+    event->te_duration = duration;
+    __atomic_store_n (&chunk->tc_count, count + 1, __ATOMIC_RELEASE);
+}
+
+//! STATIC API
+//! Write every published span as Chrome trace event JSON to the trace filepath.
+//! Caller must hold trace_sink.ts_mutex.
+static enum disir_status
+trace_sink_write_locked (void)
+{
+    struct trace_thread *trace;
+    struct trace_chunk *chunk;
+    struct trace_event *event;
+    uint64_t start;
+    uint32_t count;
+    uint32_t i;
+    FILE *file;
+    pid_t pid;
+    int first;
+
+    file = fopen (trace_sink.ts_filepath, "w");
+    if (file == NULL)
+    {
+        log_error ("Failed to open trace file '%s' for writing.", trace_sink.ts_filepath);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    pid = getpid ();
+    first = 1;
+
+    fputs ("{\"traceEvents\":[", file);
+    for (trace = trace_sink.ts_threads; trace != NULL; trace = trace->next)
+    {
+        chunk = __atomic_load_n (&trace->tt_chunks, __ATOMIC_ACQUIRE);
+        for (; chunk != NULL; chunk = __atomic_load_n (&chunk->tc_next, __ATOMIC_ACQUIRE))
+        {
+            count = __atomic_load_n (&chunk->tc_count, __ATOMIC_ACQUIRE);
+            for (i = 0; i < count; i++)
+            {
+                event = &chunk->tc_events[i];
+                if (event->te_start < trace_sink.ts_origin)
+                    continue;
+                start = event->te_start - trace_sink.ts_origin;
+
+                // Function names are C identifiers - nothing to escape.
+                // Timestamps are microseconds.
+                fprintf (file, "%s\n{\"name\":\"%s\",\"cat\":\"libdisir\",\"ph\":\"X\","
+                               "\"ts\":%" PRIu64 ".%03" PRIu64 ","
+                               "\"dur\":%" PRIu64 ".%03" PRIu64 ","
+                               "\"pid\":%d,\"tid\":%d}",
+                         (first ? "" : ","), event->te_function,
+                         start / 1000, start % 1000,
+                         event->te_duration / 1000, event->te_duration % 1000,
+                         (int) pid, (int) trace->tt_tid);
+                first = 0;
+            }
+        }
+    }
+    fprintf (file, "\n],\"displayTimeUnit\":\"ns\","
+                   "\"otherData\":{\"dropped_spans\":\"%" PRIu64 "\"}}\n",
+             __atomic_load_n (&trace_sink.ts_dropped, __ATOMIC_RELAXED));
+
+    if (fclose (file) != 0)
+    {
+        log_error ("Failed to write trace file '%s'.", trace_sink.ts_filepath);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Write the recorded spans when the process exits.
+static void
+trace_sink_shutdown (void)
+{
+    pthread_mutex_lock (&trace_sink.ts_mutex);
+    if (trace_sink.ts_filepath[0] != '\0')
+    {
+        trace_sink_write_locked ();
+    }
+    pthread_mutex_unlock (&trace_sink.ts_mutex);
+}
+
+//! STATIC API
+static void
+trace_environment_apply (void)
+{
+    const char *filepath;
+
+    filepath = getenv (DISIR_TRACE_FILEPATH_ENV);
+    if (filepath != NULL && *filepath != '\0')
+    {
+        disir_trace_filepath_set (filepath);
+    }
+}
+
+//! INTERNAL API
+void
+dx_trace_initialize (void)
+{
+    pthread_once (&trace_environment_once, trace_environment_apply);
+}
+
+//! INTERNAL API
+struct dx_trace_scope
+dx_trace_enter (const char *function)
+{
+    struct dx_trace_scope scope = DX_TRACE_SCOPE_NONE;
+    struct trace_thread *trace;
+
+    trace = trace_thread_acquire ();
+    if (trace == NULL)
+        return scope;
+
+    trace_thread_synchronize (trace);
+    if (trace->tt_depth >= TRACE_STACK_MAX)
+    {
+        __atomic_fetch_add (&trace_sink.ts_dropped, 1, __ATOMIC_RELAXED);
+        return scope;
+    }
+
+    trace->tt_stack[trace->tt_depth].tf_function = function;
+    trace->tt_stack[trace->tt_depth].tf_start = trace_now ();
+    scope.tsc_depth = trace->tt_depth;
+    scope.tsc_generation = trace->tt_generation;
+    trace->tt_depth++;
+
+    return scope;
+}
+
+//! INTERNAL API
+void
+dx_trace_exit (struct dx_trace_scope *scope)
+{
+    struct trace_thread *trace;
+    struct trace_frame *frame;
+
+    trace = thread_trace;
+    if (trace == NULL)
+        return;
+
+    // Enabled anew since - the stack was discarded, along with the span.
+    trace_thread_synchronize (trace);
+    if (trace->tt_generation != scope->tsc_generation || trace->tt_depth <= scope->tsc_depth)
+        return;
+
+    // Scopes close in reverse order of opening - this is the innermost open span.
+    trace->tt_depth = scope->tsc_depth;
+    frame = &trace->tt_stack[trace->tt_depth];
+    trace_record (trace, frame->tf_function, frame->tf_start, trace_now () - frame->tf_start);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_trace_filepath_set (const char *filepath)
+{
+    if (filepath != NULL && strlen (filepath) >= sizeof (trace_sink.ts_filepath))
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    pthread_once (&trace_sink_once, trace_sink_initialize);
+
+    pthread_mutex_lock (&trace_sink.ts_mutex);
+    if (filepath == NULL || *filepath == '\0')
+    {
+        // Write what was recorded before recording stops.
+        if (trace_sink.ts_filepath[0] != '\0')
+        {
+            __atomic_store_n (&dx_trace_enabled, 0, __ATOMIC_RELAXED);
+            trace_sink_write_locked ();
+            trace_sink.ts_filepath[0] = '\0';
+        }
+        pthread_mutex_unlock (&trace_sink.ts_mutex);
+        return DISIR_STATUS_OK;
+    }
+
+    snprintf (trace_sink.ts_filepath, sizeof (trace_sink.ts_filepath), "%s", filepath);
+    if (__atomic_load_n (&dx_trace_enabled, __ATOMIC_RELAXED) == 0)
+    {
+        trace_sink.ts_origin = trace_now ();
+        __atomic_fetch_add (&trace_sink.ts_generation, 1, __ATOMIC_RELAXED);
+        __atomic_store_n (&dx_trace_enabled, 1, __ATOMIC_RELAXED);
+    }
+    if (trace_sink.ts_atexit == 0)
+    {
+        atexit (trace_sink_shutdown);
+        trace_sink.ts_atexit = 1;
+    }
+    pthread_mutex_unlock (&trace_sink.ts_mutex);
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_trace_flush (void)
+{
+    enum disir_status status;
+
+    pthread_mutex_lock (&trace_sink.ts_mutex);
+    if (trace_sink.ts_filepath[0] == '\0')
+    {
+        status = DISIR_STATUS_NOT_EXIST;
+    }
+    else
+    {
+        status = trace_sink_write_locked ();
+    }
+    pthread_mutex_unlock (&trace_sink.ts_mutex);
+
+    return status;
+}
@@ -8,6 +8,7 @@
 
 #include "config.h"
 #include "default.h"
+#include "element_storage.h"
 #include "section.h"
 #include "keyval.h"
 #include "log.h"
@@ -217,7 +218,8 @@ disir_update_continue (struct disir_update *update)
         {
             // Config has not changed since its last update value.
             // We can safely update the stored value in config with new default
-            dx_value_copy (&keyval->kv_value, &target_def->de_value);
+            dx_context_touch (config_keyval);
+            dx_value_copy_arena (&keyval->kv_value, keyval->kv_arena, &target_def->de_value);
             // TODO: Add update report entry
             update->up_updated++;
         }
@@ -247,7 +249,7 @@ disir_update_continue (struct disir_update *update)
     }
 
     // Update version number of config
-    dc_version_set (&update->up_config_old->cf_version, &update->up_target);
+    dx_config_set_version (update->up_config_old, &update->up_target);
 
     TRACE_EXIT ("");
     return DISIR_STATUS_OK;
@@ -368,6 +370,476 @@ disir_update_finished (struct disir_update **update, struct disir_config **confi
     return DISIR_STATUS_OK;
 }
 
+//! STATIC FUNCTION
+//! Allocate the string representation of value.
+static char *
+update_plan_value_string (struct disir_value *value)
+{
+    char *output;
+    int32_t size;
+
+    size = 512;
+    if (value->dv_type == DISIR_VALUE_TYPE_STRING || value->dv_type == DISIR_VALUE_TYPE_ENUM)
+    {
+        size = value->dv_size + 1;
+    }
+
+    output = malloc (size);
+    if (output == NULL)
+        return NULL;
+
+    if (dx_value_stringify (value, size, output, NULL) != DISIR_STATUS_OK)
+    {
+        output[0] = '\0';
+    }
+
+    return output;
+}
+
+//! STATIC FUNCTION
+//! Free node and every node below it.
+static void
+update_plan_node_destroy (struct dx_update_plan_node *node)
+{
+    struct dx_update_plan_node *child;
+
+    while (node->pn_children)
+    {
+        child = node->pn_children;
+        node->pn_children = child->pn_next;
+        update_plan_node_destroy (child);
+        free (child);
+    }
+}
+
+//! STATIC FUNCTION
+//! Add an entry to plan for the mold keyval if its default changed between the plan versions.
+static enum disir_status
+update_plan_build_keyval (struct disir_update_plan *plan, struct disir_context *keyval,
+                          struct dx_update_plan_node **node)
+{
+    enum disir_status status;
+    struct disir_default *source;
+    struct disir_default *target;
+    struct dx_update_plan_entry *entries;
+    struct dx_update_plan_entry *entry;
+    int32_t capacity;
+
+    *node = NULL;
+
+    dx_default_get_active (keyval, &plan->pl_source, &source);
+    dx_default_get_active (keyval, &plan->pl_target, &target);
+    if (source == NULL || target == NULL || source == target
+        || dx_value_compare (&source->de_value, &target->de_value) == 0)
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    if (plan->pl_entries_count == plan->pl_entries_capacity)
+    {
+        capacity = (plan->pl_entries_capacity ? plan->pl_entries_capacity * 2 : 16);
+        entries = realloc (plan->pl_entries, capacity * sizeof (struct dx_update_plan_entry));
+        if (entries == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+        plan->pl_entries = entries;
+        plan->pl_entries_capacity = capacity;
+    }
+
+    *node = calloc (1, sizeof (struct dx_update_plan_node));
+    if (*node == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    entry = &plan->pl_entries[plan->pl_entries_count];
+    memset (entry, 0, sizeof (struct dx_update_plan_entry));
+    (*node)->pn_entry = plan->pl_entries_count;
+    plan->pl_entries_count++;
+
+    entry->pe_source = &source->de_value;
+    entry->pe_target = &target->de_value;
+    entry->pe_source_string = update_plan_value_string (&source->de_value);
+    entry->pe_target_string = update_plan_value_string (&target->de_value);
+    status = dc_resolve_root_name (keyval, &entry->pe_name);
+    if (status == DISIR_STATUS_OK
+        && (entry->pe_source_string == NULL || entry->pe_target_string == NULL))
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+    }
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Populate node with the elements of mold_parent leading to a keyval whose default changed.
+static enum disir_status
+update_plan_build (struct disir_update_plan *plan, struct disir_context *mold_parent,
+                   struct dx_update_plan_node *node)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct disir_collection *collection;
+    struct disir_context *context;
+    struct dx_update_plan_node *child;
+    const char *name;
+    int32_t size;
+
+    status = dx_context_element_storage (mold_parent, &storage);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dx_element_storage_get_all (storage, &collection);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    while (status == DISIR_STATUS_OK
+           && dc_collection_next (collection, &context) == DISIR_STATUS_OK)
+    {
+        child = NULL;
+        if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
+        {
+            status = update_plan_build_keyval (plan, context, &child);
+        }
+        else if (dc_context_type (context) == DISIR_CONTEXT_SECTION)
+        {
+            child = calloc (1, sizeof (struct dx_update_plan_node));
+            if (child == NULL)
+            {
+                status = DISIR_STATUS_NO_MEMORY;
+            }
+            else
+            {
+                child->pn_entry = -1;
+                status = update_plan_build (plan, context, child);
+                if (status == DISIR_STATUS_OK && child->pn_children == NULL)
+                {
+                    // Nothing changed below this section.
+                    free (child);
+                    child = NULL;
+                }
+            }
+        }
+
+        if (child)
+        {
+            // Names are owned by the mold, which the plan holds a reference to.
+            dc_get_name (context, &name, &size);
+            child->pn_name = name;
+            child->pn_hash = dx_element_storage_hash (name);
+            child->pn_next = node->pn_children;
+            node->pn_children = child;
+        }
+
+        dc_putcontext (&context);
+    }
+
+    dc_collection_finished (&collection);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Upgrade a config keyval listed by the plan entry at index.
+//! If apply is zero, the keyval is only counted - config is left untouched.
+static enum disir_status
+update_plan_apply_keyval (struct disir_update_plan *plan, int32_t index,
+                          struct disir_context *context, int apply,
+                          int *updated, int *conflicts)
+{
+    enum disir_status status;
+    struct dx_update_plan_entry *entry;
+    struct disir_keyval *keyval;
+
+    entry = &plan->pl_entries[index];
+    keyval = context->cx_keyval;
+
+    if (dx_value_compare (&keyval->kv_value, entry->pe_target) == 0)
+    {
+        // Already holds the target default.
+        return DISIR_STATUS_OK;
+    }
+    if (dx_value_compare (&keyval->kv_value, entry->pe_source) != 0)
+    {
+        // Customized - keep the value of the config.
+        (*conflicts)++;
+        return DISIR_STATUS_OK;
+    }
+    if (apply == 0)
+    {
+        (*updated)++;
+        return DISIR_STATUS_OK;
+    }
+
+    dx_context_touch (context);
+    status = dx_value_copy_arena (&keyval->kv_value, keyval->kv_arena, entry->pe_target);
+    if (status == DISIR_STATUS_OK)
+    {
+        (*updated)++;
+    }
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Visit every element of config_parent matching a child of node.
+//! Element lookups go straight to the element storage - nothing is allocated.
+static enum disir_status
+update_plan_apply_node (struct disir_update_plan *plan, struct dx_update_plan_node *node,
+                        struct disir_context *config_parent, int apply,
+                        int *updated, int *conflicts)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct dx_update_plan_node *child;
+    struct disir_context *context;
+    unsigned int index;
+
+    status = dx_context_element_storage (config_parent, &storage);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (child = node->pn_children; child != NULL; child = child->pn_next)
+    {
+        for (index = 0; dx_element_storage_get_nth_hashed (storage, child->pn_name,
+                                                           child->pn_hash, index,
+                                                           &context) == DISIR_STATUS_OK; index++)
+        {
+            if (child->pn_entry < 0 && dc_context_type (context) == DISIR_CONTEXT_SECTION)
+            {
+                status = update_plan_apply_node (plan, child, context, apply,
+                                                 updated, conflicts);
+            }
+            else if (child->pn_entry >= 0 && dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
+            {
+                status = update_plan_apply_keyval (plan, child->pn_entry, context, apply,
+                                                   updated, conflicts);
+            }
+            if (status != DISIR_STATUS_OK)
+                return status;
+        }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_update_plan_create (struct disir_mold *mold, struct disir_version *source,
+                          struct disir_version *target, struct disir_update_plan **plan)
+{
+    enum disir_status status;
+    struct disir_update_plan *pl;
+    char buffer[512];
+    int res;
+
+    TRACE_ENTER ("mold: %p, source: %p, target: %p, plan: %p", mold, source, target, plan);
+
+    if (mold == NULL || source == NULL || plan == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (mold: %p, source: %p, plan: %p)",
+                   mold, source, plan);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (target == NULL)
+    {
+        target = &mold->mo_version;
+    }
+
+    res = dc_version_compare (source, target);
+    if (res > 0)
+    {
+        log_warn ("Source version (%s) is higher than target (%s)",
+                  dc_version_string (buffer, 256, source),
+                  dc_version_string (buffer + 256, 256, target));
+        return DISIR_STATUS_CONFLICTING_SEMVER;
+    }
+    if (res == 0)
+    {
+        log_debug (4, "Source and target are of equal version (%s) - nothing to be done",
+                   dc_version_string (buffer, 512, source));
+        return DISIR_STATUS_NO_CAN_DO;
+    }
+
+    pl = calloc (1, sizeof (struct disir_update_plan));
+    if (pl == NULL)
+    {
+        log_error ("failed to allocate memory for update plan");
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    dx_mold_incref (mold);
+    pl->pl_mold = mold;
+    dc_version_set (&pl->pl_source, source);
+    dc_version_set (&pl->pl_target, target);
+    pl->pl_root.pn_entry = -1;
+
+    status = update_plan_build (pl, mold->mo_context, &pl->pl_root);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_update_plan_finished (&pl);
+        return status;
+    }
+
+    log_debug (4, "update plan from %s to %s holds %d keyval(s)",
+               dc_version_string (buffer, 256, &pl->pl_source),
+               dc_version_string (buffer + 256, 256, &pl->pl_target), pl->pl_entries_count);
+
+    *plan = pl;
+
+    TRACE_EXIT ("");
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+int32_t
+disir_update_plan_size (struct disir_update_plan *plan)
+{
+    if (plan == NULL)
+        return -1;
+
+    return plan->pl_entries_count;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_update_plan_entry (struct disir_update_plan *plan, int32_t index, const char **name,
+                         const char **source, const char **target)
+{
+    struct dx_update_plan_entry *entry;
+
+    if (plan == NULL || name == NULL || source == NULL || target == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (plan: %p, name: %p, source: %p, target: %p)",
+                   plan, name, source, target);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (index < 0 || index >= plan->pl_entries_count)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    entry = &plan->pl_entries[index];
+    *name = entry->pe_name;
+    *source = entry->pe_source_string;
+    *target = entry->pe_target_string;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_update_plan_apply (struct disir_update_plan *plan, struct disir_config *config,
+                         int keep_customized, int *updated, int *conflicts)
+{
+    enum disir_status status;
+    char buffer[512];
+    int config_updated;
+    int config_conflicts;
+
+    TRACE_ENTER ("plan: %p, config: %p, keep_customized: %d", plan, config, keep_customized);
+
+    if (plan == NULL || config == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (plan: %p, config: %p)", plan, config);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (config->cf_mold != plan->pl_mold)
+    {
+        log_debug (0, "config (%p) is not of the mold of plan (%p)", config, plan);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (dc_version_compare (&config->cf_version, &plan->pl_source) != 0)
+    {
+        log_debug (4, "config version (%s) differ from plan source version (%s)",
+                   dc_version_string (buffer, 256, &config->cf_version),
+                   dc_version_string (buffer + 256, 256, &plan->pl_source));
+        return DISIR_STATUS_CONFLICTING_SEMVER;
+    }
+
+    config_updated = 0;
+    config_conflicts = 0;
+
+    // Count the customized keyvals first, so a rejected upgrade leaves config untouched.
+    if (keep_customized == 0)
+    {
+        status = update_plan_apply_node (plan, &plan->pl_root, config->cf_context, 0,
+                                         &config_updated, &config_conflicts);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+        if (config_conflicts > 0)
+        {
+            log_debug (4, "config holds %d customized keyval(s) - not upgraded",
+                       config_conflicts);
+            if (updated)
+            {
+                *updated = 0;
+            }
+            if (conflicts)
+            {
+                *conflicts = config_conflicts;
+            }
+            return DISIR_STATUS_CONFLICT;
+        }
+        config_updated = 0;
+    }
+
+    status = update_plan_apply_node (plan, &plan->pl_root, config->cf_context, 1,
+                                     &config_updated, &config_conflicts);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    dx_config_set_version (config, &plan->pl_target);
+
+    if (updated)
+    {
+        *updated = config_updated;
+    }
+    if (conflicts)
+    {
+        *conflicts = config_conflicts;
+    }
+
+    TRACE_EXIT ("updated: %d, conflicts: %d", config_updated, config_conflicts);
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_update_plan_finished (struct disir_update_plan **plan)
+{
+    struct disir_update_plan *pl;
+    int32_t i;
+
+    if (plan == NULL || *plan == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (plan: %p)", plan);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    pl = *plan;
+
+    update_plan_node_destroy (&pl->pl_root);
+    for (i = 0; i < pl->pl_entries_count; i++)
+    {
+        free (pl->pl_entries[i].pe_name);
+        free (pl->pl_entries[i].pe_source_string);
+        free (pl->pl_entries[i].pe_target_string);
+    }
+    free (pl->pl_entries);
+    disir_mold_finished (&pl->pl_mold);
+    free (pl);
+
+    *plan = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 enum disir_status
 dx_update_config_with_changes (struct disir_config **config, int discard_violations)
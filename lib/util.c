@@ -9,6 +9,7 @@
 
 // Private disir includes
 #include "value.h"
+#include "arena.h"
 #include "log.h"
 
 //! Array of strings describing the various DISIR_STATUS_* enumerations
@@ -255,13 +256,22 @@ dx_value_compare (struct disir_value *v1, struct disir_value *v2)
 //! INTERNAL API
 enum disir_status
 dx_value_copy (struct disir_value *destination, struct disir_value *source)
+{
+    return dx_value_copy_arena (destination, NULL, source);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_value_copy_arena (struct disir_value *destination, struct disir_arena *arena,
+                     struct disir_value *source)
 {
     switch (dx_value_type_sanify (source->dv_type))
     {
     case DISIR_VALUE_TYPE_ENUM:
         // FALL-THROUGH
     case DISIR_VALUE_TYPE_STRING:
-        return dx_value_set_string (destination, source->dv_string, source->dv_size);
+        return dx_value_set_string_arena (destination, arena,
+                                          source->dv_string, source->dv_size);
         break;
     case DISIR_VALUE_TYPE_INTEGER:
         return dx_value_set_integer (destination, source->dv_integer);
@@ -419,6 +429,14 @@ dx_value_get_float (struct disir_value *value, double *output_double)
 //! INTERNAL API
 enum disir_status
 dx_value_set_string (struct disir_value *value, const char *input, int32_t size)
+{
+    return dx_value_set_string_arena (value, NULL, input, size);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_value_set_string_arena (struct disir_value *value, struct disir_arena *arena,
+                           const char *input, int32_t size)
 {
     if (value == NULL)
     {
@@ -436,7 +454,7 @@ dx_value_set_string (struct disir_value *value, const char *input, int32_t size)
     {
         if (value->dv_size > 0)
         {
-            free (value->dv_string);
+            dx_arena_free (arena, value->dv_string);
         }
         value->dv_size = 0;
         value->dv_string = NULL;
@@ -448,12 +466,12 @@ dx_value_set_string (struct disir_value *value, const char *input, int32_t size)
         // Just free the existing memory. We allocate a larger one below
         if (value->dv_size - 1 < size)
         {
-            free (value->dv_string);
+            dx_arena_free (arena, value->dv_string);
             value->dv_string = NULL;
         }
 
         // Size of requested string + 1 for NULL terminator
-        value->dv_string = calloc (1, size + 1);
+        value->dv_string = dx_arena_alloc (arena, size + 1);
         if (value->dv_string == NULL)
         {
             log_error ("failed to allocate sufficient memory for value string (%d)",
@@ -1,6 +1,9 @@
 // External public includes
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 // Public disir interface
 #include <disir/disir.h>
@@ -16,7 +19,125 @@
 #include "log.h"
 #include "element_storage.h"
 #include "restriction.h"
+#include "collection.h"
+#include "stats.h"
 
+//! Upper bound on the number of threads validating a single config.
+#define VALIDATE_MAX_THREADS 64
+
+//! Number of top-level sections a config must hold before they are split between threads.
+#define VALIDATE_PARALLEL_MIN_SECTIONS 2
+
+//! Number of threads validating the top-level sections of a config, as set by
+//! disir_validate_threads_set. Zero resolves to the number of online processors.
+//! Negative while unset. Shared by every instance in the process.
+static int validate_threads = -1;
+
+//! Number of threads from the validate_threads keyval of the last libdisir config
+//! that set it. Only used while validate_threads is unset. Negative while unset.
+static int validate_threads_configured = -1;
+
+//! Top-level elements of a config, processed by a pool of threads.
+//! Each thread claims the next unprocessed element until none remain.
+struct validate_pool
+{
+    //! Elements in document order. Referenced by the collection they were retrieved from.
+    struct disir_context        **vp_elements;
+    size_t                      vp_count;
+
+    //! Index of the next element no thread has claimed.
+    size_t                      vp_next;
+
+    //! Invoked once for every element, by the thread claiming it.
+    void                        (*vp_task) (struct validate_pool *pool, size_t index);
+
+    //! Outcome of vp_task for each element.
+    enum disir_status           *vp_results;
+
+    //! Invalid contexts found below each element. Only allocated when collected.
+    struct disir_collection     **vp_collections;
+};
+
+
+//! Context whose children are checked by validate_inclusive_restrictions.
+struct validate_inclusive
+{
+    struct disir_context        *vi_context;
+    struct disir_version        *vi_target_version;
+    enum disir_status           vi_invalid;
+};
+
+//! STATIC API
+//! Check the number of config elements named as the mold element against its restrictions.
+static enum disir_status
+validate_inclusive_element (struct disir_context *element, void *userdata)
+{
+    enum disir_status status;
+    struct validate_inclusive *inclusive;
+    struct disir_context *context;
+    const char *name;
+    int32_t size;
+    int max;
+    int min;
+
+    inclusive = userdata;
+    context = inclusive->vi_context;
+
+    min = max = 0;
+    name = NULL;
+
+    // Query how many elements in config there are of element.name
+    dc_get_name (element, &name, NULL);
+    status = dx_context_element_count (context, name, &size);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    // find maximum/minimum number required.
+    dx_restriction_entries_value (element, DISIR_RESTRICTION_INC_ENTRY_MIN,
+            inclusive->vi_target_version, &min);
+    dx_restriction_entries_value (element, DISIR_RESTRICTION_INC_ENTRY_MAX,
+            inclusive->vi_target_version, &max);
+
+
+    // Minimum restriction not fufilled.
+    if (size < min)
+    {
+        context->CONTEXT_STATE_INVALID = 1;
+        // TODO: Add complete resolved name
+        dx_log_context (context,
+                       "%s did not fulfill minimum required entities (minimum: %d, actual: %d)",
+                       name, min, size);
+
+        log_debug (2, "violated minimum restriction (count %d vx min %d)", size, min);
+        inclusive->vi_invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
+    }
+
+    // Maximum restriction not fufilled
+    if (max == -1 && size > 0)
+    {
+        context->CONTEXT_STATE_INVALID = 1;
+        char buffer[50];
+        dx_log_context (context,
+                        "%s is not a valid element for version %s",
+                        name, dc_version_string(buffer, 50,
+                                                &(context)->cx_config->cf_version));
+        inclusive->vi_invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
+    }
+    if (size > max && max > 0)
+    {
+        context->CONTEXT_STATE_INVALID = 1;
+        // TODO: Add complete resolved name
+        dx_log_context (context,
+                       "%s exceeded maximum allowed entities (maximum: %d, actual: %d)",
+                       name, max, size);
+        log_debug (2, "violated maximum restriction (count %d vx max %d)", size, max);
+        inclusive->vi_invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
+    }
+
+    return DISIR_STATUS_OK;
+}
 
 //! STATIC API
 //!
@@ -31,23 +152,9 @@
 static enum disir_status
 validate_inclusive_restrictions (struct disir_context *context)
 {
-    enum disir_status status ;
-    enum disir_status invalid;
-    struct disir_collection *mold_collection;
-    struct disir_collection *config_elements;
-    const char *name;
-    struct disir_context *element;
-    struct disir_version *target_version = NULL;
-    int max;
-    int min;
-    int size;
-
-    min = max = 0;
-
-    invalid = DISIR_STATUS_OK;
-    element = NULL;
-    mold_collection = NULL;
-    name = NULL;
+    enum disir_status status;
+    struct disir_context *mold_context;
+    struct validate_inclusive inclusive;
 
     if (dc_context_type(context->cx_root_context) != DISIR_CONTEXT_CONFIG)
     {
@@ -60,108 +167,31 @@ validate_inclusive_restrictions (struct disir_context *context)
     switch (dc_context_type (context))
     {
     case DISIR_CONTEXT_CONFIG:
-        status = dc_get_elements (context->cx_config->cf_mold->mo_context, &mold_collection);
+        mold_context = context->cx_config->cf_mold->mo_context;
         break;
     case DISIR_CONTEXT_SECTION:
-        status = dc_get_elements (context->cx_section->se_mold_equiv, &mold_collection);
+        mold_context = context->cx_section->se_mold_equiv;
         break;
     default:
         log_fatal ("Invoked internal validate with incorrect context %s.",
                    dc_context_type_string (context));
-        status = DISIR_STATUS_INTERNAL_ERROR;
-    }
-    if (status != DISIR_STATUS_OK)
-    {
-        log_error ("cannot get mold equivalent entries for %s.", dc_context_type_string (context));
-        return status;
+        return DISIR_STATUS_INTERNAL_ERROR;
     }
 
+    inclusive.vi_context = context;
     // We only validate inclusive restrictions for CONFIG toplevel contexts.
-    target_version = &context->cx_root_context->cx_config->cf_version;
-
-    do
-    {
-        if (element)
-        {
-            dc_putcontext (&element);
-        }
-
-        status = dc_collection_next (mold_collection, &element);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            status = DISIR_STATUS_OK;
-            break;
-        }
-
-        if (status != DISIR_STATUS_OK)
-            break;
+    inclusive.vi_target_version = &context->cx_root_context->cx_config->cf_version;
+    inclusive.vi_invalid = DISIR_STATUS_OK;
 
-        // Query how many elements in config there are of element.name
-        dc_get_name (element, &name, NULL);
-        status = dc_find_elements (context, name, &config_elements);
-        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
-        {
-            break;
-        }
-        if (status == DISIR_STATUS_OK)
-        {
-            size = dc_collection_size (config_elements);
-            dc_collection_finished (&config_elements);
-        }
-        else
-        {
-            // No entries
-            size = 0;
-        }
-
-        // find maximum/minimum number required.
-        dx_restriction_entries_value (element, DISIR_RESTRICTION_INC_ENTRY_MIN,
-                target_version, &min);
-        dx_restriction_entries_value (element, DISIR_RESTRICTION_INC_ENTRY_MAX,
-                target_version, &max);
-
-
-        // Minimum restriction not fufilled.
-        if (size < min)
-        {
-            context->CONTEXT_STATE_INVALID = 1;
-            // TODO: Add complete resolved name
-            dx_log_context (context,
-                           "%s did not fulfill minimum required entities (minimum: %d, actual: %d)",
-                           name, min, size);
-
-            log_debug (2, "violated minimum restriction (count %d vx min %d)", size, min);
-            invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
-        }
-
-        // Maximum restriction not fufilled
-        if (max == -1 && size > 0)
-        {
-            context->CONTEXT_STATE_INVALID = 1;
-            char buffer[50];
-            dx_log_context (context,
-                            "%s is not a valid element for version %s",
-                            name, dc_version_string(buffer, 50,
-                                                    &(context)->cx_config->cf_version));
-            invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
-        }
-        if (size > max && max > 0)
-        {
-            context->CONTEXT_STATE_INVALID = 1;
-            // TODO: Add complete resolved name
-            dx_log_context (context,
-                           "%s exceeded maximum allowed entities (maximum: %d, actual: %d)",
-                           name, max, size);
-            log_debug (2, "violated maximum restriction (count %d vx max %d)", size, max);
-            invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
-        }
-    } while (1);
-    if (mold_collection)
+    status = dc_foreach_element (mold_context, NULL, validate_inclusive_element, &inclusive);
+    if (status != DISIR_STATUS_OK)
     {
-        dc_collection_finished (&mold_collection);
+        log_error ("cannot check mold equivalent entries for %s.",
+                   dc_context_type_string (context));
+        return status;
     }
 
-    return (status == DISIR_STATUS_OK ? invalid : status);
+    return inclusive.vi_invalid;
 }
 
 //! STATIC API
@@ -227,11 +257,9 @@ static enum disir_status
 validate_finalized_parent_constructing_child_violating_max_restriction (struct disir_context *child)
 {
     int max;
-    int current_entries_count;
-    struct disir_collection *collection;
+    int32_t current_entries_count;
     char *name;
 
-    collection = NULL;
     max = 0;
     current_entries_count  = 0;
 
@@ -263,12 +291,7 @@ validate_finalized_parent_constructing_child_violating_max_restriction (struct d
 
     // Query all entries in parent with our name. Check if it is exhausted.
     dx_restriction_entries_value (child, DISIR_RESTRICTION_INC_ENTRY_MAX, NULL, &max);
-    dc_find_elements (child->cx_parent_context, name, &collection);
-    if (collection)
-    {
-        current_entries_count = dc_collection_size (collection);
-        dc_collection_finished (&collection);
-    }
+    dx_context_element_count (child->cx_parent_context, name, &current_entries_count);
 
     if (max != 0 && max <= current_entries_count)
     {
@@ -282,81 +305,296 @@ validate_finalized_parent_constructing_child_violating_max_restriction (struct d
 
 //! STATIC API
 //!
-//! \return DISIR_STATUS_ELEMENTS_INVALID if any of context' children are not valid.
-//! \return DISIR_STATUS_OK when all children are valid.
+//! Whether the outcome of validate_context_validity on context may be reused until
+//! context, or any context below it, is modified. Only contexts whose root is CONFIG
+//! are cached. A constructing context whose parent is finalized is checked against
+//! the number of its siblings, which does not mark it as changed - it is never cached.
 //!
-static enum disir_status
-validate_children (struct disir_context *context)
+//! \return 1 if the outcome may be cached.
+//! \return 0 if context must be validated every time.
+//!
+static int
+validate_cacheable (struct disir_context *context)
 {
-    enum disir_status status;
-    enum disir_status status_validate;
-    enum disir_status invalid;
-    struct disir_context *element;
-    struct disir_collection *collection;
+    if (context->cx_root_context == NULL
+        || dc_context_type (context->cx_root_context) != DISIR_CONTEXT_CONFIG)
+    {
+        return 0;
+    }
 
-    invalid = DISIR_STATUS_OK;
-    status_validate = DISIR_STATUS_OK;
-    element = NULL;
-    collection = NULL;
+    if (dc_context_type (context) != DISIR_CONTEXT_CONFIG
+        && dc_context_type (context) != DISIR_CONTEXT_SECTION
+        && dc_context_type (context) != DISIR_CONTEXT_KEYVAL)
+    {
+        return 0;
+    }
 
-    log_debug_context(2, context, "validating children");
+    if (context->CONTEXT_STATE_FINALIZED == 0
+        && context->cx_parent_context
+        && context->cx_parent_context->CONTEXT_STATE_FINALIZED)
+    {
+        return 0;
+    }
 
-    // Invoke recursively on children
-    status = dc_get_elements (context, &collection);
-    if (status != DISIR_STATUS_OK)
+    return 1;
+}
+
+//! STATIC API
+//!
+//! Whether the cached outcome of a cacheable context is still current.
+//!
+static int
+validate_unchanged (struct disir_context *context)
+{
+    struct disir_config *config;
+
+    config = context->cx_root_context->cx_config;
+    return (context->cx_validated != 0
+            && context->cx_validated >= context->cx_changed
+            && context->cx_validated >= config->cf_version_generation);
+}
+
+//! STATIC API
+//!
+//! Whether status from validating a child is an operational error, rather than
+//! a verdict on the validity of the child. Validation of the remaining children is abandoned.
+//!
+static int
+validate_status_fatal (enum disir_status status)
+{
+    return (status != DISIR_STATUS_OK
+            && status != DISIR_STATUS_CONFLICTING_SEMVER
+            && status != DISIR_STATUS_ELEMENTS_INVALID
+            && status != DISIR_STATUS_INVALID_CONTEXT
+            && status != DISIR_STATUS_RESTRICTION_VIOLATED
+            && status != DISIR_STATUS_WRONG_VALUE_TYPE
+            && status != DISIR_STATUS_MOLD_MISSING
+            && status != DISIR_STATUS_DEFAULT_MISSING);
+}
+
+//! STATIC API
+static void *
+validate_pool_worker (void *arg)
+{
+    struct validate_pool *pool;
+    size_t index;
+
+    pool = arg;
+    while (1)
     {
-        log_debug (2, "validating children failed to retrieve elements with status: %s",
-                      disir_status_string (status));
-        return status;
+        index = __atomic_fetch_add (&pool->vp_next, 1, __ATOMIC_RELAXED);
+        if (index >= pool->vp_count)
+            break;
+
+        pool->vp_task (pool, index);
     }
 
-    do
+    return NULL;
+}
+
+//! STATIC API
+//!
+//! Invoke the pool task on every element, spread over threads threads - the caller included.
+//! If a thread cannot be started, the threads already running process its share.
+//!
+static void
+validate_pool_run (struct validate_pool *pool, int threads)
+{
+    pthread_t workers[VALIDATE_MAX_THREADS];
+    int started;
+    int i;
+
+    started = 0;
+    for (i = 1; i < threads && i < VALIDATE_MAX_THREADS; i++)
     {
-        // Put back the element resource from last iteration
-        if (element)
+        if (pthread_create (&workers[started], NULL, validate_pool_worker, pool) != 0)
         {
-            status = dc_putcontext (&element);
-            if (status != DISIR_STATUS_OK)
-                break;
+            log_warn ("failed to start validation thread - continuing with %d", started + 1);
+            break;
         }
+        started++;
+    }
+
+    validate_pool_worker (pool);
 
-        // XXX: What if the last context was finalized? We should still validate, shant we?
-        // Break out if a serious error occurred in last iteration
-        if (status_validate != DISIR_STATUS_OK
-            && status_validate != DISIR_STATUS_CONFLICTING_SEMVER
-            && status_validate != DISIR_STATUS_ELEMENTS_INVALID
-            && status_validate != DISIR_STATUS_INVALID_CONTEXT
-            && status_validate != DISIR_STATUS_RESTRICTION_VIOLATED
-            && status_validate != DISIR_STATUS_WRONG_VALUE_TYPE
-            && status_validate != DISIR_STATUS_MOLD_MISSING
-            && status_validate != DISIR_STATUS_DEFAULT_MISSING)
+    for (i = 0; i < started; i++)
+    {
+        pthread_join (workers[i], NULL);
+    }
+}
+
+//! STATIC API
+//!
+//! Number of threads to split the elements of collection between. Only the top-level
+//! SECTION elements are considered worth a thread of their own, and only if skip_unchanged
+//! is zero or they must be validated anew.
+//!
+//! \return 1 if the elements shall be processed by the calling thread alone.
+//!
+static int
+validate_pool_threads (struct disir_collection *collection, int skip_unchanged)
+{
+    struct disir_context *element;
+    int threads;
+    int sections;
+    int32_t i;
+
+    threads = disir_validate_threads ();
+    if (threads == 0)
+    {
+        threads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+    }
+    if (threads <= 1)
+        return 1;
+
+    sections = 0;
+    for (i = 0; i < collection->cc_numentries; i++)
+    {
+        element = collection->cc_collection[i];
+        if (dc_context_type (element) != DISIR_CONTEXT_SECTION)
+            continue;
+        if (skip_unchanged && validate_cacheable (element) && validate_unchanged (element))
+            continue;
+
+        sections++;
+    }
+
+    if (sections < VALIDATE_PARALLEL_MIN_SECTIONS)
+        return 1;
+
+    return (threads < sections ? threads : sections);
+}
+
+//! STATIC API
+static void
+validate_children_task (struct validate_pool *pool, size_t index)
+{
+    pool->vp_results[index] = dx_validate_context (pool->vp_elements[index]);
+}
+
+//! STATIC API
+//!
+//! Validate the elements of collection, split between threads.
+//! The outcome is folded in document order, the same way validate_children does.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if allocation fails.
+//! \return DISIR_STATUS_ELEMENTS_INVALID if any of the elements are not valid.
+//! \return DISIR_STATUS_OK when all elements are valid.
+//!
+static enum disir_status
+validate_children_parallel (struct disir_collection *collection, int threads)
+{
+    enum disir_status invalid;
+    struct validate_pool pool;
+    size_t i;
+
+    memset (&pool, 0, sizeof (pool));
+    pool.vp_elements = collection->cc_collection;
+    pool.vp_count = collection->cc_numentries;
+    pool.vp_task = validate_children_task;
+    pool.vp_results = calloc (pool.vp_count, sizeof (enum disir_status));
+    if (pool.vp_results == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    log_debug (2, "validating %zu children with %d threads", pool.vp_count, threads);
+    validate_pool_run (&pool, threads);
+
+    invalid = DISIR_STATUS_OK;
+    for (i = 0; i < pool.vp_count; i++)
+    {
+        // Serial validation stops at the first operational error.
+        if (validate_status_fatal (pool.vp_results[i]))
         {
-            status = status_validate;
-            // TODO: Verify that this scenario occurs and find a reasonable way to deal with it.
+            invalid = pool.vp_results[i];
             log_fatal ("XXX: VALIDATE CHILDREN RETURNED NON-OK (NON-INVALID) status: %s",
-                       disir_status_string (status));
+                       disir_status_string (invalid));
             break;
         }
-
-        status = dc_collection_next (collection, &element);
-        if (status == DISIR_STATUS_EXHAUSTED)
+        if (pool.vp_results[i] != DISIR_STATUS_OK)
         {
-            status = DISIR_STATUS_OK;
-            break;
+            invalid = DISIR_STATUS_ELEMENTS_INVALID;
         }
-        else if (status != DISIR_STATUS_OK)
+    }
+
+    free (pool.vp_results);
+    return invalid;
+}
+
+//! STATIC API
+//!
+//! Validate a single child of validate_children, folding the outcome into invalid.
+//!
+//! \return the status of validating element, if it is an operational error.
+//! \return DISIR_STATUS_OK otherwise.
+//!
+static enum disir_status
+validate_children_element (struct disir_context *element, void *userdata)
+{
+    enum disir_status status_validate;
+    enum disir_status *invalid;
+
+    invalid = userdata;
+
+    // XXX: What if the last context was finalized? We should still validate, shant we?
+    status_validate = dx_validate_context (element);
+
+    // Break out if a serious error occurred
+    if (validate_status_fatal (status_validate))
+    {
+        // TODO: Verify that this scenario occurs and find a reasonable way to deal with it.
+        log_fatal ("XXX: VALIDATE CHILDREN RETURNED NON-OK (NON-INVALID) status: %s",
+                   disir_status_string (status_validate));
+        return status_validate;
+    }
+
+    // Only update invalid with either DISIR_STATUS_OK or the previous value of invalid.
+    *invalid = (status_validate != DISIR_STATUS_OK ? DISIR_STATUS_ELEMENTS_INVALID : *invalid);
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! \return DISIR_STATUS_ELEMENTS_INVALID if any of context' children are not valid.
+//! \return DISIR_STATUS_OK when all children are valid.
+//!
+static enum disir_status
+validate_children (struct disir_context *context)
+{
+    enum disir_status status;
+    enum disir_status invalid;
+    struct disir_collection *collection;
+    int threads;
+
+    invalid = DISIR_STATUS_OK;
+
+    log_debug_context(2, context, "validating children");
+
+    // The top-level sections of a config are independent subtrees.
+    // They are collected to be split between threads.
+    if (dc_context_type (context) == DISIR_CONTEXT_CONFIG)
+    {
+        status = dc_get_elements (context, &collection);
+        if (status != DISIR_STATUS_OK)
         {
-            break;
+            log_debug (2, "validating children failed to retrieve elements with status: %s",
+                          disir_status_string (status));
+            return status;
         }
 
-        status_validate = dx_validate_context (element);
-        // Only update invalid with either DISIR_STATUS_OK or the previous value of invalid.
-        invalid = (status_validate != DISIR_STATUS_OK ? DISIR_STATUS_ELEMENTS_INVALID : invalid);
-    } while (1);
+        threads = validate_pool_threads (collection, 1);
+        if (threads > 1)
+            status = validate_children_parallel (collection, threads);
+        dc_collection_finished (&collection);
+        if (threads > 1)
+            return status;
+    }
 
-    if (collection)
+    // Invoke recursively on children
+    status = dc_foreach_element (context, NULL, validate_children_element, &invalid);
+    if (status != DISIR_STATUS_OK && validate_status_fatal (status) == 0)
     {
-        dc_collection_finished (&collection);
+        log_debug (2, "validating children failed to visit elements with status: %s",
+                      disir_status_string (status));
     }
 
     return (status == DISIR_STATUS_OK ? invalid : status);
@@ -774,9 +1012,18 @@ enum disir_status
 dx_validate_context (struct disir_context *context)
 {
     enum disir_status status;
+    struct disir_config *config;
+    struct dx_stats_span span;
+    int cacheable;
 
     TRACE_ENTER ("context %s", dc_context_type_string(context));
 
+    // Only whole configs and molds are counted - not every context validated below them.
+    if (context == context->cx_root_context)
+    {
+        dx_stats_begin (dx_stats_process (), DISIR_STATS_VALIDATE, NULL, &span);
+    }
+
     if (context->CONTEXT_STATE_FATAL)
     {
         log_debug_context (1, context, "in fatal state - not valid");
@@ -795,9 +1042,29 @@ dx_validate_context (struct disir_context *context)
     // The below checks will return it to invalid state if checks fail.
     context->CONTEXT_STATE_INVALID = 0;
 
-    // XXX: This validity check may return any number of error conditions.
-    // This is used to determine if finalization of calling context may be done.
-    status = validate_context_validity (context);
+    // Unserializers finalize bottom-up, and every finalize validates the whole subtree.
+    // Reuse the outcome for contexts that have not changed since they were last validated,
+    // so that each context is only validated once.
+    cacheable = validate_cacheable (context);
+    config = (cacheable ? context->cx_root_context->cx_config : NULL);
+    if (cacheable && validate_unchanged (context))
+    {
+        log_debug_context (4, context, "unchanged since last validated: %s",
+                           disir_status_string (context->cx_validity));
+        status = context->cx_validity;
+    }
+    else
+    {
+        // XXX: This validity check may return any number of error conditions.
+        // This is used to determine if finalization of calling context may be done.
+        status = validate_context_validity (context);
+
+        if (cacheable)
+        {
+            context->cx_validity = status;
+            context->cx_validated = config->cf_generation;
+        }
+    }
 
     // If our parent context is finalized, and we get any sort of error, we mark invalid state
     // and return the original status back - we do not allow this context to be finalized
@@ -854,10 +1121,171 @@ dx_validate_context (struct disir_context *context)
     }
 
 out:
+    if (context == context->cx_root_context)
+    {
+        dx_stats_end (&span, status);
+    }
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
 
+//! STATIC API
+//!
+//! Push element to collection if it is invalid, followed by the invalid contexts below it.
+//!
+//! \return DISIR_STATUS_INVALID_CONTEXT if element, or any context below it, is invalid.
+//! \return DISIR_STATUS_OK otherwise.
+//!
+static enum disir_status
+invalid_elements_element (struct disir_context *element, struct disir_collection *collection)
+{
+    enum disir_status status;
+    enum disir_status invalid;
+
+    invalid = DISIR_STATUS_OK;
+
+    status = dc_context_valid (element);
+    if (status == DISIR_STATUS_INVALID_CONTEXT)
+    {
+        if (collection)
+        {
+            dc_collection_push_context (collection, element);
+        }
+        invalid = status;
+    }
+
+    // Recurse the sections
+    if (dc_context_type (element) == DISIR_CONTEXT_SECTION)
+    {
+        status = dx_invalid_elements (element, collection);
+        if (status == DISIR_STATUS_INVALID_CONTEXT)
+        {
+            invalid = status;
+        }
+    }
+
+    return invalid;
+}
+
+//! STATIC API
+static void
+invalid_elements_task (struct validate_pool *pool, size_t index)
+{
+    struct disir_collection *collection;
+
+    collection = (pool->vp_collections ? pool->vp_collections[index] : NULL);
+    pool->vp_results[index] = invalid_elements_element (pool->vp_elements[index], collection);
+}
+
+//! STATIC API
+//!
+//! Collect the invalid contexts below each element of elements, split between threads.
+//! Each element is collected into a collection of its own, appended to collection
+//! in document order once every thread is done.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if allocation fails.
+//! \return DISIR_STATUS_INVALID_CONTEXT if any of the contexts are invalid.
+//! \return DISIR_STATUS_OK otherwise.
+//!
+static enum disir_status
+invalid_elements_parallel (struct disir_collection *elements, struct disir_collection *collection,
+                           int threads)
+{
+    enum disir_status status;
+    enum disir_status invalid;
+    struct validate_pool pool;
+    struct disir_context *context;
+    size_t i;
+
+    status = DISIR_STATUS_OK;
+    invalid = DISIR_STATUS_OK;
+
+    memset (&pool, 0, sizeof (pool));
+    pool.vp_elements = elements->cc_collection;
+    pool.vp_count = elements->cc_numentries;
+    pool.vp_task = invalid_elements_task;
+    pool.vp_results = calloc (pool.vp_count, sizeof (enum disir_status));
+    if (pool.vp_results == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+    if (collection)
+    {
+        pool.vp_collections = calloc (pool.vp_count, sizeof (struct disir_collection *));
+        if (pool.vp_collections == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto out;
+        }
+        for (i = 0; i < pool.vp_count; i++)
+        {
+            pool.vp_collections[i] = dc_collection_create ();
+            if (pool.vp_collections[i] == NULL)
+            {
+                status = DISIR_STATUS_NO_MEMORY;
+                goto out;
+            }
+        }
+    }
+
+    validate_pool_run (&pool, threads);
+
+    for (i = 0; i < pool.vp_count; i++)
+    {
+        if (pool.vp_results[i] == DISIR_STATUS_INVALID_CONTEXT)
+        {
+            invalid = DISIR_STATUS_INVALID_CONTEXT;
+        }
+        if (collection == NULL)
+            continue;
+
+        while (dc_collection_next (pool.vp_collections[i], &context) == DISIR_STATUS_OK)
+        {
+            dc_collection_push_context (collection, context);
+            dc_putcontext (&context);
+        }
+    }
+
+    // FALL-THROUGH
+out:
+    if (pool.vp_collections)
+    {
+        for (i = 0; i < pool.vp_count; i++)
+        {
+            if (pool.vp_collections[i])
+                dc_collection_finished (&pool.vp_collections[i]);
+        }
+        free (pool.vp_collections);
+    }
+    free (pool.vp_results);
+
+    return (status == DISIR_STATUS_OK ? invalid : status);
+}
+
+//! Invalid contexts collected by dx_invalid_elements.
+struct invalid_elements
+{
+    struct disir_collection     *iv_collection;
+    enum disir_status           iv_invalid;
+};
+
+//! STATIC API
+static enum disir_status
+invalid_elements_visit (struct disir_context *element, void *userdata)
+{
+    struct invalid_elements *visit;
+
+    visit = userdata;
+
+    if (invalid_elements_element (element, visit->iv_collection) == DISIR_STATUS_INVALID_CONTEXT)
+    {
+        visit->iv_invalid = DISIR_STATUS_INVALID_CONTEXT;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 enum disir_status
 dx_invalid_elements (struct disir_context *context, struct disir_collection *collection)
@@ -865,7 +1293,8 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
     enum disir_status status;
     enum disir_status invalid;
     struct disir_collection *col;
-    struct disir_context *element;
+    struct invalid_elements visit;
+    int threads;
 
     invalid = (context->CONTEXT_STATE_INVALID == 1 ? DISIR_STATUS_INVALID_CONTEXT
                                                    : DISIR_STATUS_OK);
@@ -879,54 +1308,79 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
         }
     }
 
-    status = dc_get_elements (context, &col);
-    if (status != DISIR_STATUS_OK)
-    {
-        log_error ("Failed to retrieve elements from context: %s",
-                    disir_status_string (status));
-    }
-
-    while (status == DISIR_STATUS_OK)
+    // The top-level sections of a config are independent subtrees.
+    if (dc_context_type (context) == DISIR_CONTEXT_CONFIG)
     {
-        status = dc_collection_next (col, &element);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            status = DISIR_STATUS_OK;
-            break;
-        }
+        status = dc_get_elements (context, &col);
         if (status != DISIR_STATUS_OK)
         {
-            log_error ("Failed to retrieve element from collection: %s",
-                       disir_status_string (status));
-            break;
-        }
-
-        status = dc_context_valid (element);
-        if (status == DISIR_STATUS_INVALID_CONTEXT)
-        {
-            if (collection)
-            {
-                dc_collection_push_context (collection, element);
-            }
-            invalid = status;
+            log_error ("Failed to retrieve elements from context: %s",
+                        disir_status_string (status));
+            return status;
         }
 
-        // Recurse the sections
-        if (dc_context_type (element) == DISIR_CONTEXT_SECTION)
+        threads = validate_pool_threads (col, 0);
+        if (threads > 1)
         {
-            status = dx_invalid_elements (element, collection);
+            status = invalid_elements_parallel (col, collection, threads);
+            dc_collection_finished (&col);
             if (status == DISIR_STATUS_INVALID_CONTEXT)
             {
                 invalid = status;
+                status = DISIR_STATUS_OK;
             }
+            return (status == DISIR_STATUS_OK ? invalid : status);
         }
+        dc_collection_finished (&col);
+    }
 
-        dc_putcontext (&element);
-        status = DISIR_STATUS_OK;
+    visit.iv_collection = collection;
+    visit.iv_invalid = invalid;
+    status = dc_foreach_element (context, NULL, invalid_elements_visit, &visit);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_error ("Failed to visit elements of context: %s",
+                    disir_status_string (status));
     }
 
-    dc_collection_finished (&col);
+    return (status == DISIR_STATUS_OK ? visit.iv_invalid : status);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_validate_threads_set (int threads)
+{
+    if (threads < 0)
+    {
+        log_debug (0, "invoked with negative number of threads: %d", threads);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
 
-    return (status == DISIR_STATUS_OK ? invalid : status);
+    __atomic_store_n (&validate_threads, threads, __ATOMIC_RELAXED);
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+int
+disir_validate_threads (void)
+{
+    int threads;
+
+    threads = __atomic_load_n (&validate_threads, __ATOMIC_RELAXED);
+    if (threads < 0)
+    {
+        threads = __atomic_load_n (&validate_threads_configured, __ATOMIC_RELAXED);
+    }
+
+    return (threads < 0 ? 1 : threads);
 }
 
+//! INTERNAL API
+void
+dx_validate_threads_configured_set (int threads)
+{
+    if (threads < 0)
+        return;
+
+    __atomic_store_n (&validate_threads_configured, threads, __ATOMIC_RELAXED);
+}
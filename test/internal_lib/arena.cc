@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+// PRIVATE API
+extern "C" {
+#include "arena.h"
+#include "config.h"
+}
+
+#include "test_helper.h"
+
+
+class ArenaTest : public testing::Test
+{
+    void SetUp()
+    {
+        arena = dx_arena_create ();
+        ASSERT_TRUE (arena != NULL);
+    }
+
+    void TearDown()
+    {
+        dx_arena_decref (&arena);
+    }
+
+public:
+    struct disir_arena *arena;
+    struct disir_arena_stats stats;
+};
+
+TEST_F (ArenaTest, null_arena_allocates_on_heap)
+{
+    char *ptr;
+
+    ptr = (char *) dx_arena_alloc (NULL, 32);
+    ASSERT_TRUE (ptr != NULL);
+    EXPECT_EQ (0, ptr[31]);
+
+    dx_arena_free (NULL, ptr);
+
+    dx_arena_stats (NULL, &stats);
+    EXPECT_EQ (0, stats.as_allocations);
+}
+
+TEST_F (ArenaTest, allocations_are_zeroed_aligned_and_distinct)
+{
+    unsigned char *first;
+    unsigned char *second;
+    int i;
+
+    first = (unsigned char *) dx_arena_alloc (arena, 3);
+    second = (unsigned char *) dx_arena_alloc (arena, 40);
+    ASSERT_TRUE (first != NULL);
+    ASSERT_TRUE (second != NULL);
+
+    EXPECT_EQ (0, (uintptr_t) first % 16);
+    EXPECT_EQ (0, (uintptr_t) second % 16);
+    EXPECT_GE (second, first + 3);
+
+    for (i = 0; i < 40; i++)
+    {
+        EXPECT_EQ (0, second[i]);
+    }
+
+    dx_arena_stats (arena, &stats);
+    EXPECT_EQ (2, stats.as_allocations);
+    EXPECT_EQ (1, stats.as_chunks);
+}
+
+TEST_F (ArenaTest, grows_in_chunks)
+{
+    int i;
+
+    for (i = 0; i < 10000; i++)
+    {
+        ASSERT_TRUE (dx_arena_alloc (arena, 24) != NULL);
+    }
+
+    dx_arena_stats (arena, &stats);
+    EXPECT_EQ (10000, stats.as_allocations);
+    EXPECT_LT (stats.as_chunks, 10);
+    EXPECT_GE (stats.as_bytes_reserved, stats.as_bytes_used);
+}
+
+TEST_F (ArenaTest, oversized_allocation_gets_own_chunk)
+{
+    unsigned char *small;
+    unsigned char *large;
+    unsigned char *next;
+
+    small = (unsigned char *) dx_arena_alloc (arena, 16);
+    large = (unsigned char *) dx_arena_alloc (arena, 64 * 1024);
+    next = (unsigned char *) dx_arena_alloc (arena, 16);
+    ASSERT_TRUE (small != NULL && large != NULL && next != NULL);
+
+    // We keep bumping from the regular chunk, past the header of next.
+    EXPECT_EQ (small + 32, next);
+
+    dx_arena_stats (arena, &stats);
+    EXPECT_EQ (2, stats.as_chunks);
+}
+
+TEST_F (ArenaTest, freed_blocks_are_reused)
+{
+    void *small;
+    void *large;
+    struct disir_arena_stats before;
+
+    small = dx_arena_alloc (arena, 24);
+    large = dx_arena_alloc (arena, 64 * 1024);
+    ASSERT_TRUE (small != NULL && large != NULL);
+    memset (small, 0xff, 24);
+
+    dx_arena_stats (arena, &before);
+    dx_arena_free (arena, small);
+    dx_arena_free (arena, large);
+
+    // Blocks of the same size class are handed out again, cleared.
+    EXPECT_EQ (small, dx_arena_alloc (arena, 32));
+    EXPECT_EQ (0, ((unsigned char *) small)[23]);
+    EXPECT_EQ (large, dx_arena_alloc (arena, 48 * 1024));
+
+    dx_arena_stats (arena, &stats);
+    EXPECT_EQ (before.as_chunks, stats.as_chunks);
+    EXPECT_EQ (before.as_bytes_reserved, stats.as_bytes_reserved);
+}
+
+TEST_F (ArenaTest, decref_sets_pointer_null)
+{
+    struct disir_arena *reference;
+
+    reference = arena;
+    dx_arena_incref (reference);
+    dx_arena_decref (&reference);
+    EXPECT_EQ (NULL, reference);
+
+    // Still alive through the fixture reference
+    EXPECT_TRUE (dx_arena_alloc (arena, 8) != NULL);
+}
+
+class ArenaConfigTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_keyval_string (context_mold, "keyval", "value", "doc", NULL, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        if (config)
+            disir_config_finished (&config);
+        if (mold)
+            disir_mold_finished (&mold);
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    enum disir_status status;
+    struct disir_context *context_mold = NULL;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+};
+
+#ifdef DISIR_CONTEXT_ARENA
+TEST_F (ArenaConfigTest, elements_are_allocated_from_config_arena)
+{
+    struct disir_arena_stats stats;
+
+    ASSERT_TRUE (config->cf_arena != NULL);
+
+    dx_arena_stats (config->cf_arena, &stats);
+    // keyval, its name, its value and the element storage
+    EXPECT_GE (stats.as_allocations, 4);
+}
+#endif
+
+#ifdef DISIR_CONTEXT_ARENA
+TEST_F (ArenaConfigTest, element_churn_does_not_grow_arena)
+{
+    struct disir_context *context_config;
+    struct disir_context *keyval;
+    struct disir_arena_stats before;
+    struct disir_arena_stats stats;
+    int i;
+
+    context_config = dc_config_getcontext (config);
+
+    // Make room for the keyval added below, within its maximum entries.
+    status = dc_find_element (context_config, "keyval", 0, &keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dc_destroy (&keyval);
+
+    for (i = 0; i < 1000; i++)
+    {
+        if (i == 10)
+            dx_arena_stats (config->cf_arena, &before);
+
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (keyval, "keyval", strlen ("keyval"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_value_string (keyval, "a changed value", strlen ("a changed value"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_destroy (&keyval);
+    }
+
+    dc_putcontext (&context_config);
+
+    dx_arena_stats (config->cf_arena, &stats);
+    EXPECT_EQ (before.as_chunks, stats.as_chunks);
+    EXPECT_EQ (before.as_bytes_reserved, stats.as_bytes_reserved);
+    EXPECT_EQ (before.as_bytes_used, stats.as_bytes_used);
+}
+#endif
+
+TEST_F (ArenaConfigTest, held_element_is_destroyed_with_config)
+{
+    struct disir_context *context_config;
+    struct disir_context *keyval;
+    const char *value;
+    int32_t size;
+
+    context_config = dc_config_getcontext (config);
+    status = dc_find_element (context_config, "keyval", 0, &keyval);
+    dc_putcontext (&context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_finished (&config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // The context outlives the arena its keyval was allocated from
+    status = dc_get_value_string (keyval, &value, &size);
+    EXPECT_STATUS (DISIR_STATUS_DESTROYED_CONTEXT, status);
+
+    dc_putcontext (&keyval);
+}
@@ -41,7 +41,7 @@ protected:
         context = NULL;
         collection = NULL;
 
-        storage = dx_element_storage_create ();
+        storage = dx_element_storage_create (NULL);
         ASSERT_TRUE (storage != NULL);
     }
 
@@ -225,3 +225,179 @@ TEST_F (ElementStoragePopulatedTest, get_all_collection_shall_be_in_insert_order
     ASSERT_STATUS (DISIR_STATUS_EXHAUSTED, status);
 }
 
+TEST_F (ElementStorageEmptyTest, get_nth_invalid_argument_shall_fail)
+{
+    status = dx_element_storage_get_nth (NULL, "carfight", 0, &context);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dx_element_storage_get_nth (storage, NULL, 0, &context);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dx_element_storage_get_nth (storage, "carfight", 0, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (ElementStorageEmptyTest, get_nth_empty_storage_shall_not_exist)
+{
+    status = dx_element_storage_get_nth (storage, "carfight", 0, &context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    EXPECT_EQ (0, dx_element_storage_count (storage, "carfight"));
+}
+
+TEST_F (ElementStoragePopulatedTest, get_nth_shall_be_in_insert_order)
+{
+    struct disir_context *expected[3 * KEYVAL_NUMENTRIES];
+    unsigned int i;
+    unsigned int j;
+
+    i = 0;
+    for (auto it = list.begin(); it != list.end(); ++it)
+    {
+        expected[i++] = *it;
+    }
+
+    for (j = 0; j < 3; j++)
+    {
+        for (i = 0; i < KEYVAL_NUMENTRIES; i++)
+        {
+            status = dx_element_storage_get_nth (storage, keyval_names[i], j, &context);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            ASSERT_EQ (expected[j * KEYVAL_NUMENTRIES + i], context);
+        }
+    }
+}
+
+TEST_F (ElementStoragePopulatedTest, get_nth_out_of_bounds_shall_not_exist)
+{
+    status = dx_element_storage_get_nth (storage, "carfight", 3, &context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    status = dx_element_storage_get_nth (storage, "nonexistent", 0, &context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (ElementStoragePopulatedTest, count)
+{
+    EXPECT_EQ (3, dx_element_storage_count (storage, "carfight"));
+    EXPECT_EQ (0, dx_element_storage_count (storage, "nonexistent"));
+    EXPECT_EQ (-1, dx_element_storage_count (NULL, "carfight"));
+}
+
+
+TEST_F (ElementStorageEmptyTest, remove_from_small_storage_shall_keep_insert_order)
+{
+    struct disir_context *contexts[4];
+    const char *names[4] = { "a", "b", "a", "b" };
+    unsigned int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        contexts[i] = dx_context_create (DISIR_CONTEXT_KEYVAL);
+        ASSERT_TRUE (contexts[i] != NULL);
+        status = dx_element_storage_add (storage, names[i], contexts[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dx_context_decref (&contexts[i]);
+    }
+
+    status = dx_element_storage_remove (storage, "a", contexts[0]);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (3, dx_element_storage_numentries (storage));
+    EXPECT_EQ (1, dx_element_storage_count (storage, "a"));
+
+    status = dx_element_storage_get_nth (storage, "a", 0, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (contexts[2], context);
+
+    status = dx_element_storage_get_nth (storage, "b", 1, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (contexts[3], context);
+}
+
+TEST_F (ElementStorageEmptyTest, add_same_context_twice_shall_exist)
+{
+    context = dx_context_create (DISIR_CONTEXT_KEYVAL);
+    ASSERT_TRUE (context != NULL);
+
+    status = dx_element_storage_add (storage, "carfight", context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dx_element_storage_add (storage, "carfight", context);
+    EXPECT_STATUS (DISIR_STATUS_EXISTS, status);
+
+    dx_context_decref (&context);
+    EXPECT_EQ (1, dx_element_storage_numentries (storage));
+}
+
+TEST_F (ElementStorageEmptyTest, large_storage_shall_find_every_entry)
+{
+    struct disir_context *contexts[1000];
+    char name[32];
+    unsigned int i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        // Every tenth name is shared by ten entries.
+        snprintf (name, sizeof (name), "entry_%u", (i % 10 == 0 ? 0 : i));
+        contexts[i] = dx_context_create (DISIR_CONTEXT_KEYVAL);
+        ASSERT_TRUE (contexts[i] != NULL);
+        status = dx_element_storage_add (storage, name, contexts[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dx_context_decref (&contexts[i]);
+    }
+
+    EXPECT_EQ (1000, dx_element_storage_numentries (storage));
+    EXPECT_EQ (100, dx_element_storage_count (storage, "entry_0"));
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (name, sizeof (name), "entry_%u", (i % 10 == 0 ? 0 : i));
+        status = dx_element_storage_get_nth (storage, name, (i % 10 == 0 ? i / 10 : 0), &context);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        ASSERT_EQ (contexts[i], context);
+    }
+}
+
+TEST_F (ElementStoragePopulatedTest, remove_shall_keep_insert_order)
+{
+    std::list<struct disir_context *> remaining;
+    struct disir_context *removed_middle;
+    struct disir_context *removed_tail;
+    struct disir_context *c;
+
+    removed_middle = *std::next (list.begin (), KEYVAL_NUMENTRIES + 1);
+    removed_tail = list.back ();
+
+    status = dx_element_storage_remove (storage, keyval_names[1], removed_middle);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dx_element_storage_remove (storage, keyval_names[KEYVAL_NUMENTRIES - 1],
+                                        removed_tail);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (3 * KEYVAL_NUMENTRIES - 2, dx_element_storage_numentries (storage));
+    EXPECT_EQ (2, dx_element_storage_count (storage, keyval_names[1]));
+    EXPECT_EQ (2, dx_element_storage_count (storage, keyval_names[KEYVAL_NUMENTRIES - 1]));
+
+    // The third entry named keyval_names[1] is now the second.
+    status = dx_element_storage_get_nth (storage, keyval_names[1], 1, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (*std::next (list.begin (), 2 * KEYVAL_NUMENTRIES + 1), context);
+
+    for (auto it = list.begin(); it != list.end(); ++it)
+    {
+        if (*it != removed_middle && *it != removed_tail)
+            remaining.push_back (*it);
+    }
+
+    status = dx_element_storage_get_all (storage, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    for (auto it = remaining.begin(); it != remaining.end(); ++it)
+    {
+        c = *it;
+        status = dc_collection_next (collection, &context);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        ASSERT_EQ (c, context);
+    }
+    status = dc_collection_next (collection, &context);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+}
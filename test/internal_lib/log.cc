@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "test_helper.h"
+
+
+//! Exercise the log sink linked into libdisir, only through the public API.
+//! The sink is redirected to a scratch file through the log_filepath keyval.
+class LogSinkTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        struct disir_mold *mold;
+        struct disir_context *context_config;
+        struct disir_context *context;
+        struct disir_config *config;
+
+        DisirLogCurrentTestEnter ();
+
+        instance = NULL;
+        mold = NULL;
+        // The sink keeps its file open - every test needs a fresh filepath.
+        snprintf (filepath, sizeof (filepath), "/tmp/disir_log_sink_test_%d_%s.log", getpid (),
+                  ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        unlink (filepath);
+
+        status = disir_libdisir_mold (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_mold_finished (&mold);
+
+        context_config = dc_config_getcontext (config);
+        // No plugins are needed to log.
+        if (dc_find_element (context_config, "plugin", 0, &context) == DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+        }
+        // log_filepath is optional, and thus not part of the generated config.
+        status = dc_config_set_keyval_string (context_config, filepath, "log_filepath");
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_config);
+
+        status = disir_instance_create (NULL, config, &instance);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        disir_log_flush ();
+        status = disir_log_stats (&before);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+        if (instance)
+        {
+            disir_instance_destroy (&instance);
+        }
+        unlink (filepath);
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Number of lines in the log file containing needle.
+    int
+    count_lines (const char *needle)
+    {
+        std::ifstream file (filepath);
+        std::string line;
+        int count = 0;
+
+        while (std::getline (file, line))
+        {
+            if (line.find (needle) != std::string::npos)
+                count++;
+        }
+        return count;
+    }
+
+    enum disir_status status;
+    struct disir_instance *instance;
+    struct disir_log_stats before;
+    struct disir_log_stats after;
+    char filepath[256];
+};
+
+
+TEST_F (LogSinkTest, stats_invalid_argument)
+{
+    status = disir_log_stats (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (LogSinkTest, logged_lines_are_counted)
+{
+    disir_log_user (instance, "first line");
+    disir_log_user (instance, "second line");
+
+    status = disir_log_stats (&after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    // DisirLogTestBodyEnter also issued a line after the initial stats.
+    EXPECT_EQ (before.ls_written + 3, after.ls_written);
+}
+
+TEST_F (LogSinkTest, flush_writes_queued_lines)
+{
+    disir_log_user (instance, "queued line %d", 42);
+
+    disir_log_flush ();
+
+    status = disir_log_stats (&after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (before.ls_dropped, after.ls_dropped);
+    EXPECT_GT (after.ls_flushes, before.ls_flushes);
+    EXPECT_GT (after.ls_bytes, before.ls_bytes);
+    EXPECT_EQ (1, count_lines ("queued line 42"));
+}
+
+TEST_F (LogSinkTest, forked_child_logs_without_duplicating_parent_lines)
+{
+    pid_t pid;
+    int child_status;
+
+    disir_log_user (instance, "parent line before fork");
+
+    pid = fork ();
+    ASSERT_NE (-1, pid);
+    if (pid == 0)
+    {
+        // Deadlocking on an inherited lock shall fail the test, not hang it.
+        alarm (10);
+        disir_log_user (instance, "child line after fork");
+        disir_log_flush ();
+        _exit (0);
+    }
+
+    ASSERT_EQ (pid, waitpid (pid, &child_status, 0));
+    ASSERT_TRUE (WIFEXITED (child_status));
+    EXPECT_EQ (0, WEXITSTATUS (child_status));
+
+    disir_log_flush ();
+
+    EXPECT_EQ (1, count_lines ("child line after fork"));
+    EXPECT_EQ (1, count_lines ("parent line before fork"));
+}
+
+TEST_F (LogSinkTest, lines_from_exiting_threads_are_written)
+{
+    std::thread worker ([this] () {
+        disir_log_user (instance, "worker thread line");
+    });
+    worker.join ();
+
+    disir_log_flush ();
+
+    EXPECT_EQ (1, count_lines ("worker thread line"));
+}
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+// PRIVATE API
+extern "C" {
+#include "restriction.h"
+#include "restriction_table.h"
+}
+
+#include "test_helper.h"
+
+
+class RestrictionTableTest : public testing::Test
+{
+    void SetUp()
+    {
+        table = NULL;
+        version.sv_major = 1;
+        version.sv_minor = 0;
+    }
+
+    void TearDown()
+    {
+        dx_restriction_table_invalidate (&table);
+        EXPECT_EQ (NULL, table);
+
+        for (auto restriction : restrictions)
+        {
+            dx_restriction_destroy (&restriction);
+        }
+    }
+
+public:
+    struct disir_restriction *
+    add (enum disir_restriction_type type, unsigned int introduced = 1,
+         unsigned int deprecated = 0)
+    {
+        struct disir_restriction *restriction;
+
+        restriction = dx_restriction_create (NULL);
+        restriction->re_type = type;
+        restriction->re_introduced.sv_major = introduced;
+        restriction->re_deprecated.sv_major = deprecated;
+
+        // Restriction queues are only traversed forwards.
+        if (restrictions.empty () == false)
+        {
+            restrictions.back ()->next = restriction;
+            restriction->prev = restrictions.back ();
+        }
+        restrictions.push_back (restriction);
+        return restriction;
+    }
+
+    void add_range (double min, double max, unsigned int introduced = 1,
+                    unsigned int deprecated = 0)
+    {
+        struct disir_restriction *restriction;
+
+        restriction = add (DISIR_RESTRICTION_EXC_VALUE_RANGE, introduced, deprecated);
+        restriction->re_value_min = min;
+        restriction->re_value_max = max;
+    }
+
+    void add_numeric (double value, unsigned int introduced = 1, unsigned int deprecated = 0)
+    {
+        add (DISIR_RESTRICTION_EXC_VALUE_NUMERIC, introduced, deprecated)
+            ->re_value_numeric = value;
+    }
+
+    void add_enum (const char *value, unsigned int introduced = 1, unsigned int deprecated = 0)
+    {
+        add (DISIR_RESTRICTION_EXC_VALUE_ENUM, introduced, deprecated)
+            ->re_value_string = strdup (value);
+    }
+
+    struct disir_restriction_table *
+    compiled ()
+    {
+        return dx_restriction_table_get (&table,
+                                         restrictions.empty () ? NULL : restrictions.front ());
+    }
+
+    int check (double value, unsigned int major)
+    {
+        version.sv_major = major;
+        return dx_restriction_table_check_numeric (compiled (), &version, value, &active);
+    }
+
+    int check (const char *value, unsigned int major)
+    {
+        version.sv_major = major;
+        return dx_restriction_table_check_enum (compiled (), &version, value, &active);
+    }
+
+public:
+    std::vector<struct disir_restriction *> restrictions;
+    struct disir_restriction_table *table;
+    struct disir_version version;
+    uint32_t active;
+};
+
+TEST_F (RestrictionTableTest, empty_queue_has_no_active_restrictions)
+{
+    EXPECT_EQ (0, check (3.0, 1));
+    EXPECT_EQ (0u, active);
+    EXPECT_EQ (0, check ("value", 1));
+    EXPECT_EQ (0u, active);
+}
+
+TEST_F (RestrictionTableTest, table_is_compiled_once)
+{
+    struct disir_restriction_table *first;
+
+    add_numeric (1);
+
+    first = compiled ();
+    ASSERT_TRUE (first != NULL);
+    EXPECT_EQ (first, compiled ());
+    EXPECT_EQ (first, table);
+}
+
+TEST_F (RestrictionTableTest, overlapping_ranges_are_merged)
+{
+    add_range (10, 20);
+    add_range (-5, 0);
+    add_range (15, 30);
+    add_range (30, 40);
+    add_range (100, 100);
+
+    EXPECT_EQ (1, check (-5.0, 1));
+    EXPECT_EQ (1, check (0.0, 1));
+    EXPECT_EQ (0, check (0.5, 1));
+    EXPECT_EQ (0, check (9.99, 1));
+    EXPECT_EQ (1, check (10.0, 1));
+    EXPECT_EQ (1, check (25.0, 1));
+    EXPECT_EQ (1, check (40.0, 1));
+    EXPECT_EQ (0, check (40.01, 1));
+    EXPECT_EQ (1, check (100.0, 1));
+    EXPECT_EQ (0, check (-100.0, 1));
+    EXPECT_EQ (5u, active);
+}
+
+TEST_F (RestrictionTableTest, ranges_and_numerics_combine)
+{
+    add_range (0, 10);
+    add_numeric (42);
+    add_numeric (-7);
+    add_numeric (42);
+
+    EXPECT_EQ (1, check (5.0, 1));
+    EXPECT_EQ (1, check (42.0, 1));
+    EXPECT_EQ (1, check (-7.0, 1));
+    EXPECT_EQ (0, check (41.0, 1));
+    EXPECT_EQ (0, check (11.0, 1));
+    EXPECT_EQ (4u, active);
+}
+
+TEST_F (RestrictionTableTest, nan_never_fulfills)
+{
+    add_range (-INFINITY, INFINITY);
+    add_numeric (NAN);
+
+    EXPECT_EQ (1, check (1e300, 1));
+    EXPECT_EQ (0, check (NAN, 1));
+    EXPECT_EQ (2u, active);
+}
+
+TEST_F (RestrictionTableTest, enum_values)
+{
+    char name[32];
+    int i;
+
+    for (i = 0; i < 500; i++)
+    {
+        snprintf (name, sizeof (name), "value_%d", i);
+        add_enum (name);
+    }
+
+    EXPECT_EQ (1, check ("value_0", 1));
+    EXPECT_EQ (1, check ("value_499", 1));
+    EXPECT_EQ (0, check ("value_500", 1));
+    EXPECT_EQ (0, check ("value_", 1));
+    EXPECT_EQ (0, check ((const char *) NULL, 1));
+    EXPECT_EQ (500u, active);
+}
+
+TEST_F (RestrictionTableTest, restrictions_filtered_by_version)
+{
+    add_enum ("always");
+    add_enum ("introduced_two", 2);
+    add_enum ("deprecated_three", 1, 3);
+    add_enum ("between_two_and_four", 2, 4);
+    // Inclusive restrictions are never counted
+    add (DISIR_RESTRICTION_INC_ENTRY_MAX, 1);
+
+    EXPECT_EQ (0, check ("always", 0));
+    EXPECT_EQ (0u, active);
+
+    EXPECT_EQ (1, check ("always", 1));
+    EXPECT_EQ (0, check ("introduced_two", 1));
+    EXPECT_EQ (1, check ("deprecated_three", 1));
+    EXPECT_EQ (2u, active);
+
+    EXPECT_EQ (1, check ("introduced_two", 2));
+    EXPECT_EQ (1, check ("between_two_and_four", 2));
+    EXPECT_EQ (4u, active);
+
+    EXPECT_EQ (0, check ("deprecated_three", 3));
+    EXPECT_EQ (1, check ("between_two_and_four", 3));
+    EXPECT_EQ (3u, active);
+
+    EXPECT_EQ (0, check ("between_two_and_four", 4));
+    EXPECT_EQ (1, check ("introduced_two", 100));
+    EXPECT_EQ (2u, active);
+}
+
+TEST_F (RestrictionTableTest, invalidated_table_is_recompiled)
+{
+    add_numeric (1);
+    EXPECT_EQ (1, check (1.0, 1));
+    EXPECT_EQ (0, check (2.0, 1));
+
+    restrictions.back ()->re_value_numeric = 2;
+    dx_restriction_table_invalidate (&table);
+    EXPECT_EQ (NULL, table);
+
+    EXPECT_EQ (0, check (1.0, 1));
+    EXPECT_EQ (1, check (2.0, 1));
+}
+
+TEST_F (RestrictionTableTest, inclusive_restrictions_kept_apart)
+{
+    struct disir_restriction *min;
+    struct disir_restriction *max;
+    struct disir_restriction **inclusive;
+    uint32_t count;
+
+    add_enum ("first");
+    min = add (DISIR_RESTRICTION_INC_ENTRY_MIN, 1);
+    add_range (0, 10);
+    max = add (DISIR_RESTRICTION_INC_ENTRY_MAX, 2);
+
+    inclusive = dx_restriction_table_inclusive (compiled (), &count);
+    ASSERT_EQ (2u, count);
+    EXPECT_EQ (min, inclusive[0]);
+    EXPECT_EQ (max, inclusive[1]);
+
+    EXPECT_EQ (1, check ("first", 1));
+    EXPECT_EQ (2u, active);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "test_helper.h"
+
+
+//! The number of threads validating a config is process-wide. These tests
+//! run in their own process, since the first disir_validate_threads_set sticks.
+class ValidateThreadsTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter ();
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Create and destroy an instance from a libdisir config.
+    //! validate_threads is only part of the config if it is not negative.
+    void
+    instance_create (int64_t validate_threads)
+    {
+        struct disir_instance *instance = NULL;
+        struct disir_mold *mold = NULL;
+        struct disir_config *config = NULL;
+        struct disir_context *context_config;
+        struct disir_context *context;
+
+        status = disir_libdisir_mold (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_mold_finished (&mold);
+
+        context_config = dc_config_getcontext (config);
+        // No plugins are needed.
+        if (dc_find_element (context_config, "plugin", 0, &context) == DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+        }
+        // validate_threads is optional, and thus not part of the generated config.
+        if (validate_threads >= 0)
+        {
+            status = dc_config_set_keyval_integer (context_config, validate_threads,
+                                                   "validate_threads");
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        dc_putcontext (&context_config);
+
+        status = disir_instance_create (NULL, config, &instance);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_instance_destroy (&instance);
+    }
+
+public:
+    enum disir_status status;
+};
+
+TEST_F (ValidateThreadsTest, config_applies_until_set_by_application)
+{
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    struct disir_context *context_config;
+    int64_t value;
+
+    // The default libdisir config leaves it unset.
+    status = disir_libdisir_mold (&mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_generate_config_from_mold (mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    context_config = dc_config_getcontext (config);
+    status = dc_config_set_keyval_integer (context_config, -1, "validate_threads");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_config_get_keyval_integer (context_config, &value, "validate_threads");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (-1, value);
+    dc_putcontext (&context_config);
+    disir_config_finished (&config);
+    disir_mold_finished (&mold);
+
+    instance_create (-1);
+    EXPECT_EQ (1, disir_validate_threads ());
+
+    instance_create (4);
+    EXPECT_EQ (4, disir_validate_threads ());
+
+    // An instance whose config does not set it leaves it alone.
+    instance_create (-1);
+    EXPECT_EQ (4, disir_validate_threads ());
+
+    // The application takes precedence over any config.
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_validate_threads_set (2));
+    EXPECT_EQ (2, disir_validate_threads ());
+    instance_create (8);
+    EXPECT_EQ (2, disir_validate_threads ());
+
+    disir_validate_threads_set (1);
+}
@@ -145,3 +145,107 @@ TEST_F (ContextUtilTest, context_type_string_invalid_context)
     ASSERT_STREQ (dc_context_type_string (context), "UNKNOWN");
 }
 
+
+TEST_F (ContextUtilTest, context_serial_is_never_reused)
+{
+    struct disir_context *other;
+    uint64_t serial;
+
+    other = dx_context_create (DISIR_CONTEXT_CONFIG);
+    ASSERT_TRUE (other != NULL);
+    EXPECT_NE (context->cx_serial, other->cx_serial);
+    serial = other->cx_serial;
+    dx_context_destroy (&other);
+
+    // Even if the allocator hands out the same address again.
+    other = dx_context_create (DISIR_CONTEXT_CONFIG);
+    ASSERT_TRUE (other != NULL);
+    EXPECT_GT (other->cx_serial, serial);
+    dx_context_destroy (&other);
+}
+
+//! Construct a finalized mold of 'keyvals' integer keyvals at its top-level.
+static enum disir_status
+mold_of_keyvals (int keyvals, struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct disir_context *context_mold;
+    char name[32];
+    int i;
+
+    status = dc_mold_begin (&context_mold);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (i = 0; i < keyvals && status == DISIR_STATUS_OK; i++)
+    {
+        snprintf (name, sizeof (name), "keyval_%d", i);
+        status = dc_add_keyval_integer (context_mold, name, i, "doc", NULL, NULL);
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        dc_destroy (&context_mold);
+        return status;
+    }
+
+    return dc_mold_finalize (&context_mold, mold);
+}
+
+TEST_F (ContextUtilTest, finalized_mold_keeps_every_error_message)
+{
+    struct disir_mold *mold = NULL;
+    struct disir_context *context_mold;
+    struct disir_context *keyvals[64];
+    char name[32];
+    char message[32];
+    int i;
+
+    status = mold_of_keyvals (64, &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_mold = dc_mold_getcontext (mold);
+    for (i = 0; i < 64; i++)
+    {
+        snprintf (name, sizeof (name), "keyval_%d", i);
+        status = dc_find_element (context_mold, name, 0, &keyvals[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dx_context_error_set (keyvals[i], "error of keyval %d", i);
+    }
+
+    // No message is dropped to make room for later ones.
+    for (i = 0; i < 64; i++)
+    {
+        snprintf (message, sizeof (message), "error of keyval %d", i);
+        EXPECT_STREQ (message, dc_context_error (keyvals[i]));
+        // The shared context itself is left untouched.
+        EXPECT_EQ (NULL, keyvals[i]->cx_error_message);
+        dc_putcontext (&keyvals[i]);
+    }
+
+    dc_putcontext (&context_mold);
+    disir_mold_finished (&mold);
+}
+
+TEST_F (ContextUtilTest, error_on_context_held_past_its_mold)
+{
+    struct disir_mold *mold = NULL;
+    struct disir_context *context_mold;
+    struct disir_context *keyval;
+
+    status = mold_of_keyvals (1, &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_mold = dc_mold_getcontext (mold);
+    status = dc_find_element (context_mold, "keyval_0", 0, &keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dc_putcontext (&context_mold);
+
+    // The root is freed, while the keyval lives on, destroyed.
+    disir_mold_finished (&mold);
+    ASSERT_TRUE (keyval->CONTEXT_STATE_DESTROYED);
+
+    dx_context_error_set (keyval, "error after the mold");
+    EXPECT_STREQ ("error after the mold", dc_context_error (keyval));
+
+    dc_putcontext (&keyval);
+}
@@ -0,0 +1,131 @@
+#include "test_json.h"
+
+// disir
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+
+// standard
+#include <string>
+#include <unistd.h>
+
+class FileBufferTest : public testing::JsonDioTestWrapper
+{
+    void SetUp ()
+    {
+        DisirLogCurrentTestEnter ();
+
+        file = tmpfile ();
+        ASSERT_TRUE (file != NULL);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown ()
+    {
+        DisirLogTestBodyExit ();
+
+        fslib_file_buffer_release (&buffer);
+        if (file)
+        {
+            fclose (file);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Write contents to file and rewind it.
+    void write_file (const std::string& contents)
+    {
+        ASSERT_EQ (contents.size (), fwrite (contents.data (), 1, contents.size (), file));
+        ASSERT_EQ (0, fflush (file));
+        rewind (file);
+    }
+
+    //! Assert that buffer holds exactly contents, followed by a terminating zero byte.
+    void assert_contents (const std::string& contents)
+    {
+        ASSERT_EQ (contents.size (), buffer.fb_size);
+        ASSERT_EQ (contents, std::string (buffer.fb_data, buffer.fb_size));
+        ASSERT_EQ ('\0', buffer.fb_data[buffer.fb_size]);
+    }
+
+public:
+    FILE *file = NULL;
+    struct fslib_file_buffer buffer = {};
+};
+
+TEST_F (FileBufferTest, small_file_is_read)
+{
+    std::string contents ("{ \"small\" : true }");
+
+    write_file (contents);
+
+    status = fslib_file_buffer_read (instance, file, &buffer);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    assert_contents (contents);
+}
+
+TEST_F (FileBufferTest, empty_file)
+{
+    status = fslib_file_buffer_read (instance, file, &buffer);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    assert_contents ("");
+}
+
+TEST_F (FileBufferTest, large_file_is_read)
+{
+    std::string contents (256 * 1024 + 17, 'x');
+
+    write_file (contents);
+
+    status = fslib_file_buffer_read (instance, file, &buffer);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    assert_contents (contents);
+}
+
+TEST_F (FileBufferTest, buffer_outlives_truncated_file)
+{
+    std::string contents (256 * 1024 + 17, 'x');
+
+    write_file (contents);
+
+    status = fslib_file_buffer_read (instance, file, &buffer);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // A concurrent writer opening the file with "w+" truncates it in place.
+    ASSERT_EQ (0, ftruncate (fileno (file), 0));
+    assert_contents (contents);
+}
+
+TEST_F (FileBufferTest, read_from_current_offset)
+{
+    std::string contents (128 * 1024 + 3, 'x');
+
+    contents[1000] = 'y';
+    write_file (contents);
+    ASSERT_EQ (1000, lseek (fileno (file), 1000, SEEK_SET));
+
+    status = fslib_file_buffer_read (instance, file, &buffer);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    assert_contents (contents.substr (1000));
+}
+
+TEST_F (FileBufferTest, pipe_is_read)
+{
+    std::string contents (3 * 4096 + 100, 'p');
+    int fds[2];
+    FILE *input;
+
+    ASSERT_EQ (0, pipe (fds));
+    ASSERT_EQ ((ssize_t) contents.size (), write (fds[1], contents.data (), contents.size ()));
+    close (fds[1]);
+
+    input = fdopen (fds[0], "r");
+    ASSERT_TRUE (input != NULL);
+
+    status = fslib_file_buffer_read (instance, input, &buffer);
+    fclose (input);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    assert_contents (contents);
+}
@@ -0,0 +1,316 @@
+#include "test_json.h"
+
+// disir
+#include <disir/disir.h>
+
+// standard
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <experimental/filesystem>
+
+//! Number of threads concurrently operating on the shared instance.
+#define STRESS_THREADS 8
+//! Number of iterations each thread performs.
+#define STRESS_ITERATIONS 50
+
+class InstanceThreadsTest : public testing::JsonDioTestWrapper
+{
+    void SetUp ()
+    {
+        DisirLogCurrentTestEnter ();
+
+        status = disir_mold_read (instance, "test", "basic_keyval", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_mold_write (instance, "json_test", "basic_keyval", mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_write (instance, "json_test", "basic_keyval", config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        disir_config_finished (&config);
+        disir_mold_finished (&mold);
+
+        status = disir_mold_cache_clear (instance);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown ()
+    {
+        DisirLogTestBodyExit ();
+
+        if (config)
+            disir_config_finished (&config);
+        if (mold)
+            disir_mold_finished (&mold);
+
+        disir_mold_cache_clear (instance);
+        std::experimental::filesystem::remove_all ("/tmp/json_test");
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Run function on STRESS_THREADS threads, and return the total number of failures.
+    template <typename F>
+    int run_threads (F function)
+    {
+        std::vector<std::thread> threads;
+        std::atomic<int> failures (0);
+
+        for (int i = 0; i < STRESS_THREADS; i++)
+        {
+            threads.push_back (std::thread ([&failures, &function, i] () {
+                for (int j = 0; j < STRESS_ITERATIONS; j++)
+                {
+                    if (function (i) == false)
+                        failures++;
+                }
+            }));
+        }
+        for (auto &thread : threads)
+        {
+            thread.join ();
+        }
+
+        return failures.load ();
+    }
+
+public:
+    struct disir_config *config = NULL;
+    struct disir_mold *mold = NULL;
+};
+
+TEST_F (InstanceThreadsTest, concurrent_config_read)
+{
+    int failures;
+
+    failures = run_threads ([] (int) {
+        struct disir_config *c = NULL;
+        enum disir_status s;
+
+        s = disir_config_read (instance, "json_test", "basic_keyval", NULL, &c);
+        if (s != DISIR_STATUS_OK)
+            return false;
+
+        return (disir_config_finished (&c) == DISIR_STATUS_OK);
+    });
+
+    EXPECT_EQ (0, failures);
+}
+
+TEST_F (InstanceThreadsTest, concurrent_mold_read)
+{
+    int failures;
+
+    failures = run_threads ([] (int) {
+        struct disir_mold *m = NULL;
+        enum disir_status s;
+
+        s = disir_mold_read (instance, "json_test", "basic_keyval", &m);
+        if (s != DISIR_STATUS_OK)
+            return false;
+
+        return (disir_mold_finished (&m) == DISIR_STATUS_OK);
+    });
+
+    EXPECT_EQ (0, failures);
+}
+
+TEST_F (InstanceThreadsTest, concurrent_config_entries)
+{
+    int failures;
+
+    failures = run_threads ([] (int) {
+        struct disir_entry *entries = NULL;
+        struct disir_entry *next;
+        enum disir_status s;
+        int found = 0;
+
+        s = disir_config_entries (instance, "json_test", &entries);
+        if (s != DISIR_STATUS_OK)
+            return false;
+
+        while (entries != NULL)
+        {
+            if (strcmp (entries->de_entry_name, "basic_keyval") == 0)
+                found = 1;
+            next = entries->next;
+            disir_entry_finished (&entries);
+            entries = next;
+        }
+
+        return (found == 1);
+    });
+
+    EXPECT_EQ (0, failures);
+}
+
+TEST_F (InstanceThreadsTest, error_message_is_per_thread)
+{
+    int failures;
+
+    failures = run_threads ([] (int thread) {
+        struct disir_config *c = NULL;
+        std::string entry_id = "missing_" + std::to_string (thread);
+        const char *message;
+
+        disir_config_read (instance, "json_test", entry_id.c_str (), NULL, &c);
+        message = disir_error (instance);
+        if (message == NULL || strstr (message, entry_id.c_str ()) == NULL)
+            return false;
+
+        disir_error_clear (instance);
+        return (disir_error (instance) == NULL);
+    });
+
+    EXPECT_EQ (0, failures);
+}
+
+TEST_F (InstanceThreadsTest, mixed_operations)
+{
+    int failures;
+    struct disir_mold_cache_stats stats;
+
+    failures = run_threads ([] (int thread) {
+        struct disir_config *c = NULL;
+        struct disir_mold *m = NULL;
+        enum disir_status s;
+
+        if (thread % 2 == 0)
+        {
+            s = disir_config_read (instance, "json_test", "basic_keyval", NULL, &c);
+            if (s != DISIR_STATUS_OK)
+                return false;
+            s = disir_config_get_mold (c, &m);
+            if (s != DISIR_STATUS_OK)
+                return false;
+            disir_config_finished (&c);
+            return (disir_mold_finished (&m) == DISIR_STATUS_OK);
+        }
+
+        s = disir_mold_read (instance, "json_test", "basic_keyval", &m);
+        if (s != DISIR_STATUS_OK)
+            return false;
+        s = disir_generate_config_from_mold (m, NULL, &c);
+        if (s != DISIR_STATUS_OK)
+            return false;
+        disir_config_finished (&c);
+        return (disir_mold_finished (&m) == DISIR_STATUS_OK);
+    });
+
+    EXPECT_EQ (0, failures);
+
+    status = disir_mold_cache_stats (instance, &stats);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (1, stats.mcs_entries);
+}
+
+//! Return the first KEYVAL context at the top-level of mold. NULL if there is none.
+static struct disir_context *
+first_mold_keyval (struct disir_mold *mold)
+{
+    struct disir_context *context_mold;
+    struct disir_context *context = NULL;
+    struct disir_context *context_keyval = NULL;
+    struct disir_collection *collection = NULL;
+
+    context_mold = dc_mold_getcontext (mold);
+    if (dc_get_elements (context_mold, &collection) == DISIR_STATUS_OK)
+    {
+        while (context_keyval == NULL
+               && dc_collection_next (collection, &context) == DISIR_STATUS_OK)
+        {
+            if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
+                context_keyval = context;
+            else
+                dc_putcontext (&context);
+        }
+        dc_collection_finished (&collection);
+    }
+    dc_putcontext (&context_mold);
+
+    return context_keyval;
+}
+
+TEST_F (InstanceThreadsTest, cached_mold_error_messages_are_per_thread)
+{
+    int failures;
+    struct disir_mold_cache_stats before;
+    struct disir_mold_cache_stats after;
+    struct disir_context *context_keyval;
+
+    status = disir_mold_cache_stats (instance, &before);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Populate the cache - every thread below shares this very mold.
+    status = disir_config_read (instance, "json_test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_get_mold (config, &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    failures = run_threads ([] (int thread) {
+        struct disir_config *c = NULL;
+        struct disir_mold *m = NULL;
+        struct disir_context *keyval;
+        const char *message;
+        const char *expected;
+        int64_t integer_value;
+        double float_value;
+        enum disir_status s;
+        bool valid;
+
+        // Config reads share the cached mold.
+        s = disir_config_read (instance, "json_test", "basic_keyval", NULL, &c);
+        if (s != DISIR_STATUS_OK)
+            return false;
+        s = disir_config_get_mold (c, &m);
+        disir_config_finished (&c);
+        if (s != DISIR_STATUS_OK)
+            return false;
+
+        keyval = first_mold_keyval (m);
+        if (keyval == NULL)
+        {
+            disir_mold_finished (&m);
+            return false;
+        }
+
+        // Set a different error message on the same shared keyval from every other thread.
+        if (thread % 2 == 0)
+        {
+            s = dc_get_value_integer (keyval, &integer_value);
+            expected = "cannot get integer value";
+        }
+        else
+        {
+            s = dc_get_value_float (keyval, &float_value);
+            expected = "cannot get float value";
+        }
+        message = dc_context_error (keyval);
+        valid = (s != DISIR_STATUS_OK && message != NULL && strstr (message, expected) != NULL);
+
+        dc_putcontext (&keyval);
+        disir_mold_finished (&m);
+        return valid;
+    });
+
+    EXPECT_EQ (0, failures);
+
+    status = disir_mold_cache_stats (instance, &after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (before.mcs_misses + 1, after.mcs_misses);
+
+    // The shared mold itself was never written to.
+    context_keyval = first_mold_keyval (mold);
+    ASSERT_TRUE (context_keyval != NULL);
+    EXPECT_EQ (NULL, dc_context_error (context_keyval));
+    dc_putcontext (&context_keyval);
+}
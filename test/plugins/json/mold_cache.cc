@@ -0,0 +1,157 @@
+#include "test_json.h"
+
+// disir
+#include <disir/disir.h>
+
+// standard
+#include <fstream>
+#include <experimental/filesystem>
+
+class MoldCacheTest : public testing::JsonDioTestWrapper
+{
+    void SetUp ()
+    {
+        DisirLogCurrentTestEnter ();
+
+        status = disir_mold_read (instance, "test", "basic_keyval", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_mold_write (instance, "json_test", "basic_keyval", mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_write (instance, "json_test", "basic_keyval", config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        disir_config_finished (&config);
+        disir_mold_finished (&mold);
+
+        status = disir_mold_cache_clear (instance);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_mold_cache_stats (instance, &initial);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown ()
+    {
+        DisirLogTestBodyExit ();
+
+        if (config)
+            disir_config_finished (&config);
+        if (config_second)
+            disir_config_finished (&config_second);
+        if (mold)
+            disir_mold_finished (&mold);
+        if (mold_second)
+            disir_mold_finished (&mold_second);
+
+        disir_mold_cache_clear (instance);
+        std::experimental::filesystem::remove_all ("/tmp/json_test");
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    void read_config_and_mold (struct disir_config **c, struct disir_mold **m)
+    {
+        status = disir_config_read (instance, "json_test", "basic_keyval", NULL, c);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_get_mold (*c, m);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+public:
+    struct disir_config *config = NULL;
+    struct disir_config *config_second = NULL;
+    struct disir_mold *mold = NULL;
+    struct disir_mold *mold_second = NULL;
+    struct disir_mold_cache_stats initial;
+    struct disir_mold_cache_stats stats;
+};
+
+TEST_F (MoldCacheTest, stats_invalid_arguments)
+{
+    status = disir_mold_cache_stats (NULL, &stats);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_mold_cache_stats (instance, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_mold_cache_clear (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (MoldCacheTest, repeated_reads_share_mold)
+{
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config, &mold));
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config_second, &mold_second));
+
+    ASSERT_EQ (mold, mold_second);
+
+    status = disir_mold_cache_stats (instance, &stats);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (initial.mcs_misses + 1, stats.mcs_misses);
+    EXPECT_EQ (initial.mcs_hits + 1, stats.mcs_hits);
+    EXPECT_EQ (1u, stats.mcs_entries);
+}
+
+TEST_F (MoldCacheTest, cleared_cache_keeps_molds_handed_out)
+{
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config, &mold));
+
+    status = disir_mold_cache_clear (instance);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_mold_cache_stats (instance, &stats);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0u, stats.mcs_entries);
+
+    // Config still holds on to a valid mold
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config_second, &mold_second));
+    EXPECT_NE (mold, mold_second);
+}
+
+TEST_F (MoldCacheTest, modified_mold_entry_invalidates)
+{
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config, &mold));
+
+    // Append whitespace to the mold entry - changes both size and mtime.
+    std::ofstream ofs ("/tmp/json_test/mold/basic_keyval.json", std::ofstream::app);
+    ASSERT_TRUE (ofs.is_open ());
+    ofs << "\n";
+    ofs.close ();
+
+    ASSERT_NO_FATAL_FAILURE (read_config_and_mold (&config_second, &mold_second));
+    EXPECT_NE (mold, mold_second);
+
+    status = disir_mold_cache_stats (instance, &stats);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (initial.mcs_misses + 2, stats.mcs_misses);
+    EXPECT_EQ (initial.mcs_invalidations + 1, stats.mcs_invalidations);
+    EXPECT_EQ (1u, stats.mcs_entries);
+}
+
+TEST_F (MoldCacheTest, supplied_mold_bypasses_cache)
+{
+    status = disir_mold_read (instance, "json_test", "basic_keyval", &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "json_test", "basic_keyval", mold, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_mold_cache_stats (instance, &stats);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (initial.mcs_misses, stats.mcs_misses);
+    EXPECT_EQ (initial.mcs_hits, stats.mcs_hits);
+    EXPECT_EQ (0u, stats.mcs_entries);
+}
+
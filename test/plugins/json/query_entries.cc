@@ -0,0 +1,158 @@
+#include "test_json.h"
+
+// disir
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+
+// standard
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <experimental/filesystem>
+
+class QueryEntriesTest : public testing::JsonDioTestWrapper
+{
+    void SetUp ()
+    {
+        DisirLogCurrentTestEnter ();
+
+        std::experimental::filesystem::remove_all ("/tmp/json_test");
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown ()
+    {
+        DisirLogTestBodyExit ();
+
+        std::experimental::filesystem::remove_all ("/tmp/json_test");
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Create an empty file at path, relative to /tmp/json_test
+    void touch (std::string path)
+    {
+        std::string filepath = "/tmp/json_test/" + path;
+        std::string directory = filepath.substr (0, filepath.find_last_of ('/'));
+        std::ofstream ofs;
+
+        status = fslib_mkdir_p (instance, directory.c_str());
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        ofs.open (filepath.c_str(), std::ofstream::out);
+        ASSERT_TRUE (ofs.is_open ());
+        ofs.close ();
+    }
+
+    //! Collect the entries into names, in the order they were returned. Frees entries.
+    void collect (struct disir_entry *entries)
+    {
+        struct disir_entry *next;
+
+        while (entries != NULL)
+        {
+            next = entries->next;
+            names.push_back (std::string (entries->de_entry_name));
+            attributes[std::string (entries->de_entry_name)] = *entries;
+            disir_entry_finished (&entries);
+            entries = next;
+        }
+    }
+
+public:
+    std::vector<std::string> names;
+    std::map<std::string, struct disir_entry> attributes;
+};
+
+TEST_F (QueryEntriesTest, mold_entries_sorted_with_namespace_and_override)
+{
+    struct disir_entry *entries = NULL;
+
+    touch ("mold/zeta.json");
+    touch ("mold/alpha.json");
+    touch ("mold/alpha.o.json");
+    touch ("mold/orphan.o.json");
+    touch ("mold/ns/__namespace.json");
+    touch ("mold/ns/over.o.json");
+    touch ("mold/deep/er/still/entry.json");
+    touch ("mold/deep/Invalid-Name.json");
+    touch ("mold/deep/ignored.toml");
+
+    status = disir_mold_entries (instance, "json_test", &entries);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    collect (entries);
+
+    std::vector<std::string> expected = {
+        "alpha", "deep/er/still/entry", "ns/", "ns/over", "zeta",
+    };
+    ASSERT_EQ (expected, names);
+
+    EXPECT_EQ (1, attributes["alpha"].flag.DE_OVERRIDE);
+    EXPECT_EQ (0, attributes["alpha"].flag.DE_NAMESPACE_ENTRY);
+    EXPECT_EQ (1, attributes["ns/"].flag.DE_NAMESPACE_ENTRY);
+    EXPECT_EQ (1, attributes["ns/over"].flag.DE_OVERRIDE);
+    EXPECT_EQ (0, attributes["zeta"].flag.DE_OVERRIDE);
+}
+
+TEST_F (QueryEntriesTest, config_entries_require_mold)
+{
+    struct disir_entry *entries = NULL;
+
+    touch ("mold/alpha.json");
+    touch ("mold/ns/__namespace.json");
+    touch ("mold/deep/er/entry.json");
+
+    touch ("config/alpha.json");
+    touch ("config/orphan.json");
+    touch ("config/ns/first.json");
+    touch ("config/ns/second.json");
+    touch ("config/ns/nested/uncovered.json");
+    touch ("config/deep/er/entry.json");
+
+    status = disir_config_entries (instance, "json_test", &entries);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    collect (entries);
+
+    std::vector<std::string> expected = {
+        "alpha", "deep/er/entry", "ns/first", "ns/second",
+    };
+    ASSERT_EQ (expected, names);
+
+    EXPECT_EQ (0, attributes["alpha"].flag.DE_NAMESPACE_ENTRY);
+    EXPECT_EQ (1, attributes["ns/first"].flag.DE_NAMESPACE_ENTRY);
+}
+
+TEST_F (QueryEntriesTest, config_entries_wide_tree)
+{
+    struct disir_entry *entries = NULL;
+    char name[64];
+    int i;
+    int j;
+
+    for (i = 0; i < 32; i++)
+    {
+        snprintf (name, sizeof (name), "mold/dir_%02d/__namespace.json", i);
+        touch (name);
+        for (j = 0; j < 8; j++)
+        {
+            snprintf (name, sizeof (name), "config/dir_%02d/sub_%d/entry.json", i, j);
+            touch (name);
+            snprintf (name, sizeof (name), "config/dir_%02d/entry_%d.json", i, j);
+            touch (name);
+        }
+    }
+
+    status = disir_config_entries (instance, "json_test", &entries);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    collect (entries);
+
+    // Entries in sub_N are not covered by the namespace entry in dir_NN
+    ASSERT_EQ (32 * 8, names.size ());
+    EXPECT_TRUE (std::is_sorted (names.begin (), names.end ()));
+    EXPECT_EQ ("dir_00/entry_0", names.front ());
+    EXPECT_EQ ("dir_31/entry_7", names.back ());
+}
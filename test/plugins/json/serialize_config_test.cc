@@ -1,6 +1,9 @@
 #include "test_json.h"
 #include "json/json_serialize.h"
 
+// standard
+#include <sstream>
+
 class MarshallConfigTest : public testing::JsonDioTestWrapper
 {
     void SetUp()
@@ -93,3 +96,37 @@ TEST_F(MarshallConfigTest, empty_section)
             << root["empty_section"];
     );
 }
+
+TEST_F(MarshallConfigTest, stream_output_equals_string_output)
+{
+    struct disir_context *context_keyval = NULL;
+
+    status = disir_generate_config_from_mold (mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+
+    // Another test1 keyval, written as an array with the existing ones
+    status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "test1", strlen ("test1"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_value_string (context_keyval, "quote \" tab \t", strlen ("quote \" tab \t"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_finalize (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dc_putcontext (&context_keyval);
+
+    std::string serialized;
+    status = writer->serialize (config, serialized);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    std::ostringstream stream;
+    dio::ConfigWriter stream_writer (instance);
+    status = stream_writer.serialize (config, stream);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (serialized, stream.str ());
+    EXPECT_NE (std::string::npos,
+               serialized.find ("\"test1\" : [ \"1\", \"1\", \"quote \\\" tab \\t\" ]"));
+}
@@ -2,6 +2,8 @@
 #include "json/json_serialize.h"
 #include "json/json_unserialize.h"
 
+#include <disir/fslib/json.h>
+
 class UnserializeConfigTest : public testing::JsonDioTestWrapper
 {
     void SetUp()
@@ -146,3 +148,197 @@ TEST_F (UnserializeConfigTest, empty_section)
     status = unserialize_config();
     ASSERT_STATUS (DISIR_STATUS_OK, status);
 }
+
+TEST_F (UnserializeConfigTest, parse_error_shall_not_construct_config)
+{
+    status = reader->unserialize (&config, std::string ("{\n  \"version\" : \"1.0\",\n  \"config\" : {"));
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    ASSERT_TRUE (config == NULL);
+    ASSERT_STREQ ("Parse error: * Line 3, Column 15\n"
+                  "  Missing '}' or object member name\n", disir_error (instance));
+}
+
+TEST_F (UnserializeConfigTest, version_after_config)
+{
+    Json::FastWriter json_writer;
+    std::string document;
+
+    document = "{ \"config\" : " + json_writer.write (root["config"])
+               + ", \"version\" : " + json_writer.write (root["version"]) + "}";
+
+    status = reader->unserialize (&config, document);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+}
+
+TEST_F (UnserializeConfigTest, comments_shall_be_ignored)
+{
+    Json::FastWriter json_writer;
+    std::string document;
+
+    document = "// leading comment\n{ /* version */ \"version\" : /* value */ "
+               + json_writer.write (root["version"]) + " // trailing\n, \"config\" : "
+               + json_writer.write (root["config"]) + "/* end */ }";
+
+    status = reader->unserialize (&config, document);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+}
+
+TEST_F (UnserializeConfigTest, unicode_escapes)
+{
+    struct disir_context *context_config;
+    const char *value;
+    Json::StyledWriter json_writer;
+    std::string document;
+    size_t position;
+
+    root["config"]["test2"] = "placeholder";
+    document = json_writer.writeOrdered (root);
+    position = document.find ("placeholder");
+    document.replace (position, strlen ("placeholder"), "caf\\u00e9 \\ud83d\\ude00");
+
+    status = reader->unserialize (&config, document);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+    status = dc_config_get_keyval_string (context_config, &value, "test2");
+    dc_putcontext (&context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("caf\xc3\xa9 \xf0\x9f\x98\x80", value);
+}
+
+TEST_F (UnserializeConfigTest, integer_beyond_32_bits)
+{
+    struct disir_context *context_config;
+    int64_t value;
+
+    ASSERT_NO_THROW (
+        root["config"]["section_name"]["integer"] = Json::Int64 (5000000000);
+    );
+
+    status = unserialize_config ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+    status = dc_config_get_keyval_integer (context_config, &value, "section_name.integer");
+    dc_putcontext (&context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_EQ (5000000000, value);
+}
+
+TEST_F (UnserializeConfigTest, null_value_shall_fail)
+{
+    ASSERT_NO_THROW (
+        root["config"]["test2"] = Json::nullValue;
+    );
+
+    status = unserialize_config ();
+    ASSERT_STATUS (DISIR_STATUS_INTERNAL_ERROR, status);
+    ASSERT_TRUE (config == NULL);
+}
+
+TEST_F (UnserializeConfigTest, unserialize_buffer)
+{
+    Json::StyledWriter json_writer;
+    std::string document;
+
+    document = json_writer.writeOrdered (root);
+
+    status = dio_json_unserialize_config_buffer (instance, document.data (), document.size (),
+                                                 mold, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_TRUE (config != NULL);
+}
+
+TEST_F (UnserializeConfigTest, unserialize_buffer_shall_not_read_past_size)
+{
+    Json::StyledWriter json_writer;
+    std::string document;
+    size_t closing;
+
+    document = json_writer.writeOrdered (root);
+    closing = document.find_last_of ('}');
+
+    status = dio_json_unserialize_config_buffer (instance, document.data (), closing,
+                                                 mold, &config);
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    ASSERT_TRUE (config == NULL);
+}
+
+TEST_F (UnserializeConfigTest, duplicate_member_keeps_last)
+{
+    struct disir_context *context_config;
+    struct disir_collection *collection;
+    Json::StyledWriter json_writer;
+    std::string document;
+    size_t position;
+    int64_t value;
+
+    ASSERT_NO_THROW (
+        root["config"]["section_name"]["integer"] = Json::Int64 (1111);
+    );
+    document = json_writer.writeOrdered (root);
+    position = document.find ("1111");
+    document.replace (position, strlen ("1111"), "1111, \"integer\" : 2222");
+
+    status = reader->unserialize (&config, document);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+    status = dc_config_get_keyval_integer (context_config, &value, "section_name.integer");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (2222, value);
+
+    status = dc_find_elements (context_config, "section_name", &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (1, dc_collection_size (collection));
+    dc_collection_finished (&collection);
+    dc_putcontext (&context_config);
+}
+
+TEST_F (UnserializeConfigTest, duplicate_member_keeps_first_position)
+{
+    struct disir_context *context_config;
+    struct disir_context *context_section;
+    struct disir_context *context;
+    struct disir_collection *collection;
+    Json::StyledWriter json_writer;
+    std::string document;
+    const char *name;
+    int32_t name_size;
+    size_t position;
+    int64_t value;
+
+    // 'integer' is the fourth keyval of section_name. Repeat it in front of the first.
+    ASSERT_NO_THROW (
+        root["config"]["section_name"]["integer"] = Json::Int64 (2222);
+    );
+    document = json_writer.writeOrdered (root);
+    position = document.find ("\"section_name\" : {");
+    ASSERT_NE (std::string::npos, position);
+    document.insert (position + strlen ("\"section_name\" : {"), "\"integer\" : 1111,");
+
+    status = reader->unserialize (&config, document);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+    status = dc_find_element (context_config, "section_name", 0, &context_section);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_get_elements (context_section, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (root["config"]["section_name"].size (), dc_collection_size (collection));
+
+    status = dc_collection_next (collection, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_get_name (context, &name, &name_size);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (std::string ("integer"), std::string (name, name_size));
+    status = dc_get_value_integer (context, &value);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (2222, value);
+
+    dc_putcontext (&context);
+    dc_collection_finished (&collection);
+    dc_putcontext (&context_section);
+    dc_putcontext (&context_config);
+}
@@ -58,3 +58,25 @@ TEST_F (TomlUnserializeConfigTest, basic_keyval)
     // Lets start querying the keyval
 }
 
+
+TEST_F (TomlUnserializeConfigTest, unserialize_buffer)
+{
+    std::stringstream filepath;
+    std::stringstream document;
+
+    filepath << CMAKE_SOURCE_DIRECTORY << "/test/plugins/toml/testdata/basic_keyval.toml";
+    std::ifstream file (filepath.str ());
+    ASSERT_TRUE (file.is_open ());
+    document << file.rdbuf ();
+
+    status = disir_mold_read (instance, "test", "basic_keyval", &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dio_toml_unserialize_config_buffer (instance, document.str ().data (),
+                                                 document.str ().size (), mold, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_TRUE (config != NULL);
+
+    disir_config_finished (&config);
+    disir_mold_finished (&mold);
+}
@@ -236,3 +236,63 @@ TEST_F (CollectionTest, push_context_until_internal_resize)
     }
 }
 
+
+TEST_F (CollectionTest, next_destroying_while_iterating)
+{
+    struct disir_context *contexts[50];
+    struct disir_context *current;
+
+    for (i = 0; i < 50; i++)
+    {
+        status = dc_begin (context_mold, DISIR_CONTEXT_KEYVAL, &contexts[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_collection_push_context (collection, contexts[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    // Destroy every returned context, and the one following every fifth,
+    // before retrieving the next.
+    i = 0;
+    while (dc_collection_next (collection, &current) != DISIR_STATUS_EXHAUSTED)
+    {
+        ASSERT_TRUE (current == contexts[i]);
+        dc_putcontext (&current);
+
+        if (i % 5 == 0 && i + 1 < 50)
+        {
+            dc_destroy (&contexts[i + 1]);
+            dc_destroy (&contexts[i]);
+            i += 2;
+        }
+        else
+        {
+            // Every other context is kept.
+            if (i % 2 == 0)
+            {
+                dc_destroy (&contexts[i]);
+            }
+            i++;
+        }
+    }
+    EXPECT_EQ (50, i);
+
+    // Only the kept contexts remain, in order.
+    size = dc_collection_size (collection);
+    status = dc_collection_reset (collection);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    for (i = 0; i < 50; i++)
+    {
+        if (contexts[i] == NULL)
+            continue;
+
+        size--;
+        status = dc_collection_next (collection, &current);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        ASSERT_TRUE (current == contexts[i]);
+        dc_putcontext (&current);
+        dc_destroy (&contexts[i]);
+    }
+    EXPECT_EQ (0, size);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, dc_collection_next (collection, &current));
+    EXPECT_EQ (0, dc_collection_size (collection));
+}
@@ -300,3 +300,170 @@ TEST_F (ContextDefaultTest, second_default_with_conflicting_version_is_invalid)
     EXPECT_EQ (2, dc_collection_size(defaults));
     dc_collection_finished (&defaults);
 }
+
+// Test resolving the active default of a finalized mold with a long default history
+class ContextDefaultHistoryTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter();
+
+        struct disir_context *context_section;
+        struct disir_context *context_mold;
+        struct disir_context *context_keyval;
+        struct disir_version version;
+        uint32_t i;
+
+        version.sv_major = 1;
+        version.sv_minor = 0;
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_keyval_integer (context_mold, "history", 100, "doc",
+                                        &version, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 2; i <= HISTORY; i++)
+        {
+            version.sv_major = i;
+            status = dc_add_default_integer (context_keyval, i * 100, &version);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        dc_putcontext (&context_keyval);
+
+        status = dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_section, "section", strlen ("section"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_section, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        version.sv_major = 1;
+        status = dc_add_keyval_integer (context_section, "other", 7, "doc",
+                                        &version, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        // Every other version only
+        for (i = 3; i <= HISTORY; i += 2)
+        {
+            version.sv_major = i;
+            status = dc_add_default_integer (context_keyval, i * 7, &version);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        dc_putcontext (&context_keyval);
+        status = dc_finalize (&context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        context_mold = dc_mold_getcontext (mold);
+        status = dc_find_element (context_mold, "history", 0, &context_history);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_find_element (context_mold, "section", 0, &context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_find_element (context_section, "other", 0, &context_other);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_section);
+        dc_putcontext (&context_mold);
+    }
+
+    void TearDown()
+    {
+        if (context_history)
+        {
+            dc_putcontext (&context_history);
+        }
+        if (context_other)
+        {
+            dc_putcontext (&context_other);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Active default of context at major.minor
+    std::string
+    get_default (struct disir_context *context, uint32_t major, uint32_t minor)
+    {
+        struct disir_version version;
+        char buffer[32];
+        int32_t size;
+
+        version.sv_major = major;
+        version.sv_minor = minor;
+        status = dc_get_default (context, &version, sizeof (buffer), buffer, &size);
+        if (status != DISIR_STATUS_OK)
+            return disir_status_string (status);
+        return std::string (buffer, size);
+    }
+
+public:
+    static const uint32_t HISTORY = 24;
+
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_context *context_history = NULL;
+    struct disir_context *context_other = NULL;
+};
+
+TEST_F (ContextDefaultHistoryTest, active_default_at_each_version)
+{
+    uint32_t i;
+    int pass;
+
+    // The second pass resolves through the default views of the mold, where they apply.
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 1; i <= HISTORY; i++)
+        {
+            EXPECT_EQ (std::to_string (i * 100), get_default (context_history, i, 0));
+            EXPECT_EQ (std::to_string (i * 100), get_default (context_history, i, 5));
+            EXPECT_EQ (std::to_string (i < 3 ? 7 : (i - (i + 1) % 2) * 7),
+                       get_default (context_other, i, 0));
+        }
+    }
+}
+
+TEST_F (ContextDefaultHistoryTest, active_default_outside_history)
+{
+    char buffer[32];
+    int32_t size;
+
+    // Before the first default, the first default applies.
+    EXPECT_EQ ("100", get_default (context_history, 0, 0));
+    EXPECT_EQ ("100", get_default (context_history, 0, 5));
+
+    EXPECT_EQ (std::to_string (HISTORY * 100), get_default (context_history, HISTORY + 10, 0));
+
+    // NULL version is the latest default.
+    status = dc_get_default (context_history, NULL, sizeof (buffer), buffer, &size);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (std::to_string (HISTORY * 100), std::string (buffer, size));
+}
+
+TEST_F (ContextDefaultHistoryTest, generate_config_at_version)
+{
+    struct disir_config *config;
+    struct disir_context *context_config;
+    struct disir_version version;
+    int64_t value;
+    uint32_t i;
+
+    for (i = 1; i <= HISTORY; i += 5)
+    {
+        version.sv_major = i;
+        version.sv_minor = 0;
+        status = disir_generate_config_from_mold (mold, &version, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        context_config = dc_config_getcontext (config);
+        status = dc_config_get_keyval_integer (context_config, &value, "history");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_EQ (i * 100, value);
+        dc_putcontext (&context_config);
+        disir_config_finished (&config);
+    }
+}
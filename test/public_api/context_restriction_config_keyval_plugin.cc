@@ -110,6 +110,8 @@ TEST_F (ContextRestrictionConfigFinalizedKeyvalPluginTest, integer_restriction_s
     // We are not allowed to set restriction violated value on finalized keyval
     status = dc_set_value_integer (context_integer, 12);
     ASSERT_STATUS (DISIR_STATUS_RESTRICTION_VIOLATED, status);
+    EXPECT_STREQ ("No exclusive restrictions fulfilled for value 12. Must be one of: 1, 2, 8",
+                  dc_context_error (context_integer));
 
     // Check that value did not change
     // default is 2
@@ -183,6 +185,9 @@ TEST_F (ContextRestrictionConfigConstructingKeyvalPluginTest, float_restriction_
     // We are allowed to set the value, but it will become invalid
     status = dc_set_value_float (context_keyval, 45.87);
     ASSERT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    EXPECT_STREQ ("No exclusive restrictions fulfilled for value 45.870000."
+                  " Must be one of: [5.550000, 10.140000], 66.690000",
+                  dc_context_error (context_keyval));
 
     // Assert context is invalid
     status = dc_context_valid (context_keyval);
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/corpus.h>
+#include <disir/fslib/json.h>
+
+#include "test_helper.h"
+
+
+class CorpusTest : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_corpus_parameters_default (&parameters);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (config)
+        {
+            status = disir_config_finished (&config);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+        if (mold)
+        {
+            status = disir_mold_finished (&mold);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    std::string serialize (struct disir_mold *input)
+    {
+        std::string output;
+        char buffer[4096];
+        size_t size;
+        FILE *stream = tmpfile ();
+
+        EXPECT_STATUS (DISIR_STATUS_OK, dio_json_serialize_mold (instance, input, stream));
+        rewind (stream);
+        while ((size = fread (buffer, 1, sizeof (buffer), stream)) > 0)
+        {
+            output.append (buffer, size);
+        }
+        fclose (stream);
+
+        return output;
+    }
+
+    void generate ()
+    {
+        status = disir_corpus_mold (&parameters, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_corpus_config (&parameters, mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    uint32_t numkeyvals (struct disir_config *input)
+    {
+        struct disir_snapshot *snapshot;
+        uint32_t count;
+
+        EXPECT_STATUS (DISIR_STATUS_OK, disir_snapshot_create (input, &snapshot));
+        count = disir_snapshot_numentries (snapshot);
+        disir_snapshot_finished (&snapshot);
+        return count;
+    }
+
+public:
+    enum disir_status status;
+    struct disir_corpus_parameters parameters;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+};
+
+
+TEST_F (CorpusTest, invalid_arguments)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_corpus_parameters_default (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_corpus_mold (NULL, &mold);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_corpus_mold (&parameters, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    parameters.cp_keys = 0;
+    status = disir_corpus_mold (&parameters, &mold);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    disir_corpus_parameters_default (&parameters);
+    parameters.cp_restrictions = 101;
+    status = disir_corpus_mold (&parameters, &mold);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    disir_corpus_parameters_default (&parameters);
+    parameters.cp_weight_string = 0;
+    parameters.cp_weight_integer = 0;
+    parameters.cp_weight_float = 0;
+    parameters.cp_weight_boolean = 0;
+    parameters.cp_weight_enum = 0;
+    status = disir_corpus_mold (&parameters, &mold);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    EXPECT_EQ (NULL, mold);
+}
+
+TEST_F (CorpusTest, config_is_valid_at_every_version)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_config *older;
+    struct disir_version version;
+    struct disir_version mold_version;
+
+    parameters.cp_keys = 500;
+    parameters.cp_versions = 5;
+    parameters.cp_restrictions = 100;
+    generate ();
+
+    dc_mold_get_version (mold, &mold_version);
+    EXPECT_EQ (5u, mold_version.sv_major);
+    EXPECT_EQ (0u, mold_version.sv_minor);
+    EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (config, NULL));
+
+    version.sv_minor = 0;
+    for (version.sv_major = 1; version.sv_major < 5; version.sv_major++)
+    {
+        status = disir_corpus_config (&parameters, mold, &version, &older);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (older, NULL));
+        // Keyvals are introduced in later versions
+        EXPECT_LT (numkeyvals (older), numkeyvals (config));
+        disir_config_finished (&older);
+    }
+
+    version.sv_major = 6;
+    status = disir_corpus_config (&parameters, mold, &version, &older);
+    EXPECT_STATUS (DISIR_STATUS_CONFLICTING_SEMVER, status);
+}
+
+TEST_F (CorpusTest, same_seed_generates_same_corpus)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_mold *other_mold;
+    struct disir_config *other_config;
+
+    generate ();
+
+    status = disir_corpus_mold (&parameters, &other_mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_corpus_config (&parameters, other_mold, NULL, &other_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (serialize (mold), serialize (other_mold));
+    status = dc_compare (dc_config_getcontext (config), dc_config_getcontext (other_config),
+                         NULL);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+    disir_config_finished (&other_config);
+    disir_mold_finished (&other_mold);
+
+    parameters.cp_seed++;
+    status = disir_corpus_mold (&parameters, &other_mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_NE (serialize (mold), serialize (other_mold));
+    disir_mold_finished (&other_mold);
+}
+
+TEST_F (CorpusTest, repeated_sections_multiply_config_keyvals)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_context *context;
+    struct disir_context *section;
+    uint32_t single;
+
+    parameters.cp_keys = 60;
+    parameters.cp_depth = 1;
+    parameters.cp_fanout = 2;
+    parameters.cp_versions = 1;
+    parameters.cp_repeat = 1;
+    generate ();
+
+    // 20 keyvals in the mold and in each of its two sections
+    EXPECT_EQ (60u, numkeyvals (config));
+    single = numkeyvals (config);
+    disir_config_finished (&config);
+    disir_mold_finished (&mold);
+
+    parameters.cp_repeat = 3;
+    generate ();
+
+    EXPECT_EQ (single + 2 * 20, numkeyvals (config));
+
+    context = dc_config_getcontext (config);
+    status = dc_find_element (context, "section_0", 2, &section);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    dc_putcontext (&section);
+    status = dc_find_element (context, "section_1", 1, &section);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    dc_putcontext (&context);
+}
+
+TEST_F (CorpusTest, value_types_follow_weights)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_snapshot *snapshot;
+    enum disir_value_type type;
+    char key[32];
+
+    parameters.cp_keys = 50;
+    parameters.cp_depth = 0;
+    parameters.cp_weight_string = 0;
+    parameters.cp_weight_integer = 0;
+    parameters.cp_weight_float = 0;
+    parameters.cp_weight_boolean = 0;
+    parameters.cp_weight_enum = 1;
+    parameters.cp_versions = 1;
+    generate ();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_snapshot_create (config, &snapshot));
+    for (int i = 0; i < 50; i++)
+    {
+        snprintf (key, sizeof (key), "key_%d", i);
+        status = disir_snapshot_get_type (snapshot, &type, key);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_EQ (DISIR_VALUE_TYPE_ENUM, type);
+    }
+    disir_snapshot_finished (&snapshot);
+}
+
+TEST_F (CorpusTest, write_through_plugin)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    std::string path;
+
+    parameters.cp_keys = 40;
+    status = disir_corpus_write (instance, "json", "corpus_write_test", &parameters);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "json", "corpus_write_test", NULL, &config);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    if (config)
+        EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (config, NULL));
+
+    status = disir_config_remove (instance, "json", "corpus_write_test");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    path = CMAKE_BUILD_DIRECTORY "/tree/json/mold/corpus_write_test.json";
+    EXPECT_EQ (0, remove (path.c_str ()));
+}
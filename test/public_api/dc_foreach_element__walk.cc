@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "test_helper.h"
+
+
+//! Visit a config generated with keyval `first`, section `repeated` twice
+//! with keyvals `one` and `two`, and keyval `last`.
+class VisitTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter ();
+
+        create_mold ();
+        ASSERT_NO_SETUP_FAILURE ();
+
+        version.sv_major = 1;
+        version.sv_minor = 0;
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_generate_config_from_mold (mold, &version, &config));
+        context_config = dc_config_getcontext (config);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (context_config)
+        {
+            dc_putcontext (&context_config);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    void
+    create_mold (void)
+    {
+        struct disir_context *context_mold;
+        struct disir_context *context_section;
+
+        version.sv_major = 1;
+        version.sv_minor = 0;
+
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_begin (&context_mold));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "first", 1, "doc", &version, NULL));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_set_name (context_section, "repeated", strlen ("repeated")));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_documentation (context_section, "doc", 3));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_restriction_entries_min (context_section, 2, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_section, "one", 1, "doc", &version, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_section, "two", 2, "doc", &version, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "last", 3, "doc", &version, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_finalize (&context_mold, &mold));
+    }
+
+    //! Names visited, prefixed by the callback that visited them.
+    struct visit
+    {
+        std::vector<std::string> names;
+        //! Status returned on visiting stop_at, if set.
+        const char *stop_at = NULL;
+        enum disir_status stop_status = DISIR_STATUS_OK;
+    };
+
+    static enum disir_status
+    record (const char *prefix, struct disir_context *context, void *userdata)
+    {
+        struct visit *visit = static_cast<struct visit *> (userdata);
+        const char *name;
+
+        EXPECT_STATUS (DISIR_STATUS_OK, dc_get_name (context, &name, NULL));
+        visit->names.push_back (std::string (prefix) + name);
+        if (visit->stop_at && strcmp (visit->stop_at, name) == 0)
+            return visit->stop_status;
+        return DISIR_STATUS_OK;
+    }
+
+    static enum disir_status
+    record_pre (struct disir_context *context, void *userdata)
+    {
+        return record ("+", context, userdata);
+    }
+
+    static enum disir_status
+    record_post (struct disir_context *context, void *userdata)
+    {
+        return record ("-", context, userdata);
+    }
+
+public:
+    enum disir_status status;
+    struct disir_version version;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    struct disir_context *context_config = NULL;
+};
+
+
+TEST_F (VisitTest, foreach_visits_elements_in_order)
+{
+    struct visit visit;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_foreach_element (context_config, NULL, record_pre, &visit));
+
+    std::vector<std::string> expected = { "+first", "+repeated", "+repeated", "+last" };
+    EXPECT_EQ (expected, visit.names);
+}
+
+TEST_F (VisitTest, foreach_visits_elements_matching_name)
+{
+    struct visit visit;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_foreach_element (context_config, "repeated", record_pre, &visit));
+    EXPECT_EQ (2, visit.names.size ());
+
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST,
+                   dc_foreach_element (context_config, "missing", record_pre, &visit));
+    EXPECT_EQ (2, visit.names.size ());
+}
+
+TEST_F (VisitTest, foreach_stops_at_callback_status)
+{
+    struct visit visit;
+
+    visit.stop_at = "repeated";
+    visit.stop_status = DISIR_STATUS_EXHAUSTED;
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED,
+                   dc_foreach_element (context_config, NULL, record_pre, &visit));
+
+    std::vector<std::string> expected = { "+first", "+repeated" };
+    EXPECT_EQ (expected, visit.names);
+}
+
+TEST_F (VisitTest, foreach_invalid_arguments)
+{
+    struct disir_context *context_keyval;
+    struct visit visit;
+
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   dc_foreach_element (NULL, NULL, record_pre, &visit));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   dc_foreach_element (context_config, NULL, NULL, &visit));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_find_element (context_config, "first", 0, &context_keyval));
+    EXPECT_STATUS (DISIR_STATUS_WRONG_CONTEXT,
+                   dc_foreach_element (context_keyval, NULL, record_pre, &visit));
+    dc_putcontext (&context_keyval);
+}
+
+TEST_F (VisitTest, walk_visits_document_order)
+{
+    struct visit visit;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_walk (context_config, record_pre, record_post, &visit));
+
+    std::vector<std::string> expected = {
+        "+first", "-first",
+        "+repeated", "+one", "-one", "+two", "-two", "-repeated",
+        "+repeated", "+one", "-one", "+two", "-two", "-repeated",
+        "+last", "-last",
+    };
+    EXPECT_EQ (expected, visit.names);
+}
+
+TEST_F (VisitTest, walk_pre_skips_section_elements)
+{
+    struct visit visit;
+
+    visit.stop_at = "repeated";
+    visit.stop_status = DISIR_STATUS_NO_CAN_DO;
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_walk (context_config, record_pre, NULL, &visit));
+
+    std::vector<std::string> expected = { "+first", "+repeated", "+repeated", "+last" };
+    EXPECT_EQ (expected, visit.names);
+}
+
+TEST_F (VisitTest, walk_stops_at_callback_status)
+{
+    struct visit visit;
+
+    visit.stop_at = "one";
+    visit.stop_status = DISIR_STATUS_EXHAUSTED;
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED,
+                   dc_walk (context_config, NULL, record_post, &visit));
+
+    std::vector<std::string> expected = { "-first", "-one" };
+    EXPECT_EQ (expected, visit.names);
+}
+
+TEST_F (VisitTest, walk_mold)
+{
+    struct disir_context *context_mold;
+    struct visit visit;
+
+    context_mold = dc_mold_getcontext (mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_walk (context_mold, record_pre, NULL, &visit));
+    dc_putcontext (&context_mold);
+
+    std::vector<std::string> expected = { "+first", "+repeated", "+one", "+two", "+last" };
+    EXPECT_EQ (expected, visit.names);
+}
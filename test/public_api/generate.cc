@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "test_helper.h"
+
+
+//! Generate configs from a mold with a default history over VERSIONS versions.
+//! Configs at more versions than the mold keeps templates for are generated too.
+class GenerateTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter ();
+
+        create_mold ();
+        ASSERT_NO_SETUP_FAILURE ();
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (context_config)
+        {
+            dc_putcontext (&context_config);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Mold where `value` changes default at every version, `repeated` is generated twice,
+    //! and `optional` is not generated at all. `bounded` violates its restriction from 7.0.
+    void
+    create_mold (void)
+    {
+        struct disir_context *context_mold;
+        struct disir_context *context_section;
+        struct disir_context *context_keyval;
+        struct disir_version version;
+        uint32_t i;
+
+        version.sv_major = 1;
+        version.sv_minor = 0;
+
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_begin (&context_mold));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "value", 10, "doc",
+                                              &version, &context_keyval));
+        for (i = 2; i <= VERSIONS; i++)
+        {
+            version.sv_major = i;
+            ASSERT_STATUS (DISIR_STATUS_OK,
+                           dc_add_default_integer (context_keyval, i * 10, &version));
+        }
+        dc_putcontext (&context_keyval);
+
+        version.sv_major = 1;
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_set_name (context_section, "repeated", strlen ("repeated")));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_documentation (context_section, "doc", 3));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_restriction_entries_min (context_section, 2, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_string (context_section, "name", "first", "doc",
+                                             &version, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_set_name (context_section, "optional", strlen ("optional")));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_documentation (context_section, "doc", 3));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_restriction_entries_min (context_section, 0, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_boolean (context_section, "enabled", 1, "doc",
+                                              &version, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "bounded", 5, "doc",
+                                              &version, &context_keyval));
+        version.sv_major = 7;
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_default_integer (context_keyval, 50, &version));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_restriction_value_range (context_keyval, 0, 10, "doc", NULL, NULL));
+        dc_putcontext (&context_keyval);
+
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_finalize (&context_mold, &mold));
+    }
+
+    //! Generate a config at major.0 into config and context_config.
+    enum disir_status
+    generate (uint32_t major)
+    {
+        struct disir_version version;
+
+        if (context_config)
+            dc_putcontext (&context_config);
+        if (config)
+            disir_config_finished (&config);
+
+        version.sv_major = major;
+        version.sv_minor = 0;
+        status = disir_generate_config_from_mold (mold, &version, &config);
+        if (config)
+            context_config = dc_config_getcontext (config);
+        return status;
+    }
+
+public:
+    static const uint32_t VERSIONS = 8;
+
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    struct disir_context *context_config = NULL;
+};
+
+
+TEST_F (GenerateTest, defaults_at_each_version)
+{
+    const char *name;
+    int64_t value;
+    uint32_t i;
+    int pass;
+
+    // Versions beyond the first four are generated from the mold, since every template
+    // slot is taken. The second pass generates from the templates built in the first.
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 1; i <= 6; i++)
+        {
+            ASSERT_STATUS (DISIR_STATUS_OK, generate (i));
+
+            EXPECT_STATUS (DISIR_STATUS_OK,
+                           dc_config_get_keyval_integer (context_config, &value, "value"));
+            EXPECT_EQ (i * 10, value);
+            EXPECT_STATUS (DISIR_STATUS_OK,
+                           dc_config_get_keyval_string (context_config, &name, "repeated@1.name"));
+            EXPECT_STREQ ("first", name);
+            EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (config, NULL));
+        }
+    }
+}
+
+TEST_F (GenerateTest, entries_generated_once_per_minimum)
+{
+    struct disir_collection *collection;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, generate (1));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_find_elements (context_config, "repeated", &collection));
+    EXPECT_EQ (2, dc_collection_size (collection));
+    dc_collection_finished (&collection);
+
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST,
+                   dc_find_elements (context_config, "optional", &collection));
+}
+
+TEST_F (GenerateTest, invalid_default_is_generated_alike)
+{
+    enum disir_status templated;
+
+    // Version 7 is templated, version 8 is generated from the mold
+    // once every template slot is taken.
+    templated = generate (7);
+    EXPECT_NE (DISIR_STATUS_OK, templated);
+    generate (1);
+    generate (2);
+    generate (3);
+
+    EXPECT_STATUS (templated, generate (8));
+    EXPECT_STATUS (templated, generate (7));
+}
+
+TEST_F (GenerateTest, generate_from_config_root_section)
+{
+    struct disir_context *context_section;
+    uint8_t enabled;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_begin (mold, &context_config));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_generate_from_config_root (context_config));
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_set_name (context_section, "optional", strlen ("optional")));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_generate_from_config_root (context_section));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+    status = dc_config_finalize (&context_config, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    context_config = dc_config_getcontext (config);
+
+    // Generated in the section alone.
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_get_keyval_boolean (context_config, &enabled, "optional.enabled"));
+    EXPECT_EQ (1, enabled);
+}
+
+TEST_F (GenerateTest, generate_into_populated_section)
+{
+    struct disir_context *context_section;
+    struct disir_collection *collection;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_begin (mold, &context_config));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_set_name (context_section, "repeated", strlen ("repeated")));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_set_keyval_string (context_section, "custom", "name"));
+
+    // Generated alongside the keyval already present.
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_generate_from_config_root (context_section));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_find_elements (context_section, "name", &collection));
+    EXPECT_EQ (2, dc_collection_size (collection));
+    dc_collection_finished (&collection);
+
+    dc_destroy (&context_section);
+}
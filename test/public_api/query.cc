@@ -250,3 +250,110 @@ TEST_F (QueryTest, get_section_and_keyval_contexts)
     ASSERT_TRUE (dc_context_type (context_section) == DISIR_CONTEXT_SECTION);
 }
 
+TEST_F (QueryTest, compile_invalid_argument)
+{
+    struct disir_query *query = NULL;
+
+    status = dc_query_compile (NULL, "key_integer", &query);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_compile (context_mold, NULL, &query);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_compile (context_mold, "key_integer", NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_finished (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_finished (&query);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (QueryTest, compile_invalid_names_shall_fail)
+{
+    struct disir_query *query = NULL;
+    struct disir_context *context_section_mold = dc_mold_getcontext (section_mold);
+
+    status = dc_query_compile (context_section_mold, "section_name..k1", &query);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_compile (context_section_mold, "section_name@", &query);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_query_compile (context_section_mold, "section_name.k4", &query);
+    EXPECT_STATUS (DISIR_STATUS_MOLD_MISSING, status);
+
+    status = dc_query_compile (context_section_mold, "section_name.k1.k2", &query);
+    EXPECT_STATUS (DISIR_STATUS_CONFLICT, status);
+
+    EXPECT_TRUE (query == NULL);
+
+    dc_putcontext (&context_section_mold);
+}
+
+TEST_F (QueryTest, compiled_query_resolves_against_configs_of_mold)
+{
+    struct disir_query *query = NULL;
+    struct disir_config *config_second = NULL;
+    struct disir_context *context_section_mold = dc_mold_getcontext (section_mold);
+    const char *out;
+    int32_t size;
+
+    status = dc_query_compile (context_section_mold, "section_name@0.k2", &query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dc_putcontext (&context_section_mold);
+
+    status = disir_generate_config_from_mold (section_mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_generate_config_from_mold (section_mold, NULL, &config_second);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_set_keyval_string (config_second, "changed", "section_name.k2");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context = dc_config_getcontext (config);
+    status = dc_query_resolve (context, query, &context_keyval);
+    dc_putcontext (&context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_get_value_string (context_keyval, &out, &size);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("k2value", out);
+    dc_putcontext (&context_keyval);
+
+    context = dc_config_getcontext (config_second);
+    status = dc_query_resolve (context, query, &context_keyval);
+    dc_putcontext (&context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_get_value_string (context_keyval, &out, &size);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("changed", out);
+    dc_putcontext (&context_keyval);
+
+    disir_config_finished (&config_second);
+    status = dc_query_finished (&query);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_TRUE (query == NULL);
+}
+
+TEST_F (QueryTest, compiled_query_missing_index_shall_not_exist)
+{
+    struct disir_query *query = NULL;
+    struct disir_context *context_section_mold = dc_mold_getcontext (section_mold);
+
+    status = dc_query_compile (context_section_mold, "section_name@1.k1", &query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dc_putcontext (&context_section_mold);
+
+    status = disir_generate_config_from_mold (section_mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context = dc_config_getcontext (config);
+    status = dc_query_resolve (context, query, &context_keyval);
+    dc_putcontext (&context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    EXPECT_TRUE (context_keyval == NULL);
+
+    dc_query_finished (&query);
+}
+
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/snapshot.h>
+
+#include "test_helper.h"
+
+
+class SnapshotTest : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_snapshot_create (config, &snapshot);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (snapshot)
+        {
+            status = disir_snapshot_finished (&snapshot);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+        if (config)
+        {
+            status = disir_config_finished (&config);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status status;
+    struct disir_config *config = NULL;
+    struct disir_snapshot *snapshot = NULL;
+    const char *string_value = NULL;
+    int64_t integer_value = 0;
+    double float_value = 0;
+    uint8_t boolean_value = 1;
+};
+
+
+TEST_F (SnapshotTest, create_invalid_arguments)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_snapshot *other = NULL;
+
+    status = disir_snapshot_create (NULL, &other);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_create (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_finished (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_finished (&other);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (SnapshotTest, holds_every_keyval)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    // root, and two "first" sections each holding key_string,
+    // second.key_integer and the five maximal keyvals
+    EXPECT_EQ (15, disir_snapshot_numentries (snapshot));
+}
+
+TEST_F (SnapshotTest, get_values_of_every_type)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    status = disir_snapshot_get_keyval_integer (snapshot, &integer_value,
+                                                "first.maximal.key_integer");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (5, integer_value);
+
+    status = disir_snapshot_get_keyval_float (snapshot, &float_value, "first.maximal.key_float");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_DOUBLE_EQ (3.14, float_value);
+
+    status = disir_snapshot_get_keyval_boolean (snapshot, &boolean_value,
+                                                "first.maximal.key_boolean");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0, boolean_value);
+
+    status = disir_snapshot_get_keyval_enum (snapshot, &string_value, "first.maximal.key_enum");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("one", string_value);
+}
+
+TEST_F (SnapshotTest, explicit_index_equals_omitted_index)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    status = disir_snapshot_get_keyval_integer (snapshot, &integer_value,
+                                                "first@0.second@0.key_integer@0");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (5, integer_value);
+}
+
+TEST_F (SnapshotTest, get_type)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    enum disir_value_type type;
+
+    status = disir_snapshot_get_type (snapshot, &type, "first.maximal.key_float");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (DISIR_VALUE_TYPE_FLOAT, type);
+}
+
+TEST_F (SnapshotTest, missing_keys_do_not_exist)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "first@2.key_string");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root@1");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "first");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "a");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "zzz");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (SnapshotTest, wrong_value_type)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_snapshot_get_keyval_integer (snapshot, &integer_value, "root");
+    EXPECT_STATUS (DISIR_STATUS_WRONG_VALUE_TYPE, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "first.maximal.key_enum");
+    EXPECT_STATUS (DISIR_STATUS_WRONG_VALUE_TYPE, status);
+}
+
+TEST_F (SnapshotTest, malformed_keys_are_invalid)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root@");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root@x");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "first..key_string");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root.");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (snapshot, NULL, "root");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_snapshot_get_keyval_string (NULL, &string_value, "root");
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (SnapshotTest, equal_strings_are_interned)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    const char *other;
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_snapshot_get_keyval_string (snapshot, &other, "first.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (string_value, other);
+}
+
+TEST_F (SnapshotTest, independent_of_config)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_config_set_keyval_string (config, "changed", "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_finished (&config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_snapshot_get_keyval_string (snapshot, &string_value, "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+}
+
+TEST_F (SnapshotTest, version)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_version snapshot_version;
+    struct disir_version config_version;
+
+    status = disir_snapshot_version (snapshot, &snapshot_version);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    struct disir_context *context_config = dc_config_getcontext (config);
+    status = dc_get_version (context_config, &config_version);
+    dc_putcontext (&context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0, dc_version_compare (&config_version, &snapshot_version));
+}
+
+TEST_F (SnapshotTest, publish_and_acquire)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_snapshot *slot = NULL;
+    struct disir_snapshot *updated = NULL;
+
+    EXPECT_EQ (NULL, disir_snapshot_acquire (&slot));
+    EXPECT_EQ (NULL, disir_snapshot_publish (&slot, snapshot));
+    EXPECT_EQ (snapshot, disir_snapshot_acquire (&slot));
+
+    status = disir_config_set_keyval_string (config, "changed", "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_snapshot_create (config, &updated);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (snapshot, disir_snapshot_publish (&slot, updated));
+
+    status = disir_snapshot_get_keyval_string (disir_snapshot_acquire (&slot),
+                                               &string_value, "root");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("changed", string_value);
+
+    disir_snapshot_finished (&updated);
+}
+
+TEST_F (SnapshotTest, concurrent_readers)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    std::vector<std::thread> readers;
+    int failures[4] = {0};
+
+    for (int i = 0; i < 4; i++)
+    {
+        readers.push_back (std::thread ([this, &failures, i] () {
+            int64_t value;
+            for (int j = 0; j < 10000; j++)
+            {
+                if (disir_snapshot_get_keyval_integer (snapshot, &value,
+                                                       "first.second.key_integer")
+                        != DISIR_STATUS_OK || value != 5)
+                {
+                    failures[i]++;
+                }
+            }
+        }));
+    }
+    for (auto &reader : readers)
+    {
+        reader.join ();
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ (0, failures[i]);
+    }
+}
@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+
+
+class StatsTest : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_instance_stats (instance, &before);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (before)
+        {
+            disir_stats_finished (&before);
+        }
+        if (after)
+        {
+            disir_stats_finished (&after);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Return the counters of the test plugin in stats.
+    struct disir_plugin_stats *
+    test_plugin (struct disir_stats *stats)
+    {
+        struct disir_plugin_stats *plugin;
+
+        for (plugin = stats->st_plugins; plugin != NULL; plugin = plugin->next)
+        {
+            if (strcmp (plugin->ps_io_id, "test") == 0)
+                return plugin;
+        }
+        return NULL;
+    }
+
+    //! Number of calls to operation counted between before and after.
+    uint64_t
+    calls (enum disir_stats_operation operation)
+    {
+        return after->st_operations[operation].sc_calls
+               - before->st_operations[operation].sc_calls;
+    }
+
+public:
+    struct disir_stats *before = NULL;
+    struct disir_stats *after = NULL;
+    struct disir_config *config = NULL;
+};
+
+
+TEST_F (StatsTest, invalid_arguments)
+{
+    status = disir_instance_stats (NULL, &after);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_instance_stats (instance, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_stats_finished (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_stats_finished (&after);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (StatsTest, config_read_is_counted)
+{
+    struct disir_plugin_stats *plugin_before;
+    struct disir_plugin_stats *plugin_after;
+    struct disir_stats_counter *counter;
+    uint64_t histogram;
+    int i;
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_instance_stats (instance, &after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (1, calls (DISIR_STATS_CONFIG_READ));
+    EXPECT_EQ (before->st_operations[DISIR_STATS_CONFIG_READ].sc_errors,
+               after->st_operations[DISIR_STATS_CONFIG_READ].sc_errors);
+    EXPECT_LE (1, calls (DISIR_STATS_VALIDATE));
+
+    counter = &after->st_operations[DISIR_STATS_CONFIG_READ];
+    EXPECT_LT (0, counter->sc_nanoseconds);
+    histogram = 0;
+    for (i = 0; i < DISIR_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        histogram += counter->sc_histogram[i];
+    }
+    EXPECT_EQ (counter->sc_calls, counter->sc_timed);
+    EXPECT_EQ (counter->sc_timed, histogram);
+
+    // The plugin was queried for the entry, and read it.
+    plugin_before = test_plugin (before);
+    plugin_after = test_plugin (after);
+    ASSERT_TRUE (plugin_before != NULL);
+    ASSERT_TRUE (plugin_after != NULL);
+    EXPECT_STREQ ("test", plugin_after->ps_group_id);
+    EXPECT_EQ (plugin_before->ps_operations[DISIR_STATS_CONFIG_READ].sc_calls + 1,
+               plugin_after->ps_operations[DISIR_STATS_CONFIG_READ].sc_calls);
+    EXPECT_EQ (plugin_before->ps_operations[DISIR_STATS_CONFIG_QUERY].sc_calls + 1,
+               plugin_after->ps_operations[DISIR_STATS_CONFIG_QUERY].sc_calls);
+    EXPECT_EQ (0, plugin_after->ps_operations[DISIR_STATS_VALIDATE].sc_calls);
+}
+
+TEST_F (StatsTest, missing_entry_is_counted_as_error)
+{
+    status = disir_config_read (instance, "test", "no_such_entry", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    status = disir_instance_stats (instance, &after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (1, calls (DISIR_STATS_CONFIG_READ));
+    EXPECT_EQ (before->st_operations[DISIR_STATS_CONFIG_READ].sc_errors + 1,
+               after->st_operations[DISIR_STATS_CONFIG_READ].sc_errors);
+}
+
+TEST_F (StatsTest, query_resolve_is_counted)
+{
+    struct disir_context *context_config;
+    struct disir_context *keyval;
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    disir_stats_finished (&before);
+    status = disir_instance_stats (instance, &before);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    context_config = dc_config_getcontext (config);
+    status = dc_query_resolve_context (context_config, "no_such_keyval", &keyval);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    dc_putcontext (&context_config);
+
+    status = disir_instance_stats (instance, &after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (1, calls (DISIR_STATS_QUERY_RESOLVE));
+    EXPECT_EQ (before->st_operations[DISIR_STATS_QUERY_RESOLVE].sc_errors + 1,
+               after->st_operations[DISIR_STATS_QUERY_RESOLVE].sc_errors);
+}
+
+TEST_F (StatsTest, counters_survive_thread_exit)
+{
+    std::thread reader ([] {
+        struct disir_config *threaded = NULL;
+        if (disir_config_read (instance, "test", "basic_keyval", NULL, &threaded)
+            == DISIR_STATUS_OK)
+        {
+            disir_config_finished (&threaded);
+        }
+    });
+    reader.join ();
+
+    status = disir_instance_stats (instance, &after);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (1, calls (DISIR_STATS_CONFIG_READ));
+}
+
+// Threads exiting while the instance is destroyed release their counters safely.
+TEST_F (StatsTest, instance_destroyed_while_threads_exit)
+{
+    for (int round = 0; round < 20; round++)
+    {
+        struct disir_instance *other = NULL;
+        std::vector<std::thread> threads;
+        std::atomic<int> done (0);
+
+        status = disir_instance_create (NULL, NULL, &other);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        for (int i = 0; i < 8; i++)
+        {
+            threads.push_back (std::thread ([other, &done] {
+                struct disir_config *threaded = NULL;
+
+                // Leaves both error storage and counters behind on other.
+                disir_config_read (other, "test", "no_such_entry", NULL, &threaded);
+                done++;
+            }));
+        }
+
+        // The threads no longer use the instance, but are likely still exiting.
+        while (done.load () != 8)
+        {
+            std::this_thread::yield ();
+        }
+        disir_instance_destroy (&other);
+
+        for (auto &thread : threads)
+        {
+            thread.join ();
+        }
+    }
+}
+
+// The per-thread state of an instance does not consume a thread-specific key of its own.
+TEST_F (StatsTest, instances_outnumber_thread_keys)
+{
+    std::vector<struct disir_instance *> instances;
+    struct disir_instance *other;
+    struct disir_config *threaded;
+
+    // Two keys per instance would exhaust PTHREAD_KEYS_MAX well before this.
+    for (int i = 0; i < 600; i++)
+    {
+        other = NULL;
+        status = disir_instance_create (NULL, NULL, &other);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        instances.push_back (other);
+
+        threaded = NULL;
+        disir_config_read (other, "test", "no_such_entry", NULL, &threaded);
+    }
+
+    for (auto other : instances)
+    {
+        EXPECT_TRUE (disir_error (other) != NULL);
+        disir_instance_destroy (&other);
+    }
+}
+
+TEST_F (StatsTest, percentile)
+{
+    struct disir_stats_counter counter;
+
+    memset (&counter, 0, sizeof (counter));
+    EXPECT_EQ (0, disir_stats_percentile (&counter, 50));
+
+    // 90 calls in [8, 16) ns and 10 calls in [1024, 2048) ns.
+    counter.sc_histogram[3] = 90;
+    counter.sc_histogram[10] = 10;
+
+    EXPECT_EQ (16, disir_stats_percentile (&counter, 50));
+    EXPECT_EQ (16, disir_stats_percentile (&counter, 90));
+    EXPECT_EQ (2048, disir_stats_percentile (&counter, 99));
+    EXPECT_EQ (2048, disir_stats_percentile (&counter, 100));
+}
+
+TEST_F (StatsTest, operation_string)
+{
+    EXPECT_STREQ ("config_read", disir_stats_operation_string (DISIR_STATS_CONFIG_READ));
+    EXPECT_STREQ ("query_resolve", disir_stats_operation_string (DISIR_STATS_QUERY_RESOLVE));
+    EXPECT_STREQ ("UNKNOWN", disir_stats_operation_string (DISIR_STATS_OPERATION_UNKNOWN));
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <stdlib.h>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+
+
+class TraceTest : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        int fd = mkstemp (filepath);
+        ASSERT_NE (-1, fd);
+        close (fd);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        disir_trace_filepath_set (NULL);
+        unlink (filepath);
+
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Contents of the trace file.
+    std::string
+    trace (void)
+    {
+        std::ifstream file (filepath);
+        std::stringstream contents;
+
+        contents << file.rdbuf ();
+        return contents.str ();
+    }
+
+    //! Number of spans of function in the trace file.
+    int
+    spans (const std::string& contents, const std::string& function)
+    {
+        std::string needle = "\"name\":\"" + function + "\"";
+        size_t position = 0;
+        int count = 0;
+
+        while ((position = contents.find (needle, position)) != std::string::npos)
+        {
+            position += needle.size ();
+            count++;
+        }
+        return count;
+    }
+
+public:
+    char filepath[64] = "/tmp/disir_trace_test_XXXXXX";
+    struct disir_config *config = NULL;
+};
+
+
+TEST_F (TraceTest, flush_without_filepath)
+{
+    status = disir_trace_flush ();
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (TraceTest, invalid_arguments)
+{
+    std::string too_long (8192, 'a');
+
+    status = disir_trace_filepath_set (too_long.c_str ());
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_trace_flush ();
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (TraceTest, api_calls_are_written_as_trace_events)
+{
+    std::string contents;
+
+    status = disir_trace_filepath_set (filepath);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_trace_flush ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    contents = trace ();
+    EXPECT_EQ (0, contents.find ("{\"traceEvents\":["));
+    EXPECT_NE (std::string::npos, contents.find ("\"ph\":\"X\""));
+    EXPECT_NE (std::string::npos, contents.find ("\"displayTimeUnit\":\"ns\""));
+    EXPECT_EQ (1, spans (contents, "disir_config_read"));
+}
+
+TEST_F (TraceTest, spans_of_every_thread_are_written)
+{
+    std::string contents;
+    std::string tid_main;
+    std::string tid_thread;
+    size_t position;
+
+    status = disir_trace_filepath_set (filepath);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    std::thread reader ([] {
+        struct disir_config *threaded = NULL;
+        if (disir_config_read (instance, "test", "basic_keyval", NULL, &threaded)
+            == DISIR_STATUS_OK)
+        {
+            disir_config_finished (&threaded);
+        }
+    });
+    reader.join ();
+
+    // Stopping writes the spans recorded so far.
+    status = disir_trace_filepath_set (NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    contents = trace ();
+    ASSERT_EQ (2, spans (contents, "disir_config_read"));
+
+    position = contents.find ("\"name\":\"disir_config_read\"");
+    position = contents.find ("\"tid\":", position);
+    tid_main = contents.substr (position, contents.find ("}", position) - position);
+    position = contents.find ("\"name\":\"disir_config_read\"", position);
+    position = contents.find ("\"tid\":", position);
+    tid_thread = contents.substr (position, contents.find ("}", position) - position);
+    EXPECT_NE (tid_main, tid_thread);
+}
+
+TEST_F (TraceTest, nothing_is_recorded_once_stopped)
+{
+    status = disir_trace_filepath_set (filepath);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_trace_filepath_set (NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_trace_flush ();
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+// Spans are closed on every return - early returns neither leak nor pile up.
+TEST_F (TraceTest, early_returns_close_their_span)
+{
+    struct disir_context *context_config;
+    std::string contents;
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    context_config = dc_config_getcontext (config);
+
+    status = disir_trace_filepath_set (filepath);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // More often than the stack of open spans may hold.
+    for (int i = 0; i < 300; i++)
+    {
+        // Returns early, without TRACE_EXIT, on the missing version.
+        status = dc_get_version (context_config, NULL);
+        EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    }
+    dc_putcontext (&context_config);
+
+    status = disir_trace_flush ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    contents = trace ();
+    EXPECT_EQ (300, spans (contents, "dc_get_version"));
+    EXPECT_NE (std::string::npos, contents.find ("\"dropped_spans\":\"0\""));
+}
@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+
+#include "test_helper.h"
+
+
+class UpdatePlanTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter ();
+
+        version_1.sv_major = 1;
+        version_1.sv_minor = 0;
+        version_2.sv_major = 2;
+        version_2.sv_minor = 0;
+
+        create_mold ();
+        ASSERT_NO_SETUP_FAILURE ();
+
+        status = disir_generate_config_from_mold (mold, &version_1, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        context_config = dc_config_getcontext (config);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (plan)
+        {
+            disir_update_plan_finished (&plan);
+        }
+        if (context_config)
+        {
+            dc_putcontext (&context_config);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Mold at version 2.0, where `changed` and `server.port` got new defaults.
+    void
+    create_mold (void)
+    {
+        struct disir_context *context_mold;
+        struct disir_context *context_section;
+        struct disir_context *context_keyval;
+
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_begin (&context_mold));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "changed", 1, "doc",
+                                              &version_1, &context_keyval));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_default_integer (context_keyval, 2, &version_2));
+        dc_putcontext (&context_keyval);
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_mold, "restated", 5, "doc",
+                                              &version_1, &context_keyval));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_default_integer (context_keyval, 5, &version_2));
+        dc_putcontext (&context_keyval);
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_string (context_mold, "unchanged", "value", "doc",
+                                             &version_1, NULL));
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_set_name (context_section, "server", strlen ("server")));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_documentation (context_section, "doc", 3));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_restriction_entries_max (context_section, 0, NULL));
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_add_keyval_integer (context_section, "port", 80, "doc",
+                                              &version_1, &context_keyval));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_add_default_integer (context_keyval, 8080, &version_2));
+        dc_putcontext (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_finalize (&context_mold, &mold));
+    }
+
+    //! Add another server section, at its defaults, to the config.
+    void
+    add_server (void)
+    {
+        struct disir_context *context_section;
+
+        ASSERT_STATUS (DISIR_STATUS_OK,
+                       dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_set_name (context_section, "server", strlen ("server")));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_generate_from_config_root (context_section));
+        ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+    }
+
+public:
+    enum disir_status status;
+    struct disir_version version_1;
+    struct disir_version version_2;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    struct disir_context *context_config = NULL;
+    struct disir_update_plan *plan = NULL;
+};
+
+
+TEST_F (UpdatePlanTest, create_invalid_arguments)
+{
+    status = disir_update_plan_create (NULL, &version_1, NULL, &plan);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_update_plan_create (mold, NULL, NULL, &plan);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_update_plan_create (mold, &version_1, NULL, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_update_plan_finished (NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = disir_update_plan_finished (&plan);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    EXPECT_EQ (-1, disir_update_plan_size (NULL));
+}
+
+TEST_F (UpdatePlanTest, create_version_order)
+{
+    status = disir_update_plan_create (mold, &version_2, &version_1, &plan);
+    EXPECT_STATUS (DISIR_STATUS_CONFLICTING_SEMVER, status);
+
+    status = disir_update_plan_create (mold, &version_2, NULL, &plan);
+    EXPECT_STATUS (DISIR_STATUS_NO_CAN_DO, status);
+}
+
+TEST_F (UpdatePlanTest, lists_changed_defaults)
+{
+    const char *name;
+    const char *source;
+    const char *target;
+
+    status = disir_update_plan_create (mold, &version_1, NULL, &plan);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_EQ (2, disir_update_plan_size (plan));
+
+    status = disir_update_plan_entry (plan, 0, &name, &source, &target);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("changed", name);
+    EXPECT_STREQ ("1", source);
+    EXPECT_STREQ ("2", target);
+
+    status = disir_update_plan_entry (plan, 1, &name, &source, &target);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("server.port", name);
+    EXPECT_STREQ ("80", source);
+    EXPECT_STREQ ("8080", target);
+
+    status = disir_update_plan_entry (plan, 2, &name, &source, &target);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_update_plan_entry (plan, -1, &name, &source, &target);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = disir_update_plan_entry (plan, 0, NULL, &source, &target);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (UpdatePlanTest, apply_updates_defaults_and_version)
+{
+    struct disir_version version;
+    int64_t value;
+    int updated;
+    int conflicts;
+
+    add_server ();
+    ASSERT_NO_FATAL_FAILURE ();
+
+    status = disir_update_plan_create (mold, &version_1, NULL, &plan);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_update_plan_apply (plan, config, 0, &updated, &conflicts);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (3, updated);
+    EXPECT_EQ (0, conflicts);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_get_keyval_integer (context_config, &value, "changed"));
+    EXPECT_EQ (2, value);
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_get_keyval_integer (context_config, &value, "server@0.port"));
+    EXPECT_EQ (8080, value);
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_get_keyval_integer (context_config, &value, "server@1.port"));
+    EXPECT_EQ (8080, value);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_get_version (context_config, &version));
+    EXPECT_EQ (0, dc_version_compare (&version, &version_2));
+    EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (config, NULL));
+
+    // The config is no longer at the source version of the plan.
+    status = disir_update_plan_apply (plan, config, 0, &updated, &conflicts);
+    EXPECT_STATUS (DISIR_STATUS_CONFLICTING_SEMVER, status);
+}
+
+TEST_F (UpdatePlanTest, apply_keeps_customized_values)
+{
+    struct disir_version version;
+    int64_t value;
+    int updated;
+    int conflicts;
+
+    add_server ();
+    ASSERT_NO_FATAL_FAILURE ();
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_set_keyval_integer (context_config, 7, "changed"));
+
+    status = disir_update_plan_create (mold, &version_1, NULL, &plan);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Customized values are conflicts - config is left untouched.
+    status = disir_update_plan_apply (plan, config, 0, &updated, &conflicts);
+    ASSERT_STATUS (DISIR_STATUS_CONFLICT, status);
+    EXPECT_EQ (0, updated);
+    EXPECT_EQ (1, conflicts);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_get_keyval_integer (context_config, &value, "changed"));
+    EXPECT_EQ (7, value);
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_get_keyval_integer (context_config, &value, "server@1.port"));
+    EXPECT_EQ (80, value);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_get_version (context_config, &version));
+    EXPECT_EQ (0, dc_version_compare (&version, &version_1));
+
+    // Unless the caller chooses to keep them.
+    status = disir_update_plan_apply (plan, config, 1, &updated, &conflicts);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (2, updated);
+    EXPECT_EQ (1, conflicts);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_get_keyval_integer (context_config, &value, "changed"));
+    EXPECT_EQ (7, value);
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   dc_config_get_keyval_integer (context_config, &value, "server@1.port"));
+    EXPECT_EQ (8080, value);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_get_version (context_config, &version));
+    EXPECT_EQ (0, dc_version_compare (&version, &version_2));
+}
+
+TEST_F (UpdatePlanTest, apply_to_many_configs)
+{
+    struct disir_config *configs[8];
+    int64_t value;
+    int updated;
+    int i;
+
+    status = disir_update_plan_create (mold, &version_1, &version_2, &plan);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (i = 0; i < 8; i++)
+    {
+        status = disir_generate_config_from_mold (mold, &version_1, &configs[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+    for (i = 0; i < 8; i++)
+    {
+        struct disir_context *context;
+
+        status = disir_update_plan_apply (plan, configs[i], 0, &updated, NULL);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_EQ (2, updated);
+
+        context = dc_config_getcontext (configs[i]);
+        EXPECT_STATUS (DISIR_STATUS_OK, dc_config_get_keyval_integer (context, &value, "changed"));
+        EXPECT_EQ (2, value);
+        dc_putcontext (&context);
+        disir_config_finished (&configs[i]);
+    }
+}
+
+TEST_F (UpdatePlanTest, apply_invalid_arguments)
+{
+    struct disir_mold *other = NULL;
+    struct disir_config *other_config = NULL;
+
+    status = disir_update_plan_create (mold, &version_1, NULL, &plan);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_update_plan_apply (NULL, config, 0, NULL, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = disir_update_plan_apply (plan, NULL, 0, NULL, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    // A config of another mold
+    std::swap (mold, other);
+    create_mold ();
+    std::swap (mold, other);
+    ASSERT_NO_FATAL_FAILURE ();
+    status = disir_generate_config_from_mold (other, &version_1, &other_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_update_plan_apply (plan, other_config, 0, NULL, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    disir_config_finished (&other_config);
+    disir_mold_finished (&other);
+}
@@ -294,3 +294,188 @@ TEST_F (ValidateTest, generate_config_version_is_sat_correctly)
     disir_config_finished (&config);
 }
 
+
+// A section validated when finalized must be validated again once its children change.
+TEST_F (ValidateTest, config_section_revalidated_after_child_removed)
+{
+    struct disir_context *context_section = NULL;
+
+    setup_testmold ("restriction_entries");
+
+    dc_putcontext (&context_config);
+    status = dc_config_begin (mold, &context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "keyval_default", strlen ("keyval_default"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_finalize (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (int i = 0; i < 2; i++)
+    {
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_keyval, "keyval_complex", strlen ("keyval_complex"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    // section_default requires one 'nonempty' keyval.
+    status = dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_section, "section_default", strlen ("section_default"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_begin (context_section, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "nonempty", strlen ("nonempty"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_finalize (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_finalize (&context_section);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_find_element (context_config, "section_default", 0, &context_section);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Remove the required keyval after the section was validated.
+    status = dc_find_element (context_section, "nonempty", 0, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_destroy (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_config_finalize (&context_config, &config);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = disir_config_valid (config, &collection);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    ASSERT_TRUE (collection != NULL);
+    EXPECT_EQ (1, dc_collection_size (collection));
+
+    dc_collection_next (collection, &context);
+    EXPECT_EQ (context_section, context);
+
+    dc_putcontext (&context);
+    dc_putcontext (&context_section);
+}
+
+TEST_F (ValidateTest, validate_threads_set)
+{
+    EXPECT_EQ (1, disir_validate_threads ());
+
+    status = disir_validate_threads_set (-1);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    EXPECT_EQ (1, disir_validate_threads ());
+
+    status = disir_validate_threads_set (0);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0, disir_validate_threads ());
+
+    status = disir_validate_threads_set (1);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+}
+
+// The setting belongs to the process; creating an instance leaves it alone.
+TEST_F (ValidateTest, validate_threads_not_set_by_instance)
+{
+    struct disir_instance *other = NULL;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_validate_threads_set (3));
+
+    status = disir_instance_create (NULL, NULL, &other);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (3, disir_validate_threads ());
+
+    if (other)
+    {
+        disir_instance_destroy (&other);
+    }
+    disir_validate_threads_set (1);
+}
+
+// Top-level sections validated by several threads yield the same outcome as serially.
+TEST_F (ValidateTest, config_sections_validated_in_parallel)
+{
+    struct disir_context *sections[2];
+    struct disir_context *context_section;
+    enum disir_status finalize_status[2];
+    enum disir_status valid_status[2];
+    int collected[2][2];
+    int threads[2] = { 1, 4 };
+
+    setup_testmold ("restriction_entries");
+
+    for (int run = 0; run < 2; run++)
+    {
+        status = disir_validate_threads_set (threads[run]);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        dc_putcontext (&context_config);
+        status = dc_config_begin (mold, &context_config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        for (int i = 0; i < 2; i++)
+        {
+            status = dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_section, "section_default",
+                                  strlen ("section_default"));
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_begin (context_section, DISIR_CONTEXT_KEYVAL, &context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_keyval, "nonempty", strlen ("nonempty"));
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_finalize (&context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_finalize (&context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_find_element (context_config, "section_default", i, &sections[i]);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        // Invalidate both sections after they were validated, so that both are validated anew.
+        for (int i = 0; i < 2; i++)
+        {
+            status = dc_find_element (sections[i], "nonempty", 0, &context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_destroy (&context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        finalize_status[run] = dc_config_finalize (&context_config, &config);
+
+        valid_status[run] = disir_config_valid (config, &collection);
+        ASSERT_TRUE (collection != NULL);
+        // The config itself lacks the required keyval_complex entries.
+        ASSERT_EQ (3, dc_collection_size (collection));
+        dc_collection_next (collection, &context);
+        EXPECT_EQ (DISIR_CONTEXT_CONFIG, dc_context_type (context));
+        dc_putcontext (&context);
+        for (int i = 0; i < 2; i++)
+        {
+            dc_collection_next (collection, &context);
+            collected[run][i] = (context == sections[0] ? 0 : (context == sections[1] ? 1 : -1));
+            dc_putcontext (&context);
+        }
+
+        dc_collection_finished (&collection);
+        dc_putcontext (&sections[0]);
+        dc_putcontext (&sections[1]);
+        disir_config_finished (&config);
+    }
+
+    disir_validate_threads_set (1);
+
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, finalize_status[0]);
+    EXPECT_STATUS (finalize_status[0], finalize_status[1]);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, valid_status[0]);
+    EXPECT_STATUS (valid_status[0], valid_status[1]);
+
+    // Collected in document order
+    EXPECT_EQ (0, collected[0][0]);
+    EXPECT_EQ (1, collected[0][1]);
+    EXPECT_EQ (0, collected[1][0]);
+    EXPECT_EQ (1, collected[1][1]);
+}